@@ -108,6 +108,25 @@ svn_txdelta__read_raw_window_len(apr_size_t *window_len,
                                  svn_stream_t *stream,
                                  apr_pool_t *pool);
 
+/** Like svn_txdelta2() but let the source view of each window follow
+ * the target data instead of using fixed-size, aligned source views.
+ * If data got inserted into or removed from @a target, the source view
+ * gets shifted accordingly, so large files remain deltifiable beyond
+ * the first modification.
+ *
+ * Windows still fit into #SVN_DELTA_WINDOW_SIZE and their source views
+ * never slide backwards, i.e. any svndiff consumer, including older
+ * ones, can apply them.  However, they must not be stored in backends
+ * that expect window N of a delta to use the target view of window N
+ * of its base as source (FSFS, FSX, BDB).
+ */
+void
+svn_txdelta__sliding(svn_txdelta_stream_t **stream,
+                     svn_stream_t *source,
+                     svn_stream_t *target,
+                     svn_boolean_t calculate_checksum,
+                     apr_pool_t *pool);
+
 /* Return a debug editor that wraps @a wrapped_editor.
  *
  * The debug editor simply prints an indication of what callbacks are being
@@ -85,6 +85,28 @@ svn_io__file_lock_autocreate(const char *lock_file,
                              apr_pool_t *pool);
 
 
+/**
+ * Tell the OS that @a file is about to be read sequentially and only
+ * once.  This lets it read ahead more aggressively.
+ *
+ * This is merely a hint.  It is a no-op on platforms that don't support
+ * it and failures are silently ignored.
+ */
+void
+svn_io__file_advise_sequential(apr_file_t *file);
+
+/**
+ * Tell the OS that the cached contents of @a file will not be needed
+ * anymore and may be evicted from the page cache.  Use this after bulk
+ * scans to prevent them from evicting more useful data.
+ *
+ * This is merely a hint.  It is a no-op on platforms that don't support
+ * it and failures are silently ignored.
+ */
+void
+svn_io__file_advise_dontneed(apr_file_t *file);
+
+
 /** Return the underlying file, if any, associated with the stream, or
  * NULL if not available.  Accessing the file bypasses the stream.
  */
@@ -127,6 +149,30 @@ svn_stream__install_get_info(apr_finfo_t *finfo,
                              apr_int32_t wanted,
                              apr_pool_t *scratch_pool);
 
+/* Set *STREAM to a stream that reads SOURCE ahead of its consumers in a
+   separate thread and buffers up to a few MB of its contents.  This lets
+   reading the raw input overlap with processing it.  Any decoding that
+   SOURCE's consumers do still happens in their thread.  *STREAM supports
+   reading and readline only.  Closing *STREAM closes SOURCE as well.
+
+   Closing *STREAM or clearing RESULT_POOL waits for the worker thread.
+   A read from SOURCE that has already been issued cannot be interrupted,
+   i.e. this will block until SOURCE delivers some data, EOF or an error.
+   That is immediate for files but not for terminals or pipes whose
+   writer stalls.  Don't use this for interactive input.
+
+   Because SOURCE is being read from another thread, its read functions
+   must not allocate from any pool that other threads use.  It is best to
+   allocate SOURCE in a pool of its own.  SOURCE must remain valid for
+   the lifetime of RESULT_POOL.
+
+   Without thread support, *STREAM will simply be SOURCE.
+ */
+svn_error_t *
+svn_stream__read_ahead(svn_stream_t **stream,
+                       svn_stream_t *source,
+                       apr_pool_t *result_pool);
+
 /* Internal version of svn_stream_from_aprfile2() supporting the
    additional TRUNCATE_ON_SEEK argument. */
 svn_stream_t *
@@ -130,6 +130,73 @@ svn_repos__fs_type(const char **fs_type,
                    const char *repos_path,
                    apr_pool_t *pool);
 
+/**
+ * Like svn_repos_authz_check_access() but check all absolute paths
+ * (const char *) in @a paths in one go and set the respective element
+ * of the @a access_granted array, which must have at least
+ * @a paths->nelts elements.
+ *
+ * Lookups of consecutive paths share the work for their common parent
+ * paths.  Hence, @a paths should be sorted with svn_sort_compare_paths()
+ * or be in depth-first order.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_repos__authz_check_access_many(svn_boolean_t *access_granted,
+                                   svn_authz_t *authz,
+                                   const char *repos_name,
+                                   const apr_array_header_t *paths,
+                                   const char *user,
+                                   svn_repos_authz_access_t required_access,
+                                   apr_pool_t *scratch_pool);
+
+/**
+ * Batch version of #svn_repos_authz_func_t:  Set the elements of the
+ * @a allowed array to whether the respective path (const char *) in
+ * @a paths under @a root is readable.  @a paths will be in depth-first
+ * order.  Use @a pool for temporary allocations only.
+ */
+typedef svn_error_t *(*svn_repos__authz_many_func_t)(
+  svn_boolean_t *allowed,
+  svn_fs_root_t *root,
+  const apr_array_header_t *paths,
+  void *baton,
+  apr_pool_t *pool);
+
+/**
+ * Declare @a many_func to be the batch version of @a authz_func, i.e.
+ * for the same baton it returns the same results as calling @a authz_func
+ * for every path individually.  svn_repos__authz_read_many() will call
+ * @a many_func instead of @a authz_func from then on.
+ *
+ * This is not thread-safe.  Call it during initialization, before any
+ * authz checks are being made.
+ */
+svn_error_t *
+svn_repos__authz_register_many_func(svn_repos_authz_func_t authz_func,
+                                    svn_repos__authz_many_func_t many_func);
+
+/**
+ * Set the elements of the @a allowed array, which must have at least
+ * @a paths->nelts elements, to whether @a authz_func with @a authz_baton
+ * grants read access to the respective path (const char *) in @a paths
+ * under @a root.
+ *
+ * @a paths may be in any order.  They will be checked in depth-first
+ * order, using the batch function registered for @a authz_func if there
+ * is one.  This lets consecutive lookups share the work for their common
+ * parent paths.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_repos__authz_read_many(svn_boolean_t *allowed,
+                           svn_repos_authz_func_t authz_func,
+                           void *authz_baton,
+                           svn_fs_root_t *root,
+                           const apr_array_header_t *paths,
+                           apr_pool_t *scratch_pool);
 
 /* Create a commit editor for REPOS, based on REVISION.  */
 svn_error_t *
@@ -155,6 +222,67 @@ svn_repos__replay_ev2(svn_fs_root_t *root,
                       void *authz_read_baton,
                       apr_pool_t *scratch_pool);
 
+/** Helper reading revision data ahead of svn_repos_replay2().
+ * @see svn_repos__replay_prefetcher_start()
+ */
+typedef struct svn_repos__replay_prefetcher_t svn_repos__replay_prefetcher_t;
+
+/**
+ * Prepare for replaying revisions @a start_rev to @a end_rev of @a repos
+ * in ascending order, e.g. for a replay-range request.  Start a helper
+ * thread in @a *prefetcher_p that reads the changes below @a base_path
+ * and, if @a send_deltas is set, the changed file contents of the next
+ * few revisions into the caches while the current one is being replayed.
+ * The helper stays a bounded number of revisions and bytes ahead of the
+ * revision last passed to svn_repos__replay_prefetcher_progress(), so a
+ * slow receiver cannot make it read arbitrarily far ahead.  The helper
+ * opens its own instance of the repository's filesystem, using the
+ * FS configuration that @a repos was opened with.
+ *
+ * If prefetching is not worthwhile or not supported, set @a *prefetcher_p
+ * to @c NULL.  Allocate the helper in @a result_pool.
+ */
+svn_error_t *
+svn_repos__replay_prefetcher_start(
+  svn_repos__replay_prefetcher_t **prefetcher_p,
+  svn_repos_t *repos,
+  const char *base_path,
+  svn_revnum_t start_rev,
+  svn_revnum_t end_rev,
+  svn_boolean_t send_deltas,
+  apr_pool_t *result_pool);
+
+/**
+ * Tell @a prefetcher that revision @a rev is about to be replayed.
+ * @a prefetcher may be @c NULL.
+ */
+svn_error_t *
+svn_repos__replay_prefetcher_progress(
+  svn_repos__replay_prefetcher_t *prefetcher,
+  svn_revnum_t rev);
+
+/**
+ * Wait until the helper thread of @a prefetcher has read everything it
+ * may read for now.  Then, set @a *prefetched_rev to the youngest
+ * revision read so far and @a *bytes_ahead to the number of content
+ * bytes read for revisions after the one last passed to
+ * svn_repos__replay_prefetcher_progress().  @a prefetcher must not be
+ * @c NULL.  This is mainly useful for testing.
+ */
+svn_error_t *
+svn_repos__replay_prefetcher_wait(
+  svn_revnum_t *prefetched_rev,
+  apr_size_t *bytes_ahead,
+  svn_repos__replay_prefetcher_t *prefetcher);
+
+/**
+ * Make the helper thread of @a prefetcher terminate and wait for it.
+ * @a prefetcher may be @c NULL.
+ */
+svn_error_t *
+svn_repos__replay_prefetcher_stop(
+  svn_repos__replay_prefetcher_t *prefetcher);
+
 /**
  * Non-deprecated alias for svn_repos_get_logs4.
  *
@@ -230,6 +358,30 @@ svn_repos__config_pool_get(svn_config_t **cfg,
 
 /** @} */
 
+/** Callback type used by svn_repos__parse_dumpstream().  Set @a *skip
+ * to @c TRUE if the contents of the node record with @a node_baton are
+ * of no interest to the consumer.
+ */
+typedef svn_error_t *
+(*svn_repos__parse_skip_node_func_t)(svn_boolean_t *skip,
+                                     void *node_baton);
+
+/** Like svn_repos_parse_dumpstream3() but call @a skip_node_func, if not
+ * @c NULL, right after each @c new_node_record callback.  If it asks to
+ * skip the node, its property and text content will be passed over
+ * without invoking any further callbacks except @c close_node.  Seekable
+ * streams will not read skipped contents at all.
+ */
+svn_error_t *
+svn_repos__parse_dumpstream(svn_stream_t *stream,
+                            const svn_repos_parse_fns3_t *parse_fns,
+                            void *parse_baton,
+                            svn_boolean_t deltas_are_text,
+                            svn_repos__parse_skip_node_func_t skip_node_func,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *pool);
+
 /* Adjust mergeinfo paths and revisions in ways that are useful when loading
  * a dump stream.
  *
@@ -390,6 +542,131 @@ svn_repos__get_dump_editor(const svn_delta_editor_t **editor,
                            const char *update_anchor_relpath,
                            apr_pool_t *pool);
 
+/**
+ * Index of the revision records within a dump stream.  It allows readers
+ * to seek straight to the revisions they are interested in without
+ * parsing the preceding ones.
+ *
+ * The index is kept outside the dump stream, such that the latter remains
+ * readable by all tools.
+ */
+typedef struct svn_repos__dump_index_t
+{
+  /** Length of the dump stream header records, i.e. the offset of the
+   * first revision record. */
+  apr_off_t header_length;
+
+  /** The first revision contained in the dump stream. */
+  svn_revnum_t start_rev;
+
+  /** The offsets (apr_off_t) of the ends of the revision records, starting
+   * with @a start_rev.  The end of a revision record is also the start of
+   * the next one. */
+  apr_array_header_t *rev_ends;
+} svn_repos__dump_index_t;
+
+/** Return a new, empty dump index allocated in @a result_pool. */
+svn_repos__dump_index_t *
+svn_repos__dump_index_create(apr_pool_t *result_pool);
+
+/** Write @a index to @a stream.  Use @a scratch_pool for temporaries. */
+svn_error_t *
+svn_repos__dump_index_write(svn_stream_t *stream,
+                            const svn_repos__dump_index_t *index,
+                            apr_pool_t *scratch_pool);
+
+/** Read the dump index written by svn_repos__dump_index_write() from
+ * @a stream and return it in @a *index, allocated in @a result_pool.
+ * Use @a scratch_pool for temporaries.
+ */
+svn_error_t *
+svn_repos__dump_index_read(svn_repos__dump_index_t **index,
+                           svn_stream_t *stream,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool);
+
+/** Set @a *stream to a dump stream containing the header records and the
+ * revisions @a start_rev to @a end_rev of the dump file @a file, as
+ * described by @a index.  Revisions outside the range covered by @a index
+ * are silently ignored.  Only the required parts of @a file will be read.
+ *
+ * Return #SVN_ERR_STREAM_MALFORMED_DATA if @a index does not describe
+ * @a file, i.e. if the size of @a file differs from what @a index records
+ * or if the selected revision records do not start at the offsets given
+ * by @a index.
+ *
+ * @a file must be seekable and remain open while @a *stream is in use.
+ * Allocate the result in @a result_pool.
+ */
+svn_error_t *
+svn_repos__dump_index_range(svn_stream_t **stream,
+                            apr_file_t *file,
+                            const svn_repos__dump_index_t *index,
+                            svn_revnum_t start_rev,
+                            svn_revnum_t end_rev,
+                            apr_pool_t *result_pool);
+
+/**
+ * Like svn_repos_dump_fs4() but split the revision range into chunks
+ * and dump up to @a jobs of them concurrently.  The output and the
+ * sequence of notifications are identical to those of
+ * svn_repos_dump_fs4().
+ *
+ * Every job opens its own instance of @a repos, using @a fs_config and
+ * passing @a warning_func and @a warning_baton to svn_fs_set_warning_func().
+ * Finished chunks are buffered in temporary files until all preceding
+ * chunks have been written to @a stream.
+ *
+ * @a filter_func and @a cancel_func will be called from multiple threads
+ * and must therefore be thread-safe.  @a notify_func is only called from
+ * the calling thread.
+ *
+ * If @a index is not @c NULL, fill it with the offsets of the revision
+ * records written to @a stream.
+ *
+ * If @a jobs is 1 or less, threads are not supported or the caches have
+ * been configured to be single-threaded, the revisions are dumped
+ * sequentially, just as svn_repos_dump_fs4() does.
+ */
+svn_error_t *
+svn_repos__dump_fs_jobs(svn_repos_t *repos,
+                        apr_hash_t *fs_config,
+                        svn_fs_warning_callback_t warning_func,
+                        void *warning_baton,
+                        int jobs,
+                        svn_repos__dump_index_t *index,
+                        svn_stream_t *stream,
+                        svn_revnum_t start_rev,
+                        svn_revnum_t end_rev,
+                        svn_boolean_t incremental,
+                        svn_boolean_t use_deltas,
+                        svn_boolean_t include_revprops,
+                        svn_boolean_t include_changes,
+                        svn_repos_notify_func_t notify_func,
+                        void *notify_baton,
+                        svn_repos_dump_filter_func_t filter_func,
+                        void *filter_baton,
+                        svn_cancel_func_t cancel_func,
+                        void *cancel_baton,
+                        apr_pool_t *scratch_pool);
+
+/**
+ * Make the report @a report_baton, as returned by svn_repos_begin_report3(),
+ * compute the text deltas of upcoming files in @a jobs worker threads while
+ * driving the editor.  The sequence of editor calls is not affected and
+ * all of them are still made from the thread finishing the report.
+ *
+ * Every worker opens its own instance of the report's repository, using
+ * @a fs_config, which must remain valid until the report is finished.
+ *
+ * If @a jobs is 0 or threads are not supported, deltas are computed by
+ * the thread finishing the report only.  That is the default.
+ */
+void
+svn_repos__report_set_jobs(void *report_baton,
+                           int jobs,
+                           apr_hash_t *fs_config);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
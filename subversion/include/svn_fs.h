@@ -140,6 +140,15 @@ typedef struct svn_fs_t svn_fs_t;
  */
 #define SVN_FS_CONFIG_FSFS_CACHE_NODEPROPS      "fsfs-cache-nodeprops"
 
+/** Enable / disable sharing of resolved paths in committed revisions
+ * between all FS instances for the same repository.  This is disabled
+ * by default and requires the global membuffer cache.  Currently, only
+ * FSX makes use of this setting.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_CACHE_PATHS          "fsfs-cache-paths"
+
 /** Enable / disable the FSFS format 7 "block read" feature.
  *
  * @since New in 1.9.
@@ -166,6 +175,20 @@ typedef struct svn_fs_t svn_fs_t;
  */
 #define SVN_FS_CONFIG_FSFS_LOG_ADDRESSING       "fsfs-log-addressing"
 
+/** Hint that the filesystem will be used for a single sequential scan
+ * over large parts of the repository, e.g. by dump or verify.
+ *
+ * FSFS will then tell the OS to read ahead in revision and pack files.
+ * Whenever the scan moves on to a later revision or pack file, the
+ * previous one gets dropped from the page cache.  That keeps bulk
+ * administrative operations from evicting the working set of other
+ * processes serving the same repository.  However, that also drops
+ * those files if the server is using them, so this is not the default.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_SEQUENTIAL_SCAN      "fsfs-sequential-scan"
+
 /* Note to maintainers: if you add further SVN_FS_CONFIG_FSFS_CACHE_* knobs,
    update fs_fs.c:verify_as_revision_before_current_plus_plus(). */
 
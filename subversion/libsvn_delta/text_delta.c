@@ -33,6 +33,7 @@
 #include "svn_pools.h"
 #include "svn_checksum.h"
 
+#include "private/svn_delta_private.h"
 #include "delta.h"
 
 
@@ -57,6 +58,10 @@ struct txdelta_baton {
   svn_filesize_t pos;           /* Offset of next read in source file. */
   char *buf;                    /* Buffer for input data. */
 
+  /* Only used by sliding source views, cf. svn_txdelta__sliding(). */
+  apr_size_t source_len;        /* Source data kept at the start of BUF. */
+  svn_filesize_t next_offset;   /* Desired start of the next source view. */
+
   svn_checksum_ctx_t *context;  /* If not NULL, the context for computing
                                    the checksum. */
   svn_checksum_t *checksum;     /* If non-NULL, the checksum of TARGET. */
@@ -396,6 +401,103 @@ txdelta_next_window(svn_txdelta_window_t **window,
 }
 
 
+/* Minimum length of a source copy in a delta window that we consider
+   reliable enough to derive the alignment of the next source view from.
+   Shorter matches are often spurious. */
+#define SLIDING_MIN_MATCH 1024
+
+/* Return the source offset that corresponds to the end of WINDOW's target
+   view, i.e. where the next source view should start for the next target
+   view to match up.  This is derived from the last sufficiently long copy
+   from the source view.  If there is none, don't move the source view. */
+static svn_filesize_t
+next_source_offset(const svn_txdelta_window_t *window)
+{
+  svn_filesize_t result = window->sview_offset;
+  apr_size_t target_pos = 0;
+  int i;
+
+  for (i = 0; i < window->num_ops; ++i)
+    {
+      const svn_txdelta_op_t *op = &window->ops[i];
+      target_pos += op->length;
+
+      if (   op->action_code == svn_txdelta_source
+          && op->length >= SLIDING_MIN_MATCH)
+        result = window->sview_offset + op->offset + op->length
+               + (window->tview_len - target_pos);
+    }
+
+  return result;
+}
+
+/* Like txdelta_next_window but position the source view for each window
+   to follow the target data, cf. svn_txdelta__sliding(). */
+static svn_error_t *
+txdelta_next_sliding_window(svn_txdelta_window_t **window,
+                            void *baton,
+                            apr_pool_t *pool)
+{
+  struct txdelta_baton *b = baton;
+  svn_filesize_t view_offset = b->pos - b->source_len;
+  apr_size_t target_len = SVN_DELTA_WINDOW_SIZE;
+
+  /* Consumers such as svn_txdelta_apply() read the source sequentially.
+     Therefore, the new source view must neither slide backwards nor leave
+     a gap after the previous one.  If data has been removed from the
+     target, the matching source data lies ahead of the view we can
+     provide; catch up by using a shorter target view this time. */
+  if (b->next_offset > b->pos)
+    {
+      apr_size_t lag = b->next_offset - b->pos > SVN_DELTA_WINDOW_SIZE / 2
+                     ? SVN_DELTA_WINDOW_SIZE / 2
+                     : (apr_size_t)(b->next_offset - b->pos);
+      target_len -= lag;
+      b->next_offset = b->pos;
+    }
+  if (b->next_offset > view_offset)
+    {
+      apr_size_t shift = (apr_size_t)(b->next_offset - view_offset);
+      memmove(b->buf, b->buf + shift, b->source_len - shift);
+      b->source_len -= shift;
+    }
+
+  /* Fill up the source view. */
+  if (b->more_source && b->source_len < SVN_DELTA_WINDOW_SIZE)
+    {
+      apr_size_t len = SVN_DELTA_WINDOW_SIZE - b->source_len;
+      SVN_ERR(svn_stream_read_full(b->source, b->buf + b->source_len,
+                                   &len));
+      b->more_source = (b->source_len + len == SVN_DELTA_WINDOW_SIZE);
+      b->source_len += len;
+      b->pos += len;
+    }
+
+  /* Read the target stream. */
+  SVN_ERR(svn_stream_read_full(b->target, b->buf + b->source_len,
+                               &target_len));
+  if (target_len == 0)
+    {
+      /* No target data?  We're done; return the final window. */
+      if (b->context != NULL)
+        SVN_ERR(svn_checksum_final(&b->checksum, b->context, b->result_pool));
+
+      *window = NULL;
+      b->more = FALSE;
+      return SVN_NO_ERROR;
+    }
+  else if (b->context != NULL)
+    SVN_ERR(svn_checksum_update(b->context, b->buf + b->source_len,
+                                target_len));
+
+  *window = compute_window(b->buf, b->source_len, target_len,
+                           b->pos - b->source_len, pool);
+  b->next_offset = next_source_offset(*window);
+
+  return SVN_NO_ERROR;
+}
+
+
 static const unsigned char *
 txdelta_md5_digest(void *baton)
 {
@@ -489,6 +591,29 @@ svn_txdelta2(svn_txdelta_stream_t **stream,
                                       txdelta_md5_digest, pool);
 }
 
+void
+svn_txdelta__sliding(svn_txdelta_stream_t **stream,
+                     svn_stream_t *source,
+                     svn_stream_t *target,
+                     svn_boolean_t calculate_checksum,
+                     apr_pool_t *pool)
+{
+  struct txdelta_baton *b = apr_pcalloc(pool, sizeof(*b));
+
+  b->source = source;
+  b->target = target;
+  b->more_source = TRUE;
+  b->more = TRUE;
+  b->buf = apr_palloc(pool, 2 * SVN_DELTA_WINDOW_SIZE);
+  b->context = calculate_checksum
+             ? svn_checksum_ctx_create(svn_checksum_md5, pool)
+             : NULL;
+  b->result_pool = pool;
+
+  *stream = svn_txdelta_stream_create(b, txdelta_next_sliding_window,
+                                      txdelta_md5_digest, pool);
+}
+
 void
 svn_txdelta(svn_txdelta_stream_t **stream,
             svn_stream_t *source,
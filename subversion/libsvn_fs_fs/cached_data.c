@@ -2537,8 +2537,14 @@ svn_fs_fs__get_file_delta_stream(svn_txdelta_stream_t **stream_p,
 
   /* Because source and target stream will already verify their content,
    * there is no need to do this once more.  In particular if the stream
-   * content is being fetched from cache. */
-  svn_txdelta2(stream_p, source_stream, target_stream, FALSE, pool);
+   * content is being fetched from cache.  The delta is only being sent
+   * to clients and never stored in the repository, hence it may use
+   * sliding source views. */
+  if (ffd->sliding_delta_windows)
+    svn_txdelta__sliding(stream_p, source_stream, target_stream, FALSE,
+                         pool);
+  else
+    svn_txdelta2(stream_p, source_stream, target_stream, FALSE, pool);
 
   return SVN_NO_ERROR;
 }
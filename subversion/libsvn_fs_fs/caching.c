@@ -576,12 +576,28 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                            fs,
                            no_handler,
                            fs->pool, pool));
+
+      SVN_ERR(create_cache(&(ffd->mergeinfo_index_cache),
+                           NULL,
+                           membuffer,
+                           0, 0, /* Do not use the inprocess cache */
+                           /* Values are svn_stringbuf_t */
+                           NULL, NULL,
+                           sizeof(svn_revnum_t),
+                           apr_pstrcat(pool, prefix, "MERGEINFO_INDEX",
+                                       SVN_VA_NULL),
+                           0,
+                           has_namespace,
+                           fs,
+                           no_handler,
+                           fs->pool, pool));
     }
   else
     {
       ffd->fulltext_cache = NULL;
       ffd->mergeinfo_cache = NULL;
       ffd->mergeinfo_existence_cache = NULL;
+      ffd->mergeinfo_index_cache = NULL;
     }
 
   /* if enabled, cache node properties */
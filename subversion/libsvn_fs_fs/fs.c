@@ -38,6 +38,7 @@
 #include "lock.h"
 #include "hotcopy.h"
 #include "id.h"
+#include "mergeinfo-index.h"
 #include "pack.h"
 #include "recovery.h"
 #include "rep-cache.h"
@@ -325,6 +326,20 @@ fs_ioctl(svn_fs_t *fs, svn_fs_ioctl_code_t ctlcode,
                                              cancel_baton,
                                              scratch_pool));
 
+          *output_p = NULL;
+          return SVN_NO_ERROR;
+        }
+      else if (ctlcode.code == SVN_FS_FS__IOCTL_BUILD_MERGEINFO_INDEX.code)
+        {
+          svn_fs_fs__ioctl_build_mergeinfo_index_input_t *input = input_void;
+
+          SVN_ERR(svn_fs_fs__mergeinfo_index_build(fs,
+                                                   input->progress_func,
+                                                   input->progress_baton,
+                                                   cancel_func,
+                                                   cancel_baton,
+                                                   scratch_pool));
+
           *output_p = NULL;
           return SVN_NO_ERROR;
         }
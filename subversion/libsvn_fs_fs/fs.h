@@ -60,6 +60,7 @@ extern "C" {
 #define PATH_TXNS_DIR         "transactions"     /* Directory of transactions in
                                                     repos w/o log addressing */
 #define PATH_NODE_ORIGINS_DIR "node-origins"     /* Lazy node-origin cache */
+#define PATH_MERGEINFO_INDEX_DIR "mergeinfo-index" /* Mergeinfo paths */
 #define PATH_TXN_PROTOS_DIR   "txn-protorevs"    /* Directory of proto-revs */
 #define PATH_TXN_CURRENT      "txn-current"      /* File with next txn key */
 #define PATH_TXN_CURRENT_LOCK "txn-current-lock" /* Lock for txn-current */
@@ -107,10 +108,13 @@ extern "C" {
 #define CONFIG_OPTION_ENABLE_PROPS_DELTIFICATION "enable-props-deltification"
 #define CONFIG_OPTION_MAX_DELTIFICATION_WALK     "max-deltification-walk"
 #define CONFIG_OPTION_MAX_LINEAR_DELTIFICATION   "max-linear-deltification"
+#define CONFIG_OPTION_SLIDING_DELTA_WINDOWS      "sliding-delta-windows"
 #define CONFIG_OPTION_COMPRESSION_LEVEL  "compression-level"
 #define CONFIG_SECTION_PACKED_REVPROPS   "packed-revprops"
 #define CONFIG_OPTION_REVPROP_PACK_SIZE  "revprop-pack-size"
 #define CONFIG_OPTION_COMPRESS_PACKED_REVPROPS  "compress-packed-revprops"
+#define CONFIG_SECTION_MERGEINFO         "mergeinfo"
+#define CONFIG_OPTION_ENABLE_MERGEINFO_INDEX "enable-mergeinfo-index"
 #define CONFIG_SECTION_IO                "io"
 #define CONFIG_OPTION_BLOCK_SIZE         "block-size"
 #define CONFIG_OPTION_L2P_PAGE_SIZE      "l2p-page-size"
@@ -429,6 +433,10 @@ typedef struct fs_fs_data_t
      if the node has mergeinfo, "0" if it doesn't. */
   svn_cache__t *mergeinfo_existence_cache;
 
+  /* Cache for the full path lists of the mergeinfo index; the key is the
+     revision, values are svn_stringbuf_t. */
+  svn_cache__t *mergeinfo_index_cache;
+
   /* Cache for l2p_header_t objects; the key is (revision, is-packed).
      Will be NULL for pre-format7 repos */
   svn_cache__t *l2p_header_cache;
@@ -473,6 +481,9 @@ typedef struct fs_fs_data_t
    * and allowed by the configuration. */
   svn_boolean_t rep_sharing_allowed;
 
+  /* Whether to write the mergeinfo index for new revisions. */
+  svn_boolean_t mergeinfo_index;
+
   /* File size limit in bytes up to which multiple revprops shall be packed
    * into a single file. */
   apr_int64_t revprop_pack_size;
@@ -493,6 +504,10 @@ typedef struct fs_fs_data_t
    * deltification history after which skip deltas will be used. */
   apr_int64_t max_linear_deltification;
 
+  /* Whether file deltas sent to clients may use sliding source views,
+   * cf. svn_txdelta__sliding(). */
+  svn_boolean_t sliding_delta_windows;
+
   /* Compression type to use with txdelta storage format in new revs. */
   compression_type_t delta_compression_type;
 
@@ -514,6 +529,14 @@ typedef struct fs_fs_data_t
   /* Ensure that all filesystem changes are written to disk. */
   svn_boolean_t flush_to_disk;
 
+  /* Rev / pack files will be read sequentially and only once, i.e. this
+     is a bulk scan like dump or verify.  Don't pollute the page cache. */
+  svn_boolean_t sequential_scan;
+
+  /* If SEQUENTIAL_SCAN is set, the first revision in the latest rev /
+     pack file that the scan opened.  SVN_INVALID_REVNUM before that. */
+  svn_revnum_t scan_start_rev;
+
   /* Pointer to svn_fs_open. */
   svn_error_t *(*svn_fs_open_)(svn_fs_t **, const char *, apr_hash_t *,
                                apr_pool_t *, apr_pool_t *);
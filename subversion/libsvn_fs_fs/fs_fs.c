@@ -761,6 +761,14 @@ read_config(fs_fs_data_t *ffd,
   else
     ffd->rep_sharing_allowed = FALSE;
 
+  /* Initialize ffd->mergeinfo_index. */
+  if (ffd->format >= SVN_FS_FS__MIN_MERGEINFO_FORMAT)
+    SVN_ERR(svn_config_get_bool(config, &ffd->mergeinfo_index,
+                                CONFIG_SECTION_MERGEINFO,
+                                CONFIG_OPTION_ENABLE_MERGEINFO_INDEX, FALSE));
+  else
+    ffd->mergeinfo_index = FALSE;
+
   /* Initialize deltification settings in ffd. */
   if (ffd->format >= SVN_FS_FS__MIN_DELTIFICATION_FORMAT)
     {
@@ -789,6 +797,12 @@ read_config(fs_fs_data_t *ffd,
       ffd->max_linear_deltification = SVN_FS_FS_MAX_LINEAR_DELTIFICATION;
     }
 
+  /* This only affects the deltas that we send, not the repository. */
+  SVN_ERR(svn_config_get_bool(config, &ffd->sliding_delta_windows,
+                              CONFIG_SECTION_DELTIFICATION,
+                              CONFIG_OPTION_SLIDING_DELTA_WINDOWS,
+                              FALSE));
+
   /* Initialize revprop packing settings in ffd. */
   if (ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
     {
@@ -995,6 +1009,18 @@ write_config(svn_fs_t *fs,
 "### rep-sharing is enabled by default."                                     NL
 "# " CONFIG_OPTION_ENABLE_REP_SHARING " = true"                              NL
 ""                                                                           NL
+"[" CONFIG_SECTION_MERGEINFO "]"                                             NL
+"### To speed up mergeinfo queries on large trees, the filesystem can keep"  NL
+"### a list of all paths with explicit mergeinfo for each revision.  The"    NL
+"### lists are written right after each commit and stored in the"            NL
+"### 'mergeinfo-index' folder.  Revisions without such a list will be"       NL
+"### searched for mergeinfo as in previous versions.  Commits only extend"   NL
+"### an existing index.  After enabling it, run"                             NL
+"###   svnadmin build-mergeinfo-index"                                       NL
+"### once to create the list for the latest revision."                       NL
+"### The mergeinfo index is disabled by default."                            NL
+"# " CONFIG_OPTION_ENABLE_MERGEINFO_INDEX " = false"                         NL
+""                                                                           NL
 "[" CONFIG_SECTION_DELTIFICATION "]"                                         NL
 "### To conserve space, the filesystem stores data as differences against"   NL
 "### existing representations.  This comes at a slight cost in performance," NL
@@ -1056,6 +1082,17 @@ write_config(svn_fs_t *fs,
 "### For 1.8, the default value is 16; earlier versions use 1."              NL
 "# " CONFIG_OPTION_MAX_LINEAR_DELTIFICATION " = 16"                          NL
 "###"                                                                        NL
+"### When sending file changes to clients, the server computes deltas on"    NL
+"### the fly.  By default, each delta window compares fixed-size, aligned"   NL
+"### sections of the old and new contents.  Data inserted into or removed"   NL
+"### from a large file shifts all later sections against each other, so"     NL
+"### most of the file gets sent in full.  With sliding delta windows, the"   NL
+"### sections get realigned after each window.  All clients can apply such"  NL
+"### deltas but they differ from what previous servers send.  This setting"  NL
+"### has no effect on the data stored in the repository."                    NL
+"### Sliding delta windows are disabled by default."                         NL
+"# " CONFIG_OPTION_SLIDING_DELTA_WINDOWS " = false"                          NL
+"###"                                                                        NL
 "### After deltification, we compress the data to minimize on-disk size."    NL
 "### This setting controls the compression algorithm, which will be used in" NL
 "### future revisions.  It can be used to either disable compression or to"  NL
@@ -1174,6 +1211,10 @@ read_global_config(svn_fs_t *fs)
   ffd->flush_to_disk = !svn_hash__get_bool(fs->config,
                                            SVN_FS_CONFIG_NO_FLUSH_TO_DISK,
                                            FALSE);
+  ffd->sequential_scan = svn_hash__get_bool(fs->config,
+                                            SVN_FS_CONFIG_FSFS_SEQUENTIAL_SCAN,
+                                            FALSE);
+  ffd->scan_start_rev = SVN_INVALID_REVNUM;
 
   /* Ignore the user-specified larger block size if we don't use block-read.
      Defaulting to 4k gives us the same access granularity in format 7 as in
@@ -967,6 +967,14 @@ hotcopy_body(void *baton, apr_pool_t *pool)
                                             PATH_NODE_ORIGINS_DIR, TRUE,
                                             cancel_func, cancel_baton, pool));
 
+  /* Ditto for the mergeinfo index. */
+  src_subdir = svn_dirent_join(src_fs->path, PATH_MERGEINFO_INDEX_DIR, pool);
+  SVN_ERR(svn_io_check_path(src_subdir, &kind, pool));
+  if (kind == svn_node_dir)
+    SVN_ERR(hotcopy_io_copy_dir_recursively(NULL, src_subdir, dst_fs->path,
+                                            PATH_MERGEINFO_INDEX_DIR, TRUE,
+                                            cancel_func, cancel_baton, pool));
+
   /*
    * NB: Data copied below is only read by writers, not readers.
    *     Writers are still locked out at this point.
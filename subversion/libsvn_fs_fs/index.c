@@ -302,6 +302,41 @@ packed_stream_read(svn_fs_fs__packed_number_stream_t *stream)
   target = stream->buffer;
   for (i = 0; i < bytes_read;)
     {
+      /* Most values in the index are small deltas that fit into a single
+       * byte.  Test 8 bytes at once and expand all of them in one go if
+       * none has a continuation bit set.  Because every byte will produce
+       * at most one value, TARGET cannot overflow. */
+      while (i + sizeof(apr_uint64_t) <= bytes_read)
+        {
+          apr_uint64_t chunk;
+          memcpy(&chunk, buffer + i, sizeof(chunk));
+          if (chunk & APR_UINT64_C(0x8080808080808080))
+            break;
+
+          target[0].value = buffer[i];
+          target[0].total_len = i + 1;
+          target[1].value = buffer[i + 1];
+          target[1].total_len = i + 2;
+          target[2].value = buffer[i + 2];
+          target[2].total_len = i + 3;
+          target[3].value = buffer[i + 3];
+          target[3].total_len = i + 4;
+          target[4].value = buffer[i + 4];
+          target[4].total_len = i + 5;
+          target[5].value = buffer[i + 5];
+          target[5].total_len = i + 6;
+          target[6].value = buffer[i + 6];
+          target[6].total_len = i + 7;
+          target[7].value = buffer[i + 7];
+          target[7].total_len = i + 8;
+
+          target += sizeof(chunk);
+          i += sizeof(chunk);
+        }
+
+      if (i == bytes_read)
+        break;
+
       if (buffer[i] < 0x80)
         {
           /* numbers < 128 are relatively frequent and particularly easy
@@ -1103,6 +1138,9 @@ typedef struct l2p_page_info_baton_t
   /* offset of ITEM_INDEX within that page */
   apr_uint32_t page_offset;
 
+  /* (max) number of entries per page in this index */
+  apr_uint32_t page_size;
+
   /* revision identifying the l2p index file, also the first rev in that */
   svn_revnum_t first_revision;
 } l2p_page_info_baton_t;
@@ -1165,6 +1203,7 @@ l2p_page_info_copy(l2p_page_info_baton_t *baton,
       baton->entry = first_entry[baton->page_no];
     }
 
+  baton->page_size = header->page_size;
   baton->first_revision = header->first_revision;
 
   return SVN_NO_ERROR;
@@ -1816,6 +1855,139 @@ svn_fs_fs__item_offset(apr_off_t *absolute_position,
   return svn_error_trace(err);
 }
 
+/* Element type of the request list used by svn_fs_fs__item_offsets.
+ */
+typedef struct l2p_batch_entry_t
+{
+  /* item to look up */
+  svn_fs_fs__id_part_t item;
+
+  /* index of this request in the caller's input and output arrays */
+  int position;
+} l2p_batch_entry_t;
+
+/* Comparison function ordering l2p_batch_entry_t *LHS and *RHS by
+ * revision and item number, i.e. in index page order. */
+static int
+compare_l2p_batch_entries(const void *lhs,
+                          const void *rhs)
+{
+  const l2p_batch_entry_t *lhs_entry = lhs;
+  const l2p_batch_entry_t *rhs_entry = rhs;
+
+  if (lhs_entry->item.revision != rhs_entry->item.revision)
+    return lhs_entry->item.revision < rhs_entry->item.revision ? -1 : 1;
+
+  if (lhs_entry->item.number != rhs_entry->item.number)
+    return lhs_entry->item.number < rhs_entry->item.number ? -1 : 1;
+
+  return 0;
+}
+
+svn_error_t *
+svn_fs_fs__item_offsets(apr_off_t *absolute_positions,
+                        svn_fs_t *fs,
+                        svn_fs_fs__revision_file_t *rev_file,
+                        const svn_fs_fs__id_part_t *items,
+                        int count,
+                        apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_array_header_t *requests;
+  apr_pool_t *iterpool;
+  apr_pool_t *page_pool;
+  l2p_page_info_baton_t info_baton = { 0 };
+  l2p_page_t *page = NULL;
+  int i;
+
+  /* Without logical addressing, there are no index pages to share. */
+  if (!svn_fs_fs__use_log_addressing(fs))
+    {
+      iterpool = svn_pool_create(scratch_pool);
+      for (i = 0; i < count; ++i)
+        {
+          svn_pool_clear(iterpool);
+          SVN_ERR(svn_fs_fs__item_offset(&absolute_positions[i], fs,
+                                         rev_file, items[i].revision, NULL,
+                                         items[i].number, iterpool));
+        }
+      svn_pool_destroy(iterpool);
+
+      return SVN_NO_ERROR;
+    }
+
+  /* Process the requests in index page order. */
+  requests = apr_array_make(scratch_pool, count, sizeof(l2p_batch_entry_t));
+  for (i = 0; i < count; ++i)
+    {
+      l2p_batch_entry_t *request = apr_array_push(requests);
+      request->item = items[i];
+      request->position = i;
+    }
+
+  svn_sort__array(requests, compare_l2p_batch_entries);
+
+  /* Fetch every index page only once and resolve all requests covered
+   * by it. */
+  iterpool = svn_pool_create(scratch_pool);
+  page_pool = svn_pool_create(scratch_pool);
+  for (i = 0; i < requests->nelts; ++i)
+    {
+      const l2p_batch_entry_t *request
+        = &APR_ARRAY_IDX(requests, i, l2p_batch_entry_t);
+      l2p_entry_baton_t page_baton;
+
+      svn_pool_clear(iterpool);
+
+      /* Switch to the next page? */
+      if (   page == NULL
+          || request->item.revision != info_baton.revision
+          ||   request->item.number / info_baton.page_size
+            != info_baton.page_no)
+        {
+          svn_fs_fs__page_cache_key_t key = { 0 };
+          svn_boolean_t is_cached = FALSE;
+
+          info_baton.revision = request->item.revision;
+          info_baton.item_index = request->item.number;
+          SVN_ERR(get_l2p_page_info(&info_baton, rev_file, fs, iterpool));
+
+          assert(request->item.revision <= APR_UINT32_MAX);
+          key.revision = (apr_uint32_t)request->item.revision;
+          key.is_packed = svn_fs_fs__is_packed_rev(fs,
+                                                   request->item.revision);
+          key.page = info_baton.page_no;
+
+          svn_pool_clear(page_pool);
+          SVN_ERR(svn_cache__get((void **)&page, &is_cached,
+                                 ffd->l2p_page_cache, &key, page_pool));
+          if (!is_cached)
+            {
+              SVN_ERR(get_l2p_page(&page, rev_file, fs,
+                                   info_baton.first_revision,
+                                   &info_baton.entry, page_pool));
+              SVN_ERR(svn_cache__set(ffd->l2p_page_cache, &key, page,
+                                     iterpool));
+            }
+        }
+
+      /* The remainder is simple array indexing. */
+      page_baton.revision = request->item.revision;
+      page_baton.item_index = request->item.number;
+      page_baton.page_offset
+        = (apr_uint32_t)(request->item.number % info_baton.page_size);
+      SVN_ERR(l2p_page_get_entry(&page_baton, page, page->offsets,
+                                 iterpool));
+
+      absolute_positions[request->position] = page_baton.offset;
+    }
+
+  svn_pool_destroy(page_pool);
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /*
  * phys-to-log index
  */
@@ -200,6 +200,23 @@ svn_fs_fs__item_offset(apr_off_t *absolute_position,
                        apr_uint64_t item_index,
                        apr_pool_t *scratch_pool);
 
+/* Batched variant of svn_fs_fs__item_offset for committed revisions.
+ * For all COUNT entries in ITEMS, return the position of the respective
+ * item in the rev or pack file in the corresponding element of
+ * ABSOLUTE_POSITIONS.  All ITEMS must be located in REV_FILE.
+ *
+ * The requests may be given in any order.  They will be resolved in
+ * index order such that every L2P index page gets fetched only once.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svn_fs_fs__item_offsets(apr_off_t *absolute_positions,
+                        svn_fs_t *fs,
+                        svn_fs_fs__revision_file_t *rev_file,
+                        const svn_fs_fs__id_part_t *items,
+                        int count,
+                        apr_pool_t *scratch_pool);
+
 /* Use the log-to-phys indexes in FS to determine the maximum item indexes
  * assigned to revision START_REV to START_REV + COUNT - 1.  That is a
  * close upper limit to the actual number of items in the respective revs.
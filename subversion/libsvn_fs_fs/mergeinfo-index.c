@@ -0,0 +1,606 @@
+/* mergeinfo-index.c --- per-revision index of paths with mergeinfo
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <string.h>
+
+#include "svn_pools.h"
+#include "svn_hash.h"
+#include "svn_dirent_uri.h"
+#include "svn_path.h"
+#include "svn_sorts.h"
+
+#include "mergeinfo-index.h"
+#include "dag.h"
+#include "fs_fs.h"
+#include "id.h"
+#include "util.h"
+
+#include "private/svn_fspath.h"
+#include "private/svn_sorts_private.h"
+#include "../libsvn_fs/fs-loader.h"
+
+#include "svn_private_config.h"
+
+/* An index file starts with a header line, either "full" or "delta".
+ *
+ * A full index lists all paths with mergeinfo, one per line, in the
+ * order of svn_path_compare_paths.  A delta index lists the changes
+ * against the previous revision's index in the same order, each line
+ * being a path prefixed with '+' (mergeinfo added) or '-' (removed).
+ *
+ * Every MERGEINFO_INDEX_CHECKPOINT-th revision gets a full index, all
+ * others a delta.  Thus, commits only write their changes and readers
+ * apply a bounded number of deltas to the previous checkpoint.  The full
+ * lists are cached in the same format, i.e. without the header line.
+ */
+#define MERGEINFO_INDEX_CHECKPOINT 32
+
+#define HEADER_FULL "full\n"
+#define HEADER_DELTA "delta\n"
+
+/* Compare the paths (const char *) pointed to by A and B, ordering
+ * descendants directly after their ancestors. */
+static int
+compare_index_paths(const void *a,
+                    const void *b)
+{
+  return svn_path_compare_paths(*(const char * const *)a,
+                                *(const char * const *)b);
+}
+
+/* Like compare_index_paths but for changes, i.e. paths prefixed with
+ * '+' or '-'. */
+static int
+compare_changes(const void *a,
+                const void *b)
+{
+  return svn_path_compare_paths(*(const char * const *)a + 1,
+                                *(const char * const *)b + 1);
+}
+
+/* Split the newline-terminated lines in TEXT in place and return them as
+ * an array of const char *, allocated in RESULT_POOL. */
+static apr_array_header_t *
+split_lines(svn_stringbuf_t *text,
+            apr_pool_t *result_pool)
+{
+  apr_array_header_t *lines = apr_array_make(result_pool, 16,
+                                             sizeof(const char *));
+  char *line = text->data;
+  char *end = text->data + text->len;
+
+  while (line < end)
+    {
+      char *eol = memchr(line, '\n', end - line);
+
+      *eol = '\0';
+      APR_ARRAY_PUSH(lines, const char *) = line;
+      line = eol + 1;
+    }
+
+  return lines;
+}
+
+/* Read the index file of revision REV in FS.  Set *FULL to whether it is
+ * a full index and return its body in *BODY, allocated in RESULT_POOL.
+ * If there is no such file, set *BODY to NULL.  Use SCRATCH_POOL for
+ * temporary allocations. */
+static svn_error_t *
+read_index_file(svn_boolean_t *full,
+                svn_stringbuf_t **body,
+                svn_fs_t *fs,
+                svn_revnum_t rev,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  const char *index_path = svn_fs_fs__path_mergeinfo_index(fs, rev,
+                                                           scratch_pool);
+  svn_stringbuf_t *contents;
+  apr_size_t header_len;
+  svn_error_t *err;
+
+  err = svn_stringbuf_from_file2(&contents, index_path, result_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      *body = NULL;
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  *full = strncmp(contents->data, HEADER_FULL, strlen(HEADER_FULL)) == 0;
+  header_len = *full ? strlen(HEADER_FULL) : strlen(HEADER_DELTA);
+  if (   (!*full && strncmp(contents->data, HEADER_DELTA, header_len))
+      || (contents->len > header_len
+          && contents->data[contents->len - 1] != '\n'))
+    return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
+                             _("Malformed mergeinfo index in '%s'"),
+                             svn_dirent_local_style(index_path,
+                                                    scratch_pool));
+
+  svn_stringbuf_remove(contents, 0, header_len);
+  *body = contents;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the result of applying the sorted CHANGES to the sorted PATHS
+ * as a path list, allocated in RESULT_POOL.  Return an error if CHANGES
+ * contains anything but additions and removals. */
+static svn_error_t *
+apply_changes(svn_stringbuf_t **result,
+              const apr_array_header_t *paths,
+              const apr_array_header_t *changes,
+              apr_pool_t *result_pool)
+{
+  int i = 0;
+  int k = 0;
+
+  *result = svn_stringbuf_create_empty(result_pool);
+  while (i < paths->nelts || k < changes->nelts)
+    {
+      const char *path = i < paths->nelts
+                       ? APR_ARRAY_IDX(paths, i, const char *)
+                       : NULL;
+      const char *change = k < changes->nelts
+                         ? APR_ARRAY_IDX(changes, k, const char *)
+                         : NULL;
+      int diff;
+
+      if (change && *change != '+' && *change != '-')
+        return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
+                                _("Malformed mergeinfo index delta"));
+
+      diff = !change ? -1
+           : !path ? 1
+           : svn_path_compare_paths(path, change + 1);
+
+      /* Paths added by CHANGES, including duplicates of PATH. */
+      if (diff >= 0 && *change == '+')
+        {
+          svn_stringbuf_appendcstr(*result, change + 1);
+          svn_stringbuf_appendbyte(*result, '\n');
+        }
+      else if (diff < 0)
+        {
+          svn_stringbuf_appendcstr(*result, path);
+          svn_stringbuf_appendbyte(*result, '\n');
+        }
+
+      if (diff <= 0)
+        ++i;
+      if (diff >= 0)
+        ++k;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *LIST to the full path list of revision REV in FS, allocated in
+ * RESULT_POOL, or to NULL if the index of REV or of one of the revisions
+ * its delta is based on is missing.  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+get_path_list(svn_stringbuf_t **list,
+              svn_fs_t *fs,
+              svn_revnum_t rev,
+              apr_pool_t *result_pool,
+              apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_array_header_t *deltas = apr_array_make(scratch_pool, 4,
+                                              sizeof(svn_stringbuf_t *));
+  svn_stringbuf_t *base = NULL;
+  svn_boolean_t found = FALSE;
+  svn_revnum_t base_rev;
+  int i;
+
+  /* Go back to the latest full list: revision 0, a cached list or
+     a checkpoint. */
+  for (base_rev = rev; !base; --base_rev)
+    {
+      svn_boolean_t full;
+      svn_stringbuf_t *body;
+
+      if (base_rev == 0)
+        {
+          base = svn_stringbuf_create_empty(scratch_pool);
+          break;
+        }
+
+      if (ffd->mergeinfo_index_cache)
+        SVN_ERR(svn_cache__get((void **)&base, &found,
+                               ffd->mergeinfo_index_cache, &base_rev,
+                               scratch_pool));
+      if (found)
+        break;
+
+      SVN_ERR(read_index_file(&full, &body, fs, base_rev, scratch_pool,
+                              scratch_pool));
+      if (!body)
+        {
+          *list = NULL;
+          return SVN_NO_ERROR;
+        }
+
+      if (full)
+        base = body;
+      else
+        APR_ARRAY_PUSH(deltas, svn_stringbuf_t *) = body;
+    }
+
+  /* Apply the deltas, oldest first. */
+  for (i = deltas->nelts - 1; i >= 0; --i)
+    SVN_ERR(apply_changes(&base, split_lines(base, scratch_pool),
+                          split_lines(APR_ARRAY_IDX(deltas, i,
+                                                    svn_stringbuf_t *),
+                                      scratch_pool),
+                          scratch_pool));
+
+  if (ffd->mergeinfo_index_cache && !(found && base_rev == rev))
+    SVN_ERR(svn_cache__set(ffd->mergeinfo_index_cache, &rev, base,
+                           scratch_pool));
+
+  *list = svn_stringbuf_dup(base, result_pool);
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__mergeinfo_index_read(apr_array_header_t **paths,
+                                svn_fs_t *fs,
+                                svn_revnum_t rev,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *list;
+
+  /* The list is already sorted; no need to parse or sort anything. */
+  SVN_ERR(get_path_list(&list, fs, rev, result_pool, scratch_pool));
+  *paths = list ? split_lines(list, result_pool) : NULL;
+
+  return SVN_NO_ERROR;
+}
+
+int
+svn_fs_fs__mergeinfo_index_find(const apr_array_header_t *paths,
+                                const char *path)
+{
+  return svn_sort__bsearch_lower_bound(paths, &path, compare_index_paths);
+}
+
+/* Add removals for all entries in OLD_PATHS at or below PATH to CHANGES.
+ * Skip PATH itself unless INCLUDE_SELF is set.  Allocate the changes in
+ * CHANGES' pool. */
+static void
+remove_subtree(apr_array_header_t *changes,
+               const char *path,
+               svn_boolean_t include_self,
+               const apr_array_header_t *old_paths)
+{
+  int i = svn_fs_fs__mergeinfo_index_find(old_paths, path);
+
+  for (; i < old_paths->nelts; ++i)
+    {
+      const char *old_path = APR_ARRAY_IDX(old_paths, i, const char *);
+      const char *relpath = svn_fspath__skip_ancestor(path, old_path);
+
+      if (!relpath)
+        break;
+
+      if (*relpath || include_self)
+        APR_ARRAY_PUSH(changes, const char *)
+          = apr_pstrcat(changes->pool, "-", old_path, SVN_VA_NULL);
+    }
+}
+
+static svn_error_t *
+diff_directory(apr_array_header_t *changes,
+               const char *path,
+               dag_node_t *dir,
+               dag_node_t *old_dir,
+               const apr_array_header_t *old_paths,
+               apr_pool_t *scratch_pool);
+
+/* Add the changes of the mergeinfo at and below NODE at PATH to CHANGES.
+ * OLD_NODE is the node at PATH in the previous revision, if that is a
+ * directory, and NULL otherwise.  OLD_PATHS is the mergeinfo index of the
+ * previous revision.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+diff_node(apr_array_header_t *changes,
+          const char *path,
+          dag_node_t *node,
+          dag_node_t *old_node,
+          const apr_array_header_t *old_paths,
+          apr_pool_t *scratch_pool)
+{
+  apr_int64_t count;
+  svn_boolean_t has_mergeinfo, had_mergeinfo, go_down;
+  int i;
+
+  /* Without any mergeinfo, we need not look at the tree at all. */
+  SVN_ERR(svn_fs_fs__dag_get_mergeinfo_count(&count, node));
+  if (count == 0)
+    {
+      remove_subtree(changes, path, TRUE, old_paths);
+      return SVN_NO_ERROR;
+    }
+
+  i = svn_fs_fs__mergeinfo_index_find(old_paths, path);
+  had_mergeinfo = i < old_paths->nelts
+               && !strcmp(APR_ARRAY_IDX(old_paths, i, const char *), path);
+
+  SVN_ERR(svn_fs_fs__dag_has_mergeinfo(&has_mergeinfo, node));
+  if (has_mergeinfo && !had_mergeinfo)
+    APR_ARRAY_PUSH(changes, const char *)
+      = apr_pstrcat(changes->pool, "+", path, SVN_VA_NULL);
+  else if (!has_mergeinfo && had_mergeinfo)
+    APR_ARRAY_PUSH(changes, const char *)
+      = apr_pstrcat(changes->pool, "-", path, SVN_VA_NULL);
+
+  SVN_ERR(svn_fs_fs__dag_has_descendants_with_mergeinfo(&go_down, node));
+  if (go_down)
+    SVN_ERR(diff_directory(changes, path, node, old_node, old_paths,
+                           scratch_pool));
+  else
+    remove_subtree(changes, path, FALSE, old_paths);
+
+  return SVN_NO_ERROR;
+}
+
+/* Add the changes of the mergeinfo below directory DIR at PATH to
+ * CHANGES.  OLD_DIR is the node at PATH in the previous revision, if that
+ * is a directory, and NULL otherwise.  OLD_PATHS is the mergeinfo index
+ * of the previous revision.  Only sub-trees that changed since the
+ * previous revision are visited.  Use SCRATCH_POOL for temporary
+ * allocations.
+ */
+static svn_error_t *
+diff_directory(apr_array_header_t *changes,
+               const char *path,
+               dag_node_t *dir,
+               dag_node_t *old_dir,
+               const apr_array_header_t *old_paths,
+               apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_fs_t *fs = svn_fs_fs__dag_get_fs(dir);
+  apr_array_header_t *entries;
+  int i;
+
+  SVN_ERR(svn_fs_fs__dag_dir_entries(&entries, dir, scratch_pool));
+  for (i = 0; i < entries->nelts; ++i)
+    {
+      svn_fs_dirent_t *dirent = APR_ARRAY_IDX(entries, i, svn_fs_dirent_t *);
+      svn_fs_dirent_t *old_dirent = NULL;
+      dag_node_t *kid;
+      dag_node_t *old_kid = NULL;
+
+      svn_pool_clear(iterpool);
+
+      /* Unchanged sub-trees have the same mergeinfo as before. */
+      if (old_dir)
+        SVN_ERR(svn_fs_fs__dag_dir_entry(&old_dirent, old_dir, dirent->name,
+                                         iterpool, iterpool));
+      if (old_dirent && svn_fs_fs__id_eq(old_dirent->id, dirent->id))
+        continue;
+
+      SVN_ERR(svn_fs_fs__dag_get_node(&kid, fs, dirent->id, iterpool));
+      if (old_dirent && old_dirent->kind == svn_node_dir)
+        SVN_ERR(svn_fs_fs__dag_get_node(&old_kid, fs, old_dirent->id,
+                                        iterpool));
+
+      SVN_ERR(diff_node(changes, svn_fspath__join(path, dirent->name,
+                                                  iterpool),
+                        kid, old_kid, old_paths, iterpool));
+    }
+
+  /* Entries that have been deleted take their mergeinfo with them. */
+  if (old_dir)
+    {
+      SVN_ERR(svn_fs_fs__dag_dir_entries(&entries, old_dir, scratch_pool));
+      for (i = 0; i < entries->nelts; ++i)
+        {
+          svn_fs_dirent_t *old_dirent
+            = APR_ARRAY_IDX(entries, i, svn_fs_dirent_t *);
+          svn_fs_dirent_t *dirent;
+
+          svn_pool_clear(iterpool);
+          SVN_ERR(svn_fs_fs__dag_dir_entry(&dirent, dir, old_dirent->name,
+                                           iterpool, iterpool));
+          if (!dirent)
+            remove_subtree(changes,
+                           svn_fspath__join(path, old_dirent->name,
+                                            iterpool),
+                           TRUE, old_paths);
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Write the index file of revision REV in FS with the given HEADER and
+ * the lines in BODY.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+write_index(svn_fs_t *fs,
+            svn_revnum_t rev,
+            const char *header,
+            svn_stringbuf_t *body,
+            apr_pool_t *scratch_pool)
+{
+  const char *index_path = svn_fs_fs__path_mergeinfo_index(fs, rev,
+                                                           scratch_pool);
+  const char *dir = svn_dirent_dirname(index_path, scratch_pool);
+  const char *path_tmp;
+  svn_stream_t *stream;
+
+  SVN_ERR(svn_fs_fs__ensure_dir_exists(svn_dirent_join(fs->path,
+                                                       PATH_MERGEINFO_INDEX_DIR,
+                                                       scratch_pool),
+                                       fs->path, scratch_pool));
+  SVN_ERR(svn_fs_fs__ensure_dir_exists(dir, fs->path, scratch_pool));
+
+  /* As with the node origins, concurrent writers will produce the very
+     same contents and the rename is atomic. */
+  SVN_ERR(svn_stream_open_unique(&stream, &path_tmp, dir,
+                                 svn_io_file_del_none, scratch_pool,
+                                 scratch_pool));
+  SVN_ERR(svn_stream_puts(stream, header));
+  SVN_ERR(svn_stream_write(stream, body->data, &body->len));
+  SVN_ERR(svn_stream_close(stream));
+
+  return svn_io_file_rename2(path_tmp, index_path, FALSE, scratch_pool);
+}
+
+/* Write the index of revision REV in FS.  OLD_LIST is the path list of
+ * the previous revision.  If it is NULL, scan the whole tree and write a
+ * full index.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+write_revision_index(svn_fs_t *fs,
+                     svn_revnum_t rev,
+                     svn_stringbuf_t *old_list,
+                     apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_array_header_t *changes = apr_array_make(scratch_pool, 16,
+                                               sizeof(const char *));
+  apr_array_header_t *old_paths;
+  svn_stringbuf_t *list;
+  dag_node_t *root;
+  dag_node_t *old_root = NULL;
+  svn_boolean_t full = !old_list || rev % MERGEINFO_INDEX_CHECKPOINT == 0;
+  int i;
+
+  if (old_list)
+    SVN_ERR(svn_fs_fs__dag_revision_root(&old_root, fs, rev - 1,
+                                         scratch_pool));
+  else
+    old_list = svn_stringbuf_create_empty(scratch_pool);
+
+  old_paths = split_lines(svn_stringbuf_dup(old_list, scratch_pool),
+                          scratch_pool);
+
+  SVN_ERR(svn_fs_fs__dag_revision_root(&root, fs, rev, scratch_pool));
+  SVN_ERR(diff_node(changes, "/", root, old_root, old_paths, scratch_pool));
+  svn_sort__array(changes, compare_changes);
+
+  SVN_ERR(apply_changes(&list, old_paths, changes, scratch_pool));
+  if (full)
+    {
+      SVN_ERR(write_index(fs, rev, HEADER_FULL, list, scratch_pool));
+    }
+  else
+    {
+      svn_stringbuf_t *body = svn_stringbuf_create_empty(scratch_pool);
+      for (i = 0; i < changes->nelts; ++i)
+        {
+          svn_stringbuf_appendcstr(body, APR_ARRAY_IDX(changes, i,
+                                                       const char *));
+          svn_stringbuf_appendbyte(body, '\n');
+        }
+
+      SVN_ERR(write_index(fs, rev, HEADER_DELTA, body, scratch_pool));
+    }
+
+  /* The next commit will need this list. */
+  if (ffd->mergeinfo_index_cache)
+    SVN_ERR(svn_cache__set(ffd->mergeinfo_index_cache, &rev, list,
+                           scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__mergeinfo_index_update(svn_fs_t *fs,
+                                  svn_revnum_t rev,
+                                  apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *old_list;
+  svn_error_t *err;
+
+  /* Scanning the whole tree is svn_fs_fs__mergeinfo_index_build's job. */
+  SVN_ERR(get_path_list(&old_list, fs, rev - 1, scratch_pool,
+                        scratch_pool));
+  if (!old_list)
+    return SVN_NO_ERROR;
+
+  err = write_revision_index(fs, rev, old_list, scratch_pool);
+  if (err && APR_STATUS_IS_EACCES(err->apr_err))
+    {
+      /* It's just a cache; stop trying if I can't write. */
+      svn_error_clear(err);
+      err = NULL;
+    }
+
+  return svn_error_trace(err);
+}
+
+svn_error_t *
+svn_fs_fs__mergeinfo_index_build(svn_fs_t *fs,
+                                 svn_fs_progress_notify_func_t progress_func,
+                                 void *progress_baton,
+                                 svn_cancel_func_t cancel_func,
+                                 void *cancel_baton,
+                                 apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_stringbuf_t *list;
+  svn_revnum_t youngest;
+  svn_revnum_t rev;
+
+  if (!ffd->mergeinfo_index)
+    return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                            _("The mergeinfo index is not enabled for "
+                              "this filesystem."));
+
+  /* Build a full index for HEAD, unless there already is an index. */
+  SVN_ERR(svn_fs_fs__youngest_rev(&rev, fs, scratch_pool));
+  SVN_ERR(get_path_list(&list, fs, rev, scratch_pool, scratch_pool));
+  if (!list)
+    SVN_ERR(write_revision_index(fs, rev, NULL, scratch_pool));
+  if (progress_func)
+    progress_func(rev, progress_baton, scratch_pool);
+
+  /* Commits that happened in the meantime found no index to update. */
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, fs, scratch_pool));
+  while (rev < youngest)
+    {
+      ++rev;
+      svn_pool_clear(iterpool);
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(get_path_list(&list, fs, rev, iterpool, iterpool));
+      if (!list)
+        SVN_ERR(svn_fs_fs__mergeinfo_index_update(fs, rev, iterpool));
+      if (progress_func)
+        progress_func(rev, progress_baton, iterpool);
+
+      if (rev == youngest)
+        SVN_ERR(svn_fs_fs__youngest_rev(&youngest, fs, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
@@ -0,0 +1,99 @@
+/* mergeinfo-index.h : interface to the per-revision mergeinfo index
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_LIBSVN_FS_FS_MERGEINFO_INDEX_H
+#define SVN_LIBSVN_FS_FS_MERGEINFO_INDEX_H
+
+#include "svn_error.h"
+
+#include "fs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* The mergeinfo index of a revision lists all paths in that revision
+ * that carry explicit svn:mergeinfo.  It is written by each commit while
+ * it holds the write lock, derived from the index of the previous revision
+ * and the nodes changed by the new one.  Most revisions only store the
+ * changes against the previous revision.
+ *
+ * Just like the node origins, this is a cache of reconstructible data.
+ * Revisions without an index file are simply crawled as before.  Commits
+ * never scan the whole tree; if the previous revision has no index, the
+ * new one won't get one either until svn_fs_fs__mergeinfo_index_build()
+ * is run.
+ */
+
+/* Set *PATHS to the paths (const char *) with explicit mergeinfo in
+ * revision REV of FS.  They are sorted such that all descendants of a
+ * path directly follow that path.  If there is no index for REV, set
+ * *PATHS to NULL.  Allocate the result in RESULT_POOL and use
+ * SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svn_fs_fs__mergeinfo_index_read(apr_array_header_t **paths,
+                                svn_fs_t *fs,
+                                svn_revnum_t rev,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool);
+
+/* Return the position of the first entry in PATHS, as returned by
+ * svn_fs_fs__mergeinfo_index_read, that is PATH itself or one of its
+ * descendants.  Those entries form a contiguous range.  If there are no
+ * such entries, return the position where they would be.
+ */
+int
+svn_fs_fs__mergeinfo_index_find(const apr_array_header_t *paths,
+                                const char *path);
+
+/* Write the mergeinfo index for the already committed revision REV in FS
+ * if revision REV - 1 has an index.  Use SCRATCH_POOL for temporary
+ * allocations.
+ */
+svn_error_t *
+svn_fs_fs__mergeinfo_index_update(svn_fs_t *fs,
+                                  svn_revnum_t rev,
+                                  apr_pool_t *scratch_pool);
+
+/* Make sure that the HEAD revision of FS has a mergeinfo index, such that
+ * future commits will maintain it.  If HEAD has no index yet, scan its
+ * whole tree.  Also add the indexes of revisions committed in the
+ * meantime.  Indicate progress via the optional PROGRESS_FUNC with
+ * PROGRESS_BATON.  The optional CANCEL_FUNC will periodically be called
+ * with CANCEL_BATON.  Use SCRATCH_POOL for temporary allocations.
+ *
+ * Return SVN_ERR_UNSUPPORTED_FEATURE if the index is not enabled for FS.
+ */
+svn_error_t *
+svn_fs_fs__mergeinfo_index_build(svn_fs_t *fs,
+                                 svn_fs_progress_notify_func_t progress_func,
+                                 void *progress_baton,
+                                 svn_cancel_func_t cancel_func,
+                                 void *cancel_baton,
+                                 apr_pool_t *scratch_pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_FS_FS_MERGEINFO_INDEX_H */
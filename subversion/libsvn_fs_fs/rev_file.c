@@ -120,6 +120,52 @@ auto_make_writable(const char *path,
   return SVN_NO_ERROR;
 }
 
+/* FS is used for a sequential scan and has just opened APR_FILE, the rev /
+ * pack file that starts at START_REV.  If the scan moved past the file
+ * that it read before, drop the latter from the OS page cache.  Since
+ * FSFS reopens rev / pack files for every item it reads, we must not
+ * do that upon every close.  Use SCRATCH_POOL for temporary allocations.
+ */
+static void
+advance_scan(svn_fs_t *fs,
+             apr_file_t *apr_file,
+             svn_revnum_t start_rev,
+             apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  /* Going back to older files, e.g. for delta bases, does not count. */
+  if (   SVN_IS_VALID_REVNUM(ffd->scan_start_rev)
+      && ffd->scan_start_rev >= start_rev)
+    return;
+
+  svn_io__file_advise_sequential(apr_file);
+
+  if (SVN_IS_VALID_REVNUM(ffd->scan_start_rev))
+    {
+      apr_file_t *old_file;
+      const char *old_path
+        = svn_fs_fs__path_rev_absolute(fs, ffd->scan_start_rev,
+                                       scratch_pool);
+
+      /* This is just a hint.  If the file has been packed in the
+       * meantime, we simply won't find it. */
+      svn_error_t *err = svn_io_file_open(&old_file, old_path, APR_READ,
+                                          APR_OS_DEFAULT, scratch_pool);
+      if (err)
+        {
+          svn_error_clear(err);
+        }
+      else
+        {
+          svn_io__file_advise_dontneed(old_file);
+          svn_error_clear(svn_io_file_close(old_file, scratch_pool));
+        }
+    }
+
+  ffd->scan_start_rev = start_rev;
+}
+
 /* Core implementation of svn_fs_fs__open_pack_or_rev_file working on an
  * existing, initialized FILE structure.  If WRITABLE is TRUE, give write
  * access to the file - temporarily resetting the r/o state if necessary.
@@ -160,6 +206,10 @@ open_pack_or_rev_file(svn_fs_fs__revision_file_t *file,
                                                   result_pool);
           file->is_packed = svn_fs_fs__is_packed_rev(fs, rev);
 
+          /* Bulk scans shall not evict the working set of others. */
+          if (ffd->sequential_scan)
+            advance_scan(fs, apr_file, file->start_revision, scratch_pool);
+
           return SVN_NO_ERROR;
         }
 
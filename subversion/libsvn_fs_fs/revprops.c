@@ -672,6 +672,164 @@ read_pack_revprop(packed_revprops_t **revprops,
   return SVN_NO_ERROR;
 }
 
+/* Read a decimal number terminated by '\n' from the buffered FILE and
+ * return it in *VALUE.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+read_pack_header_number(apr_int64_t *value,
+                        apr_file_t *file,
+                        apr_pool_t *scratch_pool)
+{
+  char buffer[SVN_INT64_BUFFER_SIZE];
+  apr_size_t len = 0;
+  char c;
+
+  SVN_ERR(svn_io_file_getc(&c, file, scratch_pool));
+  while (c != '\n')
+    {
+      if (len + 1 >= sizeof(buffer))
+        return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
+                                _("Number too long in revprop pack header"));
+
+      buffer[len++] = c;
+      SVN_ERR(svn_io_file_getc(&c, file, scratch_pool));
+    }
+
+  buffer[len] = '\0';
+  return svn_error_trace(svn_cstring_atoi64(value, buffer));
+}
+
+/* Implement read_stored_pack_revprop() but return errors instead of
+ * falling back.
+ */
+static svn_error_t *
+read_stored_pack_revprop_body(apr_size_t *size,
+                              svn_string_t **serialized,
+                              svn_fs_t *fs,
+                              svn_revnum_t rev,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool)
+{
+  packed_revprops_t revprops = { 0 };
+  apr_file_t *file;
+  svn_filesize_t file_size;
+  apr_off_t header_size, offset = 0;
+  apr_uint64_t content_size = 0;
+  apr_int64_t first_rev, count, i, rev_size = 0;
+  char c;
+  int shift;
+
+  revprops.revision = rev;
+  SVN_ERR(get_revprop_packname(fs, &revprops, scratch_pool, scratch_pool));
+  SVN_ERR(svn_io_file_open(&file,
+                           svn_dirent_join(revprops.folder,
+                                           revprops.filename,
+                                           scratch_pool),
+                           APR_READ | APR_BUFFERED, APR_OS_DEFAULT,
+                           scratch_pool));
+  SVN_ERR(svn_io_file_size_get(&file_size, file, scratch_pool));
+
+  /* The pack starts with the 7b/8b encoded length of the uncompressed
+   * data.  If that equals the remainder of the file, the data has been
+   * "stored" instead of being compressed, cf. svn__compress_zlib(). */
+  for (shift = 0; shift < SVN__MAX_ENCODED_UINT_LEN; ++shift)
+    {
+      SVN_ERR(svn_io_file_getc(&c, file, scratch_pool));
+      content_size = (content_size << 7) | ((unsigned char)c & 0x7f);
+      if ((unsigned char)c < 0x80)
+        break;
+    }
+
+  SVN_ERR(svn_io_file_get_offset(&header_size, file, scratch_pool));
+  if (content_size != (apr_uint64_t)(file_size - header_size))
+    return SVN_NO_ERROR;
+
+  /* The uncompressed header is "<first rev>\n<count>\n<size>\n...\n\n".
+   * Sum up the sizes of all revprops stored before REV. */
+  SVN_ERR(read_pack_header_number(&first_rev, file, scratch_pool));
+  SVN_ERR(read_pack_header_number(&count, file, scratch_pool));
+  if (   count < 1
+      || rev < first_rev
+      || rev >= first_rev + count
+      || !same_shard(fs, rev, first_rev + count - 1))
+    return SVN_NO_ERROR;
+
+  for (i = 0; i < count; ++i)
+    {
+      apr_int64_t entry_size;
+      SVN_ERR(read_pack_header_number(&entry_size, file, scratch_pool));
+      if (entry_size < 0 || entry_size > file_size)
+        return SVN_NO_ERROR;
+
+      if (first_rev + i < rev)
+        offset += (apr_off_t)entry_size;
+      else if (first_rev + i == rev)
+        rev_size = entry_size;
+    }
+
+  SVN_ERR(svn_io_file_getc(&c, file, scratch_pool));
+  if (c != '\n')
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_io_file_get_offset(&header_size, file, scratch_pool));
+  offset += header_size;
+  if (offset + rev_size > file_size)
+    return SVN_NO_ERROR;
+
+  if (serialized)
+    {
+      svn_stringbuf_t *content
+        = svn_stringbuf_create_ensure((apr_size_t)rev_size, result_pool);
+
+      SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+      SVN_ERR(svn_io_file_read_full2(file, content->data,
+                                     (apr_size_t)rev_size, NULL, NULL,
+                                     scratch_pool));
+      content->len = (apr_size_t)rev_size;
+      content->data[content->len] = '\0';
+
+      *serialized = svn_stringbuf__morph_into_string(content);
+    }
+
+  *size = (apr_size_t)rev_size;
+  SVN_ERR(svn_io_file_close(file, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* If the revprop pack containing revision REV in FS has been written
+ * without compression, read only its header plus the serialized revprops
+ * of REV instead of the whole pack.  Return the size of the latter in
+ * *SIZE and, if SERIALIZED is not NULL, their contents in *SERIALIZED.
+ * Set *FOUND to FALSE if the pack is compressed or could not be read for
+ * any reason.  Callers are expected to fall back to read_pack_revprop(),
+ * which takes care of retries after concurrent writes and of reporting
+ * errors.
+ *
+ * Allocate the result in RESULT_POOL and temporaries in SCRATCH_POOL.
+ */
+static svn_error_t *
+read_stored_pack_revprop(svn_boolean_t *found,
+                         apr_size_t *size,
+                         svn_string_t **serialized,
+                         svn_fs_t *fs,
+                         svn_revnum_t rev,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  apr_pool_t *subpool = svn_pool_create(scratch_pool);
+  svn_error_t *err;
+
+  *size = APR_SIZE_MAX;
+  err = read_stored_pack_revprop_body(size, serialized, fs, rev,
+                                      result_pool, subpool);
+  *found = !err && *size != APR_SIZE_MAX;
+  svn_error_clear(err);
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_fs__get_revision_props_size(apr_off_t *props_size_p,
                                    svn_fs_t *fs,
@@ -716,9 +874,19 @@ svn_fs_fs__get_revision_props_size(apr_off_t *props_size_p,
    * likely invalid (or its revprops highly contested). */
   {
     packed_revprops_t *revprops;
+    svn_boolean_t found;
+    apr_size_t size;
+
+    /* Uncompressed packs let us read the size from the header alone. */
+    SVN_ERR(read_stored_pack_revprop(&found, &size, NULL, fs, rev,
+                                     scratch_pool, scratch_pool));
+    if (found)
+      {
+        *props_size_p = (apr_off_t)size;
+        return SVN_NO_ERROR;
+      }
 
-    /* ### This is inefficient -- reading all the revprops in a pack. We
-       should just read the index. */
+    /* Compressed packs have to be read and decompressed as a whole. */
     SVN_ERR(read_pack_revprop(&revprops, fs, rev,
                               TRUE /*read_all*/, FALSE /*populate_cache*/,
                               scratch_pool));
@@ -804,10 +972,30 @@ svn_fs_fs__get_revision_proplist(apr_hash_t **proplist_p,
    * likely invalid (or its revprops highly contested). */
   if (ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT && !*proplist_p)
     {
-      packed_revprops_t *revprops;
-      SVN_ERR(read_pack_revprop(&revprops, fs, rev, FALSE, populate_cache,
-                                result_pool));
-      *proplist_p = revprops->properties;
+      svn_boolean_t found = FALSE;
+      apr_size_t size;
+      svn_string_t *serialized;
+
+      /* If we are not going to fill the cache with the whole pack anyway,
+       * fetch just the revprops of REV from uncompressed packs.  Callers
+       * that read many revisions, e.g. 'svn log', are better served by
+       * parsing the pack once and caching all of its revisions. */
+      if (!populate_cache)
+        SVN_ERR(read_stored_pack_revprop(&found, &size, &serialized, fs, rev,
+                                         scratch_pool, scratch_pool));
+
+      if (found)
+        {
+          SVN_ERR(parse_revprop(proplist_p, fs, rev, serialized,
+                                result_pool, scratch_pool));
+        }
+      else
+        {
+          packed_revprops_t *revprops;
+          SVN_ERR(read_pack_revprop(&revprops, fs, rev, FALSE,
+                                    populate_cache, result_pool));
+          *proplist_p = revprops->properties;
+        }
     }
 
   /* The revprops should have been there. Did we get them? */
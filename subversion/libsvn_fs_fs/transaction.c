@@ -42,6 +42,7 @@
 #include "cached_data.h"
 #include "lock.h"
 #include "rep-cache.h"
+#include "mergeinfo-index.h"
 
 #include "private/svn_fs_util.h"
 #include "private/svn_fspath.h"
@@ -3932,6 +3933,22 @@ commit_body(void *baton, apr_pool_t *pool)
   /* Remove this transaction directory. */
   SVN_ERR(svn_fs_fs__purge_txn(cb->fs, cb->txn->id, pool));
 
+  /* Record the paths with mergeinfo in the new revision.  This must
+     happen under the write lock, lest the next commit finds no index for
+     its predecessor.  The revision has been committed already and the
+     index is optional, so failures must not be reported as commit
+     failures. */
+  if (ffd->mergeinfo_index)
+    {
+      svn_error_t *err = svn_fs_fs__mergeinfo_index_update(cb->fs, new_rev,
+                                                           pool);
+      if (err)
+        {
+          (cb->fs->warning)(cb->fs->warning_baton, err);
+          svn_error_clear(err);
+        }
+    }
+
   return SVN_NO_ERROR;
 }
 
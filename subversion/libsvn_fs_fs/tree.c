@@ -62,6 +62,7 @@
 #include "temp_serializer.h"
 #include "transaction.h"
 #include "util.h"
+#include "mergeinfo-index.h"
 
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_subr_private.h"
@@ -4165,6 +4166,54 @@ assemble_history(svn_fs_t *fs,
 /* mergeinfo queries */
 
 
+/* NODE is the DAG node at PATH and has mergeinfo.  Call RECEIVER with
+   its mergeinfo and BATON.  Silently skip syntactically invalid
+   mergeinfo.  SCRATCH_POOL is used for temporary allocations, including
+   the mergeinfo hash passed to RECEIVER. */
+static svn_error_t *
+report_node_mergeinfo(const char *path,
+                      dag_node_t *node,
+                      svn_fs_mergeinfo_receiver_t receiver,
+                      void *baton,
+                      apr_pool_t *scratch_pool)
+{
+  apr_hash_t *proplist;
+  svn_mergeinfo_t mergeinfo;
+  svn_string_t *mergeinfo_string;
+  svn_error_t *err;
+
+  SVN_ERR(svn_fs_fs__dag_get_proplist(&proplist, node, scratch_pool));
+  mergeinfo_string = svn_hash_gets(proplist, SVN_PROP_MERGEINFO);
+  if (!mergeinfo_string)
+    {
+      svn_string_t *idstr
+        = svn_fs_fs__id_unparse(svn_fs_fs__dag_get_id(node), scratch_pool);
+      return svn_error_createf
+        (SVN_ERR_FS_CORRUPT, NULL,
+         _("Node-revision #'%s' claims to have mergeinfo but doesn't"),
+         idstr->data);
+    }
+
+  /* Issue #3896: If a node has syntactically invalid mergeinfo, then
+     treat it as if no mergeinfo is present rather than raising a parse
+     error. */
+  err = svn_mergeinfo_parse(&mergeinfo, mergeinfo_string->data,
+                            scratch_pool);
+  if (err)
+    {
+      if (err->apr_err == SVN_ERR_MERGEINFO_PARSE_ERROR)
+        svn_error_clear(err);
+      else
+        return svn_error_trace(err);
+    }
+  else
+    {
+      SVN_ERR(receiver(path, mergeinfo, baton, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* DIR_DAG is a directory DAG node which has mergeinfo in its
    descendants.  This function iterates over its children.  For each
    child with immediate mergeinfo, call RECEIVER with it and BATON.
@@ -4203,42 +4252,8 @@ crawl_directory_dag_for_mergeinfo(svn_fs_root_t *root,
       SVN_ERR(svn_fs_fs__dag_has_descendants_with_mergeinfo(&go_down, kid_dag));
 
       if (has_mergeinfo)
-        {
-          /* Save this particular node's mergeinfo. */
-          apr_hash_t *proplist;
-          svn_mergeinfo_t kid_mergeinfo;
-          svn_string_t *mergeinfo_string;
-          svn_error_t *err;
-
-          SVN_ERR(svn_fs_fs__dag_get_proplist(&proplist, kid_dag, iterpool));
-          mergeinfo_string = svn_hash_gets(proplist, SVN_PROP_MERGEINFO);
-          if (!mergeinfo_string)
-            {
-              svn_string_t *idstr = svn_fs_fs__id_unparse(dirent->id, iterpool);
-              return svn_error_createf
-                (SVN_ERR_FS_CORRUPT, NULL,
-                 _("Node-revision #'%s' claims to have mergeinfo but doesn't"),
-                 idstr->data);
-            }
-
-          /* Issue #3896: If a node has syntactically invalid mergeinfo, then
-             treat it as if no mergeinfo is present rather than raising a parse
-             error. */
-          err = svn_mergeinfo_parse(&kid_mergeinfo,
-                                    mergeinfo_string->data,
-                                    iterpool);
-          if (err)
-            {
-              if (err->apr_err == SVN_ERR_MERGEINFO_PARSE_ERROR)
-                svn_error_clear(err);
-              else
-                return svn_error_trace(err);
-              }
-          else
-            {
-              SVN_ERR(receiver(kid_path, kid_mergeinfo, baton, iterpool));
-            }
-        }
+        SVN_ERR(report_node_mergeinfo(kid_path, kid_dag, receiver, baton,
+                                      iterpool));
 
       if (go_down)
         SVN_ERR(crawl_directory_dag_for_mergeinfo(root,
@@ -4430,10 +4445,13 @@ get_mergeinfo_for_path(svn_mergeinfo_t *mergeinfo,
 }
 
 /* Invoke RECEIVER with BATON for each mergeinfo found on descendants of
-   PATH (but not PATH itself).  Use SCRATCH_POOL for temporary values. */
+   PATH (but not PATH itself).  If not NULL, INDEX is the mergeinfo index
+   of ROOT and will be used instead of crawling the tree.  Use
+   SCRATCH_POOL for temporary values. */
 static svn_error_t *
 add_descendant_mergeinfo(svn_fs_root_t *root,
                          const char *path,
+                         const apr_array_header_t *index,
                          svn_fs_mergeinfo_receiver_t receiver,
                          void *baton,
                          apr_pool_t *scratch_pool)
@@ -4444,13 +4462,42 @@ add_descendant_mergeinfo(svn_fs_root_t *root,
   SVN_ERR(get_dag(&this_dag, root, path, scratch_pool));
   SVN_ERR(svn_fs_fs__dag_has_descendants_with_mergeinfo(&go_down,
                                                         this_dag));
-  if (go_down)
-    SVN_ERR(crawl_directory_dag_for_mergeinfo(root,
-                                              path,
-                                              this_dag,
-                                              receiver,
-                                              baton,
-                                              scratch_pool));
+  if (go_down && index)
+    {
+      /* All descendants directly follow PATH in the index. */
+      apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+      const char *abspath = svn_fs__canonicalize_abspath(path, scratch_pool);
+      int i = svn_fs_fs__mergeinfo_index_find(index, abspath);
+
+      for (; i < index->nelts; ++i)
+        {
+          const char *kid_path = APR_ARRAY_IDX(index, i, const char *);
+          const char *relpath = svn_fspath__skip_ancestor(abspath, kid_path);
+          dag_node_t *kid_dag;
+
+          if (!relpath)
+            break;
+          if (!*relpath)
+            continue;
+
+          svn_pool_clear(iterpool);
+          SVN_ERR(get_dag(&kid_dag, root, kid_path, iterpool));
+          SVN_ERR(report_node_mergeinfo(kid_path, kid_dag, receiver, baton,
+                                        iterpool));
+        }
+
+      svn_pool_destroy(iterpool);
+    }
+  else if (go_down)
+    {
+      SVN_ERR(crawl_directory_dag_for_mergeinfo(root,
+                                                path,
+                                                this_dag,
+                                                receiver,
+                                                baton,
+                                                scratch_pool));
+    }
+
   return SVN_NO_ERROR;
 }
 
@@ -4470,9 +4517,17 @@ get_mergeinfos_for_paths(svn_fs_root_t *root,
                          void *baton,
                          apr_pool_t *scratch_pool)
 {
+  fs_fs_data_t *ffd = root->fs->fsap_data;
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_array_header_t *index = NULL;
   int i;
 
+  /* Listing all paths with mergeinfo is much cheaper than looking for
+     them in the tree. */
+  if (include_descendants && ffd->mergeinfo_index)
+    SVN_ERR(svn_fs_fs__mergeinfo_index_read(&index, root->fs, root->rev,
+                                            scratch_pool, scratch_pool));
+
   for (i = 0; i < paths->nelts; i++)
     {
       svn_error_t *err;
@@ -4501,7 +4556,7 @@ get_mergeinfos_for_paths(svn_fs_root_t *root,
       if (path_mergeinfo)
         SVN_ERR(receiver(path, path_mergeinfo, baton, iterpool));
       if (include_descendants)
-        SVN_ERR(add_descendant_mergeinfo(root, path, receiver, baton,
+        SVN_ERR(add_descendant_mergeinfo(root, path, index, receiver, baton,
                                          iterpool));
     }
   svn_pool_destroy(iterpool);
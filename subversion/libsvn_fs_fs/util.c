@@ -365,6 +365,24 @@ svn_fs_fs__path_node_origin(svn_fs_t *fs,
                               buffer, SVN_VA_NULL);
 }
 
+const char *
+svn_fs_fs__path_mergeinfo_index(svn_fs_t *fs,
+                                svn_revnum_t rev,
+                                apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  if (ffd->max_files_per_dir)
+    return svn_dirent_join_many(pool, fs->path, PATH_MERGEINFO_INDEX_DIR,
+                                apr_psprintf(pool, "%ld",
+                                             rev / ffd->max_files_per_dir),
+                                apr_psprintf(pool, "%ld", rev),
+                                SVN_VA_NULL);
+
+  return svn_dirent_join_many(pool, fs->path, PATH_MERGEINFO_INDEX_DIR,
+                              apr_psprintf(pool, "%ld", rev), SVN_VA_NULL);
+}
+
 const char *
 svn_fs_fs__path_min_unpacked_rev(svn_fs_t *fs,
                                  apr_pool_t *pool)
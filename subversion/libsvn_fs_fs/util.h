@@ -287,6 +287,14 @@ svn_fs_fs__path_node_origin(svn_fs_t *fs,
                             const svn_fs_fs__id_part_t *node_id,
                             apr_pool_t *pool);
 
+/* Return the path of the file containing the mergeinfo index for
+ * revision REV in FS.  The result will be allocated in POOL.
+ */
+const char *
+svn_fs_fs__path_mergeinfo_index(svn_fs_t *fs,
+                                svn_revnum_t rev,
+                                apr_pool_t *pool);
+
 /* Set *MIN_UNPACKED_REV to the integer value read from the file returned
  * by #svn_fs_fs__path_min_unpacked_rev() for FS.
  * Use POOL for temporary allocations.
@@ -41,6 +41,10 @@
 
 /** Verifying. **/
 
+/* Maximum number of L2P lookups to batch in a single call to
+ * svn_fs_fs__item_offsets(). */
+#define VERIFY_L2P_BATCH_SIZE 1024
+
 /* Baton type expected by verify_walker().  The purpose is to reuse open
  * rev / pack file handles between calls.  Its contents need to be cleaned
  * periodically to limit resource usage.
@@ -264,6 +268,10 @@ compare_l2p_to_p2l_index(svn_fs_t *fs,
   svn_revnum_t i;
   apr_pool_t *iterpool = svn_pool_create(pool);
   apr_array_header_t *max_ids;
+  svn_fs_fs__id_part_t *items
+    = apr_palloc(pool, VERIFY_L2P_BATCH_SIZE * sizeof(*items));
+  apr_off_t *offsets
+    = apr_palloc(pool, VERIFY_L2P_BATCH_SIZE * sizeof(*offsets));
 
   /* common file access structure */
   svn_fs_fs__revision_file_t *rev_file;
@@ -280,16 +288,32 @@ compare_l2p_to_p2l_index(svn_fs_t *fs,
       apr_uint64_t k;
       apr_uint64_t max_id = APR_ARRAY_IDX(max_ids, i, apr_uint64_t);
       svn_revnum_t revision = start + i;
+      int batch_count = 0;
 
       for (k = 0; k < max_id; ++k)
         {
           apr_off_t offset;
           svn_fs_fs__p2l_entry_t *p2l_entry;
+          int batch_index = (int)(k % VERIFY_L2P_BATCH_SIZE);
           svn_pool_clear(iterpool);
 
-          /* get L2P entry.  Ignore unused entries. */
-          SVN_ERR(svn_fs_fs__item_offset(&offset, fs, rev_file, revision,
-                                         NULL, k, iterpool));
+          /* get the next batch of L2P entries. */
+          if (batch_index == 0)
+            {
+              batch_count = (int)MIN(max_id - k, VERIFY_L2P_BATCH_SIZE);
+              for (batch_index = 0; batch_index < batch_count; ++batch_index)
+                {
+                  items[batch_index].revision = revision;
+                  items[batch_index].number = k + batch_index;
+                }
+
+              SVN_ERR(svn_fs_fs__item_offsets(offsets, fs, rev_file, items,
+                                              batch_count, iterpool));
+              batch_index = 0;
+            }
+
+          /* Ignore unused entries. */
+          offset = offsets[batch_index];
           if (offset == -1)
             continue;
 
@@ -366,6 +390,9 @@ compare_p2l_to_l2p_index(svn_fs_t *fs,
     {
       apr_array_header_t *entries;
       svn_fs_fs__p2l_entry_t *last_entry;
+      svn_fs_fs__id_part_t *items;
+      apr_off_t *l2p_offsets;
+      int item_count = 0;
       int i;
 
       svn_pool_clear(iterpool);
@@ -386,6 +413,23 @@ compare_p2l_to_l2p_index(svn_fs_t *fs,
         = &APR_ARRAY_IDX(entries, entries->nelts-1, svn_fs_fs__p2l_entry_t);
       offset = last_entry->offset + last_entry->size;
 
+      /* look up all used items in the L2P index in one go */
+      items = apr_palloc(iterpool, entries->nelts * sizeof(*items));
+      l2p_offsets = apr_palloc(iterpool,
+                               entries->nelts * sizeof(*l2p_offsets));
+      for (i = 0; i < entries->nelts; ++i)
+        {
+          svn_fs_fs__p2l_entry_t *entry
+            = &APR_ARRAY_IDX(entries, i, svn_fs_fs__p2l_entry_t);
+
+          if (entry->type != SVN_FS_FS__ITEM_TYPE_UNUSED)
+            items[item_count++] = entry->item;
+        }
+
+      SVN_ERR(svn_fs_fs__item_offsets(l2p_offsets, fs, rev_file, items,
+                                      item_count, iterpool));
+
+      item_count = 0;
       for (i = 0; i < entries->nelts; ++i)
         {
           svn_fs_fs__p2l_entry_t *entry
@@ -411,11 +455,7 @@ compare_p2l_to_l2p_index(svn_fs_t *fs,
             }
           else
             {
-              apr_off_t l2p_offset;
-              SVN_ERR(svn_fs_fs__item_offset(&l2p_offset, fs, rev_file,
-                                             entry->item.revision, NULL,
-                                             entry->item.number, iterpool));
-
+              apr_off_t l2p_offset = l2p_offsets[item_count++];
               if (l2p_offset != entry->offset)
                 return svn_error_createf(SVN_ERR_FS_INDEX_INCONSISTENT,
                                          NULL,
@@ -28,6 +28,7 @@
 #include "svn_ctype.h"
 #include "svn_sorts.h"
 
+#include "private/svn_delta_private.h"
 #include "private/svn_io_private.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_string_private.h"
@@ -386,13 +387,25 @@ svn_fs_x__get_node_revision(svn_fs_x__noderev_t **noderev_p,
 }
 
 
-svn_error_t *
-svn_fs_x__get_mergeinfo_count(apr_int64_t *count,
-                              svn_fs_t *fs,
-                              const svn_fs_x__id_t *id,
-                              apr_pool_t *scratch_pool)
+/* If the node-revision for ID in FS is part of a cached noderevs
+   container, apply GETTER to it, passing OUT and BATON through, and set
+   *FOUND.  Before that, set *SUB_ITEM to the index of the noderev within
+   the container.  Unless BATON contains SUB_ITEM, it will usually be
+   SUB_ITEM itself.  Otherwise, set *FOUND to FALSE and leave OUT untouched.
+   This allows for reading individual fields without constructing the whole
+   noderev.  Do temporary allocations in SCRATCH_POOL.
+ */
+static svn_error_t *
+get_cached_noderev_part(svn_boolean_t *found,
+                        void **out,
+                        svn_fs_t *fs,
+                        const svn_fs_x__id_t *id,
+                        svn_cache__partial_getter_func_t getter,
+                        apr_uint32_t *sub_item,
+                        void *baton,
+                        apr_pool_t *scratch_pool)
 {
-  svn_fs_x__noderev_t *noderev;
+  *found = FALSE;
 
   /* If we want a full access log, we need to provide full data and
      cannot take shortcuts here. */
@@ -414,24 +427,38 @@ svn_fs_x__get_mergeinfo_count(apr_int64_t *count,
         {
           svn_fs_x__pair_cache_key_t key;
           apr_off_t offset;
-          apr_uint32_t sub_item;
-          svn_boolean_t is_cached;
 
-          SVN_ERR(svn_fs_x__item_offset(&offset, &sub_item, fs, rev_file,
+          SVN_ERR(svn_fs_x__item_offset(&offset, sub_item, fs, rev_file,
                                         id, scratch_pool));
           key.revision = svn_fs_x__packed_base_rev(fs, revision);
           key.second = offset;
 
-          SVN_ERR(svn_cache__get_partial((void **)count, &is_cached,
+          SVN_ERR(svn_cache__get_partial(out, found,
                                          ffd->noderevs_container_cache, &key,
-                                         svn_fs_x__mergeinfo_count_get_func,
-                                         &sub_item, scratch_pool));
-          if (is_cached)
-            return SVN_NO_ERROR;
+                                         getter, baton, scratch_pool));
         }
     }
 #endif
 
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_x__get_mergeinfo_count(apr_int64_t *count,
+                              svn_fs_t *fs,
+                              const svn_fs_x__id_t *id,
+                              apr_pool_t *scratch_pool)
+{
+  svn_fs_x__noderev_t *noderev;
+  svn_boolean_t found;
+  apr_uint32_t sub_item;
+
+  SVN_ERR(get_cached_noderev_part(&found, (void **)count, fs, id,
+                                  svn_fs_x__mergeinfo_count_get_func,
+                                  &sub_item, &sub_item, scratch_pool));
+  if (found)
+    return SVN_NO_ERROR;
+
   /* fallback to the naive implementation handling all edge cases */
   SVN_ERR(svn_fs_x__get_node_revision(&noderev, fs, id, scratch_pool,
                                       scratch_pool));
@@ -440,6 +467,74 @@ svn_fs_x__get_mergeinfo_count(apr_int64_t *count,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_x__get_history_ids(svn_fs_x__id_t *node_id,
+                          svn_fs_x__id_t *copy_id,
+                          svn_fs_t *fs,
+                          const svn_fs_x__id_t *id,
+                          apr_pool_t *scratch_pool)
+{
+  svn_fs_x__noderev_t *noderev;
+  svn_fs_x__id_t history_ids[2];
+  svn_boolean_t found;
+  apr_uint32_t sub_item;
+
+  SVN_ERR(get_cached_noderev_part(&found, (void **)history_ids, fs, id,
+                                  svn_fs_x__history_ids_get_func,
+                                  &sub_item, &sub_item, scratch_pool));
+  if (found)
+    {
+      *node_id = history_ids[0];
+      *copy_id = history_ids[1];
+      return SVN_NO_ERROR;
+    }
+
+  /* fallback to the naive implementation handling all edge cases */
+  SVN_ERR(svn_fs_x__get_node_revision(&noderev, fs, id, scratch_pool,
+                                      scratch_pool));
+  *node_id = noderev->node_id;
+  *copy_id = noderev->copy_id;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_x__get_predecessor(svn_fs_x__id_t *predecessor_id,
+                          const char **created_path,
+                          svn_fs_t *fs,
+                          const svn_fs_x__id_t *id,
+                          const char *path,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
+{
+  svn_fs_x__noderev_t *noderev;
+  svn_fs_x__predecessor_baton_t baton;
+  void *dummy;
+  svn_boolean_t found;
+
+  baton.path = path;
+  baton.path_len = strlen(path);
+
+  SVN_ERR(get_cached_noderev_part(&found, &dummy, fs, id,
+                                  svn_fs_x__predecessor_get_func,
+                                  &baton.sub_item, &baton, scratch_pool));
+  if (found && baton.same_path)
+    {
+      *predecessor_id = baton.predecessor_id;
+      *created_path = path;
+      return SVN_NO_ERROR;
+    }
+
+  /* fallback to the naive implementation handling all edge cases */
+  SVN_ERR(svn_fs_x__get_node_revision(&noderev, fs, id, result_pool,
+                                      scratch_pool));
+  *predecessor_id = noderev->predecessor_id;
+  *created_path = strcmp(noderev->created_path, path) ? noderev->created_path
+                                                      : path;
+
+  return SVN_NO_ERROR;
+}
+
 /* Describes a lazily opened rev / pack file.  Instances will be shared
    between multiple instances of rep_state_t. */
 typedef struct shared_file_t
@@ -2372,6 +2467,7 @@ svn_fs_x__get_file_delta_stream(svn_txdelta_stream_t **stream_p,
                                 apr_pool_t *result_pool,
                                 apr_pool_t *scratch_pool)
 {
+  svn_fs_x__data_t *ffd = fs->fsap_data;
   svn_stream_t *source_stream, *target_stream;
   rep_state_t *rep_state;
   svn_fs_x__rep_header_t *rep_header;
@@ -2436,8 +2532,15 @@ svn_fs_x__get_file_delta_stream(svn_txdelta_stream_t **stream_p,
 
   /* Because source and target stream will already verify their content,
    * there is no need to do this once more.  In particular if the stream
-   * content is being fetched from cache. */
-  svn_txdelta2(stream_p, source_stream, target_stream, FALSE, result_pool);
+   * content is being fetched from cache.  The delta is only being sent
+   * to clients and never stored in the repository, hence it may use
+   * sliding source views. */
+  if (ffd->sliding_delta_windows)
+    svn_txdelta__sliding(stream_p, source_stream, target_stream, FALSE,
+                         result_pool);
+  else
+    svn_txdelta2(stream_p, source_stream, target_stream, FALSE,
+                 result_pool);
 
   return SVN_NO_ERROR;
 }
@@ -49,6 +49,33 @@ svn_fs_x__get_mergeinfo_count(apr_int64_t *count,
                               const svn_fs_x__id_t *id,
                               apr_pool_t *scratch_pool);
 
+/* Set *NODE_ID and *COPY_ID to the node_id and copy_id members of the
+   node-revision for the node ID in FS.  Do temporary allocations in
+   SCRATCH_POOL.
+ */
+svn_error_t *
+svn_fs_x__get_history_ids(svn_fs_x__id_t *node_id,
+                          svn_fs_x__id_t *copy_id,
+                          svn_fs_t *fs,
+                          const svn_fs_x__id_t *id,
+                          apr_pool_t *scratch_pool);
+
+/* Set *PREDECESSOR_ID to the predecessor_id and *CREATED_PATH to the
+   created_path of the node-revision for the node ID in FS.  If the latter
+   equals PATH, *CREATED_PATH will be PATH itself.  For node-revisions in
+   cached noderevs containers, that case does not construct the noderev.
+   Allocate *CREATED_PATH in RESULT_POOL and do temporary allocations in
+   SCRATCH_POOL.
+ */
+svn_error_t *
+svn_fs_x__get_predecessor(svn_fs_x__id_t *predecessor_id,
+                          const char **created_path,
+                          svn_fs_t *fs,
+                          const svn_fs_x__id_t *id,
+                          const char *path,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool);
+
 /* Verify that representation REP in FS can be accessed.
    Do any allocations in SCRATCH_POOL. */
 svn_error_t *
@@ -69,9 +69,9 @@ normalize_key_part(const char *original,
   return normalized->data;
 }
 
-/* *CACHE_TXDELTAS, *CACHE_FULLTEXTS, *CACHE_REVPROPS and *CACHE_NODEPROPS
-   flags will be set according to FS->CONFIG.  *CACHE_NAMESPACE receives
-   the cache prefix to use.
+/* *CACHE_TXDELTAS, *CACHE_FULLTEXTS, *CACHE_REVPROPS, *CACHE_NODEPROPS
+   and *CACHE_PATHS flags will be set according to FS->CONFIG.
+   *CACHE_NAMESPACE receives the cache prefix to use.
 
    Allocate CACHE_NAMESPACE in RESULT_POOL. */
 static svn_error_t *
@@ -80,6 +80,7 @@ read_config(const char **cache_namespace,
             svn_boolean_t *cache_fulltexts,
             svn_boolean_t *cache_revprops,
             svn_boolean_t *cache_nodeprops,
+            svn_boolean_t *cache_paths,
             svn_fs_t *fs,
             apr_pool_t *result_pool)
 {
@@ -147,6 +148,17 @@ read_config(const char **cache_namespace,
                          SVN_FS_CONFIG_FSFS_CACHE_NODEPROPS,
                          TRUE);
 
+  /* don't share resolved revision paths between FS instances by default.
+   * It only pays off for servers with many sessions accessing the same
+   * few revisions.  Everybody else would only pay for the extra key
+   * construction and cache lookup with every path not found in the
+   * 1st level DAG node cache.
+   */
+  *cache_paths
+    = svn_hash__get_bool(fs->config,
+                         SVN_FS_CONFIG_FSFS_CACHE_PATHS,
+                         FALSE);
+
   return SVN_NO_ERROR;
 }
 
@@ -391,6 +403,7 @@ svn_fs_x__initialize_caches(svn_fs_t *fs,
   svn_boolean_t cache_fulltexts;
   svn_boolean_t cache_revprops;
   svn_boolean_t cache_nodeprops;
+  svn_boolean_t cache_paths;
   const char *cache_namespace;
   svn_boolean_t has_namespace;
 
@@ -400,6 +413,7 @@ svn_fs_x__initialize_caches(svn_fs_t *fs,
                       &cache_fulltexts,
                       &cache_revprops,
                       &cache_nodeprops,
+                      &cache_paths,
                       fs,
                       scratch_pool));
 
@@ -433,6 +447,27 @@ svn_fs_x__initialize_caches(svn_fs_t *fs,
   /* 1st level DAG node cache */
   ffd->dag_node_cache = svn_fs_x__create_dag_cache(fs->pool);
 
+  /* 2nd level DAG path cache, shared between sessions.  Don't fall back
+     to an inprocess cache as that would duplicate the 1st level cache.
+     Without a cache, don't even construct the keys. */
+  if (cache_paths && membuffer)
+    SVN_ERR(create_cache(&(ffd->dag_path_cache),
+                         NULL,
+                         membuffer,
+                         0, 0, /* Do not use inprocess cache */
+                         svn_fs_x__serialize_id,
+                         svn_fs_x__deserialize_id,
+                         APR_HASH_KEY_STRING,
+                         apr_pstrcat(scratch_pool, prefix, "DAGPATH",
+                                     SVN_VA_NULL),
+                         SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                         has_namespace,
+                         fs,
+                         no_handler, FALSE,
+                         fs->pool, scratch_pool));
+  else
+    ffd->dag_path_cache = NULL;
+
   /* Very rough estimate: 1K per directory. */
   SVN_ERR(create_cache(&(ffd->dir_cache),
                        NULL,
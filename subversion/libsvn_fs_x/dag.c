@@ -154,6 +154,26 @@ svn_fs_x__dag_same_line_of_history(dag_node_t *lhs,
       && svn_fs_x__id_eq(&lhs_noderev->copy_id, &rhs_noderev->copy_id);
 }
 
+svn_error_t *
+svn_fs_x__dag_same_line_of_history_by_id(svn_boolean_t *same,
+                                         svn_fs_t *fs,
+                                         const svn_fs_x__id_t *lhs,
+                                         const svn_fs_x__id_t *rhs,
+                                         apr_pool_t *scratch_pool)
+{
+  svn_fs_x__id_t lhs_node_id, lhs_copy_id, rhs_node_id, rhs_copy_id;
+
+  SVN_ERR(svn_fs_x__get_history_ids(&lhs_node_id, &lhs_copy_id, fs, lhs,
+                                    scratch_pool));
+  SVN_ERR(svn_fs_x__get_history_ids(&rhs_node_id, &rhs_copy_id, fs, rhs,
+                                    scratch_pool));
+
+  *same = svn_fs_x__id_eq(&lhs_node_id, &rhs_node_id)
+       && svn_fs_x__id_eq(&lhs_copy_id, &rhs_copy_id);
+
+  return SVN_NO_ERROR;
+}
+
 svn_boolean_t
 svn_fs_x__dag_check_mutable(const dag_node_t *node)
 {
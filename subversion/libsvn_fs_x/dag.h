@@ -125,6 +125,18 @@ svn_boolean_t
 svn_fs_x__dag_same_line_of_history(dag_node_t *lhs,
                                    dag_node_t *rhs);
 
+/* Set *SAME to TRUE, iff the nodes identified by LHS and RHS in FS have
+ * the same node and copy IDs.  Unlike svn_fs_x__dag_same_line_of_history,
+ * this does not need to construct the node objects and may read the IDs
+ * directly from cached containers.  Use SCRATCH_POOL for temporaries.
+ */
+svn_error_t *
+svn_fs_x__dag_same_line_of_history_by_id(svn_boolean_t *same,
+                                         svn_fs_t *fs,
+                                         const svn_fs_x__id_t *lhs,
+                                         const svn_fs_x__id_t *rhs,
+                                         apr_pool_t *scratch_pool);
+
 /* Return the created path of NODE.  The value returned is shared
    with NODE, and will be deallocated when NODE is.  */
 const char *
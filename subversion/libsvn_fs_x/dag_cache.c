@@ -423,6 +423,73 @@ dag_node_cache_get(svn_fs_root_t *root,
   return cache_lookup(ffd->dag_node_cache, change_set, path)->node;
 }
 
+/* 2nd level cache */
+
+/* Return the key for PATH in the committed CHANGE_SET to be used with the
+   DAG path cache.  Allocate the result in RESULT_POOL.
+ */
+static const char *
+dag_path_key(svn_fs_x__change_set_t change_set,
+             const svn_string_t *path,
+             apr_pool_t *result_pool)
+{
+  return apr_psprintf(result_pool, "%ld:%.*s",
+                      svn_fs_x__get_revnum(change_set),
+                      (int)path->len, path->data);
+}
+
+/* Set *NODE_ID to the noderev ID that PATH in CHANGE_SET resolved to in
+   any session that shares FS' DAG path cache.  Reset *NODE_ID if PATH is
+   not cached, if CHANGE_SET is not a committed revision or if FS has no
+   DAG path cache.  Use
+   SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+dag_path_cache_get(svn_fs_x__id_t *node_id,
+                   svn_fs_t *fs,
+                   svn_fs_x__change_set_t change_set,
+                   const svn_string_t *path,
+                   apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+  svn_fs_x__id_t *cached;
+  svn_boolean_t found = FALSE;
+
+  /* Only revisions are immutable. */
+  if (ffd->dag_path_cache && svn_fs_x__is_revision(change_set))
+    SVN_ERR(svn_cache__get((void **)&cached, &found, ffd->dag_path_cache,
+                           dag_path_key(change_set, path, scratch_pool),
+                           scratch_pool));
+
+  if (found)
+    *node_id = *cached;
+  else
+    svn_fs_x__id_reset(node_id);
+
+  return SVN_NO_ERROR;
+}
+
+/* Make PATH in CHANGE_SET resolve to NODE_ID in all sessions that share
+   FS' DAG path cache.  This is a no-op for uncommitted CHANGE_SETs.
+   Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+dag_path_cache_set(svn_fs_t *fs,
+                   svn_fs_x__change_set_t change_set,
+                   const svn_string_t *path,
+                   const svn_fs_x__id_t *node_id,
+                   apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+
+  if (ffd->dag_path_cache && svn_fs_x__is_revision(change_set))
+    SVN_ERR(svn_cache__set(ffd->dag_path_cache,
+                           dag_path_key(change_set, path, scratch_pool),
+                           (void *)node_id, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 
 void
 svn_fs_x__update_dag_cache(dag_node_t *node)
@@ -568,25 +635,34 @@ dag_step(dag_node_t **child_p,
       return SVN_NO_ERROR;
     }
 
-  /* Get the ID of the node we are looking for.  The function call checks
-     for various error conditions such like PARENT not being a directory. */
-  SVN_ERR(svn_fs_x__dir_entry_id(&node_id, parent, name, scratch_pool));
+  /* Another session may already have resolved PATH. */
+  SVN_ERR(dag_path_cache_get(&node_id, fs, change_set, path, scratch_pool));
   if (! svn_fs_x__id_used(&node_id))
     {
-      const char *dir;
-
-      /* No such directory entry.  Is a simple NULL result o.k.? */
-      if (allow_empty)
+      /* Get the ID of the node we are looking for.  The function call
+         checks for various error conditions such like PARENT not being a
+         directory. */
+      SVN_ERR(svn_fs_x__dir_entry_id(&node_id, parent, name, scratch_pool));
+      if (! svn_fs_x__id_used(&node_id))
         {
-          *child_p = NULL;
-          return SVN_NO_ERROR;
-        }
+          const char *dir;
+
+          /* No such directory entry.  Is a simple NULL result o.k.? */
+          if (allow_empty)
+            {
+              *child_p = NULL;
+              return SVN_NO_ERROR;
+            }
 
-      /* Produce an appropriate error message. */
-      dir = apr_pstrmemdup(scratch_pool, path->data, path->len);
-      dir = svn_fs__canonicalize_abspath(dir, scratch_pool);
+          /* Produce an appropriate error message. */
+          dir = apr_pstrmemdup(scratch_pool, path->data, path->len);
+          dir = svn_fs__canonicalize_abspath(dir, scratch_pool);
 
-      return SVN_FS__NOT_FOUND(root, dir);
+          return SVN_FS__NOT_FOUND(root, dir);
+        }
+
+      SVN_ERR(dag_path_cache_set(fs, change_set, path, &node_id,
+                                 scratch_pool));
     }
 
   /* We are about to add a new entry to the cache.  Periodically clear it.
@@ -657,6 +733,7 @@ walk_dag_path(dag_node_t **node_p,
   const char *entry;
   svn_string_t directory;
   svn_stringbuf_t *entry_buffer;
+  svn_fs_x__id_t node_id;
 
   /* Special case: root directory.
      We will later assume that all paths have at least one parent level,
@@ -704,6 +781,27 @@ walk_dag_path(dag_node_t **node_p,
                                         change_set, FALSE, scratch_pool));
     }
 
+  /* Third attempt: Some other session may have walked the same path in
+     the same revision before.  Then, we only need to construct the node
+     itself. */
+  SVN_ERR(dag_path_cache_get(&node_id, root->fs, change_set, path,
+                             scratch_pool));
+  if (svn_fs_x__id_used(&node_id))
+    {
+      svn_fs_x__data_t *ffd = root->fs->fsap_data;
+      cache_entry_t *bucket;
+
+      auto_clear_dag_cache(ffd->dag_node_cache);
+      bucket = cache_lookup(ffd->dag_node_cache, change_set, path);
+      if (bucket->node == NULL)
+        SVN_ERR(svn_fs_x__dag_get_node(&bucket->node, root->fs, &node_id,
+                                       ffd->dag_node_cache->pool,
+                                       scratch_pool));
+
+      *node_p = bucket->node;
+      return SVN_NO_ERROR;
+    }
+
   /* Now there is something to iterate over. Thus, create the ITERPOOL. */
   iterpool = svn_pool_create(scratch_pool);
 
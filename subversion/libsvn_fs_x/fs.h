@@ -103,7 +103,9 @@ extern "C" {
 #define CONFIG_SECTION_DELTIFICATION     "deltification"
 #define CONFIG_OPTION_MAX_DELTIFICATION_WALK     "max-deltification-walk"
 #define CONFIG_OPTION_MAX_LINEAR_DELTIFICATION   "max-linear-deltification"
+#define CONFIG_OPTION_SLIDING_DELTA_WINDOWS      "sliding-delta-windows"
 #define CONFIG_OPTION_COMPRESSION_LEVEL  "compression-level"
+#define CONFIG_OPTION_PACK_MATCH_THREADS "pack-match-threads"
 #define CONFIG_SECTION_PACKED_REVPROPS   "packed-revprops"
 #define CONFIG_OPTION_REVPROP_PACK_SIZE  "revprop-pack-size"
 #define CONFIG_OPTION_COMPRESS_PACKED_REVPROPS  "compress-packed-revprops"
@@ -290,6 +292,12 @@ typedef struct svn_fs_x__data_t
   /* Caches native dag_node_t* instances */
   svn_fs_x__dag_cache_t *dag_node_cache;
 
+  /* Second level behind DAG_NODE_CACHE.  Maps "REV:PATH" of nodes in
+     committed revisions to their noderev ID (svn_fs_x__id_t *).  Unlike
+     the 1st level cache, this will be shared between all svn_fs_t for
+     the same filesystem and namespace.  NULL if disabled. */
+  svn_cache__t *dag_path_cache;
+
   /* A cache of the contents of immutable directories; maps from
      unparsed FS ID to a apr_hash_t * mapping (const char *) dirent
      names to (svn_fs_x__dirent_t *). */
@@ -391,9 +399,17 @@ typedef struct svn_fs_x__data_t
    * deltification history after which skip deltas will be used. */
   apr_int64_t max_linear_deltification;
 
+  /* Whether file deltas sent to clients may use sliding source views,
+   * cf. svn_txdelta__sliding(). */
+  svn_boolean_t sliding_delta_windows;
+
   /* Compression level to use with txdelta storage format in new revs. */
   int delta_compression_level;
 
+  /* Number of threads to use when searching for matches while building
+   * representation containers during pack. */
+  int pack_match_threads;
+
   /* Pack after every commit. */
   svn_boolean_t pack_after_commit;
 
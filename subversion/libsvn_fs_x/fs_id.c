@@ -174,31 +174,30 @@ get_aux_pool(const fs_x__id_t *id)
   return context->aux_pool;
 }
 
-/* Return the noderev structure identified by ID.  Returns NULL for invalid
-   IDs or inaccessible repositories.  The caller should clear the auxiliary
-   pool before returning to its respective caller. */
-static svn_fs_x__noderev_t *
-get_noderev(const fs_x__id_t *id)
+/* Set *NODE_ID to the ID of the node that the noderev identified by ID
+   belongs to.  Returns FALSE for invalid IDs or inaccessible repositories.
+   The caller should clear the auxiliary pool before returning to its
+   respective caller. */
+static svn_boolean_t
+get_node_id(svn_fs_x__id_t *node_id,
+            const fs_x__id_t *id)
 {
-  svn_fs_x__noderev_t *result = NULL;
-
   svn_fs_x__id_context_t *context = id->generic_id.fsap_data;
   svn_fs_t *fs = get_fs(context);
   apr_pool_t *pool = get_aux_pool(id);
 
   if (fs)
     {
-      svn_error_t *err = svn_fs_x__get_node_revision(&result, fs,
-                                                     &id->noderev_id,
-                                                     pool, pool);
-      if (err)
-        {
-          svn_error_clear(err);
-          result = NULL;
-        }
+      svn_fs_x__id_t copy_id;
+      svn_error_t *err = svn_fs_x__get_history_ids(node_id, &copy_id, fs,
+                                                   &id->noderev_id, pool);
+      if (!err)
+        return TRUE;
+
+      svn_error_clear(err);
     }
 
-  return result;
+  return FALSE;
 }
 
 
@@ -226,22 +225,19 @@ id_compare(const svn_fs_id_t *a,
 {
   const fs_x__id_t *id_a = (const fs_x__id_t *)a;
   const fs_x__id_t *id_b = (const fs_x__id_t *)b;
-  svn_fs_x__noderev_t *noderev_a, *noderev_b;
+  svn_fs_x__id_t node_id_a, node_id_b;
   svn_boolean_t same_node;
 
   /* Quick check: same IDs? */
   if (svn_fs_x__id_eq(&id_a->noderev_id, &id_b->noderev_id))
     return svn_fs_node_unchanged;
 
-  /* Fetch the nodesrevs, compare the IDs of the nodes they belong to and
-     clean up any temporaries.  If we can't find one of the noderevs, don't
-     get access to the FS etc., report the IDs as "unrelated" as only
-     valid / existing things may be related. */
-  noderev_a = get_noderev(id_a);
-  noderev_b = get_noderev(id_b);
-
-  if (noderev_a && noderev_b)
-    same_node = svn_fs_x__id_eq(&noderev_a->node_id, &noderev_b->node_id);
+  /* Fetch the IDs of the nodes they belong to, compare them and clean up
+     any temporaries.  If we can't find one of the noderevs, don't get
+     access to the FS etc., report the IDs as "unrelated" as only valid /
+     existing things may be related. */
+  if (get_node_id(&node_id_a, id_a) && get_node_id(&node_id_b, id_b))
+    same_node = svn_fs_x__id_eq(&node_id_a, &node_id_b);
   else
     same_node = FALSE;
 
@@ -262,6 +262,7 @@ read_config(svn_fs_x__data_t *ffd,
 {
   svn_config_t *config;
   apr_int64_t compression_level;
+  apr_int64_t pack_match_threads;
 
   SVN_ERR(svn_config_read3(&config,
                            svn_dirent_join(fs_path, PATH_CONFIG, scratch_pool),
@@ -281,6 +282,10 @@ read_config(svn_fs_x__data_t *ffd,
                                CONFIG_SECTION_DELTIFICATION,
                                CONFIG_OPTION_MAX_LINEAR_DELTIFICATION,
                                SVN_FS_X_MAX_LINEAR_DELTIFICATION));
+  SVN_ERR(svn_config_get_bool(config, &ffd->sliding_delta_windows,
+                              CONFIG_SECTION_DELTIFICATION,
+                              CONFIG_OPTION_SLIDING_DELTA_WINDOWS,
+                              FALSE));
   SVN_ERR(svn_config_get_int64(config, &compression_level,
                                CONFIG_SECTION_DELTIFICATION,
                                CONFIG_OPTION_COMPRESSION_LEVEL,
@@ -288,6 +293,11 @@ read_config(svn_fs_x__data_t *ffd,
   ffd->delta_compression_level
     = (int)MIN(MAX(SVN_DELTA_COMPRESSION_LEVEL_NONE, compression_level),
                 SVN_DELTA_COMPRESSION_LEVEL_MAX);
+  SVN_ERR(svn_config_get_int64(config, &pack_match_threads,
+                               CONFIG_SECTION_DELTIFICATION,
+                               CONFIG_OPTION_PACK_MATCH_THREADS,
+                               1));
+  ffd->pack_match_threads = (int)MIN(MAX(1, pack_match_threads), 64);
 
   /* Initialize revprop packing settings in ffd. */
   SVN_ERR(svn_config_get_bool(config, &ffd->compress_packed_revprops,
@@ -440,6 +450,17 @@ write_config(svn_fs_t *fs,
 "### For 1.8, the default value is 16."                                      NL
 "# " CONFIG_OPTION_MAX_LINEAR_DELTIFICATION " = 16"                          NL
 "###"                                                                        NL
+"### When sending file changes to clients, the server computes deltas on"    NL
+"### the fly.  By default, each delta window compares fixed-size, aligned"   NL
+"### sections of the old and new contents.  Data inserted into or removed"   NL
+"### from a large file shifts all later sections against each other, so"     NL
+"### most of the file gets sent in full.  With sliding delta windows, the"   NL
+"### sections get realigned after each window.  All clients can apply such"  NL
+"### deltas but they differ from what previous servers send.  This setting"  NL
+"### has no effect on the data stored in the repository."                    NL
+"### Sliding delta windows are disabled by default."                         NL
+"# " CONFIG_OPTION_SLIDING_DELTA_WINDOWS " = false"                          NL
+"###"                                                                        NL
 "### After deltification, we compress the data through zlib to minimize on-" NL
 "### disk size.  That can be an expensive and ineffective process.  This"    NL
 "### setting controls the usage of zlib in future revisions."                NL
@@ -457,6 +478,12 @@ write_config(svn_fs_t *fs,
 "### and 0 disabling it altogether."                                         NL
 "### The default value is 5."                                                NL
 "# " CONFIG_OPTION_COMPRESSION_LEVEL " = 5"                                  NL
+"###"                                                                        NL
+"### When packing, similar file contents get stored in shared containers."   NL
+"### Searching the contents for common sections can be spread over several"  NL
+"### threads.  The resulting pack files are the same for any setting."       NL
+"### Only one thread is used by default."                                    NL
+"# " CONFIG_OPTION_PACK_MATCH_THREADS " = 1"                                 NL
 ""                                                                           NL
 "[" CONFIG_SECTION_PACKED_REVPROPS "]"                                       NL
 "### This parameter controls the size (in kBytes) of packed revprop files."  NL
@@ -911,3 +911,70 @@ svn_fs_x__mergeinfo_count_get_func(void **out,
 
   return SVN_NO_ERROR;
 }
+
+/* Return the binary noderev with index IDX in the cache-serialized
+ * CONTAINER and set *IDS to the resolved ID parts array.
+ */
+static const binary_noderev_t *
+get_serialized_noderev(apr_array_header_t *ids,
+                       const svn_fs_x__noderevs_t *container,
+                       apr_uint32_t idx)
+{
+  apr_array_header_t noderevs;
+
+  /* Resolve only the container pointers we need */
+  resolve_apr_array_header(ids, container, &container->ids);
+  resolve_apr_array_header(&noderevs, container, &container->noderevs);
+
+  return &APR_ARRAY_IDX(&noderevs, idx, binary_noderev_t);
+}
+
+svn_error_t *
+svn_fs_x__history_ids_get_func(void **out,
+                               const void *data,
+                               apr_size_t data_len,
+                               void *baton,
+                               apr_pool_t *pool)
+{
+  svn_fs_x__id_t *history_ids = (svn_fs_x__id_t *)out;
+  apr_array_header_t ids;
+  const binary_noderev_t *binary_noderev
+    = get_serialized_noderev(&ids, data, *(apr_uint32_t *)baton);
+
+  SVN_ERR(get_id(&history_ids[0], &ids, binary_noderev->node_id));
+  SVN_ERR(get_id(&history_ids[1], &ids, binary_noderev->copy_id));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_x__predecessor_get_func(void **out,
+                               const void *data,
+                               apr_size_t data_len,
+                               void *baton,
+                               apr_pool_t *pool)
+{
+  svn_fs_x__predecessor_baton_t *b = baton;
+  const svn_fs_x__noderevs_t *container = data;
+  apr_array_header_t ids;
+  const binary_noderev_t *binary_noderev
+    = get_serialized_noderev(&ids, container, b->sub_item);
+
+  SVN_ERR(get_id(&b->predecessor_id, &ids, binary_noderev->predecessor_id));
+
+  if (binary_noderev->flags & NODEREV_HAS_CPATH)
+    {
+      const string_table_t *paths
+        = svn_temp_deserializer__ptr(container,
+                                     (const void *const *)&container->paths);
+      b->same_path = svn_fs_x__string_table_equals_func(
+                       paths, binary_noderev->created_path,
+                       b->path, b->path_len);
+    }
+  else
+    {
+      b->same_path = FALSE;
+    }
+
+  return SVN_NO_ERROR;
+}
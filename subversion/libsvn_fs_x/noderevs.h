@@ -139,4 +139,46 @@ svn_fs_x__mergeinfo_count_get_func(void **out,
                                    void *baton,
                                    apr_pool_t *pool);
 
+/* Implements svn_cache__partial_getter_func_t for the node_id and
+ * copy_id in the stored noderevs.  OUT must point to an array of two
+ * svn_fs_x__id_t, which will be set to the node_id and copy_id,
+ * respectively, of the noderev selected by the apr_uint32_t index passed
+ * in as *BATON.  This does not allocate any memory.
+ */
+svn_error_t *
+svn_fs_x__history_ids_get_func(void **out,
+                               const void *data,
+                               apr_size_t data_len,
+                               void *baton,
+                               apr_pool_t *pool);
+
+/* Baton type to be used with svn_fs_x__predecessor_get_func. */
+typedef struct svn_fs_x__predecessor_baton_t
+{
+  /* Index of the noderev within the container. */
+  apr_uint32_t sub_item;
+
+  /* The path to compare the noderev's created path with. */
+  const char *path;
+  apr_size_t path_len;
+
+  /* To be set by svn_fs_x__predecessor_get_func:
+     The predecessor ID and whether the created path equals PATH. */
+  svn_fs_x__id_t predecessor_id;
+  svn_boolean_t same_path;
+} svn_fs_x__predecessor_baton_t;
+
+/* Implements svn_cache__partial_getter_func_t for the predecessor_id and
+ * created_path in the stored noderevs.  For the noderev selected by the
+ * svn_fs_x__predecessor_baton_t passed in as *BATON, fill in the result
+ * members of that baton.  The created path is compared in place, i.e.
+ * this does not allocate any memory.  *OUT will not be modified.
+ */
+svn_error_t *
+svn_fs_x__predecessor_get_func(void **out,
+                               const void *data,
+                               apr_size_t data_len,
+                               void *baton,
+                               apr_pool_t *pool);
+
 #endif
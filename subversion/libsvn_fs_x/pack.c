@@ -90,6 +90,19 @@
  */
 #define DEFAULT_MAX_MEM (64 * 1024 * 1024)
 
+/* Maximum amount of item data that we read ahead from the temporary files
+ * before writing it to the pack file.  Within such a batch, items will be
+ * read in temp file order instead of their final pack file order.
+ */
+#define MAX_COPY_BATCH_SIZE (16 * 1024 * 1024)
+
+/* Maximum number and total size of fulltexts that we add to a reps
+ * container at once.  Within such a batch, the search for matches may
+ * run in parallel.
+ */
+#define MAX_REPS_BATCH 16
+#define MAX_BATCH_SIZE (4 * 1024 * 1024)
+
 /* Data structure describing a node change at PATH, REVISION.
  * We will sort these instances by PATH and NODE_ID such that we can combine
  * similar nodes in the same reps container and store containers in path
@@ -1207,6 +1220,34 @@ write_reps_container(pack_context_t *context,
   return SVN_NO_ERROR;
 }
 
+/* Add the fulltexts in BATCH to CONTAINER, which already contains
+ * FIRST_IDX reps, and clear BATCH as well as BATCH_POOL.  Use SCRATCH_POOL
+ * for temporary allocations.
+ */
+static svn_error_t *
+add_reps_batch(pack_context_t *context,
+               svn_fs_x__reps_builder_t *container,
+               apr_size_t first_idx,
+               apr_array_header_t *batch,
+               apr_pool_t *batch_pool,
+               apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = context->fs->fsap_data;
+  apr_size_t list_index;
+
+  if (batch->nelts == 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_x__reps_add_many(&list_index, container, batch,
+                                  ffd->pack_match_threads, scratch_pool));
+  SVN_ERR_ASSERT(list_index == first_idx);
+
+  apr_array_clear(batch);
+  svn_pool_clear(batch_pool);
+
+  return SVN_NO_ERROR;
+}
+
 /* Read the (property) representations identified by svn_fs_x__p2l_entry_t
  * elements in ENTRIES from TEMP_FILE, aggregate them and write them into
  * CONTEXT->PACK_FILE.  Use SCRATCH_POOL for temporary allocations.
@@ -1220,8 +1261,16 @@ write_reps_containers(pack_context_t *context,
 {
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
   apr_pool_t *container_pool = svn_pool_create(scratch_pool);
+  apr_pool_t *batch_pool = svn_pool_create(scratch_pool);
   int i;
 
+  /* Fulltexts read but not added to the container, yet, and their total
+   * size.  The batch size must not depend on the number of threads
+   * because it influences how the texts get matched. */
+  apr_array_header_t *batch
+    = apr_array_make(scratch_pool, MAX_REPS_BATCH, sizeof(svn_string_t *));
+  apr_size_t batch_size = 0;
+
   apr_ssize_t block_left = get_block_left(context);
 
   svn_fs_x__reps_builder_t *container
@@ -1239,12 +1288,15 @@ write_reps_containers(pack_context_t *context,
       svn_fs_x__representation_t representation = { 0 };
       svn_stringbuf_t *contents;
       svn_stream_t *stream;
-      apr_size_t list_index;
       svn_fs_x__p2l_entry_t *entry
         = APR_ARRAY_IDX(entries, i, svn_fs_x__p2l_entry_t *);
 
       if ((block_left < entry->size) && sub_items->nelts)
         {
+          SVN_ERR(add_reps_batch(context, container,
+                                 sub_items->nelts - batch->nelts,
+                                 batch, batch_pool, iterpool));
+          batch_size = 0;
           block_left = get_block_left(context)
                      - svn_fs_x__reps_estimate_size(container);
         }
@@ -1282,28 +1334,39 @@ write_reps_containers(pack_context_t *context,
       SVN_ERR(svn_fs_x__get_contents(&stream, context->fs, &representation,
                                      FALSE, iterpool));
       contents = svn_stringbuf_create_ensure(representation.expanded_size,
-                                             iterpool);
+                                             batch_pool);
       contents->len = representation.expanded_size;
 
       /* The representation is immutable.  Read it normally. */
       SVN_ERR(svn_stream_read_full(stream, contents->data, &contents->len));
       SVN_ERR(svn_stream_close(stream));
 
-      SVN_ERR(svn_fs_x__reps_add(&list_index, container,
-                                 svn_stringbuf__morph_into_string(contents)));
-      SVN_ERR_ASSERT(list_index == sub_items->nelts);
+      APR_ARRAY_PUSH(batch, svn_string_t *)
+        = svn_stringbuf__morph_into_string(contents);
+      batch_size += contents->len;
       block_left -= entry->size;
 
       APR_ARRAY_PUSH(sub_items, svn_fs_x__id_t) = entry->items[0];
 
+      if (batch->nelts == MAX_REPS_BATCH || batch_size >= MAX_BATCH_SIZE)
+        {
+          SVN_ERR(add_reps_batch(context, container,
+                                 sub_items->nelts - batch->nelts,
+                                 batch, batch_pool, iterpool));
+          batch_size = 0;
+        }
+
       svn_pool_clear(iterpool);
     }
 
+  SVN_ERR(add_reps_batch(context, container, sub_items->nelts - batch->nelts,
+                         batch, batch_pool, iterpool));
   if (sub_items->nelts)
     SVN_ERR(write_reps_container(context, container, sub_items,
                                  new_entries, iterpool));
 
   svn_pool_destroy(iterpool);
+  svn_pool_destroy(batch_pool);
   svn_pool_destroy(container_pool);
 
   return SVN_NO_ERROR;
@@ -1334,8 +1397,46 @@ should_flush_nodes_container(pack_context_t *context,
   return block_left < rep_sum + container_size;
 }
 
+/* Item to read in a batch of store_items().
+ */
+typedef struct read_order_t
+{
+  /* the item to read, ENTRY->OFFSET being its temp file location */
+  svn_fs_x__p2l_entry_t *entry;
+
+  /* where its data goes within the batch buffer */
+  apr_size_t buffer_offset;
+} read_order_t;
+
+/* Comparator for read_order_t, sorting by temp file offset.
+ */
+static int
+compare_read_order(const read_order_t *lhs,
+                   const read_order_t *rhs)
+{
+  return lhs->entry->offset < rhs->entry->offset
+       ? -1
+       : (lhs->entry->offset == rhs->entry->offset ? 0 : 1);
+}
+
+/* Return TRUE if ENTRY is to be copied by store_items().
+ */
+static svn_boolean_t
+is_item_to_store(svn_fs_x__p2l_entry_t *entry)
+{
+  return entry
+      && entry->type != SVN_FS_X__ITEM_TYPE_UNUSED
+      && entry->item_count != 0;
+}
+
 /* Read the contents of the first COUNT non-NULL, non-empty items in ITEMS
  * from TEMP_FILE and write them to CONTEXT->PACK_FILE.
+ *
+ * The items are usually scattered all over TEMP_FILE.  Therefore, collect
+ * them in batches of up to MAX_COPY_BATCH_SIZE bytes, read each batch in
+ * temp file order and write it sequentially.  Only items larger than a
+ * whole batch get streamed directly.
+ *
  * Use SCRATCH_POOL for temporary allocations.
  */
 static svn_error_t *
@@ -1345,35 +1446,105 @@ store_items(pack_context_t *context,
             int count,
             apr_pool_t *scratch_pool)
 {
-  int i;
+  int i, k;
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_array_header_t *batch
+    = apr_array_make(scratch_pool, 16, sizeof(read_order_t));
+  char *buffer = NULL;
+  apr_size_t buffer_size = 0;
 
-  /* copy all items in strict order */
-  for (i = 0; i < count; ++i)
+  for (i = 0; i < count; )
     {
-      svn_fs_x__p2l_entry_t *entry
-        = APR_ARRAY_IDX(items, i, svn_fs_x__p2l_entry_t *);
-      if (!entry
-          || entry->type == SVN_FS_X__ITEM_TYPE_UNUSED
-          || entry->item_count == 0)
-        continue;
+      int first = i;
+      apr_size_t batch_size = 0;
 
-      /* select the item in the source file and copy it into the target
-       * pack file */
-      SVN_ERR(svn_io_file_seek(temp_file, APR_SET, &entry->offset,
-                               iterpool));
-      SVN_ERR(copy_file_data(context, context->pack_file, temp_file,
-                             entry->size, iterpool));
+      svn_pool_clear(iterpool);
+      apr_array_clear(batch);
+
+      /* select the next items in their final order */
+      for (; i < count; ++i)
+        {
+          read_order_t read_order;
+          svn_fs_x__p2l_entry_t *entry
+            = APR_ARRAY_IDX(items, i, svn_fs_x__p2l_entry_t *);
+          if (!is_item_to_store(entry))
+            continue;
 
-      /* write index entry and update current position */
-      entry->offset = context->pack_offset;
-      context->pack_offset += entry->size;
+          if (   batch->nelts
+              && batch_size + entry->size > MAX_COPY_BATCH_SIZE)
+            break;
 
-      SVN_ERR(svn_fs_x__p2l_proto_index_add_entry
-                  (context->proto_p2l_index, entry, iterpool));
+          read_order.entry = entry;
+          read_order.buffer_offset = batch_size;
+          APR_ARRAY_PUSH(batch, read_order_t) = read_order;
+          batch_size += (apr_size_t)entry->size;
+        }
 
-      APR_ARRAY_PUSH(context->reps, svn_fs_x__p2l_entry_t *) = entry;
-      svn_pool_clear(iterpool);
+      if (batch->nelts == 0)
+        break;
+
+      if (batch_size > MAX_COPY_BATCH_SIZE)
+        {
+          /* a single large item - stream it */
+          svn_fs_x__p2l_entry_t *entry
+            = APR_ARRAY_IDX(batch, 0, read_order_t).entry;
+
+          SVN_ERR(svn_io_file_seek(temp_file, APR_SET, &entry->offset,
+                                   iterpool));
+          SVN_ERR(copy_file_data(context, context->pack_file, temp_file,
+                                 entry->size, iterpool));
+        }
+      else
+        {
+          if (batch_size > buffer_size)
+            {
+              buffer_size = MIN(MAX(batch_size, 2 * buffer_size),
+                                MAX_COPY_BATCH_SIZE);
+              buffer = apr_palloc(scratch_pool, buffer_size);
+            }
+
+          /* read the items in temp file order ... */
+          svn_sort__array(batch,
+                          (int (*)(const void *, const void *))
+                            compare_read_order);
+          for (k = 0; k < batch->nelts; ++k)
+            {
+              read_order_t *read_order = &APR_ARRAY_IDX(batch, k,
+                                                        read_order_t);
+              svn_fs_x__p2l_entry_t *entry = read_order->entry;
+
+              SVN_ERR(svn_io_file_seek(temp_file, APR_SET, &entry->offset,
+                                       iterpool));
+              SVN_ERR(svn_io_file_read_full2(temp_file,
+                                             buffer + read_order->buffer_offset,
+                                             (apr_size_t)entry->size,
+                                             NULL, NULL, iterpool));
+            }
+
+          /* ... and write them en bloc in pack file order */
+          SVN_ERR(svn_io_file_write_full(context->pack_file, buffer,
+                                         batch_size, NULL, iterpool));
+        }
+
+      /* write index entries and update current position */
+      for (k = first; k < i; ++k)
+        {
+          svn_fs_x__p2l_entry_t *entry
+            = APR_ARRAY_IDX(items, k, svn_fs_x__p2l_entry_t *);
+          if (!is_item_to_store(entry))
+            continue;
+
+          entry->offset = context->pack_offset;
+          context->pack_offset += entry->size;
+
+          SVN_ERR(svn_fs_x__p2l_proto_index_add_entry
+                      (context->proto_p2l_index, entry, iterpool));
+
+          APR_ARRAY_PUSH(context->reps, svn_fs_x__p2l_entry_t *) = entry;
+        }
+
+      if (context->cancel_func)
+        SVN_ERR(context->cancel_func(context->cancel_baton));
     }
 
   svn_pool_destroy(iterpool);
@@ -22,6 +22,9 @@
 
 #include "reps.h"
 
+#include <apr_thread_proc.h>
+
+#include "svn_pools.h"
 #include "svn_sorts.h"
 #include "private/svn_string_private.h"
 #include "private/svn_packed_data.h"
@@ -53,6 +56,15 @@
 /* value of unused hash buckets */
 #define NO_OFFSET ((apr_uint32_t)(-1))
 
+/* Number of bytes following a match within which we check whether the
+ * same match continues after a replaced section.  Must be a multiple of
+ * MATCH_BLOCKSIZE. */
+#define CONTINUATION_RANGE (4 * MATCH_BLOCKSIZE)
+
+/* Upper limit to the number of threads svn_fs_x__reps_add_many will use.
+ */
+#define MAX_MATCH_JOBS 64
+
 /* Byte strings are described by a series of copy instructions that each
  * do one of the following
  *
@@ -297,7 +309,7 @@ hash_key(const char *data)
 /* Map the ADLER32 key to a bucket index in HASH and return that index.
  */
 static apr_size_t
-hash_to_index(hash_t *hash, hash_key_t adler32)
+hash_to_index(const hash_t *hash, hash_key_t adler32)
 {
   return (adler32 * 0xd1f3da69) >> hash->shift;
 }
@@ -480,94 +492,399 @@ add_new_text(svn_fs_x__reps_builder_t *builder,
     }
 }
 
-svn_error_t *
-svn_fs_x__reps_add(apr_size_t *rep_idx,
-                   svn_fs_x__reps_builder_t *builder,
-                   const svn_string_t *contents)
+/* A section of the text being added to a builder that matches the text
+ * corpus.
+ */
+typedef struct match_t
 {
-  rep_t rep;
-  const char *current = contents->data;
-  const char *processed = current;
-  const char *end = current + contents->len;
-  const char *last_to_test = end - MATCH_BLOCKSIZE - 1;
+  /* first matching byte in the text being added */
+  const char *start;
 
-  if (builder->text->len + contents->len > MAX_TEXT_BODY)
-    return svn_error_create(SVN_ERR_FS_CONTAINER_SIZE, NULL,
-                      _("Text body exceeds star delta container capacity"));
+  /* number of matching bytes */
+  apr_size_t len;
 
-  if (  builder->instructions->nelts + 2 * contents->len / MATCH_BLOCKSIZE
-      > MAX_INSTRUCTIONS)
-    return svn_error_create(SVN_ERR_FS_CONTAINER_SIZE, NULL,
-              _("Instruction count exceeds star delta container capacity"));
+  /* offset of the matching section within the text corpus */
+  apr_size_t offset;
+} match_t;
 
-  rep.first_instruction = (apr_uint32_t)builder->instructions->nelts;
-  while (current < last_to_test)
+/* Search the text from PROCESSED to END for the next section of at least
+ * MATCH_BLOCKSIZE bytes that can also be found within the first CORPUS_LEN
+ * bytes of CORPUS.  HASH indexes the blocks of that corpus.  CONTINUATION
+ * is the corpus offset right behind the previous match or NO_OFFSET.
+ *
+ * If a match has been found, extend it in both directions, describe it in
+ * *MATCH and return TRUE.  Return FALSE otherwise.
+ */
+static svn_boolean_t
+find_match(match_t *match,
+           const char *processed,
+           const char *end,
+           apr_size_t continuation,
+           const char *corpus,
+           apr_size_t corpus_len,
+           const hash_t *hash)
+{
+  const char *current = processed;
+  const char *last_to_test;
+  hash_key_t key;
+  size_t offset = NO_OFFSET;
+
+  if (end - processed <= MATCH_BLOCKSIZE + 1)
+    return FALSE;
+
+  last_to_test = end - MATCH_BLOCKSIZE - 1;
+  key = hash_key(current);
+
+  /* search for the next matching sequence */
+
+  for (; current < last_to_test; ++current)
     {
-      hash_key_t key = hash_key(current);
-      size_t offset;
       size_t idx;
 
-      /* search for the next matching sequence */
-
-      for (; current < last_to_test; ++current)
+      /* Similar texts tend to differ in short sections that have been
+       * replaced by the same number of bytes.  Rather than waiting
+       * for the next hashed block, try to continue the last match
+       * directly.  The hash only covers every MATCH_BLOCKSIZE'th
+       * position in the corpus and may have lost entries to
+       * collisions. */
+      if (continuation != NO_OFFSET)
         {
-          idx = hash_to_index(&builder->hash, key);
-          if (builder->hash.prefixes[idx] == current[0])
+          apr_size_t distance = current - processed;
+          offset = continuation + distance;
+
+          if (   distance >= CONTINUATION_RANGE
+              || offset + MATCH_BLOCKSIZE > corpus_len)
             {
-              offset = builder->hash.offsets[idx];
-              if (   (offset != NO_OFFSET)
-                  && (memcmp(&builder->text->data[offset], current,
-                             MATCH_BLOCKSIZE) == 0))
-                break;
+              continuation = NO_OFFSET;
+            }
+          else if (   corpus[offset] == current[0]
+                   && memcmp(&corpus[offset], current, MATCH_BLOCKSIZE) == 0)
+            {
+              break;
             }
-          key = hash_key_replace(key, current[0], current[MATCH_BLOCKSIZE]);
         }
 
-      /* found it? */
-
-      if (current < last_to_test)
+      idx = hash_to_index(hash, key);
+      if (hash->prefixes[idx] == current[0])
         {
-          instruction_t instruction;
+          offset = hash->offsets[idx];
+          if (   (offset != NO_OFFSET)
+              && (memcmp(&corpus[offset], current, MATCH_BLOCKSIZE) == 0))
+            break;
+        }
+      key = hash_key_replace(key, current[0], current[MATCH_BLOCKSIZE]);
+    }
 
-          /* extend the match */
+  /* found it? */
 
-          size_t prefix_match
-            = svn_cstring__reverse_match_length(current,
-                                                builder->text->data + offset,
-                                                MIN(offset, current - processed));
-          size_t postfix_match
-            = svn_cstring__match_length(current + MATCH_BLOCKSIZE,
-                           builder->text->data + offset + MATCH_BLOCKSIZE,
-                           MIN(builder->text->len - offset - MATCH_BLOCKSIZE,
-                               end - current - MATCH_BLOCKSIZE));
+  if (current < last_to_test)
+    {
+      /* extend the match */
+
+      size_t prefix_match
+        = svn_cstring__reverse_match_length(current,
+                                            corpus + offset,
+                                            MIN(offset, current - processed));
+      size_t postfix_match
+        = svn_cstring__match_length(current + MATCH_BLOCKSIZE,
+                                    corpus + offset + MATCH_BLOCKSIZE,
+                                    MIN(corpus_len - offset - MATCH_BLOCKSIZE,
+                                        end - current - MATCH_BLOCKSIZE));
+
+      match->start = current - prefix_match;
+      match->len = prefix_match + MATCH_BLOCKSIZE + postfix_match;
+      match->offset = offset - prefix_match;
+
+      return TRUE;
+    }
 
-          /* non-matched section */
+  return FALSE;
+}
 
-          size_t new_copy = (current - processed) - prefix_match;
-          if (new_copy)
-            add_new_text(builder, processed, new_copy);
+/* Add a copy instruction for MATCH to BUILDER.
+ */
+static void
+add_match(svn_fs_x__reps_builder_t *builder,
+          const match_t *match)
+{
+  instruction_t instruction;
+  instruction.offset = (apr_int32_t)match->offset;
+  instruction.count = (apr_uint32_t)match->len;
+  APR_ARRAY_PUSH(builder->instructions, instruction_t) = instruction;
+}
 
-          /* add instruction for matching section */
+/* Add the text from START to END to BUILDER as part of the current rep.
+ * Copy matching sections from the text corpus and add everything else as
+ * new text.  *CONTINUATION is the corpus offset right behind the last
+ * match or NO_OFFSET and will be updated with every match found.
+ */
+static void
+add_text(svn_fs_x__reps_builder_t *builder,
+         const char *start,
+         const char *end,
+         apr_size_t *continuation)
+{
+  const char *processed = start;
+  match_t match;
 
-          instruction.offset = (apr_int32_t)(offset - prefix_match);
-          instruction.count = (apr_uint32_t)(prefix_match + postfix_match +
-                                             MATCH_BLOCKSIZE);
-          APR_ARRAY_PUSH(builder->instructions, instruction_t) = instruction;
+  while (find_match(&match, processed, end, *continuation,
+                    builder->text->data, builder->text->len,
+                    &builder->hash))
+    {
+      add_new_text(builder, processed, match.start - processed);
+      add_match(builder, &match);
 
-          processed = current + MATCH_BLOCKSIZE + postfix_match;
-          current = processed;
-        }
+      processed = match.start + match.len;
+      *continuation = match.offset + match.len;
     }
 
   add_new_text(builder, processed, end - processed);
+}
+
+/* Return an error if adding CONTENTS to BUILDER might exceed the container
+ * capacity.
+ */
+static svn_error_t *
+check_capacity(svn_fs_x__reps_builder_t *builder,
+               const svn_string_t *contents)
+{
+  if (builder->text->len + contents->len > MAX_TEXT_BODY)
+    return svn_error_create(SVN_ERR_FS_CONTAINER_SIZE, NULL,
+                      _("Text body exceeds star delta container capacity"));
+
+  if (  builder->instructions->nelts + 2 * contents->len / MATCH_BLOCKSIZE
+      > MAX_INSTRUCTIONS)
+    return svn_error_create(SVN_ERR_FS_CONTAINER_SIZE, NULL,
+              _("Instruction count exceeds star delta container capacity"));
+
+  return SVN_NO_ERROR;
+}
+
+/* Finish the rep in BUILDER whose instructions start at FIRST_INSTRUCTION
+ * and return its index in *REP_IDX.
+ */
+static void
+add_rep(apr_size_t *rep_idx,
+        svn_fs_x__reps_builder_t *builder,
+        apr_uint32_t first_instruction)
+{
+  rep_t rep;
+  rep.first_instruction = first_instruction;
   rep.instruction_count = (apr_uint32_t)builder->instructions->nelts
-                        - rep.first_instruction;
+                        - first_instruction;
   APR_ARRAY_PUSH(builder->reps, rep_t) = rep;
 
   *rep_idx = (apr_size_t)(builder->reps->nelts - 1);
+}
+
+svn_error_t *
+svn_fs_x__reps_add(apr_size_t *rep_idx,
+                   svn_fs_x__reps_builder_t *builder,
+                   const svn_string_t *contents)
+{
+  apr_uint32_t first_instruction;
+  apr_size_t continuation = NO_OFFSET;
+
+  SVN_ERR(check_capacity(builder, contents));
+
+  first_instruction = (apr_uint32_t)builder->instructions->nelts;
+  add_text(builder, contents->data, contents->data + contents->len,
+           &continuation);
+  add_rep(rep_idx, builder, first_instruction);
+
   return SVN_NO_ERROR;
 }
 
+/* Matches found by a single match_job_t for some text.
+ */
+typedef struct match_list_t
+{
+  /* match_t elements in text order */
+  apr_array_header_t *matches;
+} match_list_t;
+
+/* Search a subset of the texts to add for matches with the text corpus.
+ */
+typedef struct match_job_t
+{
+  /* Process every STEP'th element in TEXTS, starting at the FIRST one. */
+  int first;
+  int step;
+
+  /* svn_string_t * texts to add */
+  const apr_array_header_t *texts;
+
+  /* Results.  LISTS[i] belongs to element i of TEXTS. */
+  match_list_t *lists;
+
+  /* Text corpus and its hash as they were before adding any of TEXTS.
+   * Read-only during the search. */
+  const char *corpus;
+  apr_size_t corpus_len;
+  const hash_t *hash;
+
+  /* Thread-safe pool that the match lists get allocated in. */
+  apr_pool_t *pool;
+
+#if APR_HAS_THREADS
+  /* Thread executing this job or NULL. */
+  apr_thread_t *thread;
+#endif
+} match_job_t;
+
+/* Execute JOB.
+ */
+static void
+run_match_job(match_job_t *job)
+{
+  int i;
+  for (i = job->first; i < job->texts->nelts; i += job->step)
+    {
+      const svn_string_t *text = APR_ARRAY_IDX(job->texts, i,
+                                               const svn_string_t *);
+      const char *processed = text->data;
+      const char *end = text->data + text->len;
+      apr_size_t continuation = NO_OFFSET;
+      apr_array_header_t *matches = apr_array_make(job->pool, 16,
+                                                   sizeof(match_t));
+      match_t match;
+
+      while (find_match(&match, processed, end, continuation,
+                        job->corpus, job->corpus_len, job->hash))
+        {
+          APR_ARRAY_PUSH(matches, match_t) = match;
+          processed = match.start + match.len;
+          continuation = match.offset + match.len;
+        }
+
+      job->lists[i].matches = matches;
+    }
+}
+
+#if APR_HAS_THREADS
+/* Thread function executing a match_job_t in DATA.
+ */
+static void * APR_THREAD_FUNC
+match_job_thread(apr_thread_t *thread, void *data)
+{
+  run_match_job(data);
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+#endif
+
+svn_error_t *
+svn_fs_x__reps_add_many(apr_size_t *first_rep_idx,
+                        svn_fs_x__reps_builder_t *builder,
+                        const apr_array_header_t *texts,
+                        int jobs,
+                        apr_pool_t *scratch_pool)
+{
+  match_list_t *lists = apr_pcalloc(scratch_pool,
+                                    texts->nelts * sizeof(*lists));
+  match_job_t *job_list;
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  *first_rep_idx = (apr_size_t)builder->reps->nelts;
+  if (texts->nelts == 0)
+    return SVN_NO_ERROR;
+
+  jobs = MAX(1, MIN(MIN(jobs, texts->nelts), MAX_MATCH_JOBS));
+  job_list = apr_pcalloc(scratch_pool, jobs * sizeof(*job_list));
+
+  /* Search all texts for matches with the current corpus.  None of this
+   * modifies BUILDER, so the texts are independent of each other and the
+   * results do not depend on how the texts got distributed over the
+   * jobs.  Each job needs its own thread-safe pool. */
+  for (i = 0; i < jobs; ++i)
+    {
+      match_job_t *job = &job_list[i];
+      job->first = i;
+      job->step = jobs;
+      job->texts = texts;
+      job->lists = lists;
+      job->corpus = builder->text->data;
+      job->corpus_len = builder->text->len;
+      job->hash = &builder->hash;
+      job->pool = svn_pool_create(NULL);
+    }
+
+#if APR_HAS_THREADS
+  /* Let the main thread process the first job. */
+  for (i = 1; i < jobs; ++i)
+    {
+      match_job_t *job = &job_list[i];
+      apr_status_t status = apr_thread_create(&job->thread, NULL,
+                                              match_job_thread, job,
+                                              job->pool);
+
+      /* Can't have more threads?  Then, run the job ourselves. */
+      if (status)
+        job->thread = NULL;
+    }
+#endif
+
+  for (i = 0; i < jobs; ++i)
+    {
+      match_job_t *job = &job_list[i];
+
+#if APR_HAS_THREADS
+      if (job->thread)
+        {
+          apr_status_t retval;
+          apr_status_t status = apr_thread_join(&retval, job->thread);
+          if (status && !err)
+            err = svn_error_wrap_apr(status, _("Can't join match thread"));
+
+          continue;
+        }
+#endif
+
+      run_match_job(job);
+    }
+
+  /* Now, add the texts in order.  Copy the matches found above and search
+   * the sections in between against the whole corpus - which by now may
+   * include earlier TEXTS as well. */
+  for (i = 0; i < texts->nelts && !err; ++i)
+    {
+      const svn_string_t *text = APR_ARRAY_IDX(texts, i,
+                                               const svn_string_t *);
+      const apr_array_header_t *matches = lists[i].matches;
+      const char *processed = text->data;
+      apr_uint32_t first_instruction;
+      apr_size_t continuation = NO_OFFSET;
+      apr_size_t rep_idx;
+      int k;
+
+      err = check_capacity(builder, text);
+      if (err)
+        break;
+
+      first_instruction = (apr_uint32_t)builder->instructions->nelts;
+      for (k = 0; k < matches->nelts; ++k)
+        {
+          const match_t *match = &APR_ARRAY_IDX(matches, k, match_t);
+
+          add_text(builder, processed, match->start, &continuation);
+          add_match(builder, match);
+
+          processed = match->start + match->len;
+          continuation = match->offset + match->len;
+        }
+
+      add_text(builder, processed, text->data + text->len, &continuation);
+      add_rep(&rep_idx, builder, first_instruction);
+    }
+
+  for (i = 0; i < jobs; ++i)
+    svn_pool_destroy(job_list[i].pool);
+
+  return svn_error_trace(err);
+}
+
 apr_size_t
 svn_fs_x__reps_estimate_size(const svn_fs_x__reps_builder_t *builder)
 {
@@ -103,6 +103,21 @@ svn_fs_x__reps_add(apr_size_t *rep_idx,
                    svn_fs_x__reps_builder_t *builder,
                    const svn_string_t *contents);
 
+/* Add the byte strings (svn_string_t *) in TEXTS to BUILDER, in that order.
+ * Return the item index of the first one in *FIRST_REP_IDX; the others
+ * follow consecutively.
+ *
+ * Use up to JOBS threads to search the texts for matches against the text
+ * corpus as it was before this call.  The result does not depend on JOBS.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svn_fs_x__reps_add_many(apr_size_t *first_rep_idx,
+                        svn_fs_x__reps_builder_t *builder,
+                        const apr_array_header_t *texts,
+                        int jobs,
+                        apr_pool_t *scratch_pool);
+
 /* Return a rough estimate in bytes for the serialized representation
  * of BUILDER.
  */
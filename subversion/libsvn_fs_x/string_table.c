@@ -269,6 +269,36 @@ insert_string(builder_table_t *table,
   return result;
 }
 
+/* Return the short string entry in TABLE that equals the LEN bytes at
+ * STRING or NULL, if there is none.  This allows us to detect duplicates
+ * without copying them into the builder's pool first.  STRING does not
+ * need to be NUL-terminated.
+ */
+static const builder_string_t *
+find_string(const builder_table_t *table,
+            const char *string,
+            apr_size_t len)
+{
+  const builder_string_t *current = table->top;
+  while (current)
+    {
+      /* Same order as strcmp() in insert_string. */
+      int diff = memcmp(current->string.data, string,
+                        MIN(current->string.len, len));
+      if (diff == 0)
+        {
+          if (current->string.len == len)
+            return current;
+
+          diff = current->string.len < len ? -1 : 1;
+        }
+
+      current = diff < 0 ? current->left : current->right;
+    }
+
+  return NULL;
+}
+
 apr_size_t
 svn_fs_x__string_table_builder_add(string_table_builder_t *builder,
                                    const char *string,
@@ -281,13 +311,10 @@ svn_fs_x__string_table_builder_add(string_table_builder_t *builder,
   if (len == 0)
     len = strlen(string);
 
-  string = apr_pstrmemdup(builder->pool, string, len);
   if (len > MAX_SHORT_STRING_LEN)
     {
       void *idx_void;
       svn_string_t item;
-      item.data = string;
-      item.len = len;
 
       idx_void = apr_hash_get(table->long_string_dict, string, len);
       result = (apr_uintptr_t)idx_void;
@@ -296,6 +323,10 @@ svn_fs_x__string_table_builder_add(string_table_builder_t *builder,
              + LONG_STRING_MASK
              + (((apr_size_t)builder->tables->nelts - 1) << TABLE_SHIFT);
 
+      string = apr_pstrmemdup(builder->pool, string, len);
+      item.data = string;
+      item.len = len;
+
       if (table->long_strings->nelts == MAX_STRINGS_PER_TABLE)
         table = add_table(builder);
 
@@ -310,7 +341,17 @@ svn_fs_x__string_table_builder_add(string_table_builder_t *builder,
     }
   else
     {
-      builder_string_t *item = apr_pcalloc(builder->pool, sizeof(*item));
+      builder_string_t *item;
+
+      /* Paths tend to get added many times.  Duplicates of the strings
+         in the current sub-table are cheap to find. */
+      const builder_string_t *existing = find_string(table, string, len);
+      if (existing)
+        return existing->position
+             + (((apr_size_t)builder->tables->nelts - 1) << TABLE_SHIFT);
+
+      string = apr_pstrmemdup(builder->pool, string, len);
+      item = apr_pcalloc(builder->pool, sizeof(*item));
       item->string.data = string;
       item->string.len = len;
       item->previous_match_len = 0;
@@ -584,6 +625,68 @@ svn_fs_x__string_table_get(const string_table_t *table,
   return apr_pstrmemdup(result_pool, "", 0);
 }
 
+/* Return TRUE, if the short string described by HEADER in TABLE equals
+ * the first LEN chars of STRING.  The caller must make sure that LEN is
+ * the actual length of the string in TABLE.  This mirrors the logic of
+ * table_copy_string but compares the string segments in place, starting
+ * with the tail.  Paths tend to share prefixes, so we detect differences
+ * early and don't need to visit all the head strings in that case.
+ */
+static svn_boolean_t
+table_equals_string(const string_sub_table_t *table,
+                    const string_header_t *header,
+                    const char *string,
+                    apr_size_t len)
+{
+  while (len)
+    {
+      assert(header->head_length <= len);
+      if (memcmp(string + header->head_length,
+                 table->data + header->tail_start,
+                 len - header->head_length))
+        return FALSE;
+
+      len = header->head_length;
+      header = &table->short_strings[header->head_string];
+    }
+
+  return TRUE;
+}
+
+svn_boolean_t
+svn_fs_x__string_table_equals(const string_table_t *table,
+                              apr_size_t idx,
+                              const char *string,
+                              apr_size_t len)
+{
+  apr_size_t table_number = idx >> TABLE_SHIFT;
+  apr_size_t sub_index = idx & STRING_INDEX_MASK;
+
+  if (table_number < table->size)
+    {
+      string_sub_table_t *sub_table = &table->sub_tables[table_number];
+      if (idx & LONG_STRING_MASK)
+        {
+          if (sub_index < sub_table->long_string_count)
+            return sub_table->long_strings[sub_index].len == len
+                && memcmp(sub_table->long_strings[sub_index].data, string,
+                          len) == 0;
+        }
+      else
+        {
+          if (sub_index < sub_table->short_string_count)
+            {
+              string_header_t *header = sub_table->short_strings + sub_index;
+              return header->head_length + header->tail_length == len
+                  && table_equals_string(sub_table, header, string, len);
+            }
+        }
+    }
+
+  /* Invalid indexes refer to the empty string. */
+  return len == 0;
+}
+
 svn_error_t *
 svn_fs_x__write_string_table(svn_stream_t *stream,
                              const string_table_t *table,
@@ -904,3 +1007,62 @@ svn_fs_x__string_table_get_func(const string_table_t *table,
 
   return "";
 }
+
+svn_boolean_t
+svn_fs_x__string_table_equals_func(const string_table_t *table,
+                                   apr_size_t idx,
+                                   const char *string,
+                                   apr_size_t len)
+{
+  apr_size_t table_number = idx >> TABLE_SHIFT;
+  apr_size_t sub_index = idx & STRING_INDEX_MASK;
+
+  if (table_number < table->size)
+    {
+      /* resolve TABLE->SUB_TABLES pointer and select sub-table */
+      string_sub_table_t *sub_tables
+        = (string_sub_table_t *)svn_temp_deserializer__ptr(table,
+                                   (const void *const *)&table->sub_tables);
+      string_sub_table_t *sub_table = sub_tables + table_number;
+
+      /* pick the right kind of string */
+      if (idx & LONG_STRING_MASK)
+        {
+          if (sub_index < sub_table->long_string_count)
+            {
+              svn_string_t *long_strings
+                = (svn_string_t *)svn_temp_deserializer__ptr(sub_table,
+                             (const void *const *)&sub_table->long_strings);
+              const char *str_data
+                = (const char*)svn_temp_deserializer__ptr(long_strings,
+                        (const void *const *)&long_strings[sub_index].data);
+
+              return long_strings[sub_index].len == len
+                  && memcmp(str_data, string, len) == 0;
+            }
+        }
+      else
+        {
+          if (sub_index < sub_table->short_string_count)
+            {
+              /* Same as in svn_fs_x__string_table_get_func: resolve the
+                 pointers that we need in a copy of the sub-table struct. */
+              string_header_t *header;
+              string_sub_table_t table_copy = *sub_table;
+              table_copy.data
+                = (const char *)svn_temp_deserializer__ptr(sub_tables,
+                                     (const void *const *)&sub_table->data);
+              table_copy.short_strings
+                = (string_header_t *)svn_temp_deserializer__ptr(sub_tables,
+                            (const void *const *)&sub_table->short_strings);
+
+              header = table_copy.short_strings + sub_index;
+              return header->head_length + header->tail_length == len
+                  && table_equals_string(&table_copy, header, string, len);
+            }
+        }
+    }
+
+  /* Invalid indexes refer to the empty string. */
+  return len == 0;
+}
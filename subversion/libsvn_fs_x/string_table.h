@@ -75,16 +75,27 @@ string_table_t *
 svn_fs_x__string_table_create(const string_table_builder_t *builder,
                               apr_pool_t *result_pool);
 
-/* Extract string number INDEX from TABLE and return a copy of it allocated
+/* Extract string number IDX from TABLE and return a copy of it allocated
  * in RESULT_POOL.  If LENGTH is not NULL, set *LENGTH to strlen() of the
  * result string.  Returns an empty string for invalid indexes.
  */
 const char*
 svn_fs_x__string_table_get(const string_table_t *table,
-                           apr_size_t index,
+                           apr_size_t idx,
                            apr_size_t *length,
                            apr_pool_t *result_pool);
 
+/* Return TRUE, if string number IDX in TABLE equals the LEN bytes at
+ * STRING.  Unlike svn_fs_x__string_table_get, this compares the string
+ * in place and does not allocate memory.  Invalid indexes refer to the
+ * empty string.
+ */
+svn_boolean_t
+svn_fs_x__string_table_equals(const string_table_t *table,
+                              apr_size_t idx,
+                              const char *string,
+                              apr_size_t len);
+
 /* Write a serialized representation of the string table TABLE to STREAM.
  * Use SCRATCH_POOL for temporary allocations.
  */
@@ -126,6 +137,15 @@ svn_fs_x__string_table_get_func(const string_table_t *table,
                                 apr_size_t *length,
                                 apr_pool_t *result_pool);
 
+/* Like svn_fs_x__string_table_equals but operates on the cache serialized
+ * representation at TABLE.
+ */
+svn_boolean_t
+svn_fs_x__string_table_equals_func(const string_table_t *table,
+                                   apr_size_t idx,
+                                   const char *string,
+                                   apr_size_t len);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -1081,6 +1081,29 @@ svn_fs_x__deserialize_rep_header(void **out,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_x__serialize_id(void **data,
+                       apr_size_t *data_len,
+                       void *in,
+                       apr_pool_t *pool)
+{
+  *data_len = sizeof(svn_fs_x__id_t);
+  *data = in;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_x__deserialize_id(void **out,
+                         void *data,
+                         apr_size_t data_len,
+                         apr_pool_t *result_pool)
+{
+  *out = data;
+
+  return SVN_NO_ERROR;
+}
+
 /* Utility function to serialize change CHANGE_P in the given serialization
  * CONTEXT.
  */
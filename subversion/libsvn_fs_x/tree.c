@@ -679,7 +679,7 @@ compare_dir_structure(svn_boolean_t *changed,
 
       if (strcmp(lhs_entry->name, rhs_entry->name) == 0)
         {
-          dag_node_t *lhs_node, *rhs_node;
+          svn_boolean_t same;
 
           /* Unchanged entry? */
           if (!svn_fs_x__id_eq(&lhs_entry->id, &rhs_entry->id))
@@ -689,11 +689,11 @@ compare_dir_structure(svn_boolean_t *changed,
           svn_pool_clear(iterpool);
 
           /* Modified but not copied / replaced or anything? */
-          SVN_ERR(svn_fs_x__dag_get_node(&lhs_node, fs, &lhs_entry->id,
-                                         iterpool, iterpool));
-          SVN_ERR(svn_fs_x__dag_get_node(&rhs_node, fs, &rhs_entry->id,
-                                         iterpool, iterpool));
-          if (svn_fs_x__dag_same_line_of_history(lhs_node, rhs_node))
+          SVN_ERR(svn_fs_x__dag_same_line_of_history_by_id(&same, fs,
+                                                           &lhs_entry->id,
+                                                           &rhs_entry->id,
+                                                           iterpool));
+          if (same)
             continue;
         }
 
@@ -2613,28 +2613,31 @@ history_prev(svn_fs_history_t **prev_history,
     {
       /* We know the last reported node (CURRENT_ID) and the NEXT_COPY
          revision is somewhat further in the past. */
-      svn_fs_x__noderev_t *noderev;
+      const char *created_path;
       assert(reported);
 
       /* Get the previous node change.  If there is none, then we already
-         reported the initial addition and this history traversal is done. */
-      SVN_ERR(svn_fs_x__get_node_revision(&noderev, fs, &fhd->current_id,
-                                          scratch_pool, scratch_pool));
-      if (! svn_fs_x__id_used(&noderev->predecessor_id))
+         reported the initial addition and this history traversal is done.
+         Without copies, the path does not change, so we usually don't
+         need to construct the whole noderev for this. */
+      SVN_ERR(svn_fs_x__get_predecessor(&pred_id, &created_path, fs,
+                                        &fhd->current_id, fhd->path,
+                                        scratch_pool, scratch_pool));
+      if (! svn_fs_x__id_used(&pred_id))
         return SVN_NO_ERROR;
 
       /* If the previous node change is younger than the next copy, it is
          part of the linear history section. */
-      commit_rev = svn_fs_x__get_revnum(noderev->predecessor_id.change_set);
+      commit_rev = svn_fs_x__get_revnum(pred_id.change_set);
       if (commit_rev > fhd->next_copy)
         {
           /* Within the linear history, simply report all node changes and
              continue with the respective predecessor. */
-          *prev_history = assemble_history(fs, noderev->created_path,
+          *prev_history = assemble_history(fs, created_path,
                                            commit_rev, TRUE, NULL,
                                            SVN_INVALID_REVNUM,
                                            fhd->next_copy,
-                                           &noderev->predecessor_id,
+                                           &pred_id,
                                            result_pool);
 
           return SVN_NO_ERROR;
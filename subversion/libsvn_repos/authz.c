@@ -33,6 +33,7 @@
 #include "svn_dirent_uri.h"
 #include "svn_path.h"
 #include "svn_repos.h"
+#include "svn_checksum.h"
 #include "svn_config.h"
 #include "svn_ctype.h"
 #include "private/svn_atomic.h"
@@ -124,10 +125,12 @@ combine_right_limits(limited_rights_t *target,
 /*** Authz cache access. ***/
 
 /* All authz instances currently in use as well as all filtered authz
- * instances in use will be cached here.
- * Both caches will be instantiated at most once. */
+ * instances in use will be cached here.  The digests of the rules that
+ * apply to a given user in a given authz model are cached as well.
+ * All caches will be instantiated at most once. */
 static svn_object_pool__t *authz_pool = NULL;
 static svn_object_pool__t *filtered_pool = NULL;
+static svn_object_pool__t *digest_pool = NULL;
 static svn_atomic_t authz_pool_initialized = FALSE;
 
 /* Implements svn_atomic__err_init_func_t. */
@@ -142,6 +145,7 @@ synchronized_authz_initialize(void *baton, apr_pool_t *pool)
 
   SVN_ERR(svn_object_pool__create(&authz_pool, multi_threaded, pool));
   SVN_ERR(svn_object_pool__create(&filtered_pool, multi_threaded, pool));
+  SVN_ERR(svn_object_pool__create(&digest_pool, multi_threaded, pool));
 
   return SVN_NO_ERROR;
 }
@@ -187,20 +191,26 @@ construct_authz_key(const svn_checksum_t *authz_key,
   return result;
 }
 
-/* Return a combination of REPOS_NAME, USER and AUTHZ_ID, allocated in
- * RESULT_POOL.  USER may be NULL.  This is the key for the FILTERED_POOL.
+/* Return a combination of REPOS_NAME, USER and the DIGEST_SIZE bytes at
+ * DIGEST, allocated in RESULT_POOL.  USER may be NULL.
+ *
+ * With the digest of the rules relevant to USER and REPOS_NAME, this is
+ * the key for the FILTERED_POOL.  Hence, filtered trees survive
+ * modifications of the authz file that don't affect them.  With the
+ * authz id, this is the key for the DIGEST_POOL.
  */
 static svn_membuf_t *
 construct_filtered_key(const char *repos_name,
                        const char *user,
-                       const svn_membuf_t *authz_id,
+                       const void *digest,
+                       apr_size_t digest_size,
                        apr_pool_t *result_pool)
 {
   svn_membuf_t *result = apr_pcalloc(result_pool, sizeof(*result));
   size_t repos_len = strlen(repos_name);
   size_t user_len = user ? strlen(user) : 1;
   const char *nullable_user = user ? user : "\0";
-  size_t size = authz_id->size + repos_len + 1 + user_len + 1;
+  size_t size = digest_size + repos_len + 1 + user_len + 1;
 
   svn_membuf__create(result, size, result_pool);
   result->size = size;
@@ -209,7 +219,7 @@ construct_filtered_key(const char *repos_name,
   size = repos_len + 1;
   memcpy((char *)result->data + size, nullable_user, user_len + 1);
   size += user_len + 1;
-  memcpy((char *)result->data + size, authz_id->data, authz_id->size);
+  memcpy((char *)result->data + size, digest, digest_size);
 
   return result;
 }
@@ -872,27 +882,17 @@ finalize_tree(node_t *node,
   combine_right_limits(sum, local_sum);
 }
 
-/* From the authz CONFIG, extract the parts relevant to USER and REPOSITORY.
- * Return the filtered rule tree.
+/* Return all ACLs (const authz_acl_t *) in AUTHZ for REPOSITORY, allocated
+ * in RESULT_POOL.  Note that repo-specific rules replace global rules,
+ * even if they don't apply to the current user.
  */
-static node_t *
-create_user_authz(authz_full_t *authz,
-                  const char *repository,
-                  const char *user,
-                  apr_pool_t *result_pool,
-                  apr_pool_t *scratch_pool)
+static apr_array_header_t *
+get_repos_acls(const authz_full_t *authz,
+               const char *repository,
+               apr_pool_t *result_pool)
 {
   int i;
-  node_t *root = create_node(NULL, result_pool);
-  construction_context_t *ctx = create_construction_context(scratch_pool);
-
-  /* Use a separate sub-pool to keep memory usage tight. */
-  apr_pool_t *subpool = svn_pool_create(scratch_pool);
-
-  /* Find all ACLs for REPOSITORY.
-   * Note that repo-specific rules replace global rules,
-   * even if they don't apply to the current user. */
-  apr_array_header_t *acls = apr_array_make(subpool, authz->acls->nelts,
+  apr_array_header_t *acls = apr_array_make(result_pool, authz->acls->nelts,
                                             sizeof(authz_acl_t *));
   for (i = 0; i < authz->acls->nelts; ++i)
     {
@@ -920,6 +920,106 @@ create_user_authz(authz_full_t *authz,
         }
     }
 
+  return acls;
+}
+
+/* Compare two ACLs (const authz_acl_t **) by their sequence numbers.
+ * Implements the comparison function for svn_sort__array(). */
+static int
+compare_acl_sequence_numbers(const void *lhs,
+                             const void *rhs)
+{
+  const authz_acl_t *lhs_acl = *(const authz_acl_t * const *)lhs;
+  const authz_acl_t *rhs_acl = *(const authz_acl_t * const *)rhs;
+
+  return lhs_acl->sequence_number - rhs_acl->sequence_number;
+}
+
+/* Set *DIGEST to a checksum over all ACLs in AUTHZ that contribute to
+ * the filtered rule tree for USER and REPOSITORY, allocated in
+ * RESULT_POOL.  Equal digests imply equal filtered trees.  Use
+ * SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+get_rules_digest(svn_checksum_t **digest,
+                 const authz_full_t *authz,
+                 const char *repository,
+                 const char *user,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *acls = get_repos_acls(authz, repository,
+                                            scratch_pool);
+  apr_array_header_t *user_acls = apr_array_make(scratch_pool, acls->nelts,
+                                                 sizeof(authz_acl_t *));
+  svn_checksum_ctx_t *ctx = svn_checksum_ctx_create(svn_checksum_sha1,
+                                                    scratch_pool);
+  int i, k;
+
+  /* Rules that don't apply to USER, e.g. due to group membership, are
+   * skipped such that changing them won't affect the digest. */
+  for (i = 0; i < acls->nelts; ++i)
+    {
+      const authz_acl_t *acl = APR_ARRAY_IDX(acls, i, const authz_acl_t *);
+      authz_access_t access;
+
+      if (svn_authz__get_acl_access(&access, acl, user, repository))
+        APR_ARRAY_PUSH(user_acls, const authz_acl_t *) = acl;
+    }
+
+  /* The tree only depends on the relative order of the ACLs' sequence
+   * numbers, not on their absolute values.  Those shift whenever rules
+   * for other users get added or removed further up in the authz file.
+   * So, hash the ACLs in sequence order but leave out the numbers. */
+  svn_sort__array(user_acls, compare_acl_sequence_numbers);
+
+  /* Hash exactly the information that process_acl() puts into the tree. */
+  for (i = 0; i < user_acls->nelts; ++i)
+    {
+      const authz_acl_t *acl = APR_ARRAY_IDX(user_acls, i,
+                                             const authz_acl_t *);
+      authz_access_t access;
+      int values[2];
+
+      svn_authz__get_acl_access(&access, acl, user, repository);
+      values[0] = access;
+      values[1] = acl->rule.len;
+      SVN_ERR(svn_checksum_update(ctx, values, sizeof(values)));
+
+      for (k = 0; k < acl->rule.len; ++k)
+        {
+          const authz_rule_segment_t *segment = &acl->rule.path[k];
+          int kind = segment->kind;
+
+          SVN_ERR(svn_checksum_update(ctx, &kind, sizeof(kind)));
+          SVN_ERR(svn_checksum_update(ctx, segment->pattern.data,
+                                      segment->pattern.len + 1));
+        }
+    }
+
+  return svn_error_trace(svn_checksum_final(digest, ctx, result_pool));
+}
+
+/* From the authz CONFIG, extract the parts relevant to USER and REPOSITORY.
+ * Return the filtered rule tree.
+ */
+static node_t *
+create_user_authz(authz_full_t *authz,
+                  const char *repository,
+                  const char *user,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  int i;
+  node_t *root = create_node(NULL, result_pool);
+  construction_context_t *ctx = create_construction_context(scratch_pool);
+
+  /* Use a separate sub-pool to keep memory usage tight. */
+  apr_pool_t *subpool = svn_pool_create(scratch_pool);
+
+  /* Find all ACLs for REPOSITORY. */
+  apr_array_header_t *acls = get_repos_acls(authz, repository, subpool);
+
   /* Filtering and tree construction. */
   for (i = 0; i < acls->nelts; ++i)
     process_acl(ctx, APR_ARRAY_IDX(acls, i, const authz_acl_t *),
@@ -967,6 +1067,19 @@ create_user_authz(authz_full_t *authz,
 
 /*** Lookup. ***/
 
+/* Snapshot of a lookup_state_t taken after following a parent path. */
+typedef struct lookup_frame_t
+{
+  /* Length of the parent path that this frame applies to. */
+  apr_size_t path_len;
+
+  /* Rights that apply at that parent path. */
+  limited_rights_t rights;
+
+  /* Nodes applying to that parent path. */
+  apr_array_header_t *nodes;
+} lookup_frame_t;
+
 /* Reusable lookup state object. It is easy to pass to functions and
  * recycling it between lookups saves significant setup costs. */
 typedef struct lookup_state_t
@@ -992,6 +1105,13 @@ typedef struct lookup_state_t
   /* Rights that apply at PARENT_PATH, if PARENT_PATH is not empty. */
   limited_rights_t parent_rights;
 
+  /* Stack of lookup_frame_t, one for each segment of PARENT_PATH.  Only
+   * the first DEPTH elements are valid; the remainder is being kept for
+   * recycling.  Lookups of paths sharing only some leading segments with
+   * PARENT_PATH can resume at the deepest common frame. */
+  apr_array_header_t *frames;
+  int depth;
+
 } lookup_state_t;
 
 /* Constructor for lookup_state_t. */
@@ -1002,6 +1122,7 @@ create_lookup_state(apr_pool_t *result_pool)
 
   state->next = apr_array_make(result_pool, 4, sizeof(node_t *));
   state->current = apr_array_make(result_pool, 4, sizeof(node_t *));
+  state->frames = apr_array_make(result_pool, 8, sizeof(lookup_frame_t));
 
   /* Virtually all path segments should fit into this buffer.  If they
    * don't, the buffer gets automatically reallocated.
@@ -1018,6 +1139,34 @@ create_lookup_state(apr_pool_t *result_pool)
   return state;
 }
 
+/* Record the CURRENT nodes and PARENT_RIGHTS of STATE for the current
+ * PARENT_PATH as a new frame on top of the STATE's frame stack. */
+static void
+push_lookup_frame(lookup_state_t *state)
+{
+  lookup_frame_t *frame;
+
+  /* Recycle the node array of a previously used frame, if possible. */
+  if (state->depth == state->frames->nelts)
+    {
+      frame = apr_array_push(state->frames);
+      frame->nodes = apr_array_make(state->frames->pool,
+                                    state->current->nelts,
+                                    sizeof(node_t *));
+    }
+  else
+    {
+      frame = &APR_ARRAY_IDX(state->frames, state->depth, lookup_frame_t);
+      apr_array_clear(frame->nodes);
+    }
+
+  frame->path_len = state->parent_path->len;
+  frame->rights = state->parent_rights;
+  apr_array_cat(frame->nodes, state->current);
+
+  ++state->depth;
+}
+
 /* Clear the current contents of STATE and re-initialize it for ROOT.
  * Check whether we can reuse a previous parent path lookup to shorten
  * the current PATH walk.  Return the full or remaining portion of
@@ -1042,6 +1191,31 @@ init_lockup_state(lookup_state_t *state,
       return path + state->parent_path->len;
     }
 
+  /* Maybe, some less deep parent path of the previous lookup matches.
+   * Frames further up the stack may only apply to longer paths. */
+  while (state->depth > 0)
+    {
+      lookup_frame_t *frame = &APR_ARRAY_IDX(state->frames, state->depth - 1,
+                                             lookup_frame_t);
+      if (   (len > frame->path_len)
+          && (path[frame->path_len] == '/')
+          && !memcmp(path, state->parent_path->data, frame->path_len))
+        {
+          /* Resume at that frame. */
+          svn_stringbuf_chop(state->parent_path,
+                             state->parent_path->len - frame->path_len);
+          state->parent_rights = frame->rights;
+          state->rights = frame->rights;
+
+          apr_array_clear(state->current);
+          apr_array_cat(state->current, frame->nodes);
+
+          return path + frame->path_len;
+        }
+
+      --state->depth;
+    }
+
   /* Start lookup at ROOT for the full PATH. */
   state->rights = root->rights;
   state->parent_rights = root->rights;
@@ -1063,6 +1237,7 @@ init_lockup_state(lookup_state_t *state,
 
   svn_stringbuf_setempty(state->parent_path);
   svn_stringbuf_setempty(state->scratch_pad);
+  state->depth = 0;
 
   return path;
 }
@@ -1359,6 +1534,7 @@ lookup(lookup_state_t *state,
 
           /* In STATE, PARENT_PATH, PARENT_RIGHTS and CURRENT are now in sync. */
           state->parent_rights = state->rights;
+          push_lookup_frame(state);
         }
     }
 
@@ -1467,6 +1643,47 @@ get_user_rules(svn_authz_t *authz,
   return authz->filtered;
 }
 
+/* Set *DIGEST to the rules digest for USER and REPOS_NAME in AUTHZ as
+ * returned by get_rules_digest().  AUTHZ must be backed by the AUTHZ_POOL.
+ * Digests are computed only once per authz model, user and repository.
+ * The result remains valid until RESULT_POOL gets cleaned up.  Use
+ * SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+get_cached_rules_digest(svn_checksum_t **digest,
+                        svn_authz_t *authz,
+                        const char *repos_name,
+                        const char *user,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  svn_membuf_t *key = construct_filtered_key(repos_name, user,
+                                             authz->authz_id->data,
+                                             authz->authz_id->size,
+                                             scratch_pool);
+
+  SVN_ERR(svn_object_pool__lookup((void **)digest, digest_pool, key,
+                                  result_pool));
+  if (!*digest)
+    {
+      apr_pool_t *item_pool = svn_object_pool__new_item_pool(digest_pool);
+      svn_checksum_t *new_digest;
+
+      SVN_ERR(get_rules_digest(&new_digest, authz->full, repos_name, user,
+                               item_pool, scratch_pool));
+      SVN_ERR(svn_object_pool__insert((void **)digest, digest_pool, key,
+                                      new_digest, item_pool, result_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+const void *
+svn_authz__get_filtered_tree(const svn_authz_t *authz)
+{
+  return authz->filtered ? authz->filtered->root : NULL;
+}
+
 /* In AUTHZ's user rules, construct the actual filtered tree.
  * Use SCRATCH_POOL for temporary allocations.
  */
@@ -1479,11 +1696,22 @@ filter_tree(svn_authz_t *authz,
   const char *user = authz->filtered->user;
   node_t *root;
 
-  if (filtered_pool)
+  /* Only authz objects read through authz_read() are backed by the
+   * AUTHZ_POOL and may share their filtered trees. */
+  if (filtered_pool && authz->authz_id)
     {
-      svn_membuf_t *key = construct_filtered_key(repos_name, user,
-                                                 authz->authz_id,
-                                                 scratch_pool);
+      svn_checksum_t *rules_digest;
+      svn_membuf_t *key;
+
+      /* After a modification of the authz file, we parse it into a new
+       * full model.  But if the rules relevant to this user didn't change,
+       * we can simply continue to use the filtered tree derived from the
+       * previous model. */
+      SVN_ERR(get_cached_rules_digest(&rules_digest, authz, repos_name,
+                                      user, scratch_pool, scratch_pool));
+      key = construct_filtered_key(repos_name, user, rules_digest->digest,
+                                   svn_checksum_size(rules_digest),
+                                   scratch_pool);
 
       /* Cache lookup. */
       SVN_ERR(svn_object_pool__lookup((void **)&root, filtered_pool, key,
@@ -1736,3 +1964,177 @@ svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
 
   return SVN_NO_ERROR;
 }
+
+svn_error_t *
+svn_repos__authz_check_access_many(svn_boolean_t *access_granted,
+                                   svn_authz_t *authz,
+                                   const char *repos_name,
+                                   const apr_array_header_t *paths,
+                                   const char *user,
+                                   svn_repos_authz_access_t required_access,
+                                   apr_pool_t *scratch_pool)
+{
+  const authz_access_t required =
+    ((required_access & svn_authz_read ? authz_access_read_flag : 0)
+     | (required_access & svn_authz_write ? authz_access_write_flag : 0));
+  svn_boolean_t recursive = !!(required_access & svn_authz_recursive);
+  apr_pool_t *iterpool;
+  int i;
+
+  /* Pick or create the suitable pre-filtered path rule tree. */
+  authz_user_rules_t *rules = get_user_rules(
+      authz,
+      (repos_name ? repos_name : AUTHZ_ANY_REPOSITORY),
+      user);
+
+  /* Uniform access to the whole repository? */
+  if (   ((rules->global_rights.min_access & required) == required)
+      || ((rules->global_rights.max_access & required) != required))
+    {
+      svn_boolean_t granted
+        = (rules->global_rights.min_access & required) == required;
+
+      for (i = 0; i < paths->nelts; ++i)
+        access_granted[i] = granted;
+
+      return SVN_NO_ERROR;
+    }
+
+  /* Did we already filter the data model? */
+  if (!rules->root)
+    SVN_ERR(filter_tree(authz, scratch_pool));
+
+  /* Walk the rules tree once for all paths.  The lookup state remembers
+   * the nodes for all parent paths of the previous lookup, such that
+   * common prefixes don't have to be walked again. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+
+      svn_pool_clear(iterpool);
+
+      path = init_lockup_state(rules->lookup_state, rules->root, path);
+      SVN_ERR_ASSERT(path[0] == '/');
+
+      access_granted[i] = lookup(rules->lookup_state, path, required,
+                                 recursive, iterpool);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+
+/*** Batch authz callbacks. ***/
+
+/* Maximum number of batch authz functions that may be registered.
+ * Every server process only has one or two kinds of authz callbacks. */
+#define MAX_AUTHZ_MANY_FUNCS 4
+
+/* Pairs of per-path authz callbacks and their batch versions. */
+static struct
+{
+  svn_repos_authz_func_t authz_func;
+  svn_repos__authz_many_func_t many_func;
+} authz_many_funcs[MAX_AUTHZ_MANY_FUNCS];
+
+/* Number of used entries in AUTHZ_MANY_FUNCS. */
+static int authz_many_funcs_count = 0;
+
+svn_error_t *
+svn_repos__authz_register_many_func(svn_repos_authz_func_t authz_func,
+                                    svn_repos__authz_many_func_t many_func)
+{
+  int i;
+  for (i = 0; i < authz_many_funcs_count; ++i)
+    if (authz_many_funcs[i].authz_func == authz_func)
+      {
+        authz_many_funcs[i].many_func = many_func;
+        return SVN_NO_ERROR;
+      }
+
+  SVN_ERR_ASSERT(authz_many_funcs_count < MAX_AUTHZ_MANY_FUNCS);
+  authz_many_funcs[authz_many_funcs_count].authz_func = authz_func;
+  authz_many_funcs[authz_many_funcs_count].many_func = many_func;
+  ++authz_many_funcs_count;
+
+  return SVN_NO_ERROR;
+}
+
+/* Sort callback comparing two pointers to paths (const char *) such that
+ * the result is in depth-first order. */
+static int
+compare_path_ptrs(const void *lhs,
+                  const void *rhs)
+{
+  const char *const *lhs_path = *(const char *const *const *)lhs;
+  const char *const *rhs_path = *(const char *const *const *)rhs;
+
+  return svn_path_compare_paths(*lhs_path, *rhs_path);
+}
+
+svn_error_t *
+svn_repos__authz_read_many(svn_boolean_t *allowed,
+                           svn_repos_authz_func_t authz_func,
+                           void *authz_baton,
+                           svn_fs_root_t *root,
+                           const apr_array_header_t *paths,
+                           apr_pool_t *scratch_pool)
+{
+  const char *const *first = (const char *const *)paths->elts;
+  const char *const **ordered;
+  apr_array_header_t *sorted_paths;
+  svn_boolean_t *sorted_allowed;
+  svn_repos__authz_many_func_t many_func = NULL;
+  int i;
+
+  if (paths->nelts == 0)
+    return SVN_NO_ERROR;
+
+  /* Put the paths into depth-first order, remembering where each of
+   * them came from. */
+  ordered = apr_palloc(scratch_pool, paths->nelts * sizeof(*ordered));
+  for (i = 0; i < paths->nelts; ++i)
+    ordered[i] = first + i;
+
+  qsort(ordered, paths->nelts, sizeof(*ordered), compare_path_ptrs);
+
+  sorted_paths = apr_array_make(scratch_pool, paths->nelts,
+                                sizeof(const char *));
+  for (i = 0; i < paths->nelts; ++i)
+    APR_ARRAY_PUSH(sorted_paths, const char *) = *ordered[i];
+
+  /* Check them all in one go, if we can. */
+  for (i = 0; i < authz_many_funcs_count; ++i)
+    if (authz_many_funcs[i].authz_func == authz_func)
+      many_func = authz_many_funcs[i].many_func;
+
+  sorted_allowed = apr_palloc(scratch_pool,
+                              paths->nelts * sizeof(*sorted_allowed));
+  if (many_func)
+    {
+      SVN_ERR(many_func(sorted_allowed, root, sorted_paths, authz_baton,
+                        scratch_pool));
+    }
+  else
+    {
+      apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+      for (i = 0; i < sorted_paths->nelts; ++i)
+        {
+          svn_pool_clear(iterpool);
+          SVN_ERR(authz_func(&sorted_allowed[i], root,
+                             APR_ARRAY_IDX(sorted_paths, i, const char *),
+                             authz_baton, iterpool));
+        }
+
+      svn_pool_destroy(iterpool);
+    }
+
+  /* Return the results in the caller's order. */
+  for (i = 0; i < paths->nelts; ++i)
+    allowed[ordered[i] - first] = sorted_allowed[i];
+
+  return SVN_NO_ERROR;
+}
@@ -367,6 +367,15 @@ svn_authz__get_global_rights(authz_rights_t *rights,
                              const authz_full_t *authz,
                              const char *user, const char *repos);
 
+/* Return the filtered rule tree that AUTHZ currently uses for lookups,
+ * or NULL if it has not been constructed, yet.  Authz objects returning
+ * the same tree share it through the filtered tree cache.
+ *
+ * This is for testing only.
+ */
+const void *
+svn_authz__get_filtered_tree(const svn_authz_t *authz);
+
 
 #ifdef __cplusplus
 }
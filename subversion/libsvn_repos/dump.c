@@ -23,6 +23,8 @@
 
 #include <stdarg.h>
 
+#include <apr_thread_proc.h>
+
 #include "svn_private_config.h"
 #include "svn_pools.h"
 #include "svn_error.h"
@@ -37,8 +39,10 @@
 #include "svn_checksum.h"
 #include "svn_props.h"
 #include "svn_sorts.h"
+#include "svn_cache_config.h"
 
 #include "private/svn_repos_private.h"
+#include "private/svn_atomic.h"
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_fs_private.h"
 #include "private/svn_sorts_private.h"
@@ -2021,81 +2025,54 @@ dump_filter_authz_func(svn_boolean_t *allowed,
 
 
 
-/* The main dumper. */
-svn_error_t *
-svn_repos_dump_fs4(svn_repos_t *repos,
-                   svn_stream_t *stream,
-                   svn_revnum_t start_rev,
-                   svn_revnum_t end_rev,
-                   svn_boolean_t incremental,
-                   svn_boolean_t use_deltas,
-                   svn_boolean_t include_revprops,
-                   svn_boolean_t include_changes,
-                   svn_repos_notify_func_t notify_func,
-                   void *notify_baton,
-                   svn_repos_dump_filter_func_t filter_func,
-                   void *filter_baton,
-                   svn_cancel_func_t cancel_func,
-                   void *cancel_baton,
-                   apr_pool_t *pool)
+/* Validate the START_REV and END_REV parameters for dumping the FS and
+   replace invalid / unspecified revisions by their defaults.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+check_dump_range(svn_revnum_t *start_rev,
+                 svn_revnum_t *end_rev,
+                 svn_fs_t *fs,
+                 apr_pool_t *scratch_pool)
 {
-  const svn_delta_editor_t *dump_editor;
-  void *dump_edit_baton = NULL;
-  svn_revnum_t rev;
-  svn_fs_t *fs = svn_repos_fs(repos);
-  apr_pool_t *iterpool = svn_pool_create(pool);
   svn_revnum_t youngest;
-  const char *uuid;
-  int version;
-  svn_boolean_t found_old_reference = FALSE;
-  svn_boolean_t found_old_mergeinfo = FALSE;
-  svn_repos_notify_t *notify;
-  svn_repos_authz_func_t authz_func;
-  dump_filter_baton_t authz_baton = {0};
-
-  /* Make sure we catch up on the latest revprop changes.  This is the only
-   * time we will refresh the revprop data in this query. */
-  SVN_ERR(svn_fs_refresh_revision_props(fs, pool));
 
   /* Determine the current youngest revision of the filesystem. */
-  SVN_ERR(svn_fs_youngest_rev(&youngest, fs, pool));
+  SVN_ERR(svn_fs_youngest_rev(&youngest, fs, scratch_pool));
 
   /* Use default vals if necessary. */
-  if (! SVN_IS_VALID_REVNUM(start_rev))
-    start_rev = 0;
-  if (! SVN_IS_VALID_REVNUM(end_rev))
-    end_rev = youngest;
-  if (! stream)
-    stream = svn_stream_empty(pool);
+  if (! SVN_IS_VALID_REVNUM(*start_rev))
+    *start_rev = 0;
+  if (! SVN_IS_VALID_REVNUM(*end_rev))
+    *end_rev = youngest;
 
   /* Validate the revisions. */
-  if (start_rev > end_rev)
+  if (*start_rev > *end_rev)
     return svn_error_createf(SVN_ERR_REPOS_BAD_ARGS, NULL,
                              _("Start revision %ld"
                                " is greater than end revision %ld"),
-                             start_rev, end_rev);
-  if (end_rev > youngest)
+                             *start_rev, *end_rev);
+  if (*end_rev > youngest)
     return svn_error_createf(SVN_ERR_REPOS_BAD_ARGS, NULL,
                              _("End revision %ld is invalid "
                                "(youngest revision is %ld)"),
-                             end_rev, youngest);
+                             *end_rev, youngest);
 
-  /* We use read authz callback to implement dump filtering. If there is no
-   * read access for some node, it will be excluded from dump as well as
-   * references to it (e.g. copy source). */
-  if (filter_func)
-    {
-      authz_func = dump_filter_authz_func;
-      authz_baton.filter_func = filter_func;
-      authz_baton.filter_baton = filter_baton;
-    }
-  else
-    {
-      authz_func = NULL;
-    }
+  return SVN_NO_ERROR;
+}
+
+/* Write the dump file header records for REPOS to STREAM.  The format
+   version depends on USE_DELTAS.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+write_dump_header(svn_stream_t *stream,
+                  svn_repos_t *repos,
+                  svn_boolean_t use_deltas,
+                  apr_pool_t *scratch_pool)
+{
+  const char *uuid;
+  int version;
 
   /* Write out the UUID. */
-  SVN_ERR(svn_fs_get_uuid(fs, &uuid, pool));
+  SVN_ERR(svn_fs_get_uuid(svn_repos_fs(repos), &uuid, scratch_pool));
 
   /* If we're not using deltas, use the previous version, for
      compatibility with svn 1.0.x. */
@@ -2105,13 +2082,51 @@ svn_repos_dump_fs4(svn_repos_t *repos,
 
   /* Write out "general" metadata for the dumpfile.  In this case, a
      magic header followed by a dumpfile format version. */
-  SVN_ERR(svn_repos__dump_magic_header_record(stream, version, pool));
-  SVN_ERR(svn_repos__dump_uuid_header_record(stream, uuid, pool));
+  SVN_ERR(svn_repos__dump_magic_header_record(stream, version,
+                                              scratch_pool));
+  SVN_ERR(svn_repos__dump_uuid_header_record(stream, uuid, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Write the records for revisions START_REV to END_REV in REPOS to STREAM.
+   OLDEST_DUMPED_REV is the first revision of the whole dump, which may
+   be older than START_REV.  Set *FOUND_OLD_REFERENCE and
+   *FOUND_OLD_MERGEINFO if we find references to revisions older than
+   OLDEST_DUMPED_REV.  Filter the nodes through AUTHZ_FUNC with
+   AUTHZ_BATON, if not NULL.  All other parameters are the same as for
+   svn_repos_dump_fs4().  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+dump_revision_range(svn_repos_t *repos,
+                    svn_stream_t *stream,
+                    svn_revnum_t start_rev,
+                    svn_revnum_t end_rev,
+                    svn_revnum_t oldest_dumped_rev,
+                    svn_boolean_t incremental,
+                    svn_boolean_t use_deltas,
+                    svn_boolean_t include_revprops,
+                    svn_boolean_t include_changes,
+                    svn_boolean_t *found_old_reference,
+                    svn_boolean_t *found_old_mergeinfo,
+                    svn_repos_notify_func_t notify_func,
+                    void *notify_baton,
+                    svn_repos_authz_func_t authz_func,
+                    void *authz_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *scratch_pool)
+{
+  const svn_delta_editor_t *dump_editor;
+  void *dump_edit_baton = NULL;
+  svn_revnum_t rev;
+  svn_fs_t *fs = svn_repos_fs(repos);
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_repos_notify_t *notify;
 
   /* Create a notify object that we can reuse in the loop. */
   if (notify_func)
     notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
-                                     pool);
+                                     scratch_pool);
 
   /* Main loop:  we're going to dump revision REV.  */
   for (rev = start_rev; rev <= end_rev; rev++)
@@ -2127,7 +2142,7 @@ svn_repos_dump_fs4(svn_repos_t *repos,
 
       /* Write the revision record. */
       SVN_ERR(write_revision_record(stream, repos, rev, include_revprops,
-                                    authz_func, &authz_baton, iterpool));
+                                    authz_func, authz_baton, iterpool));
 
       /* When dumping revision 0, we just write out the revision record.
          The parser might want to use its properties.
@@ -2140,11 +2155,11 @@ svn_repos_dump_fs4(svn_repos_t *repos,
          non-incremental dump. */
       use_deltas_for_rev = use_deltas && (incremental || rev != start_rev);
       SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
-                              "", stream, &found_old_reference,
-                              &found_old_mergeinfo, NULL,
+                              "", stream, found_old_reference,
+                              found_old_mergeinfo, NULL,
                               notify_func, notify_baton,
-                              start_rev, use_deltas_for_rev, FALSE, FALSE,
-                              iterpool));
+                              oldest_dumped_rev, use_deltas_for_rev,
+                              FALSE, FALSE, iterpool));
 
       /* Drive the editor in one way or another. */
       SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, iterpool));
@@ -2160,7 +2175,7 @@ svn_repos_dump_fs4(svn_repos_t *repos,
           SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
                                        to_root, "",
                                        dump_editor, dump_edit_baton,
-                                       authz_func, &authz_baton,
+                                       authz_func, authz_baton,
                                        FALSE, /* don't send text-deltas */
                                        svn_depth_infinity,
                                        FALSE, /* don't send entry props */
@@ -2172,7 +2187,7 @@ svn_repos_dump_fs4(svn_repos_t *repos,
           /* The normal case: compare consecutive revs. */
           SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
                                     dump_editor, dump_edit_baton,
-                                    authz_func, &authz_baton, iterpool));
+                                    authz_func, authz_baton, iterpool));
 
           /* While our editor close_edit implementation is a no-op, we still
              do this for completeness. */
@@ -2187,41 +2202,666 @@ svn_repos_dump_fs4(svn_repos_t *repos,
         }
     }
 
-  if (notify_func)
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Send the final notifications of a dump to NOTIFY_FUNC with NOTIFY_BATON,
+   if not NULL.  FOUND_OLD_REFERENCE and FOUND_OLD_MERGEINFO tell whether
+   we need to issue the respective warnings.  Use SCRATCH_POOL for
+   temporary allocations. */
+static void
+notify_dump_end(svn_boolean_t found_old_reference,
+                svn_boolean_t found_old_mergeinfo,
+                svn_repos_notify_func_t notify_func,
+                void *notify_baton,
+                apr_pool_t *scratch_pool)
+{
+  svn_repos_notify_t *notify;
+
+  if (!notify_func)
+    return;
+
+  /* Did we issue any warnings about references to revisions older than
+     the oldest dumped revision?  If so, then issue a final generic
+     warning, since the inline warnings already issued might easily be
+     missed. */
+
+  notify = svn_repos_notify_create(svn_repos_notify_dump_end, scratch_pool);
+  notify_func(notify_baton, notify, scratch_pool);
+
+  if (found_old_reference)
     {
-      /* Did we issue any warnings about references to revisions older than
-         the oldest dumped revision?  If so, then issue a final generic
-         warning, since the inline warnings already issued might easily be
-         missed. */
+      notify_warning(scratch_pool, notify_func, notify_baton,
+                     svn_repos_notify_warning_found_old_reference,
+                     _("The range of revisions dumped "
+                       "contained references to "
+                       "copy sources outside that "
+                       "range."));
+    }
 
-      notify = svn_repos_notify_create(svn_repos_notify_dump_end, iterpool);
-      notify_func(notify_baton, notify, iterpool);
+  /* Ditto if we issued any warnings about old revisions referenced
+     in dumped mergeinfo. */
+  if (found_old_mergeinfo)
+    {
+      notify_warning(scratch_pool, notify_func, notify_baton,
+                     svn_repos_notify_warning_found_old_mergeinfo,
+                     _("The range of revisions dumped "
+                       "contained mergeinfo "
+                       "which reference revisions outside "
+                       "that range."));
+    }
+}
+
+/* The main dumper. */
+svn_error_t *
+svn_repos_dump_fs4(svn_repos_t *repos,
+                   svn_stream_t *stream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   svn_boolean_t incremental,
+                   svn_boolean_t use_deltas,
+                   svn_boolean_t include_revprops,
+                   svn_boolean_t include_changes,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_repos_dump_filter_func_t filter_func,
+                   void *filter_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool)
+{
+  svn_fs_t *fs = svn_repos_fs(repos);
+  svn_boolean_t found_old_reference = FALSE;
+  svn_boolean_t found_old_mergeinfo = FALSE;
+  svn_repos_authz_func_t authz_func;
+  dump_filter_baton_t authz_baton = {0};
+
+  /* Make sure we catch up on the latest revprop changes.  This is the only
+   * time we will refresh the revprop data in this query. */
+  SVN_ERR(svn_fs_refresh_revision_props(fs, pool));
+
+  SVN_ERR(check_dump_range(&start_rev, &end_rev, fs, pool));
+  if (! stream)
+    stream = svn_stream_empty(pool);
+
+  /* We use read authz callback to implement dump filtering. If there is no
+   * read access for some node, it will be excluded from dump as well as
+   * references to it (e.g. copy source). */
+  if (filter_func)
+    {
+      authz_func = dump_filter_authz_func;
+      authz_baton.filter_func = filter_func;
+      authz_baton.filter_baton = filter_baton;
+    }
+  else
+    {
+      authz_func = NULL;
+    }
 
-      if (found_old_reference)
+  SVN_ERR(write_dump_header(stream, repos, use_deltas, pool));
+  SVN_ERR(dump_revision_range(repos, stream, start_rev, end_rev, start_rev,
+                              incremental, use_deltas, include_revprops,
+                              include_changes, &found_old_reference,
+                              &found_old_mergeinfo, notify_func, notify_baton,
+                              authz_func, &authz_baton,
+                              cancel_func, cancel_baton, pool));
+  notify_dump_end(found_old_reference, found_old_mergeinfo,
+                  notify_func, notify_baton, pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for a stream counting the bytes written to STREAM. */
+typedef struct counting_stream_baton_t
+{
+  svn_stream_t *stream;
+  apr_off_t *written;
+} counting_stream_baton_t;
+
+/* Implements svn_write_fn_t for counting streams. */
+static svn_error_t *
+write_handler_counting(void *baton,
+                       const char *data,
+                       apr_size_t *len)
+{
+  counting_stream_baton_t *b = baton;
+
+  SVN_ERR(svn_stream_write(b->stream, data, len));
+  *b->written += *len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a stream that forwards all data to STREAM and adds the number
+   of bytes written to *WRITTEN.  Closing the result does not close
+   STREAM.  Allocate the result in RESULT_POOL. */
+static svn_stream_t *
+counting_stream_create(svn_stream_t *stream,
+                       apr_off_t *written,
+                       apr_pool_t *result_pool)
+{
+  counting_stream_baton_t *baton = apr_pcalloc(result_pool, sizeof(*baton));
+  svn_stream_t *result;
+
+  baton->stream = stream;
+  baton->written = written;
+
+  result = svn_stream_create(baton, result_pool);
+  svn_stream_set_write(result, write_handler_counting);
+
+  return result;
+}
+
+/* Baton for index_notify_func(). */
+typedef struct index_notify_baton_t
+{
+  /* Receives the end offsets of the revision records. */
+  svn_repos__dump_index_t *index;
+
+  /* Number of bytes written to the dump stream so far. */
+  apr_off_t *written;
+
+  /* Notification function to forward to.  May be NULL. */
+  svn_repos_notify_func_t notify_func;
+  void *notify_baton;
+} index_notify_baton_t;
+
+/* Implements svn_repos_notify_func_t.  Record the current stream offset
+   at the end of every revision record in the index_notify_baton_t BATON
+   and forward all notifications. */
+static void
+index_notify_func(void *baton,
+                  const svn_repos_notify_t *notify,
+                  apr_pool_t *scratch_pool)
+{
+  index_notify_baton_t *b = baton;
+
+  if (notify->action == svn_repos_notify_dump_rev_end)
+    APR_ARRAY_PUSH(b->index->rev_ends, apr_off_t) = *b->written;
+
+  if (b->notify_func)
+    b->notify_func(b->notify_baton, notify, scratch_pool);
+}
+
+#if APR_HAS_THREADS
+
+/* Maximum number of revisions dumped by a single job of a parallel dump.
+   The output of finished jobs gets buffered in temporary files until all
+   previous revisions have been written, so keep that data small. */
+#define MAX_REVS_PER_DUMP_JOB 100
+
+/* Parameters shared by all jobs of a parallel dump. */
+typedef struct dump_jobs_baton_t
+{
+  const char *repos_path;
+  apr_hash_t *fs_config;
+  svn_fs_warning_callback_t warning_func;
+  void *warning_baton;
+
+  svn_revnum_t oldest_dumped_rev;
+  svn_boolean_t use_deltas;
+  svn_boolean_t include_revprops;
+  svn_boolean_t include_changes;
+
+  svn_repos_authz_func_t authz_func;
+  dump_filter_baton_t *authz_baton;
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  /* If not NULL, record the revision offsets in here.  WRITTEN is the
+     number of bytes written to the output stream so far. */
+  svn_repos__dump_index_t *index;
+  apr_off_t *written;
+
+  /* Set when the remaining jobs shall terminate early. */
+  svn_atomic_t abort;
+} dump_jobs_baton_t;
+
+/* A single job of a parallel dump, i.e. a revision range being dumped
+   into a temporary file. */
+typedef struct dump_job_t
+{
+  /* Parameters shared with all other jobs. */
+  dump_jobs_baton_t *shared;
+
+  /* The revision range to dump and whether its first revision shall be
+     dumped incrementally. */
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+  svn_boolean_t incremental;
+
+  /* Root pool owned by this job.  Everything the job allocates lives in
+     here, such that it does not interfere with the other threads. */
+  apr_pool_t *pool;
+
+  /* The temporary file receiving the dump data and the number of bytes
+     written to it so far. */
+  apr_file_t *file;
+  apr_off_t written;
+
+  /* The notifications (svn_repos_notify_t *) sent while dumping.  They
+     will be forwarded in the order of the revisions. */
+  apr_array_header_t *notifications;
+
+  /* Offsets (apr_off_t) within FILE at the end of each revision record. */
+  apr_array_header_t *rev_ends;
+
+  /* The outcome of the job. */
+  svn_boolean_t found_old_reference;
+  svn_boolean_t found_old_mergeinfo;
+  svn_error_t *result;
+
+  /* The thread executing this job. */
+  apr_thread_t *thread;
+} dump_job_t;
+
+/* Implements svn_repos_notify_func_t.  Add a copy of NOTIFY to the
+   dump_job_t BATON's list of notifications. */
+static void
+collect_job_notification(void *baton,
+                         const svn_repos_notify_t *notify,
+                         apr_pool_t *scratch_pool)
+{
+  dump_job_t *job = baton;
+  svn_repos_notify_t *copy = svn_repos_notify_create(notify->action,
+                                                     job->pool);
+
+  copy->revision = notify->revision;
+  copy->warning = notify->warning;
+  copy->warning_str = apr_pstrdup(job->pool, notify->warning_str);
+  copy->path = apr_pstrdup(job->pool, notify->path);
+
+  APR_ARRAY_PUSH(job->notifications, svn_repos_notify_t *) = copy;
+
+  if (notify->action == svn_repos_notify_dump_rev_end)
+    APR_ARRAY_PUSH(job->rev_ends, apr_off_t) = job->written;
+}
+
+/* Implements svn_cancel_func_t for the dump_jobs_baton_t BATON. */
+static svn_error_t *
+check_job_cancel(void *baton)
+{
+  dump_jobs_baton_t *shared = baton;
+
+  if (svn_atomic_read(&shared->abort))
+    return svn_error_create(SVN_ERR_CANCELLED, NULL, NULL);
+
+  if (shared->cancel_func)
+    SVN_ERR(shared->cancel_func(shared->cancel_baton));
+
+  return SVN_NO_ERROR;
+}
+
+/* Dump the revision range given by JOB into a new temporary file. */
+static svn_error_t *
+run_dump_job(dump_job_t *job)
+{
+  dump_jobs_baton_t *shared = job->shared;
+  svn_repos_t *repos;
+  svn_stream_t *stream;
+
+  /* Each job needs its own FS instance. */
+  SVN_ERR(svn_repos_open3(&repos, shared->repos_path, shared->fs_config,
+                          job->pool, job->pool));
+  if (shared->warning_func)
+    svn_fs_set_warning_func(svn_repos_fs(repos), shared->warning_func,
+                            shared->warning_baton);
+
+  SVN_ERR(svn_io_open_unique_file3(&job->file, NULL, NULL,
+                                   svn_io_file_del_on_pool_cleanup,
+                                   job->pool, job->pool));
+  stream = counting_stream_create(svn_stream_from_aprfile2(job->file, TRUE,
+                                                           job->pool),
+                                  &job->written, job->pool);
+
+  SVN_ERR(dump_revision_range(repos, stream, job->start_rev, job->end_rev,
+                              shared->oldest_dumped_rev, job->incremental,
+                              shared->use_deltas, shared->include_revprops,
+                              shared->include_changes,
+                              &job->found_old_reference,
+                              &job->found_old_mergeinfo,
+                              collect_job_notification, job,
+                              shared->authz_func, shared->authz_baton,
+                              check_job_cancel, shared, job->pool));
+
+  return svn_error_trace(svn_io_file_flush(job->file, job->pool));
+}
+
+/* Thread entry point.  DATA is the dump_job_t to execute. */
+static void * APR_THREAD_FUNC
+dump_job_thread(apr_thread_t *thread,
+                void *data)
+{
+  dump_job_t *job = data;
+  job->result = run_dump_job(job);
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Start a new thread dumping revisions START_REV to END_REV as
+   configured in SHARED.  Return the new job in *JOB_P. */
+static svn_error_t *
+start_dump_job(dump_job_t **job_p,
+               dump_jobs_baton_t *shared,
+               svn_revnum_t start_rev,
+               svn_revnum_t end_rev,
+               svn_boolean_t incremental)
+{
+  apr_status_t status;
+
+  /* To be able to run each job in a separate thread, they must use
+   * separate, thread-safe pools. */
+  apr_pool_t *pool = svn_pool_create(NULL);
+  dump_job_t *job = apr_pcalloc(pool, sizeof(*job));
+
+  job->shared = shared;
+  job->start_rev = start_rev;
+  job->end_rev = end_rev;
+  job->incremental = incremental;
+  job->pool = pool;
+  job->notifications = apr_array_make(pool, end_rev - start_rev + 1,
+                                      sizeof(svn_repos_notify_t *));
+  job->rev_ends = apr_array_make(pool, end_rev - start_rev + 1,
+                                 sizeof(apr_off_t));
+
+  status = apr_thread_create(&job->thread, NULL, dump_job_thread, job,
+                             pool);
+  if (status)
+    {
+      svn_pool_destroy(pool);
+      return svn_error_wrap_apr(status, _("Can't create dump thread"));
+    }
+
+  *job_p = job;
+  return SVN_NO_ERROR;
+}
+
+/* Wait for JOB to finish.  If it completed successfully, append its
+   output to STREAM, add its revision offsets to the index (if any) and
+   forward its notifications to NOTIFY_FUNC with NOTIFY_BATON.  Update
+   *FOUND_OLD_REFERENCE and *FOUND_OLD_MERGEINFO.  Release all of JOB's
+   resources in any case.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+finish_dump_job(dump_job_t *job,
+                svn_stream_t *stream,
+                svn_boolean_t *found_old_reference,
+                svn_boolean_t *found_old_mergeinfo,
+                svn_repos_notify_func_t notify_func,
+                void *notify_baton,
+                apr_pool_t *scratch_pool)
+{
+  dump_jobs_baton_t *shared = job->shared;
+  apr_status_t retval;
+  apr_status_t status = apr_thread_join(&retval, job->thread);
+  svn_error_t *err = job->result;
+  apr_off_t base = shared->index ? *shared->written : 0;
+  int i;
+
+  if (status)
+    err = svn_error_compose_create(err,
+                                   svn_error_wrap_apr(status,
+                                        _("Can't join dump thread")));
+
+  if (!err)
+    {
+      apr_off_t offset = 0;
+      err = svn_io_file_seek(job->file, APR_SET, &offset, scratch_pool);
+      if (!err)
+        err = svn_stream_copy3(svn_stream_from_aprfile2(job->file, TRUE,
+                                                        scratch_pool),
+                               svn_stream_disown(stream, scratch_pool),
+                               NULL, NULL, scratch_pool);
+    }
+
+  if (!err && shared->index)
+    for (i = 0; i < job->rev_ends->nelts; ++i)
+      APR_ARRAY_PUSH(shared->index->rev_ends, apr_off_t)
+        = base + APR_ARRAY_IDX(job->rev_ends, i, apr_off_t);
+
+  if (!err && notify_func)
+    for (i = 0; i < job->notifications->nelts; ++i)
+      notify_func(notify_baton,
+                  APR_ARRAY_IDX(job->notifications, i, svn_repos_notify_t *),
+                  scratch_pool);
+
+  *found_old_reference |= job->found_old_reference;
+  *found_old_mergeinfo |= job->found_old_mergeinfo;
+
+  /* This also removes the temporary file. */
+  svn_pool_destroy(job->pool);
+
+  return svn_error_trace(err);
+}
+
+/* Wait for JOB to finish and release all of its resources, discarding
+   its output and all errors. */
+static void
+discard_dump_job(dump_job_t *job)
+{
+  apr_status_t retval;
+  apr_thread_join(&retval, job->thread);
+
+  svn_error_clear(job->result);
+
+  /* This also removes the temporary file. */
+  svn_pool_destroy(job->pool);
+}
+
+/* Write the records for revisions START_REV to END_REV to STREAM, using
+   up to JOBS threads configured by SHARED.  INCREMENTAL applies to
+   START_REV only.  Set *FOUND_OLD_REFERENCE and *FOUND_OLD_MERGEINFO
+   as well as send notifications to NOTIFY_FUNC with NOTIFY_BATON just
+   like dump_revision_range() does.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+dump_revision_range_parallel(dump_jobs_baton_t *shared,
+                             int jobs,
+                             svn_stream_t *stream,
+                             svn_revnum_t start_rev,
+                             svn_revnum_t end_rev,
+                             svn_boolean_t incremental,
+                             svn_boolean_t *found_old_reference,
+                             svn_boolean_t *found_old_mergeinfo,
+                             svn_repos_notify_func_t notify_func,
+                             void *notify_baton,
+                             apr_pool_t *scratch_pool)
+{
+  dump_job_t **queue;
+  int first = 0;
+  int count = 0;
+  svn_revnum_t next_rev;
+  svn_revnum_t chunk_size;
+  svn_error_t *err = SVN_NO_ERROR;
+  apr_pool_t *iterpool;
+
+  /* Use a few ranges per job to even out differences in revision sizes
+     but keep them large enough for the per-job overhead not to matter.
+     Limit their size to not buffer too much data in temporary files. */
+  chunk_size = (end_rev - start_rev + 1) / (jobs * 4);
+  chunk_size = MAX(MIN(chunk_size, MAX_REVS_PER_DUMP_JOB), 1);
+
+  /* Keep up to JOBS ranges in flight and append their output in
+     revision order.  Only finished but not yet appended ranges get
+     buffered in temporary files. */
+  queue = apr_pcalloc(scratch_pool, jobs * sizeof(*queue));
+  iterpool = svn_pool_create(scratch_pool);
+  next_rev = start_rev;
+  while (!err && (next_rev <= end_rev || count))
+    {
+      svn_pool_clear(iterpool);
+
+      /* Keep all workers busy. */
+      while (!err && count < jobs && next_rev <= end_rev)
         {
-          notify_warning(iterpool, notify_func, notify_baton,
-                         svn_repos_notify_warning_found_old_reference,
-                         _("The range of revisions dumped "
-                           "contained references to "
-                           "copy sources outside that "
-                           "range."));
+          svn_revnum_t last_rev = MIN(next_rev + chunk_size - 1, end_rev);
+          svn_boolean_t incremental_range = incremental
+                                         || next_rev != start_rev;
+
+          err = start_dump_job(&queue[(first + count) % jobs], shared,
+                               next_rev, last_rev, incremental_range);
+          if (!err)
+            {
+              ++count;
+              next_rev = last_rev + 1;
+            }
         }
 
-      /* Ditto if we issued any warnings about old revisions referenced
-         in dumped mergeinfo. */
-      if (found_old_mergeinfo)
+      /* Wait for the oldest range and append it. */
+      if (count)
         {
-          notify_warning(iterpool, notify_func, notify_baton,
-                         svn_repos_notify_warning_found_old_mergeinfo,
-                         _("The range of revisions dumped "
-                           "contained mergeinfo "
-                           "which reference revisions outside "
-                           "that range."));
+          err = svn_error_compose_create(err,
+                        finish_dump_job(queue[first], stream,
+                                        found_old_reference,
+                                        found_old_mergeinfo,
+                                        notify_func, notify_baton,
+                                        iterpool));
+          first = (first + 1) % jobs;
+          --count;
+        }
+    }
+
+  /* Upon failure, terminate all remaining jobs.  Their output must not
+     be appended after the gap left by the failed one. */
+  if (err)
+    {
+      svn_atomic_set(&shared->abort, TRUE);
+      while (count)
+        {
+          discard_dump_job(queue[first]);
+          first = (first + 1) % jobs;
+          --count;
         }
     }
 
   svn_pool_destroy(iterpool);
 
+  return svn_error_trace(err);
+}
+
+#endif
+
+svn_error_t *
+svn_repos__dump_fs_jobs(svn_repos_t *repos,
+                        apr_hash_t *fs_config,
+                        svn_fs_warning_callback_t warning_func,
+                        void *warning_baton,
+                        int jobs,
+                        svn_repos__dump_index_t *index,
+                        svn_stream_t *stream,
+                        svn_revnum_t start_rev,
+                        svn_revnum_t end_rev,
+                        svn_boolean_t incremental,
+                        svn_boolean_t use_deltas,
+                        svn_boolean_t include_revprops,
+                        svn_boolean_t include_changes,
+                        svn_repos_notify_func_t notify_func,
+                        void *notify_baton,
+                        svn_repos_dump_filter_func_t filter_func,
+                        void *filter_baton,
+                        svn_cancel_func_t cancel_func,
+                        void *cancel_baton,
+                        apr_pool_t *scratch_pool)
+{
+  svn_fs_t *fs = svn_repos_fs(repos);
+  svn_boolean_t found_old_reference = FALSE;
+  svn_boolean_t found_old_mergeinfo = FALSE;
+  svn_repos_authz_func_t authz_func = NULL;
+  dump_filter_baton_t *authz_baton = NULL;
+  apr_off_t written = 0;
+
+#if !APR_HAS_THREADS
+  jobs = 1;
+#endif
+
+  /* The parallel jobs share the process-wide caches.  Without locking,
+     those must only be accessed by a single thread. */
+  if (svn_cache_config_get()->single_threaded)
+    jobs = 1;
+
+  if (jobs <= 1 && !index)
+    return svn_error_trace(svn_repos_dump_fs4(repos, stream,
+                                              start_rev, end_rev,
+                                              incremental, use_deltas,
+                                              include_revprops,
+                                              include_changes,
+                                              notify_func, notify_baton,
+                                              filter_func, filter_baton,
+                                              cancel_func, cancel_baton,
+                                              scratch_pool));
+
+  SVN_ERR(svn_fs_refresh_revision_props(fs, scratch_pool));
+  SVN_ERR(check_dump_range(&start_rev, &end_rev, fs, scratch_pool));
+  if (! stream)
+    stream = svn_stream_empty(scratch_pool);
+  if (index)
+    stream = counting_stream_create(stream, &written, scratch_pool);
+
+  if (filter_func)
+    {
+      authz_func = dump_filter_authz_func;
+      authz_baton = apr_pcalloc(scratch_pool, sizeof(*authz_baton));
+      authz_baton->filter_func = filter_func;
+      authz_baton->filter_baton = filter_baton;
+    }
+
+  SVN_ERR(write_dump_header(stream, repos, use_deltas, scratch_pool));
+  if (index)
+    {
+      index->header_length = written;
+      index->start_rev = start_rev;
+      apr_array_clear(index->rev_ends);
+    }
+
+#if APR_HAS_THREADS
+  if (jobs > 1)
+    {
+      dump_jobs_baton_t *shared = apr_pcalloc(scratch_pool, sizeof(*shared));
+      shared->repos_path = svn_repos_path(repos, scratch_pool);
+      shared->fs_config = fs_config;
+      shared->warning_func = warning_func;
+      shared->warning_baton = warning_baton;
+      shared->oldest_dumped_rev = start_rev;
+      shared->use_deltas = use_deltas;
+      shared->include_revprops = include_revprops;
+      shared->include_changes = include_changes;
+      shared->authz_func = authz_func;
+      shared->authz_baton = authz_baton;
+      shared->cancel_func = cancel_func;
+      shared->cancel_baton = cancel_baton;
+      shared->index = index;
+      shared->written = &written;
+
+      SVN_ERR(dump_revision_range_parallel(shared, jobs, stream,
+                                           start_rev, end_rev, incremental,
+                                           &found_old_reference,
+                                           &found_old_mergeinfo,
+                                           notify_func, notify_baton,
+                                           scratch_pool));
+    }
+  else
+#endif
+    {
+      index_notify_baton_t notify_wrapper;
+      notify_wrapper.index = index;
+      notify_wrapper.written = &written;
+      notify_wrapper.notify_func = notify_func;
+      notify_wrapper.notify_baton = notify_baton;
+
+      SVN_ERR(dump_revision_range(repos, stream, start_rev, end_rev,
+                                  start_rev, incremental, use_deltas,
+                                  include_revprops, include_changes,
+                                  &found_old_reference,
+                                  &found_old_mergeinfo,
+                                  index_notify_func, &notify_wrapper,
+                                  authz_func, authz_baton,
+                                  cancel_func, cancel_baton, scratch_pool));
+    }
+
+  notify_dump_end(found_old_reference, found_old_mergeinfo,
+                  notify_func, notify_baton, scratch_pool);
+
   return SVN_NO_ERROR;
 }
 
@@ -0,0 +1,356 @@
+/* dump_index.c --- random access to dump files via an external index
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "svn_pools.h"
+#include "svn_error.h"
+#include "svn_io.h"
+#include "svn_string.h"
+#include "svn_repos.h"
+
+#include "private/svn_repos_private.h"
+
+#include "svn_private_config.h"
+
+
+
+/* The index file consists of a few header lines followed by one line
+ * per revision, giving the end offset of the respective revision record:
+ *
+ *   SVN-dump-index-version: 1
+ *   Header-length: <offset of the first revision record>
+ *   Start-revision: <first revision in the dump file>
+ *
+ *   <end of first revision record>
+ *   <end of second revision record>
+ *   ...
+ */
+#define INDEX_VERSION 1
+
+#define INDEX_VERSION_HEADER "SVN-dump-index-version: "
+#define HEADER_LENGTH_HEADER "Header-length: "
+#define START_REVISION_HEADER "Start-revision: "
+
+svn_repos__dump_index_t *
+svn_repos__dump_index_create(apr_pool_t *result_pool)
+{
+  svn_repos__dump_index_t *index = apr_pcalloc(result_pool, sizeof(*index));
+
+  index->start_rev = SVN_INVALID_REVNUM;
+  index->rev_ends = apr_array_make(result_pool, 16, sizeof(apr_off_t));
+
+  return index;
+}
+
+svn_error_t *
+svn_repos__dump_index_write(svn_stream_t *stream,
+                            const svn_repos__dump_index_t *index,
+                            apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *buffer = svn_stringbuf_create_empty(scratch_pool);
+  int i;
+
+  SVN_ERR(svn_stream_printf(stream, scratch_pool,
+                            INDEX_VERSION_HEADER "%d\n"
+                            HEADER_LENGTH_HEADER "%" APR_OFF_T_FMT "\n"
+                            START_REVISION_HEADER "%ld\n\n",
+                            INDEX_VERSION, index->header_length,
+                            index->start_rev));
+
+  /* The index may cover millions of revisions.  Write it in larger
+     blocks instead of line by line. */
+  for (i = 0; i < index->rev_ends->nelts; ++i)
+    {
+      svn_stringbuf_appendcstr(buffer,
+                               apr_psprintf(scratch_pool,
+                                            "%" APR_OFF_T_FMT "\n",
+                                            APR_ARRAY_IDX(index->rev_ends, i,
+                                                          apr_off_t)));
+      if (   buffer->len > SVN__STREAM_CHUNK_SIZE
+          || i + 1 == index->rev_ends->nelts)
+        {
+          SVN_ERR(svn_stream_write(stream, buffer->data, &buffer->len));
+          svn_stringbuf_setempty(buffer);
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Read the next line from STREAM, which must start with PREFIX, and
+   set *VALUE to the remainder of that line.  Use POOL for all
+   allocations. */
+static svn_error_t *
+read_index_header(const char **value,
+                  svn_stream_t *stream,
+                  const char *prefix,
+                  apr_pool_t *pool)
+{
+  svn_stringbuf_t *line;
+  svn_boolean_t eof;
+
+  SVN_ERR(svn_stream_readline(stream, &line, "\n", &eof, pool));
+  if (eof || strncmp(line->data, prefix, strlen(prefix)))
+    return svn_error_createf(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                             _("Dump index lacks the '%s' header"),
+                             prefix);
+
+  *value = line->data + strlen(prefix);
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__dump_index_read(svn_repos__dump_index_t **index,
+                           svn_stream_t *stream,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool)
+{
+  svn_repos__dump_index_t *result
+    = svn_repos__dump_index_create(result_pool);
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  const char *value;
+  apr_int64_t number;
+  int version;
+  svn_stringbuf_t *line;
+  svn_boolean_t eof;
+
+  SVN_ERR(read_index_header(&value, stream, INDEX_VERSION_HEADER,
+                            scratch_pool));
+  SVN_ERR(svn_cstring_atoi(&version, value));
+  if (version != INDEX_VERSION)
+    return svn_error_createf(SVN_ERR_STREAM_UNRECOGNIZED_DATA, NULL,
+                             _("Unsupported dump index version %d"),
+                             version);
+
+  SVN_ERR(read_index_header(&value, stream, HEADER_LENGTH_HEADER,
+                            scratch_pool));
+  SVN_ERR(svn_cstring_atoi64(&number, value));
+  result->header_length = (apr_off_t)number;
+
+  SVN_ERR(read_index_header(&value, stream, START_REVISION_HEADER,
+                            scratch_pool));
+  SVN_ERR(svn_revnum_parse(&result->start_rev, value, NULL));
+
+  /* An empty line terminates the headers. */
+  SVN_ERR(svn_stream_readline(stream, &line, "\n", &eof, scratch_pool));
+  if (eof || line->len)
+    return svn_error_create(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                            _("Dump index headers are not terminated by"
+                              " an empty line"));
+
+  while (TRUE)
+    {
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_stream_readline(stream, &line, "\n", &eof, iterpool));
+      if (eof && line->len == 0)
+        break;
+
+      SVN_ERR(svn_cstring_atoi64(&number, line->data));
+      APR_ARRAY_PUSH(result->rev_ends, apr_off_t) = (apr_off_t)number;
+
+      if (eof)
+        break;
+    }
+
+  svn_pool_destroy(iterpool);
+  *index = result;
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for a stream reading a sequence of sections from a file. */
+typedef struct range_stream_baton_t
+{
+  apr_file_t *file;
+
+  /* The sections to read: start offsets and lengths. */
+  apr_off_t offsets[2];
+  apr_off_t lengths[2];
+
+  /* The section we are currently reading.  Positioning the file at its
+     start is deferred until the first read. */
+  int current;
+  svn_boolean_t positioned;
+
+  /* Pool to use for the file operations. */
+  apr_pool_t *pool;
+} range_stream_baton_t;
+
+/* Implements svn_read_fn_t for range streams. */
+static svn_error_t *
+read_handler_range(void *baton,
+                   char *buffer,
+                   apr_size_t *len)
+{
+  range_stream_baton_t *b = baton;
+  apr_size_t total = 0;
+
+  while (total < *len && b->current < 2)
+    {
+      apr_size_t to_read;
+      apr_size_t bytes_read;
+      svn_boolean_t hit_eof;
+
+      if (b->lengths[b->current] == 0)
+        {
+          ++b->current;
+          b->positioned = FALSE;
+          continue;
+        }
+
+      if (!b->positioned)
+        {
+          apr_off_t offset = b->offsets[b->current];
+          SVN_ERR(svn_io_file_seek(b->file, APR_SET, &offset, b->pool));
+          b->positioned = TRUE;
+        }
+
+      to_read = *len - total;
+      if ((apr_off_t)to_read > b->lengths[b->current])
+        to_read = (apr_size_t)b->lengths[b->current];
+
+      SVN_ERR(svn_io_file_read_full2(b->file, buffer + total, to_read,
+                                     &bytes_read, &hit_eof, b->pool));
+      if (hit_eof && bytes_read < to_read)
+        return svn_error_create(SVN_ERR_STREAM_UNEXPECTED_EOF, NULL,
+                                _("Dump file is shorter than its index"));
+
+      total += bytes_read;
+      b->offsets[b->current] += bytes_read;
+      b->lengths[b->current] -= bytes_read;
+    }
+
+  *len = total;
+  return SVN_NO_ERROR;
+}
+
+/* Verify that the revision record for REVISION starts at OFFSET in FILE.
+   Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+verify_record_start(apr_file_t *file,
+                    apr_off_t offset,
+                    svn_revnum_t revision,
+                    apr_pool_t *scratch_pool)
+{
+  const char *expected = apr_psprintf(scratch_pool,
+                                      SVN_REPOS_DUMPFILE_REVISION_NUMBER
+                                      ": %ld\n", revision);
+  apr_size_t len = strlen(expected);
+  char *buffer = apr_palloc(scratch_pool, len);
+  apr_size_t bytes_read;
+
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+  SVN_ERR(svn_io_file_read_full2(file, buffer, len, &bytes_read, NULL,
+                                 scratch_pool));
+  if (bytes_read != len || memcmp(buffer, expected, len))
+    return svn_error_createf(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                             _("Dump file does not match its index:"
+                               " no record for revision %ld at offset %s"),
+                             revision,
+                             apr_off_t_toa(scratch_pool, offset));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__dump_index_range(svn_stream_t **stream,
+                            apr_file_t *file,
+                            const svn_repos__dump_index_t *index,
+                            svn_revnum_t start_rev,
+                            svn_revnum_t end_rev,
+                            apr_pool_t *result_pool)
+{
+  range_stream_baton_t *baton = apr_pcalloc(result_pool, sizeof(*baton));
+  int count = index->rev_ends->nelts;
+  int first;
+  int last;
+  svn_filesize_t file_size;
+  apr_off_t expected_size;
+
+  if (start_rev > end_rev)
+    return svn_error_createf(SVN_ERR_REPOS_BAD_ARGS, NULL,
+                             _("Start revision %ld"
+                               " is greater than end revision %ld"),
+                             start_rev, end_rev);
+
+  /* Clip the revision range to what the index covers. */
+  first = (start_rev > index->start_rev)
+        ? (int)MIN(start_rev - index->start_rev, count)
+        : 0;
+  last = (end_rev >= index->start_rev)
+       ? (int)MIN(end_rev - index->start_rev, count - 1)
+       : -1;
+
+  /* Make sure that INDEX actually describes FILE.  The size must match
+     exactly and the selected records, as well as the one following them,
+     must start where the index says they do.  This catches indexes that
+     belong to a different or a since modified dump file. */
+  expected_size = count
+                ? APR_ARRAY_IDX(index->rev_ends, count - 1, apr_off_t)
+                : index->header_length;
+  SVN_ERR(svn_io_file_size_get(&file_size, file, result_pool));
+  if (file_size != expected_size)
+    return svn_error_createf(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                             _("Dump file does not match its index:"
+                               " expected %s bytes, found %s"),
+                             apr_off_t_toa(result_pool, expected_size),
+                             apr_off_t_toa(result_pool,
+                                           (apr_off_t)file_size));
+
+  if (first <= last)
+    {
+      SVN_ERR(verify_record_start(file,
+                                  first
+                                    ? APR_ARRAY_IDX(index->rev_ends,
+                                                    first - 1, apr_off_t)
+                                    : index->header_length,
+                                  index->start_rev + first, result_pool));
+      if (last + 1 < count)
+        SVN_ERR(verify_record_start(file,
+                                    APR_ARRAY_IDX(index->rev_ends, last,
+                                                  apr_off_t),
+                                    index->start_rev + last + 1,
+                                    result_pool));
+    }
+
+  baton->file = file;
+  baton->pool = result_pool;
+
+  /* The header records are always needed. */
+  baton->offsets[0] = 0;
+  baton->lengths[0] = index->header_length;
+
+  /* Followed by the selected revision records, if any. */
+  if (first <= last)
+    {
+      baton->offsets[1] = first
+                        ? APR_ARRAY_IDX(index->rev_ends, first - 1, apr_off_t)
+                        : index->header_length;
+      baton->lengths[1] = APR_ARRAY_IDX(index->rev_ends, last, apr_off_t)
+                        - baton->offsets[1];
+    }
+
+  *stream = svn_stream_create(baton, result_pool);
+  svn_stream_set_read2(*stream, NULL, read_handler_range);
+
+  return SVN_NO_ERROR;
+}
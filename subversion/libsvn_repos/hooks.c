@@ -26,6 +26,7 @@
 
 #include <apr_pools.h>
 #include <apr_file_io.h>
+#include <apr_thread_proc.h>
 
 #include "svn_config.h"
 #include "svn_hash.h"
@@ -37,7 +38,9 @@
 #include "svn_utf.h"
 #include "repos.h"
 #include "svn_private_config.h"
+#include "private/svn_atomic.h"
 #include "private/svn_fs_private.h"
+#include "private/svn_mutex.h"
 #include "private/svn_repos_private.h"
 #include "private/svn_string_private.h"
 
@@ -45,40 +48,29 @@
 
 /*** Hook drivers. ***/
 
-/* Helper function for run_hook_cmd().  Wait for a hook to finish
-   executing and return either SVN_NO_ERROR if the hook script completed
-   without error, or an error describing the reason for failure.
+/* Helper function for check_hook_result() and run_daemon_hook().
+   Return either SVN_NO_ERROR if the hook NAME completed without error,
+   or an error describing the reason for failure.
 
-   NAME and CMD are the name and path of the hook program, CMD_PROC
-   is a pointer to the structure representing the running process,
-   and READ_ERRHANDLE is an open handle to the hook's stderr.
+   EXITCODE and EXITWHY describe how the hook terminated.  NATIVE_STDERR
+   is the hook's stderr output, unless reading that failed with ERR2.
+   This function takes ownership of ERR2.
 
-   Hooks are considered to have failed if we are unable to wait for the
-   process, if we are unable to read from the hook's stderr, if the
-   process has failed to exit cleanly (due to a coredump, for example),
-   or if the process returned a non-zero return code.
+   Hooks are considered to have failed if we are unable to read from the
+   hook's stderr, if the process has failed to exit cleanly (due to a
+   coredump, for example), or if the process returned a non-zero return
+   code.
 
    Any error output returned by the hook's stderr will be included in an
    error message, though the presence of output on stderr is not itself
    a reason to fail a hook. */
 static svn_error_t *
-check_hook_result(const char *name, const char *cmd, apr_proc_t *cmd_proc,
-                  apr_file_t *read_errhandle, apr_pool_t *pool)
+check_hook_status(const char *name, int exitcode, apr_exit_why_e exitwhy,
+                  svn_stringbuf_t *native_stderr, svn_error_t *err2,
+                  apr_pool_t *pool)
 {
-  svn_error_t *err, *err2;
-  svn_stringbuf_t *native_stderr, *failure_message;
+  svn_stringbuf_t *failure_message;
   const char *utf8_stderr;
-  int exitcode;
-  apr_exit_why_e exitwhy;
-
-  err2 = svn_stringbuf_from_aprfile(&native_stderr, read_errhandle, pool);
-
-  err = svn_io_wait_for_cmd(cmd_proc, cmd, &exitcode, &exitwhy, pool);
-  if (err)
-    {
-      svn_error_clear(err2);
-      return svn_error_trace(err);
-    }
 
   if (APR_PROC_CHECK_EXIT(exitwhy) && exitcode == 0)
     {
@@ -158,10 +150,42 @@ check_hook_result(const char *name, const char *cmd, apr_proc_t *cmd_proc,
                                _(" with no output."));
     }
 
-  return svn_error_create(SVN_ERR_REPOS_HOOK_FAILURE, err,
+  return svn_error_create(SVN_ERR_REPOS_HOOK_FAILURE, NULL,
                           failure_message->data);
 }
 
+/* Helper function for run_hook_cmd().  Wait for a hook to finish
+   executing and return either SVN_NO_ERROR if the hook script completed
+   without error, or an error describing the reason for failure.
+
+   NAME and CMD are the name and path of the hook program, CMD_PROC
+   is a pointer to the structure representing the running process,
+   and READ_ERRHANDLE is an open handle to the hook's stderr.
+
+   Besides the reasons given for check_hook_status(), hooks are also
+   considered to have failed if we are unable to wait for the process. */
+static svn_error_t *
+check_hook_result(const char *name, const char *cmd, apr_proc_t *cmd_proc,
+                  apr_file_t *read_errhandle, apr_pool_t *pool)
+{
+  svn_error_t *err, *err2;
+  svn_stringbuf_t *native_stderr;
+  int exitcode;
+  apr_exit_why_e exitwhy;
+
+  err2 = svn_stringbuf_from_aprfile(&native_stderr, read_errhandle, pool);
+
+  err = svn_io_wait_for_cmd(cmd_proc, cmd, &exitcode, &exitwhy, pool);
+  if (err)
+    {
+      svn_error_clear(err2);
+      return svn_error_trace(err);
+    }
+
+  return svn_error_trace(check_hook_status(name, exitcode, exitwhy,
+                                           native_stderr, err2, pool));
+}
+
 /* Copy the environment given as key/value pairs of ENV_HASH into
  * an array of C strings allocated in RESULT_POOL.
  * If the hook environment is empty, return NULL.
@@ -193,11 +217,505 @@ env_from_env_hash(apr_hash_t *env_hash,
   return env;
 }
 
+/* Check if the HOOK program exists and is a file or a symbolic link, using
+   POOL for temporary allocations.
+
+   If the hook exists but is a broken symbolic link, set *BROKEN_LINK
+   to TRUE, else if the hook program exists set *BROKEN_LINK to FALSE.
+
+   Return the hook program if found, else return NULL and don't touch
+   *BROKEN_LINK.
+*/
+static const char*
+check_hook_cmd(const char *hook, svn_boolean_t *broken_link, apr_pool_t *pool)
+{
+  static const char* const check_extns[] = {
+#ifdef WIN32
+  /* For WIN32, we need to check with file name extension(s) added.
+
+     As Windows Scripting Host (.wsf) files can accommodate (at least)
+     JavaScript (.js) and VB Script (.vbs) code, extensions for the
+     corresponding file types need not be enumerated explicitly. */
+    ".exe", ".cmd", ".bat", ".wsf", /* ### Any other extensions? */
+#else
+    "",
+#endif
+    NULL
+  };
+
+  const char *const *extn;
+  svn_error_t *err = NULL;
+  svn_boolean_t is_special;
+  for (extn = check_extns; *extn; ++extn)
+    {
+      const char *const hook_path =
+        (**extn ? apr_pstrcat(pool, hook, *extn, SVN_VA_NULL) : hook);
+
+      svn_node_kind_t kind;
+      if (!(err = svn_io_check_resolved_path(hook_path, &kind, pool))
+          && kind == svn_node_file)
+        {
+          *broken_link = FALSE;
+          return hook_path;
+        }
+      svn_error_clear(err);
+      if (!(err = svn_io_check_special_path(hook_path, &kind, &is_special,
+                                            pool))
+          && is_special)
+        {
+          *broken_link = TRUE;
+          return hook_path;
+        }
+      svn_error_clear(err);
+    }
+  return NULL;
+}
+
+/* Return an error for the failure of HOOK due to a broken symlink. */
+static svn_error_t *
+hook_symlink_error(const char *hook)
+{
+  return svn_error_createf
+    (SVN_ERR_REPOS_HOOK_FAILURE, NULL,
+     _("Failed to run '%s' hook; broken symlink"), hook);
+}
+
+/* Return the environment configured in HOOKS_ENV for the hook NAME, or
+   the default environment if there is none for NAME.  Return NULL if
+   HOOKS_ENV is NULL. */
+static apr_hash_t *
+get_hook_env(apr_hash_t *hooks_env,
+             const char *name)
+{
+  apr_hash_t *hook_env = NULL;
+
+  /* Check if a custom environment is defined for this hook, or else
+   * whether a default environment is defined. */
+  if (hooks_env)
+    {
+      hook_env = svn_hash_gets(hooks_env, name);
+      if (hook_env == NULL)
+        hook_env = svn_hash_gets(hooks_env,
+                                 SVN_REPOS__HOOKS_ENV_DEFAULT_SECTION);
+    }
+
+  return hook_env;
+}
+
+
+/*** Hook daemon. ***/
+
+/* If the hooks directory contains a program named SVN_REPOS__HOOK_DAEMON,
+ * we send all hook invocations to it instead of starting a new process
+ * for every hook.  Requests go to the daemon's stdin and responses are
+ * read from its stdout.  Both consist of fields, each being written as
+ *
+ *   <length of the contents in bytes, as decimal number>\n
+ *   <contents>\n
+ *
+ * A request consists of the hook name, the number of arguments followed
+ * by the arguments themselves, the number of environment variables
+ * followed by NAME=VALUE pairs and finally the hook's stdin data.  The
+ * response consists of the exit code, stdout and stderr of the hook.
+ *
+ * Every daemon process handles one request at a time.  To let concurrent
+ * hook invocations proceed in parallel, we keep a pool of idle daemon
+ * processes per daemon program and start another one whenever all of
+ * them are busy.  They live for as long as this process does, i.e. a
+ * server that forks per connection gets new daemons for every
+ * connection.  Hence, the daemon mainly helps servers that serve many
+ * connections from one process, like a threaded svnserve.
+ *
+ * The hook-daemon.tmpl file in the repository describes this in more
+ * detail.
+ */
+
+/* How long we wait for a hook daemon to process a request before we
+   consider it hung and fail the hook. */
+#define HOOK_DAEMON_TIMEOUT apr_time_from_sec(600)
+
+/* A running hook daemon process and the pipes to talk to it. */
+typedef struct hook_daemon_channel_t
+{
+  /* The daemon process, including the pipes to its stdin and stdout. */
+  apr_proc_t *proc;
+
+  /* Pool containing PROC.  Destroying it terminates the daemon. */
+  apr_pool_t *pool;
+} hook_daemon_channel_t;
+
+/* A hook daemon program and its idle processes. */
+typedef struct hook_daemon_t
+{
+  /* Absolute path of the daemon program. */
+  const char *path;
+
+  /* Serializes access to IDLE. */
+  svn_mutex__t *mutex;
+
+  /* hook_daemon_channel_t * of all daemon processes that are currently
+     not handling a request.  Processes that failed are not put back. */
+  apr_array_header_t *idle;
+} hook_daemon_t;
+
+/* All hook daemons known to this process, keyed by the path of the
+ * program without any executable extension.  The entries are never
+ * removed; once the program is gone, the entry will simply have no idle
+ * processes. */
+static apr_hash_t *hook_daemons = NULL;
+static svn_mutex__t *hook_daemons_lock = NULL;
+static svn_atomic_t hook_daemons_initialized = FALSE;
+
+/* Implements svn_atomic__err_init_func_t. */
+static svn_error_t *
+initialize_hook_daemons(void *baton, apr_pool_t *pool)
+{
+  /* The daemons shall live as long as this process. */
+  apr_pool_t *global_pool = svn_pool_create(NULL);
+
+  hook_daemons = apr_hash_make(global_pool);
+  SVN_ERR(svn_mutex__init(&hook_daemons_lock, TRUE, global_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *DAEMON to the entry for KEY in the HOOK_DAEMONS registry.  If
+   CMD is not NULL, add a new entry for the daemon program at CMD if
+   there is none, else set *DAEMON to NULL in that case.
+   Must be called while holding HOOK_DAEMONS_LOCK. */
+static svn_error_t *
+get_hook_daemon(hook_daemon_t **daemon,
+                const char *key,
+                const char *cmd)
+{
+  apr_pool_t *global_pool = apr_hash_pool_get(hook_daemons);
+
+  *daemon = svn_hash_gets(hook_daemons, key);
+  if (*daemon == NULL && cmd)
+    {
+      /* Each daemon gets its own pool because its IDLE list grows
+         under its own mutex only. */
+      apr_pool_t *daemon_pool = svn_pool_create(NULL);
+
+      *daemon = apr_pcalloc(daemon_pool, sizeof(**daemon));
+      (*daemon)->path = apr_pstrdup(daemon_pool, cmd);
+      (*daemon)->idle = apr_array_make(daemon_pool, 1,
+                                       sizeof(hook_daemon_channel_t *));
+      SVN_ERR(svn_mutex__init(&(*daemon)->mutex, TRUE, daemon_pool));
+
+      svn_hash_sets(hook_daemons, apr_pstrdup(global_pool, key), *daemon);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Terminate the process of CHANNEL. */
+static void
+stop_hook_daemon(hook_daemon_channel_t *channel)
+{
+  svn_pool_destroy(channel->pool);
+}
+
+/* Terminate all idle processes of DAEMON. */
+static svn_error_t *
+stop_idle_hook_daemons(hook_daemon_t *daemon)
+{
+  SVN_ERR(svn_mutex__lock(daemon->mutex));
+  while (daemon->idle->nelts)
+    stop_hook_daemon(APR_ARRAY_IDX(daemon->idle, --daemon->idle->nelts,
+                                   hook_daemon_channel_t *));
+
+  return svn_error_trace(svn_mutex__unlock(daemon->mutex, SVN_NO_ERROR));
+}
+
+/* Set *DAEMON to the hook daemon of REPOS or to NULL, if REPOS does not
+   have a hook daemon.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+find_hook_daemon(hook_daemon_t **daemon,
+                 svn_repos_t *repos,
+                 apr_pool_t *scratch_pool)
+{
+  const char *key;
+  const char *cmd;
+  svn_boolean_t broken_link;
+
+  SVN_ERR(svn_atomic__init_once(&hook_daemons_initialized,
+                                initialize_hook_daemons, NULL,
+                                scratch_pool));
+
+  SVN_ERR(svn_dirent_get_absolute(&key,
+                                  svn_dirent_join(repos->hook_path,
+                                                  SVN_REPOS__HOOK_DAEMON,
+                                                  scratch_pool),
+                                  scratch_pool));
+
+  /* The daemon program may have been removed since we last used it.
+     Look for it every time, so that we go back to running the hook
+     programs directly as soon as it is gone. */
+  cmd = check_hook_cmd(key, &broken_link, scratch_pool);
+  if (cmd && broken_link)
+    return hook_symlink_error(cmd);
+
+  SVN_MUTEX__WITH_LOCK(hook_daemons_lock,
+                       get_hook_daemon(daemon, key, cmd));
+
+  if (!cmd && *daemon)
+    {
+      /* Don't keep processes of a program that no longer exists. */
+      SVN_ERR(stop_idle_hook_daemons(*daemon));
+      *daemon = NULL;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Start a new process of DAEMON for the repository at REPOS_PATH with
+   the environment configured in HOOKS_ENV and return it in *CHANNEL.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+start_hook_daemon(hook_daemon_channel_t **channel,
+                  hook_daemon_t *daemon,
+                  const char *repos_path,
+                  apr_hash_t *hooks_env,
+                  apr_pool_t *scratch_pool)
+{
+  apr_pool_t *proc_pool = svn_pool_create(NULL);
+  apr_proc_t *proc = apr_pcalloc(proc_pool, sizeof(*proc));
+  apr_file_t *null_handle;
+  const char *args[3];
+  svn_error_t *err;
+
+  args[0] = daemon->path;
+  args[1] = repos_path;
+  args[2] = NULL;
+
+  /* The daemon's stderr may be the server's protocol channel. */
+  err = svn_io_file_open(&null_handle, SVN_NULL_DEVICE_NAME, APR_WRITE,
+                         APR_OS_DEFAULT, proc_pool);
+  if (!err)
+    err = svn_io_start_cmd3(proc, ".", daemon->path, args,
+                            env_from_env_hash(get_hook_env(
+                                                hooks_env,
+                                                SVN_REPOS__HOOK_DAEMON),
+                                              proc_pool, scratch_pool),
+                            FALSE, TRUE, NULL, TRUE, NULL, FALSE,
+                            null_handle, proc_pool);
+  if (err)
+    {
+      svn_pool_destroy(proc_pool);
+      return svn_error_createf(SVN_ERR_REPOS_HOOK_FAILURE, err,
+                               _("Failed to start hook daemon '%s'"),
+                               daemon->path);
+    }
+
+  /* When we shut the daemon down, it will see EOF on its stdin and
+     should exit.  Don't wait for it forever, though. */
+  apr_pool_note_subprocess(proc_pool, proc, APR_KILL_AFTER_TIMEOUT);
+
+  /* A hung daemon must not block the hook forever. */
+  apr_file_pipe_timeout_set(proc->in, HOOK_DAEMON_TIMEOUT);
+  apr_file_pipe_timeout_set(proc->out, HOOK_DAEMON_TIMEOUT);
+
+  *channel = apr_pcalloc(proc_pool, sizeof(**channel));
+  (*channel)->proc = proc;
+  (*channel)->pool = proc_pool;
+
+  return SVN_NO_ERROR;
+}
+
+/* Append a hook daemon protocol field with the LEN bytes at DATA
+   to BUFFER. */
+static void
+append_field(svn_stringbuf_t *buffer,
+             const char *data,
+             apr_size_t len)
+{
+  char len_buffer[SVN_INT64_BUFFER_SIZE];
+
+  svn__ui64toa(len_buffer, len);
+  svn_stringbuf_appendcstr(buffer, len_buffer);
+  svn_stringbuf_appendbyte(buffer, '\n');
+  svn_stringbuf_appendbytes(buffer, data, len);
+  svn_stringbuf_appendbyte(buffer, '\n');
+}
+
+/* Append a hook daemon protocol field containing the decimal
+   representation of VALUE to BUFFER. */
+static void
+append_number_field(svn_stringbuf_t *buffer,
+                    apr_size_t value)
+{
+  char value_buffer[SVN_INT64_BUFFER_SIZE];
+  apr_size_t len = svn__ui64toa(value_buffer, value);
+
+  append_field(buffer, value_buffer, len);
+}
+
+/* Read the next hook daemon protocol field from FILE and return its
+   contents in *FIELD.  Allocate *FIELD in POOL. */
+static svn_error_t *
+read_field(svn_stringbuf_t **field,
+           apr_file_t *file,
+           apr_pool_t *pool)
+{
+  char len_buffer[SVN_INT64_BUFFER_SIZE];
+  apr_uint64_t len;
+  apr_size_t i;
+  char c = 0;
+
+  /* The pipe is unbuffered but the length line is short. */
+  for (i = 0; i < sizeof(len_buffer); ++i)
+    {
+      SVN_ERR(svn_io_file_getc(&c, file, pool));
+      if (c == '\n')
+        break;
+
+      len_buffer[i] = c;
+    }
+
+  if (c != '\n')
+    return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL,
+                            _("Malformed field length in hook daemon "
+                              "response"));
+
+  len_buffer[i] = '\0';
+  SVN_ERR(svn_cstring_strtoui64(&len, len_buffer, 0, APR_SIZE_MAX - 1, 10));
+
+  /* Read the contents plus the terminating newline. */
+  *field = svn_stringbuf_create_ensure((apr_size_t)len, pool);
+  SVN_ERR(svn_io_file_read_full2(file, (*field)->data, (apr_size_t)len + 1,
+                                 NULL, NULL, pool));
+  if ((*field)->data[len] != '\n')
+    return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL,
+                            _("Unterminated field in hook daemon "
+                              "response"));
+
+  (*field)->data[len] = '\0';
+  (*field)->len = (apr_size_t)len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Send REQUEST to the daemon process CHANNEL.  Return the hook's exit
+   code in *EXITCODE and its stdout and stderr output in *NATIVE_STDOUT
+   and *NATIVE_STDERR, respectively.  Allocate the results in POOL. */
+static svn_error_t *
+hook_daemon_request(int *exitcode,
+                    svn_stringbuf_t **native_stdout,
+                    svn_stringbuf_t **native_stderr,
+                    hook_daemon_channel_t *channel,
+                    const svn_stringbuf_t *request,
+                    apr_pool_t *pool)
+{
+  svn_stringbuf_t *exitcode_field;
+
+  SVN_ERR(svn_io_file_write_full(channel->proc->in, request->data,
+                                 request->len, NULL, pool));
+
+  SVN_ERR(read_field(&exitcode_field, channel->proc->out, pool));
+  SVN_ERR(read_field(native_stdout, channel->proc->out, pool));
+  SVN_ERR(read_field(native_stderr, channel->proc->out, pool));
+
+  return svn_error_trace(svn_cstring_atoi(exitcode, exitcode_field->data));
+}
+
+/* Like run_hook_cmd() but have DAEMON run the hook.  REPOS_PATH is the
+   path of the repository the daemon serves.  HOOK_ENV is the environment
+   for this particular hook, while HOOKS_ENV is the full hooks-env
+   configuration. */
+static svn_error_t *
+run_daemon_hook(svn_string_t **result,
+                hook_daemon_t *daemon,
+                const char *repos_path,
+                const char *name,
+                const char **args,
+                const char **hook_env,
+                apr_hash_t *hooks_env,
+                apr_file_t *stdin_handle,
+                apr_pool_t *pool)
+{
+  svn_stringbuf_t *request = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *native_stdout, *native_stderr;
+  svn_stringbuf_t *input;
+  hook_daemon_channel_t *channel = NULL;
+  int exitcode;
+  int count;
+  svn_error_t *err;
+
+  append_field(request, name, strlen(name));
+
+  for (count = 0; args[count]; ++count)
+    ;
+  append_number_field(request, count);
+  for (count = 0; args[count]; ++count)
+    append_field(request, args[count], strlen(args[count]));
+
+  for (count = 0; hook_env && hook_env[count]; ++count)
+    ;
+  append_number_field(request, count);
+  for (count = 0; hook_env && hook_env[count]; ++count)
+    append_field(request, hook_env[count], strlen(hook_env[count]));
+
+  if (stdin_handle)
+    SVN_ERR(svn_stringbuf_from_aprfile(&input, stdin_handle, pool));
+  else
+    input = svn_stringbuf_create_empty(pool);
+  append_field(request, input->data, input->len);
+
+  /* Take an idle daemon process or start a new one if all are busy.
+     The request itself runs without holding any lock. */
+  SVN_ERR(svn_mutex__lock(daemon->mutex));
+  if (daemon->idle->nelts)
+    channel = APR_ARRAY_IDX(daemon->idle, --daemon->idle->nelts,
+                            hook_daemon_channel_t *);
+  SVN_ERR(svn_mutex__unlock(daemon->mutex, SVN_NO_ERROR));
+
+  if (channel)
+    err = SVN_NO_ERROR;
+  else
+    err = start_hook_daemon(&channel, daemon, repos_path, hooks_env, pool);
+
+  if (!err)
+    err = hook_daemon_request(&exitcode, &native_stdout, &native_stderr,
+                              channel, request, pool);
+
+  if (err)
+    {
+      /* We can't tell how much of the conversation got through.  Don't
+         reuse this process. */
+      if (channel)
+        stop_hook_daemon(channel);
+    }
+  else
+    {
+      SVN_ERR(svn_mutex__lock(daemon->mutex));
+      APR_ARRAY_PUSH(daemon->idle, hook_daemon_channel_t *) = channel;
+      err = svn_mutex__unlock(daemon->mutex, SVN_NO_ERROR);
+    }
+
+  if (err)
+    return svn_error_createf(SVN_ERR_REPOS_HOOK_FAILURE, err,
+                             _("'%s' hook failed; no response from hook "
+                               "daemon '%s'"),
+                             name, daemon->path);
+
+  SVN_ERR(check_hook_status(name, exitcode, APR_PROC_EXIT, native_stderr,
+                            SVN_NO_ERROR, pool));
+
+  if (result)
+    *result = svn_stringbuf__morph_into_string(native_stdout);
+
+  return SVN_NO_ERROR;
+}
+
 /* NAME, CMD and ARGS are the name, path to and arguments for the hook
    program that is to be run.  The hook's exit status will be checked,
    and if an error occurred the hook's stderr output will be added to
    the returned error.
 
+   If REPOS has a hook daemon, send the hook invocation to the daemon
+   instead of running CMD.
+
    If STDIN_HANDLE is non-null, pass it as the hook's stdin, else pass
    no stdin to the hook.
 
@@ -205,6 +723,7 @@ env_from_env_hash(apr_hash_t *env_hash,
    a zero-length string if the hook generates no output on stdout. */
 static svn_error_t *
 run_hook_cmd(svn_string_t **result,
+             svn_repos_t *repos,
              const char *name,
              const char *cmd,
              const char **args,
@@ -217,7 +736,19 @@ run_hook_cmd(svn_string_t **result,
   svn_error_t *err;
   apr_proc_t cmd_proc = {0};
   apr_pool_t *cmd_pool;
-  apr_hash_t *hook_env = NULL;
+  hook_daemon_t *daemon;
+  const char **hook_env;
+
+  hook_env = env_from_env_hash(get_hook_env(hooks_env, name), pool, pool);
+
+  SVN_ERR(find_hook_daemon(&daemon, repos, pool));
+  if (daemon)
+    return svn_error_trace(run_daemon_hook(result, daemon,
+                                           svn_dirent_local_style(
+                                             svn_repos_path(repos, pool),
+                                             pool),
+                                           name, args, hook_env, hooks_env,
+                                           stdin_handle, pool));
 
   if (result)
     {
@@ -237,18 +768,7 @@ run_hook_cmd(svn_string_t **result,
    * destroy in order to clean up the stderr pipe opened for the process. */
   cmd_pool = svn_pool_create(pool);
 
-  /* Check if a custom environment is defined for this hook, or else
-   * whether a default environment is defined. */
-  if (hooks_env)
-    {
-      hook_env = svn_hash_gets(hooks_env, name);
-      if (hook_env == NULL)
-        hook_env = svn_hash_gets(hooks_env,
-                                 SVN_REPOS__HOOKS_ENV_DEFAULT_SECTION);
-    }
-
-  err = svn_io_start_cmd3(&cmd_proc, ".", cmd, args,
-                          env_from_env_hash(hook_env, pool, pool),
+  err = svn_io_start_cmd3(&cmd_proc, ".", cmd, args, hook_env,
                           FALSE, FALSE, stdin_handle, result != NULL,
                           null_handle, TRUE, NULL, cmd_pool);
   if (!err)
@@ -302,60 +822,6 @@ create_temp_file(apr_file_t **f, const svn_string_t *value, apr_pool_t *pool)
 }
 
 
-/* Check if the HOOK program exists and is a file or a symbolic link, using
-   POOL for temporary allocations.
-
-   If the hook exists but is a broken symbolic link, set *BROKEN_LINK
-   to TRUE, else if the hook program exists set *BROKEN_LINK to FALSE.
-
-   Return the hook program if found, else return NULL and don't touch
-   *BROKEN_LINK.
-*/
-static const char*
-check_hook_cmd(const char *hook, svn_boolean_t *broken_link, apr_pool_t *pool)
-{
-  static const char* const check_extns[] = {
-#ifdef WIN32
-  /* For WIN32, we need to check with file name extension(s) added.
-
-     As Windows Scripting Host (.wsf) files can accommodate (at least)
-     JavaScript (.js) and VB Script (.vbs) code, extensions for the
-     corresponding file types need not be enumerated explicitly. */
-    ".exe", ".cmd", ".bat", ".wsf", /* ### Any other extensions? */
-#else
-    "",
-#endif
-    NULL
-  };
-
-  const char *const *extn;
-  svn_error_t *err = NULL;
-  svn_boolean_t is_special;
-  for (extn = check_extns; *extn; ++extn)
-    {
-      const char *const hook_path =
-        (**extn ? apr_pstrcat(pool, hook, *extn, SVN_VA_NULL) : hook);
-
-      svn_node_kind_t kind;
-      if (!(err = svn_io_check_resolved_path(hook_path, &kind, pool))
-          && kind == svn_node_file)
-        {
-          *broken_link = FALSE;
-          return hook_path;
-        }
-      svn_error_clear(err);
-      if (!(err = svn_io_check_special_path(hook_path, &kind, &is_special,
-                                            pool))
-          && is_special)
-        {
-          *broken_link = TRUE;
-          return hook_path;
-        }
-      svn_error_clear(err);
-    }
-  return NULL;
-}
-
 /* Baton for parse_hooks_env_option. */
 struct parse_hooks_env_option_baton {
   /* The name of the section being parsed. If not the default section,
@@ -445,15 +911,6 @@ svn_repos__parse_hooks_env(apr_hash_t **hooks_env_p,
   return SVN_NO_ERROR;
 }
 
-/* Return an error for the failure of HOOK due to a broken symlink. */
-static svn_error_t *
-hook_symlink_error(const char *hook)
-{
-  return svn_error_createf
-    (SVN_ERR_REPOS_HOOK_FAILURE, NULL,
-     _("Failed to run '%s' hook; broken symlink"), hook);
-}
-
 svn_error_t *
 svn_repos__hooks_start_commit(svn_repos_t *repos,
                               apr_hash_t *hooks_env,
@@ -491,8 +948,8 @@ svn_repos__hooks_start_commit(svn_repos_t *repos,
       args[4] = txn_name;
       args[5] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_START_COMMIT, hook, args,
-                           hooks_env, NULL, pool));
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_START_COMMIT,
+                           hook, args, hooks_env, NULL, pool));
     }
 
   return SVN_NO_ERROR;
@@ -578,8 +1035,8 @@ svn_repos__hooks_pre_commit(svn_repos_t *repos,
         SVN_ERR(svn_io_file_open(&stdin_handle, SVN_NULL_DEVICE_NAME,
                                  APR_READ, APR_OS_DEFAULT, pool));
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_PRE_COMMIT, hook, args,
-                           hooks_env, stdin_handle, pool));
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_PRE_COMMIT,
+                           hook, args, hooks_env, stdin_handle, pool));
     }
 
   return SVN_NO_ERROR;
@@ -610,8 +1067,8 @@ svn_repos__hooks_post_commit(svn_repos_t *repos,
       args[3] = txn_name;
       args[4] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_COMMIT, hook, args,
-                           hooks_env, NULL, pool));
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_POST_COMMIT,
+                           hook, args, hooks_env, NULL, pool));
     }
 
   return SVN_NO_ERROR;
@@ -659,8 +1116,8 @@ svn_repos__hooks_pre_revprop_change(svn_repos_t *repos,
       args[5] = action_string;
       args[6] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_PRE_REVPROP_CHANGE, hook,
-                           args, hooks_env, stdin_handle, pool));
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_PRE_REVPROP_CHANGE,
+                           hook, args, hooks_env, stdin_handle, pool));
 
       SVN_ERR(svn_io_file_close(stdin_handle, pool));
     }
@@ -722,8 +1179,8 @@ svn_repos__hooks_post_revprop_change(svn_repos_t *repos,
       args[5] = action_string;
       args[6] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_REVPROP_CHANGE, hook,
-                           args, hooks_env, stdin_handle, pool));
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_POST_REVPROP_CHANGE,
+                           hook, args, hooks_env, stdin_handle, pool));
 
       SVN_ERR(svn_io_file_close(stdin_handle, pool));
     }
@@ -763,8 +1220,8 @@ svn_repos__hooks_pre_lock(svn_repos_t *repos,
       args[5] = steal_lock ? "1" : "0";
       args[6] = NULL;
 
-      SVN_ERR(run_hook_cmd(&buf, SVN_REPOS__HOOK_PRE_LOCK, hook, args,
-                           hooks_env, NULL, pool));
+      SVN_ERR(run_hook_cmd(&buf, repos, SVN_REPOS__HOOK_PRE_LOCK,
+                           hook, args, hooks_env, NULL, pool));
 
       if (token)
         /* No validation here; the FS will take care of that. */
@@ -808,8 +1265,8 @@ svn_repos__hooks_post_lock(svn_repos_t *repos,
       args[3] = NULL;
       args[4] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_LOCK, hook, args,
-                           hooks_env, stdin_handle, pool));
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_POST_LOCK,
+                           hook, args, hooks_env, stdin_handle, pool));
 
       SVN_ERR(svn_io_file_close(stdin_handle, pool));
     }
@@ -846,8 +1303,8 @@ svn_repos__hooks_pre_unlock(svn_repos_t *repos,
       args[5] = break_lock ? "1" : "0";
       args[6] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_PRE_UNLOCK, hook, args,
-                           hooks_env, NULL, pool));
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_PRE_UNLOCK,
+                           hook, args, hooks_env, NULL, pool));
     }
 
   return SVN_NO_ERROR;
@@ -884,8 +1341,8 @@ svn_repos__hooks_post_unlock(svn_repos_t *repos,
       args[3] = NULL;
       args[4] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_UNLOCK, hook, args,
-                           hooks_env, stdin_handle, pool));
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_POST_UNLOCK,
+                           hook, args, hooks_env, stdin_handle, pool));
 
       SVN_ERR(svn_io_file_close(stdin_handle, pool));
     }
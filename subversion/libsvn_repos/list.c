@@ -26,6 +26,7 @@
 #include "svn_pools.h"
 #include "svn_error.h"
 #include "svn_dirent_uri.h"
+#include "svn_hash.h"
 #include "svn_time.h"
 
 #include "private/svn_repos_private.h"
@@ -93,17 +94,109 @@ svn_repos_stat(svn_dirent_t **dirent,
   return SVN_NO_ERROR;
 }
 
-/* Return TRUE of DIRNAME matches any of the const char * in PATTERNS.
- * Note that any DIRNAME will match if PATTERNS is empty.
- * Use SCRATCH_BUFFER for temporary string contents. */
+/* The search patterns given to svn_repos_list, prepared for matching
+ * large numbers of names. */
+typedef struct list_patterns_t
+{
+  /* Patterns that don't contain any wildcards, used as keys.
+   * These match by simple lookup. */
+  apr_hash_t *literals;
+
+  /* All other patterns (const char *). */
+  apr_array_header_t *globs;
+
+  /* For each entry in GLOBS, the length of the literal part before the
+   * first wildcard (apr_size_t).  Names not starting with that prefix
+   * can't match and don't need to go through apr_fnmatch. */
+  apr_array_header_t *prefix_lengths;
+} list_patterns_t;
+
+/* Characters that apr_fnmatch treats specially. */
+#define GLOB_SPECIAL_CHARS "*?[\\"
+
+/* Return the const char * in PATTERNS in a form prepared for matching.
+ * Return NULL if PATTERNS is NULL.  Allocate the result in RESULT_POOL.
+ */
+static list_patterns_t *
+prepare_patterns(const apr_array_header_t *patterns,
+                 apr_pool_t *result_pool)
+{
+  list_patterns_t *result;
+  int i;
+
+  if (!patterns)
+    return NULL;
+
+  result = apr_pcalloc(result_pool, sizeof(*result));
+  result->literals = apr_hash_make(result_pool);
+  result->globs = apr_array_make(result_pool, patterns->nelts,
+                                 sizeof(const char *));
+  result->prefix_lengths = apr_array_make(result_pool, patterns->nelts,
+                                          sizeof(apr_size_t));
+
+  for (i = 0; i < patterns->nelts; ++i)
+    {
+      const char *pattern = APR_ARRAY_IDX(patterns, i, const char *);
+      apr_size_t prefix_length = strcspn(pattern, GLOB_SPECIAL_CHARS);
+
+      if (pattern[prefix_length] == '\0')
+        {
+          svn_hash_sets(result->literals, pattern, pattern);
+        }
+      else
+        {
+          APR_ARRAY_PUSH(result->globs, const char *) = pattern;
+          APR_ARRAY_PUSH(result->prefix_lengths, apr_size_t) = prefix_length;
+        }
+    }
+
+  return result;
+}
+
+/* Return TRUE of DIRNAME matches any of the PATTERNS.
+ * Note that any DIRNAME will match if PATTERNS is NULL.
+ * Use SCRATCH_BUFFER for temporary string contents.
+ *
+ * This is equivalent to svn_utf__fuzzy_glob_match but avoids most of
+ * the apr_fnmatch calls for non-matching names. */
 static svn_boolean_t
 matches_any(const char *dirname,
-            const apr_array_header_t *patterns,
+            const list_patterns_t *patterns,
             svn_membuf_t *scratch_buffer)
 {
-  return patterns
-       ? svn_utf__fuzzy_glob_match(dirname, patterns, scratch_buffer)
-       : TRUE;
+  const char *normalized;
+  svn_error_t *err;
+  int i;
+
+  if (!patterns)
+    return TRUE;
+
+  /* Try to normalize case and accents in DIRNAME.
+   *
+   * If that should fail for some reason, consider DIRNAME a mismatch. */
+  err = svn_utf__xfrm(&normalized, dirname, strlen(dirname), TRUE, TRUE,
+                      scratch_buffer);
+  if (err)
+    {
+      svn_error_clear(err);
+      return FALSE;
+    }
+
+  if (svn_hash_gets(patterns->literals, normalized))
+    return TRUE;
+
+  for (i = 0; i < patterns->globs->nelts; ++i)
+    {
+      const char *pattern = APR_ARRAY_IDX(patterns->globs, i, const char *);
+      apr_size_t prefix_length = APR_ARRAY_IDX(patterns->prefix_lengths, i,
+                                               apr_size_t);
+
+      if (   strncmp(pattern, normalized, prefix_length) == 0
+          && apr_fnmatch(pattern, normalized, 0) == APR_SUCCESS)
+        return TRUE;
+    }
+
+  return FALSE;
 }
 
 /* Utility to prevent code duplication.
@@ -136,26 +229,118 @@ report_dirent(svn_fs_root_t *root,
   return SVN_NO_ERROR;
 }
 
-/* Utility data struct, used to attach a filter result flag to a dirent. */
-typedef struct filtered_dirent_t
+/* Directory entry to report or to recurse into.  We keep one array of
+ * these per tree level while recursing, so this is kept minimal. */
+typedef struct list_entry_t
 {
-  /* Actual dirent, never NULL. */
-  svn_fs_dirent_t *dirent;
+  /* Name of the entry, never NULL. */
+  const char *name;
 
-  /* DIRENT passed the filter. */
+  /* Node kind of the entry. */
+  svn_node_kind_t kind;
+
+  /* The entry passed the filter. */
   svn_boolean_t is_match;
-} filtered_dirent_t;
+} list_entry_t;
 
-/* Implement a standard sort function for filtered_dirent_t *, sorting them
+/* Implement a standard sort function for list_entry_t *, sorting them
  * by entry name. */
 static int
-compare_filtered_dirent(const void *lhs,
-                        const void *rhs)
+compare_list_entry(const void *lhs,
+                   const void *rhs)
+{
+  const list_entry_t *lhs_entry = (const list_entry_t *)lhs;
+  const list_entry_t *rhs_entry = (const list_entry_t *)rhs;
+
+  return strcmp(lhs_entry->name, rhs_entry->name);
+}
+
+/* Set *ENTRIES_P to the list_entry_t for all entries of directory PATH
+ * under ROOT that do_list needs to report or to recurse into, sorted
+ * by name.  PATTERNS, DEPTH, AUTHZ_READ_FUNC and AUTHZ_READ_BATON are
+ * the same as for do_list.
+ *
+ * Allocate the result in RESULT_POOL.  All temporaries, including the
+ * full directory contents, go into SCRATCH_POOL.  Use SCRATCH_BUFFER for
+ * temporary string contents.
+ */
+static svn_error_t *
+get_list_entries(apr_array_header_t **entries_p,
+                 svn_fs_root_t *root,
+                 const char *path,
+                 const list_patterns_t *patterns,
+                 svn_depth_t depth,
+                 svn_repos_authz_func_t authz_read_func,
+                 void *authz_read_baton,
+                 svn_membuf_t *scratch_buffer,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
 {
-  const filtered_dirent_t *lhs_dirent = (const filtered_dirent_t *)lhs;
-  const filtered_dirent_t *rhs_dirent = (const filtered_dirent_t *)rhs;
+  apr_hash_t *dirents;
+  apr_hash_index_t *hi;
+  apr_array_header_t *entries;
+  int i, count;
+
+  /* Filter according to DEPTH and PATTERNS first.  This is cheap and
+   * usually removes most entries when searching. */
+  SVN_ERR(svn_fs_dir_entries(&dirents, root, path, scratch_pool));
+  entries = apr_array_make(result_pool, apr_hash_count(dirents),
+                           sizeof(list_entry_t));
+  for (hi = apr_hash_first(scratch_pool, dirents); hi; hi = apr_hash_next(hi))
+    {
+      svn_fs_dirent_t *dirent = apr_hash_this_val(hi);
+      list_entry_t entry;
+
+      /* Skip directories if we want to report files only. */
+      if (dirent->kind == svn_node_dir && depth == svn_depth_files)
+        continue;
+
+      /* We can skip entries that don't match any of the search patterns,
+       * unless we need to look for matches further down the tree. */
+      entry.is_match = matches_any(dirent->name, patterns, scratch_buffer);
+      if (   !entry.is_match
+          && (dirent->kind != svn_node_dir || depth != svn_depth_infinity))
+        continue;
+
+      entry.name = apr_pstrdup(result_pool, dirent->name);
+      entry.kind = dirent->kind;
+      APR_ARRAY_PUSH(entries, list_entry_t) = entry;
+    }
+
+  svn_sort__array(entries, compare_list_entry);
+
+  /* Check access to all remaining entries in one go, removing the ones
+   * we may not see. */
+  if (authz_read_func && entries->nelts)
+    {
+      apr_array_header_t *paths = apr_array_make(scratch_pool,
+                                                 entries->nelts,
+                                                 sizeof(const char *));
+      svn_boolean_t *has_access = apr_palloc(scratch_pool,
+                                             entries->nelts
+                                               * sizeof(*has_access));
+
+      for (i = 0; i < entries->nelts; ++i)
+        APR_ARRAY_PUSH(paths, const char *)
+          = svn_dirent_join(path,
+                            APR_ARRAY_IDX(entries, i, list_entry_t).name,
+                            scratch_pool);
+
+      SVN_ERR(svn_repos__authz_read_many(has_access, authz_read_func,
+                                         authz_read_baton, root, paths,
+                                         scratch_pool));
+
+      for (i = 0, count = 0; i < entries->nelts; ++i)
+        if (has_access[i])
+          APR_ARRAY_IDX(entries, count++, list_entry_t)
+            = APR_ARRAY_IDX(entries, i, list_entry_t);
+
+      entries->nelts = count;
+    }
+
+  *entries_p = entries;
 
-  return strcmp(lhs_dirent->dirent->name, rhs_dirent->dirent->name);
+  return SVN_NO_ERROR;
 }
 
 /* Core of svn_repos_list with the same parameter list.
@@ -163,12 +348,15 @@ compare_filtered_dirent(const void *lhs,
  * However, DEPTH is not svn_depth_empty and PATH has already been reported.
  * Therefore, we can call this recursively.
  *
+ * The tree is traversed depth-first.  Per tree level, we only keep the
+ * names and kinds of the entries still to process.
+ *
  * Uses SCRATCH_BUFFER for temporary string contents.
  */
 static svn_error_t *
 do_list(svn_fs_root_t *root,
         const char *path,
-        const apr_array_header_t *patterns,
+        const list_patterns_t *patterns,
         svn_depth_t depth,
         svn_boolean_t path_info_only,
         svn_repos_authz_func_t authz_read_func,
@@ -180,72 +368,29 @@ do_list(svn_fs_root_t *root,
         svn_membuf_t *scratch_buffer,
         apr_pool_t *scratch_pool)
 {
-  apr_hash_t *entries;
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
-  apr_hash_index_t *hi;
-  apr_array_header_t *sorted;
+  apr_array_header_t *entries;
   int i;
 
-  /* Fetch all directory entries, filter and sort them.
-   *
-   * Performance trade-off:
-   * Constructing a full path vs. faster sort due to authz filtering.
-   * We filter according to DEPTH and PATTERNS only because constructing
-   * the full path required for authz is somewhat expensive and we don't
-   * want to do this twice while authz will rarely filter paths out.
-   */
-  SVN_ERR(svn_fs_dir_entries(&entries, root, path, scratch_pool));
-  sorted = apr_array_make(scratch_pool, apr_hash_count(entries),
-                          sizeof(filtered_dirent_t));
-  for (hi = apr_hash_first(scratch_pool, entries); hi; hi = apr_hash_next(hi))
-    {
-      filtered_dirent_t filtered;
-      svn_pool_clear(iterpool);
-
-      filtered.dirent = apr_hash_this_val(hi);
-
-      /* Skip directories if we want to report files only. */
-      if (filtered.dirent->kind == svn_node_dir && depth == svn_depth_files)
-        continue;
-
-      /* We can skip files that don't match any of the search patterns. */
-      filtered.is_match = matches_any(filtered.dirent->name, patterns,
-                                      scratch_buffer);
-      if (!filtered.is_match && filtered.dirent->kind == svn_node_file)
-        continue;
-
-      APR_ARRAY_PUSH(sorted, filtered_dirent_t) = filtered;
-    }
-
-  svn_sort__array(sorted, compare_filtered_dirent);
+  /* Fetch, filter and sort the directory entries.  The full directory
+   * contents get released right after that. */
+  SVN_ERR(get_list_entries(&entries, root, path, patterns, depth,
+                           authz_read_func, authz_read_baton,
+                           scratch_buffer, scratch_pool, iterpool));
 
   /* Iterate over all remaining directory entries and report them.
    * Recurse into sub-directories if requested. */
-  for (i = 0; i < sorted->nelts; ++i)
+  for (i = 0; i < entries->nelts; ++i)
     {
       const char *sub_path;
-      filtered_dirent_t *filtered;
-      svn_fs_dirent_t *dirent;
+      list_entry_t *entry = &APR_ARRAY_IDX(entries, i, list_entry_t);
 
       svn_pool_clear(iterpool);
-
-      filtered = &APR_ARRAY_IDX(sorted, i, filtered_dirent_t);
-      dirent = filtered->dirent;
-
-      /* Skip paths that we don't have access to? */
-      sub_path = svn_dirent_join(path, dirent->name, iterpool);
-      if (authz_read_func)
-        {
-          svn_boolean_t has_access;
-          SVN_ERR(authz_read_func(&has_access, root, sub_path,
-                                  authz_read_baton, iterpool));
-          if (!has_access)
-            continue;
-        }
+      sub_path = svn_dirent_join(path, entry->name, iterpool);
 
       /* Report entry, if it passed the filter. */
-      if (filtered->is_match)
-        SVN_ERR(report_dirent(root, sub_path, dirent->kind, path_info_only,
+      if (entry->is_match)
+        SVN_ERR(report_dirent(root, sub_path, entry->kind, path_info_only,
                               receiver, receiver_baton, iterpool));
 
       /* Check for cancellation before recursing down.  This should be
@@ -254,7 +399,7 @@ do_list(svn_fs_root_t *root,
         SVN_ERR(cancel_func(cancel_baton));
 
       /* Recurse on directories. */
-      if (depth == svn_depth_infinity && dirent->kind == svn_node_dir)
+      if (depth == svn_depth_infinity && entry->kind == svn_node_dir)
         SVN_ERR(do_list(root, sub_path, patterns, svn_depth_infinity,
                         path_info_only, authz_read_func, authz_read_baton,
                         receiver, receiver_baton, cancel_func,
@@ -281,6 +426,7 @@ svn_repos_list(svn_fs_root_t *root,
                apr_pool_t *scratch_pool)
 {
   svn_membuf_t scratch_buffer;
+  list_patterns_t *prepared_patterns;
 
   /* Parameter check. */
   svn_node_kind_t kind;
@@ -322,16 +468,17 @@ svn_repos_list(svn_fs_root_t *root,
   /* We need a scratch buffer for temporary string data.
    * Create one with a reasonable initial size. */
   svn_membuf__create(&scratch_buffer, 256, scratch_pool);
+  prepared_patterns = prepare_patterns(patterns, scratch_pool);
 
   /* Actually report PATH, if it passes the filters. */
-  if (matches_any(svn_dirent_basename(path, scratch_pool), patterns,
+  if (matches_any(svn_dirent_basename(path, scratch_pool), prepared_patterns,
                   &scratch_buffer))
     SVN_ERR(report_dirent(root, path, kind, path_info_only,
                           receiver, receiver_baton, scratch_pool));
 
   /* Report directory contents if requested. */
   if (depth > svn_depth_empty)
-    SVN_ERR(do_list(root, path, patterns, depth,
+    SVN_ERR(do_list(root, path, prepared_patterns, depth,
                     path_info_only, authz_read_func, authz_read_baton,
                     receiver, receiver_baton, cancel_func, cancel_baton,
                     &scratch_buffer, scratch_pool));
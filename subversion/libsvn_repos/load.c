@@ -33,6 +33,7 @@
 #include "svn_ctype.h"
 
 #include "private/svn_dep_compat.h"
+#include "private/svn_repos_private.h"
 
 /*----------------------------------------------------------------------*/
 
@@ -53,6 +54,37 @@ stream_malformed(void)
                           _("Dumpstream data appears to be malformed"));
 }
 
+/* Consume LENGTH bytes from STREAM without looking at them.  If STREAM
+   supports it, this will simply seek forward. */
+static svn_error_t *
+skip_content(svn_stream_t *stream,
+             svn_filesize_t length)
+{
+  char last_byte;
+  apr_size_t len = 1;
+
+  if (length <= 0)
+    return SVN_NO_ERROR;
+
+  while (length > 1)
+    {
+      apr_size_t chunk = (apr_uint64_t)(length - 1) > APR_SIZE_MAX
+                       ? APR_SIZE_MAX
+                       : (apr_size_t)(length - 1);
+
+      SVN_ERR(svn_stream_skip(stream, chunk));
+      length -= chunk;
+    }
+
+  /* Seeking beyond the end of the stream does not fail.  Actually read
+     the last byte to detect truncated streams. */
+  SVN_ERR(svn_stream_read_full(stream, &last_byte, &len));
+  if (len != 1)
+    return stream_ran_dry();
+
+  return SVN_NO_ERROR;
+}
+
 /* Allocate a new hash *HEADERS in POOL, and read a series of
    RFC822-style headers from STREAM.  Duplicate each header's name and
    value into POOL and store in hash as a const char * ==> const char *.
@@ -317,8 +349,10 @@ parse_text_block(svn_stream_t *stream,
       SVN_ERR(parse_fns->set_fulltext(&text_stream, record_baton));
     }
 
-  /* Regardless of whether or not we have a sink for our data, we
-     need to read it. */
+  /* Nobody is interested in the data.  Don't read it if we can avoid it. */
+  if (! text_stream)
+    return svn_error_trace(skip_content(stream, content_length));
+
   while (content_length)
     {
       if (content_length >= (svn_filesize_t)buflen)
@@ -565,6 +599,25 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
                             svn_cancel_func_t cancel_func,
                             void *cancel_baton,
                             apr_pool_t *pool)
+{
+  return svn_error_trace(svn_repos__parse_dumpstream(stream, parse_fns,
+                                                     parse_baton,
+                                                     deltas_are_text,
+                                                     NULL,
+                                                     cancel_func,
+                                                     cancel_baton,
+                                                     pool));
+}
+
+svn_error_t *
+svn_repos__parse_dumpstream(svn_stream_t *stream,
+                            const svn_repos_parse_fns3_t *parse_fns,
+                            void *parse_baton,
+                            svn_boolean_t deltas_are_text,
+                            svn_repos__parse_skip_node_func_t skip_node_func,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *pool)
 {
   svn_boolean_t eof;
   svn_stringbuf_t *linebuf;
@@ -612,6 +665,7 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
       const char *text_cl;
       const char *value;
       svn_filesize_t actual_prop_length;
+      svn_boolean_t skip_node = FALSE;
 
       /* Clear our per-line pool. */
       svn_pool_clear(linepool);
@@ -666,6 +720,9 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
                                              rev_baton,
                                              nodepool));
           found_node = TRUE;
+
+          if (skip_node_func)
+            SVN_ERR(skip_node_func(&skip_node, node_baton));
         }
       /* Or is this the repos UUID? */
       else if ((value = svn_hash_gets(headers, SVN_REPOS_DUMPFILE_UUID)))
@@ -701,6 +758,24 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
       old_v1_with_cl =
         version == 1 && content_length && ! prop_cl && ! text_cl;
 
+      /* The consumer is not interested in this node's contents. */
+      if (skip_node)
+        {
+          svn_filesize_t length;
+
+          if (content_length)
+            length = svn__atoui64(content_length);
+          else
+            length = (prop_cl ? svn__atoui64(prop_cl) : 0)
+                   + (text_cl ? svn__atoui64(text_cl) : 0);
+
+          SVN_ERR(skip_content(stream, length));
+          SVN_ERR(parse_fns->close_node(node_baton));
+          svn_pool_clear(nodepool);
+
+          continue;
+        }
+
       /* Is there a props content-block to parse? */
       if (prop_cl || old_v1_with_cl)
         {
@@ -783,7 +858,6 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
       */
       if (content_length && ! old_v1_with_cl)
         {
-          apr_size_t rlen, num_to_read;
           svn_filesize_t remaining =
             svn__atoui64(content_length) -
             (prop_cl ? svn__atoui64(prop_cl) : 0) -
@@ -796,19 +870,7 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
                                       "total block content length"));
 
           /* Consume remaining bytes in this content block */
-          while (remaining > 0)
-            {
-              if (remaining >= (svn_filesize_t)buflen)
-                rlen = buflen;
-              else
-                rlen = (apr_size_t) remaining;
-
-              num_to_read = rlen;
-              SVN_ERR(svn_stream_read_full(stream, buffer, &rlen));
-              remaining -= rlen;
-              if (rlen != num_to_read)
-                return stream_ran_dry();
-            }
+          SVN_ERR(skip_content(stream, remaining));
         }
 
       /* If we just finished processing a node record, we need to
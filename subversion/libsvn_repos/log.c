@@ -38,9 +38,11 @@
 #include "svn_props.h"
 #include "svn_mergeinfo.h"
 #include "repos.h"
+#include "prefetch.h"
 #include "private/svn_fspath.h"
 #include "private/svn_fs_private.h"
 #include "private/svn_mergeinfo_private.h"
+#include "private/svn_repos_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_string_private.h"
@@ -56,6 +58,11 @@ typedef struct log_callbacks_t
   void *revision_receiver_baton;
   svn_repos_authz_func_t authz_read_func;
   void *authz_read_baton;
+
+  /* The helper thread reading ahead of the top-level do_logs and what it
+     reads.  PREFETCHER may be NULL. */
+  svn_repos__prefetcher_t *prefetcher;
+  struct log_prefetch_t *prefetch;
 } log_callbacks_t;
 
 
@@ -124,7 +131,10 @@ svn_repos_check_revision_access(svn_repos_revision_access_level_t *access_level,
   svn_fs_path_change3_t *change;
   svn_boolean_t found_readable = FALSE;
   svn_boolean_t found_unreadable = FALSE;
+  apr_array_header_t *paths, *added;
+  svn_boolean_t *readable;
   apr_pool_t *iterpool;
+  int i;
 
   /* By default, we'll grant full read access to REVISION. */
   *access_level = svn_repos_revision_access_full;
@@ -140,72 +150,68 @@ svn_repos_check_revision_access(svn_repos_revision_access_level_t *access_level,
 
   /* No changed paths?  We're done.
 
-     Note that the check at "decision:" assumes that at least one
-     path has been processed.  So, this actually affects functionality. */
+     Note that the checks at the end assume that at least one path has
+     been processed.  So, this actually affects functionality. */
   if (!change)
     return SVN_NO_ERROR;
 
   /* Otherwise, we have to check the readability of each changed
-     path, or at least enough to answer the question asked. */
-  iterpool = svn_pool_create(pool);
+     path, or at least enough to answer the question asked.  Check all
+     changed paths in one batch.  That is much cheaper than checking them
+     one by one in the order of the changes list. */
+  paths = apr_array_make(pool, 16, sizeof(const char *));
+  added = apr_array_make(pool, 16, sizeof(const char *));
   while (change)
     {
-      svn_boolean_t readable;
+      const char *path = apr_pstrmemdup(pool, change->path.data,
+                                        change->path.len);
+      APR_ARRAY_PUSH(paths, const char *) = path;
 
-      svn_pool_clear(iterpool);
+      if (   change->change_kind == svn_fs_path_change_add
+          || change->change_kind == svn_fs_path_change_replace)
+        APR_ARRAY_PUSH(added, const char *) = path;
 
-      SVN_ERR(authz_read_func(&readable, rev_root, change->path.data,
-                              authz_read_baton, iterpool));
-      if (! readable)
-        found_unreadable = TRUE;
-      else
-        found_readable = TRUE;
+      SVN_ERR(svn_fs_path_change_get(&change, iterator));
+    }
 
-      /* If we have at least one of each (readable/unreadable), we
-         have our answer. */
-      if (found_readable && found_unreadable)
-        goto decision;
+  readable = apr_palloc(pool, paths->nelts * sizeof(*readable));
+  SVN_ERR(svn_repos__authz_read_many(readable, authz_read_func,
+                                     authz_read_baton, rev_root, paths,
+                                     pool));
+  for (i = 0; i < paths->nelts; ++i)
+    if (readable[i])
+      found_readable = TRUE;
+    else
+      found_unreadable = TRUE;
 
-      switch (change->change_kind)
-        {
-        case svn_fs_path_change_add:
-        case svn_fs_path_change_replace:
-          {
-            const char *copyfrom_path;
-            svn_revnum_t copyfrom_rev;
+  /* If we have at least one of each (readable/unreadable), we
+     have our answer.  Otherwise, copy sources may make a difference. */
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < added->nelts && !(found_readable && found_unreadable); ++i)
+    {
+      const char *path = APR_ARRAY_IDX(added, i, const char *);
+      const char *copyfrom_path;
+      svn_revnum_t copyfrom_rev;
 
-            SVN_ERR(svn_fs_copied_from(&copyfrom_rev, &copyfrom_path,
-                                       rev_root, change->path.data,
-                                       iterpool));
-            if (copyfrom_path && SVN_IS_VALID_REVNUM(copyfrom_rev))
-              {
-                svn_fs_root_t *copyfrom_root;
-                SVN_ERR(svn_fs_revision_root(&copyfrom_root, fs,
-                                             copyfrom_rev, iterpool));
-                SVN_ERR(authz_read_func(&readable,
-                                        copyfrom_root, copyfrom_path,
-                                        authz_read_baton, iterpool));
-                if (! readable)
-                  found_unreadable = TRUE;
-
-                /* If we have at least one of each (readable/unreadable), we
-                   have our answer. */
-                if (found_readable && found_unreadable)
-                  goto decision;
-              }
-          }
-          break;
+      svn_pool_clear(iterpool);
 
-        case svn_fs_path_change_delete:
-        case svn_fs_path_change_modify:
-        default:
-          break;
-        }
+      SVN_ERR(svn_fs_copied_from(&copyfrom_rev, &copyfrom_path,
+                                 rev_root, path, iterpool));
+      if (copyfrom_path && SVN_IS_VALID_REVNUM(copyfrom_rev))
+        {
+          svn_fs_root_t *copyfrom_root;
+          svn_boolean_t copyfrom_readable;
 
-      SVN_ERR(svn_fs_path_change_get(&change, iterator));
+          SVN_ERR(svn_fs_revision_root(&copyfrom_root, fs,
+                                       copyfrom_rev, iterpool));
+          SVN_ERR(authz_read_func(&copyfrom_readable,
+                                  copyfrom_root, copyfrom_path,
+                                  authz_read_baton, iterpool));
+          if (! copyfrom_readable)
+            found_unreadable = TRUE;
+        }
     }
 
- decision:
   svn_pool_destroy(iterpool);
 
   /* Either every changed path was unreadable... */
@@ -221,6 +227,61 @@ svn_repos_check_revision_access(svn_repos_revision_access_level_t *access_level,
 }
 
 
+/* Maximum number of changes that detect_changed processes as a batch. */
+#define CHANGES_BATCH_SIZE 1024
+
+/* Clear CHANGES and fill it with copies of up to CHANGES_BATCH_SIZE
+ * changes (svn_fs_path_change3_t *) from ITERATOR.  Set the respective
+ * elements of READABLE to whether CALLBACKS->AUTHZ_READ_FUNC grants access
+ * to the changed path under ROOT, checking all paths in one batch.  Without
+ * an authz callback, all paths are readable.
+ *
+ * Allocate the copies in RESULT_POOL.
+ */
+static svn_error_t *
+next_changes_batch(apr_array_header_t *changes,
+                   svn_boolean_t *readable,
+                   svn_fs_path_change_iterator_t *iterator,
+                   svn_fs_root_t *root,
+                   const log_callbacks_t *callbacks,
+                   apr_pool_t *result_pool)
+{
+  svn_fs_path_change3_t *change;
+  int i;
+
+  apr_array_clear(changes);
+  while (changes->nelts < CHANGES_BATCH_SIZE)
+    {
+      SVN_ERR(svn_fs_path_change_get(&change, iterator));
+      if (!change)
+        break;
+
+      APR_ARRAY_PUSH(changes, svn_fs_path_change3_t *)
+        = svn_fs_path_change3_dup(change, result_pool);
+    }
+
+  if (callbacks->authz_read_func && changes->nelts)
+    {
+      apr_array_header_t *paths = apr_array_make(result_pool, changes->nelts,
+                                                 sizeof(const char *));
+      for (i = 0; i < changes->nelts; ++i)
+        APR_ARRAY_PUSH(paths, const char *)
+          = APR_ARRAY_IDX(changes, i, svn_fs_path_change3_t *)->path.data;
+
+      SVN_ERR(svn_repos__authz_read_many(readable,
+                                         callbacks->authz_read_func,
+                                         callbacks->authz_read_baton,
+                                         root, paths, result_pool));
+    }
+  else
+    {
+      for (i = 0; i < changes->nelts; ++i)
+        readable[i] = TRUE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Find all significant changes under ROOT and, if not NULL, report them
  * to the CALLBACKS->PATH_CHANGE_RECEIVER.  "Significant" means that the
  * text or properties of the node were changed, or that the node was added
@@ -252,16 +313,27 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
                apr_pool_t *scratch_pool)
 {
   svn_fs_path_change_iterator_t *iterator;
-  svn_fs_path_change3_t *change;
-  apr_pool_t *iterpool;
+  apr_array_header_t *changes;
+  svn_boolean_t *readable;
+  apr_pool_t *iterpool, *batch_pool;
   svn_boolean_t found_readable = FALSE;
   svn_boolean_t found_unreadable = FALSE;
+  int i;
+
+  /* Retrieve the first batch of changes in the list.  Checking the
+     readability of many paths at once is much cheaper than checking
+     them one by one. */
+  changes = apr_array_make(scratch_pool, CHANGES_BATCH_SIZE,
+                           sizeof(svn_fs_path_change3_t *));
+  readable = apr_palloc(scratch_pool,
+                        CHANGES_BATCH_SIZE * sizeof(*readable));
+  batch_pool = svn_pool_create(scratch_pool);
 
-  /* Retrieve the first change in the list. */
   SVN_ERR(svn_fs_paths_changed3(&iterator, root, scratch_pool, scratch_pool));
-  SVN_ERR(svn_fs_path_change_get(&change, iterator));
+  SVN_ERR(next_changes_batch(changes, readable, iterator, root, callbacks,
+                             batch_pool));
 
-  if (!change)
+  if (changes->nelts == 0)
     {
       /* No paths changed in this revision?  Uh, sure, I guess the
          revision is readable, then.  */
@@ -270,27 +342,35 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
     }
 
   iterpool = svn_pool_create(scratch_pool);
-  while (change)
+  for (i = 0; ; ++i)
     {
       /* NOTE:  Much of this loop is going to look quite similar to
          svn_repos_check_revision_access(), but we have to do more things
          here, so we'll live with the duplication. */
-      const char *path = change->path.data;
+      svn_fs_path_change3_t *change;
+      const char *path;
+
+      /* Continue with the next batch once we are through this one. */
+      if (i == changes->nelts)
+        {
+          svn_pool_clear(batch_pool);
+          SVN_ERR(next_changes_batch(changes, readable, iterator, root,
+                                     callbacks, batch_pool));
+          if (changes->nelts == 0)
+            break;
+
+          i = 0;
+        }
+
+      change = APR_ARRAY_IDX(changes, i, svn_fs_path_change3_t *);
+      path = change->path.data;
       svn_pool_clear(iterpool);
 
       /* Skip path if unreadable. */
-      if (callbacks->authz_read_func)
+      if (! readable[i])
         {
-          svn_boolean_t readable;
-          SVN_ERR(callbacks->authz_read_func(&readable, root, path,
-                                             callbacks->authz_read_baton,
-                                             iterpool));
-          if (! readable)
-            {
-              found_unreadable = TRUE;
-              SVN_ERR(svn_fs_path_change_get(&change, iterator));
-              continue;
-            }
+          found_unreadable = TRUE;
+          continue;
         }
 
       /* At least one changed-path was readable. */
@@ -382,12 +462,10 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
                                      callbacks->path_change_receiver_baton,
                                      change,
                                      iterpool));
-
-      /* Next changed path. */
-      SVN_ERR(svn_fs_path_change_get(&change, iterator));
     }
 
   svn_pool_destroy(iterpool);
+  svn_pool_destroy(batch_pool);
 
   if (! found_readable)
     {
@@ -1935,6 +2013,249 @@ store_search(svn_mergeinfo_t processed,
   return SVN_NO_ERROR;
 }
 
+/* Number of revisions that the log prefetcher may read ahead of the
+   revision being processed. */
+#define LOG_PREFETCH_LOOKAHEAD 16
+
+/* Reading a revision's changed paths and revprops from a cold cache is
+   dominated by I/O latency.  The same goes for walking node histories and
+   reading mergeinfo.  For long logs, we therefore let a helper thread read
+   the data of the next few revisions while we are processing the current
+   one.  It simply discards what it reads; the only point is to get that
+   data into the caches shared by all FS instances of this process before
+   we ask for it. */
+typedef struct log_prefetch_t
+{
+  /* Which data to read. */
+  svn_boolean_t changes;
+  svn_boolean_t revprops;
+  svn_boolean_t mergeinfo;
+
+  /* If not NULL, walk the histories of these PATHS between HIST_START and
+     HIST_END the same way do_logs does and read the data of the revisions
+     in which they changed.  STRICT_NODE_HISTORY and DESCENDING_ORDER are
+     the same as for do_logs.  MERGEINFO is only supported in this mode. */
+  const apr_array_header_t *paths;
+  svn_revnum_t hist_start;
+  svn_revnum_t hist_end;
+  svn_boolean_t strict_node_history;
+  svn_boolean_t descending_order;
+
+  /* Otherwise, read COUNT revisions, starting at FIRST and incremented by
+     STEP. */
+  svn_revnum_t first;
+  int count;
+  int step;
+
+  /* Number of revisions processed by the log driver so far.  When walking
+     histories with ascending order, the revisions found by the walk count
+     first, followed by the revisions sent.  Protected by the prefetcher's
+     mutex. */
+  int sent;
+} log_prefetch_t;
+
+/* Wait until the log driver has gotten close enough to position INDEX in
+   the sequence of revisions that PREFETCHER reads for PREFETCH.  Set *STOP
+   if the prefetcher shall terminate instead. */
+static svn_error_t *
+log_prefetch_wait(svn_boolean_t *stop,
+                  svn_repos__prefetcher_t *prefetcher,
+                  log_prefetch_t *prefetch,
+                  int index)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_repos__prefetcher_lock(prefetcher));
+  while (   !err
+         && !svn_repos__prefetcher_stopping(prefetcher)
+         && index >= prefetch->sent + LOG_PREFETCH_LOOKAHEAD)
+    err = svn_repos__prefetcher_wait(prefetcher);
+  *stop = svn_repos__prefetcher_stopping(prefetcher);
+
+  return svn_error_trace(svn_repos__prefetcher_unlock(prefetcher, err));
+}
+
+/* Read the changed paths and revprops of REV in FS as requested by
+   PREFETCH.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+log_prefetch_revision(log_prefetch_t *prefetch,
+                      svn_fs_t *fs,
+                      svn_revnum_t rev,
+                      apr_pool_t *scratch_pool)
+{
+  if (prefetch->changes && rev > 0)
+    {
+      svn_fs_root_t *root;
+      svn_fs_path_change_iterator_t *iterator;
+      svn_fs_path_change3_t *change;
+
+      SVN_ERR(svn_fs_revision_root(&root, fs, rev, scratch_pool));
+      SVN_ERR(svn_fs_paths_changed3(&iterator, root, scratch_pool,
+                                    scratch_pool));
+      do
+        SVN_ERR(svn_fs_path_change_get(&change, iterator));
+      while (change);
+    }
+
+  if (prefetch->revprops)
+    {
+      apr_hash_t *props;
+      SVN_ERR(svn_fs_revision_proplist2(&props, fs, rev, FALSE,
+                                        scratch_pool, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Walk the histories of PREFETCH->PATHS in FS and read the data of the
+   revisions found, as described by PREFETCH.  Authz is not being checked
+   here, so we may read a few revisions that the log driver will skip.
+   PREFETCHER is the prefetcher we are running in.  Use POOL for all
+   allocations. */
+static svn_error_t *
+log_prefetch_history(svn_repos__prefetcher_t *prefetcher,
+                     log_prefetch_t *prefetch,
+                     svn_fs_t *fs,
+                     apr_pool_t *pool)
+{
+  apr_array_header_t *histories;
+  apr_array_header_t *revs = apr_array_make(pool, 64, sizeof(svn_revnum_t));
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_pool_t *iterpool2 = svn_pool_create(pool);
+  svn_boolean_t any_histories_left = TRUE;
+  svn_boolean_t stop = FALSE;
+  svn_revnum_t current;
+  int i;
+
+  SVN_ERR(get_path_histories(&histories, fs, prefetch->paths,
+                             prefetch->hist_start, prefetch->hist_end,
+                             prefetch->strict_node_history, TRUE,
+                             NULL, NULL, pool));
+
+  for (current = prefetch->hist_end;
+       any_histories_left && !stop;
+       current = next_history_rev(histories))
+    {
+      svn_boolean_t changed = FALSE;
+      any_histories_left = FALSE;
+      svn_pool_clear(iterpool);
+
+      /* Stay in sync with the history walk in do_logs. */
+      for (i = 0; i < histories->nelts; i++)
+        {
+          struct path_info *info = APR_ARRAY_IDX(histories, i,
+                                                 struct path_info *);
+
+          svn_pool_clear(iterpool2);
+          SVN_ERR(check_history(&changed, info, fs, current,
+                                prefetch->strict_node_history, NULL, NULL,
+                                prefetch->hist_start, pool, iterpool2));
+          if (! info->done)
+            any_histories_left = TRUE;
+        }
+
+      if (! changed)
+        continue;
+
+      SVN_ERR(log_prefetch_wait(&stop, prefetcher, prefetch, revs->nelts));
+      if (stop)
+        break;
+
+      APR_ARRAY_PUSH(revs, svn_revnum_t) = current;
+
+      /* Read the same mergeinfo as do_logs does for this revision. */
+      if (prefetch->mergeinfo)
+        {
+          svn_mergeinfo_t added_mergeinfo, deleted_mergeinfo;
+          apr_array_header_t *cur_paths
+            = apr_array_make(iterpool, histories->nelts,
+                             sizeof(const char *));
+
+          for (i = 0; i < histories->nelts; i++)
+            APR_ARRAY_PUSH(cur_paths, const char *)
+              = APR_ARRAY_IDX(histories, i, struct path_info *)->path->data;
+
+          SVN_ERR(get_combined_mergeinfo_changes(&added_mergeinfo,
+                                                 &deleted_mergeinfo,
+                                                 fs, cur_paths, current,
+                                                 iterpool, iterpool));
+        }
+
+      /* Descending logs get sent while walking the histories. */
+      if (prefetch->descending_order)
+        SVN_ERR(log_prefetch_revision(prefetch, fs, current, iterpool));
+    }
+
+  /* Ascending logs get sent in reverse order after the walk. */
+  if (!prefetch->descending_order)
+    for (i = 0; i < revs->nelts && !stop; ++i)
+      {
+        svn_pool_clear(iterpool);
+        SVN_ERR(log_prefetch_wait(&stop, prefetcher, prefetch,
+                                  revs->nelts + i));
+        if (!stop)
+          SVN_ERR(log_prefetch_revision(prefetch, fs,
+                                        APR_ARRAY_IDX(revs,
+                                                      revs->nelts - i - 1,
+                                                      svn_revnum_t),
+                                        iterpool));
+      }
+
+  svn_pool_destroy(iterpool2);
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos__prefetch_func_t.  Read the data of the revisions
+   described by the log_prefetch_t BATON from FS, staying no more than
+   LOG_PREFETCH_LOOKAHEAD revisions ahead of what has been processed. */
+static svn_error_t *
+prefetch_log_data(svn_repos__prefetcher_t *prefetcher,
+                  void *baton,
+                  svn_fs_t *fs,
+                  apr_pool_t *pool)
+{
+  log_prefetch_t *prefetch = baton;
+  apr_pool_t *iterpool;
+  svn_boolean_t stop = FALSE;
+  int i;
+
+  if (prefetch->paths)
+    return svn_error_trace(log_prefetch_history(prefetcher, prefetch, fs,
+                                                pool));
+
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < prefetch->count && !stop; ++i)
+    {
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(log_prefetch_wait(&stop, prefetcher, prefetch, i));
+      if (!stop)
+        SVN_ERR(log_prefetch_revision(prefetch, fs,
+                                      prefetch->first + i * prefetch->step,
+                                      iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Tell the PREFETCHER reading for PREFETCH that SENT revisions have been
+   processed.  PREFETCHER may be NULL. */
+static svn_error_t *
+log_prefetch_progress(svn_repos__prefetcher_t *prefetcher,
+                      log_prefetch_t *prefetch,
+                      int sent)
+{
+  if (!prefetcher)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_repos__prefetcher_lock(prefetcher));
+  prefetch->sent = sent;
+  return svn_error_trace(svn_repos__prefetcher_unlock(prefetcher,
+                           svn_repos__prefetcher_signal(prefetcher)));
+}
+
 /* Find logs for PATHS from HIST_START to HIST_END in FS, and invoke the
    CALLBACKS on them.  If DESCENDING_ORDER is TRUE, send the logs back as
    we find them, else buffer the logs and send them back in youngest->oldest
@@ -1992,6 +2313,7 @@ do_logs(svn_fs_t *fs,
   apr_array_header_t *histories;
   svn_boolean_t any_histories_left = TRUE;
   int send_count = 0;
+  int walk_count = 0;
   int i;
 
   if (processed)
@@ -2147,6 +2469,12 @@ do_logs(svn_fs_t *fs,
                                add_and_del_mergeinfo);
                 }
             }
+
+          /* Let the prefetcher follow our walk. */
+          if (! handling_merged_revisions)
+            SVN_ERR(log_prefetch_progress(callbacks->prefetcher,
+                                          callbacks->prefetch,
+                                          ++walk_count));
         }
     }
   svn_pool_destroy(iterpool2);
@@ -2208,6 +2536,11 @@ do_logs(svn_fs_t *fs,
                                               revprops, callbacks,
                                               iterpool));
             }
+
+          if (! handling_merged_revisions)
+            SVN_ERR(log_prefetch_progress(callbacks->prefetcher,
+                                          callbacks->prefetch,
+                                          revs->nelts + i + 1));
           if (limit && i + 1 >= limit)
             break;
         }
@@ -2325,6 +2658,8 @@ svn_repos_get_logs5(svn_repos_t *repos,
   svn_boolean_t descending_order;
   svn_mergeinfo_t paths_history_mergeinfo = NULL;
   log_callbacks_t callbacks;
+  log_prefetch_t *prefetch;
+  svn_error_t *err;
 
   callbacks.path_change_receiver = path_change_receiver;
   callbacks.path_change_receiver_baton = path_change_receiver_baton;
@@ -2332,6 +2667,8 @@ svn_repos_get_logs5(svn_repos_t *repos,
   callbacks.revision_receiver_baton = revision_receiver_baton;
   callbacks.authz_read_func = authz_read_func;
   callbacks.authz_read_baton = authz_read_baton;
+  callbacks.prefetcher = NULL;
+  callbacks.prefetch = NULL;
 
   if (revprops)
     {
@@ -2398,6 +2735,7 @@ svn_repos_get_logs5(svn_repos_t *repos,
       apr_uint64_t send_count = 0;
       int i;
       apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+      svn_repos__prefetcher_t *prefetcher = NULL;
 
       /* If we are provided an authz callback function, use it to
          verify that the user has read access to the root path in the
@@ -2424,7 +2762,24 @@ svn_repos_get_logs5(svn_repos_t *repos,
       send_count = end - start + 1;
       if (limit > 0 && send_count > limit)
         send_count = limit;
-      for (i = 0; i < send_count; ++i)
+
+      /* Read ahead in a helper thread, unless the log is too short to
+         be worth it. */
+      prefetch = apr_pcalloc(scratch_pool, sizeof(*prefetch));
+      prefetch->changes = authz_read_func || path_change_receiver;
+      prefetch->revprops = !revprops || revprops->nelts;
+      prefetch->first = descending_order ? end : start;
+      prefetch->count = (int)send_count;
+      prefetch->step = descending_order ? -1 : 1;
+
+      if (   prefetch->count > LOG_PREFETCH_LOOKAHEAD
+          && (prefetch->changes || prefetch->revprops))
+        svn_repos__prefetcher_start(&prefetcher, fs, repos->fs_config, 1,
+                                    prefetch_log_data, prefetch,
+                                    scratch_pool);
+
+      err = SVN_NO_ERROR;
+      for (i = 0; i < send_count && !err; ++i)
         {
           svn_revnum_t rev;
 
@@ -2434,13 +2789,18 @@ svn_repos_get_logs5(svn_repos_t *repos,
             rev = end - i;
           else
             rev = start + i;
-          SVN_ERR(send_log(rev, fs, NULL, NULL,
-                           FALSE, FALSE, revprops, FALSE,
-                           &callbacks, iterpool));
+          err = send_log(rev, fs, NULL, NULL,
+                         FALSE, FALSE, revprops, FALSE,
+                         &callbacks, iterpool);
+          if (!err)
+            err = log_prefetch_progress(prefetcher, prefetch, i + 1);
         }
       svn_pool_destroy(iterpool);
 
-      return SVN_NO_ERROR;
+      err = svn_error_compose_create(err,
+                                     svn_repos__prefetcher_stop(prefetcher));
+
+      return svn_error_trace(err);
     }
 
   /* If we are including merged revisions, then create mergeinfo that
@@ -2460,8 +2820,35 @@ svn_repos_get_logs5(svn_repos_t *repos,
       svn_pool_destroy(subpool);
     }
 
-  return do_logs(repos->fs, paths, paths_history_mergeinfo, NULL, NULL,
-                 start, end, limit, strict_node_history,
-                 include_merged_revisions, FALSE, FALSE, FALSE,
-                 revprops, descending_order, &callbacks, scratch_pool);
+  /* Follow the history walk of do_logs in a helper thread, reading the
+     data of the revisions found ahead of time.  Again, don't bother for
+     short logs. */
+  prefetch = apr_pcalloc(scratch_pool, sizeof(*prefetch));
+  prefetch->changes = authz_read_func || path_change_receiver;
+  prefetch->revprops = !revprops || revprops->nelts;
+  prefetch->mergeinfo = include_merged_revisions;
+  prefetch->paths = paths;
+  prefetch->hist_start = start;
+  prefetch->hist_end = end;
+  prefetch->strict_node_history = strict_node_history;
+  prefetch->descending_order = descending_order;
+
+  if (end - start >= LOG_PREFETCH_LOOKAHEAD)
+    {
+      svn_repos__prefetcher_start(&callbacks.prefetcher, fs,
+                                  repos->fs_config, 1, prefetch_log_data,
+                                  prefetch, scratch_pool);
+      callbacks.prefetch = prefetch;
+    }
+
+  err = do_logs(repos->fs, paths, paths_history_mergeinfo, NULL, NULL,
+                start, end, limit, strict_node_history,
+                include_merged_revisions, FALSE, FALSE, FALSE,
+                revprops, descending_order, &callbacks, scratch_pool);
+
+  err = svn_error_compose_create(err,
+                                 svn_repos__prefetcher_stop(
+                                   callbacks.prefetcher));
+
+  return svn_error_trace(err);
 }
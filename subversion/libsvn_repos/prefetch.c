@@ -0,0 +1,255 @@
+/* prefetch.c : worker threads reading repository data ahead of time
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_thread_proc.h>
+#include <apr_thread_cond.h>
+
+#include "svn_pools.h"
+#include "svn_cache_config.h"
+
+#include "private/svn_mutex.h"
+
+#include "prefetch.h"
+
+#include "svn_private_config.h"
+
+
+struct svn_repos__prefetcher_t
+{
+#if APR_HAS_THREADS
+  /* How the workers shall open their FS instances. */
+  const char *fs_path;
+  apr_hash_t *fs_config;
+
+  /* What the workers shall do. */
+  svn_repos__prefetch_func_t func;
+  void *baton;
+
+  /* Protects STOP and all data shared by the driver and its workers.
+     CHANGED gets signaled whenever any of that changes. */
+  svn_mutex__t *mutex;
+  apr_thread_cond_t *changed;
+
+  /* Set when the workers shall terminate. */
+  svn_boolean_t stop;
+
+  /* The worker threads (apr_thread_t *). */
+  apr_array_header_t *threads;
+#else
+  /* Truly empty structs are not allowed. */
+  int dummy;
+#endif
+};
+
+#if APR_HAS_THREADS
+
+/* Implements svn_fs_warning_callback_t.  Prefetching is optional, so
+   nobody cares about the workers' warnings. */
+static void
+ignore_fs_warning(void *baton,
+                  svn_error_t *err)
+{
+}
+
+/* Open the worker's FS instance and run PREFETCHER's function.
+   Use POOL for all allocations. */
+static svn_error_t *
+run_worker(svn_repos__prefetcher_t *prefetcher,
+           apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+
+  SVN_ERR(svn_fs_open2(&fs, prefetcher->fs_path, prefetcher->fs_config,
+                       pool, pool));
+  svn_fs_set_warning_func(fs, ignore_fs_warning, NULL);
+
+  return svn_error_trace(prefetcher->func(prefetcher, prefetcher->baton, fs,
+                                          pool));
+}
+
+/* Thread entry point.  DATA is the svn_repos__prefetcher_t to work for. */
+static void * APR_THREAD_FUNC
+prefetch_thread(apr_thread_t *thread,
+                void *data)
+{
+  /* Workers must not share pools with the driving thread. */
+  apr_pool_t *pool = svn_pool_create(NULL);
+
+  /* Failures merely mean that the driver will do the work itself. */
+  svn_error_clear(run_worker(data, pool));
+
+  svn_pool_destroy(pool);
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+#endif /* APR_HAS_THREADS */
+
+void
+svn_repos__prefetcher_start(svn_repos__prefetcher_t **prefetcher_p,
+                            svn_fs_t *fs,
+                            apr_hash_t *fs_config,
+                            int jobs,
+                            svn_repos__prefetch_func_t func,
+                            void *baton,
+                            apr_pool_t *result_pool)
+{
+#if APR_HAS_THREADS
+  svn_repos__prefetcher_t *prefetcher;
+  svn_error_t *err;
+  apr_status_t status;
+  int i;
+#endif
+
+  *prefetcher_p = NULL;
+
+#if APR_HAS_THREADS
+  /* The workers fill the FS caches for the driver, so those must support
+     concurrent access. */
+  if (jobs < 1 || svn_cache_config_get()->single_threaded)
+    return;
+
+  prefetcher = apr_pcalloc(result_pool, sizeof(*prefetcher));
+  prefetcher->fs_path = svn_fs_path(fs, result_pool);
+  prefetcher->fs_config = fs_config;
+  prefetcher->func = func;
+  prefetcher->baton = baton;
+  prefetcher->threads = apr_array_make(result_pool, jobs,
+                                       sizeof(apr_thread_t *));
+
+  /* Without the means to synchronize, there is no prefetching. */
+  err = svn_mutex__init(&prefetcher->mutex, TRUE, result_pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      return;
+    }
+
+  status = apr_thread_cond_create(&prefetcher->changed, result_pool);
+  if (status)
+    return;
+
+  /* Run with as many workers as we can get. */
+  for (i = 0; i < jobs; ++i)
+    {
+      apr_thread_t *thread;
+
+      status = apr_thread_create(&thread, NULL, prefetch_thread, prefetcher,
+                                 result_pool);
+      if (status)
+        break;
+
+      APR_ARRAY_PUSH(prefetcher->threads, apr_thread_t *) = thread;
+    }
+
+  if (prefetcher->threads->nelts)
+    *prefetcher_p = prefetcher;
+#endif
+}
+
+svn_error_t *
+svn_repos__prefetcher_lock(svn_repos__prefetcher_t *prefetcher)
+{
+#if APR_HAS_THREADS
+  SVN_ERR(svn_mutex__lock(prefetcher->mutex));
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__prefetcher_unlock(svn_repos__prefetcher_t *prefetcher,
+                             svn_error_t *err)
+{
+#if APR_HAS_THREADS
+  return svn_mutex__unlock(prefetcher->mutex, err);
+#else
+  return err;
+#endif
+}
+
+svn_error_t *
+svn_repos__prefetcher_wait(svn_repos__prefetcher_t *prefetcher)
+{
+#if APR_HAS_THREADS
+  apr_status_t status
+    = apr_thread_cond_wait(prefetcher->changed,
+                           svn_mutex__get(prefetcher->mutex));
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't wait for prefetched data"));
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__prefetcher_signal(svn_repos__prefetcher_t *prefetcher)
+{
+#if APR_HAS_THREADS
+  apr_status_t status = apr_thread_cond_broadcast(prefetcher->changed);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't signal prefetched data"));
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+svn_boolean_t
+svn_repos__prefetcher_stopping(svn_repos__prefetcher_t *prefetcher)
+{
+#if APR_HAS_THREADS
+  return prefetcher->stop;
+#else
+  return TRUE;
+#endif
+}
+
+svn_error_t *
+svn_repos__prefetcher_stop(svn_repos__prefetcher_t *prefetcher)
+{
+#if APR_HAS_THREADS
+  int i;
+
+  if (!prefetcher)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__lock(prefetcher->mutex));
+  prefetcher->stop = TRUE;
+  SVN_ERR(svn_mutex__unlock(prefetcher->mutex,
+                            svn_repos__prefetcher_signal(prefetcher)));
+
+  for (i = 0; i < prefetcher->threads->nelts; ++i)
+    {
+      apr_status_t retval;
+      apr_status_t status
+        = apr_thread_join(&retval, APR_ARRAY_IDX(prefetcher->threads, i,
+                                                 apr_thread_t *));
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't join prefetch thread"));
+    }
+
+  apr_array_clear(prefetcher->threads);
+  return SVN_NO_ERROR;
+#else
+  return SVN_NO_ERROR;
+#endif
+}
@@ -0,0 +1,118 @@
+/* prefetch.h : worker threads reading repository data ahead of time,
+ *              private to libsvn_repos
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_REPOS_PREFETCH_H
+#define SVN_REPOS_PREFETCH_H
+
+#include <apr_hash.h>
+#include <apr_pools.h>
+
+#include "svn_error.h"
+#include "svn_fs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+
+/* Several drivers in this library, e.g. the reporter and the log code,
+ * know which data they will need next.  They let worker threads read or
+ * compute that data ahead of time, each worker using its own FS instance.
+ * This is the infrastructure shared by them: the worker threads, their FS
+ * instances and the synchronization with the driving thread.  What to
+ * prefetch and how far to read ahead is up to the respective driver.
+ *
+ * Prefetching is always optional.  Drivers must produce the same results
+ * if no prefetcher could be started or if the workers fail.
+ */
+typedef struct svn_repos__prefetcher_t svn_repos__prefetcher_t;
+
+/* The body of a prefetch worker thread.  PREFETCHER is the prefetcher the
+ * thread belongs to and BATON is the baton given to
+ * svn_repos__prefetcher_start().  FS is the worker's own FS instance.
+ * POOL is owned by the worker thread and will be destroyed after this
+ * function returns.
+ *
+ * The function should return soon after svn_repos__prefetcher_stopping()
+ * returns TRUE.  Errors returned by it will be ignored.
+ */
+typedef svn_error_t *
+(*svn_repos__prefetch_func_t)(svn_repos__prefetcher_t *prefetcher,
+                              void *baton,
+                              svn_fs_t *fs,
+                              apr_pool_t *pool);
+
+/* Start JOBS worker threads running FUNC with BATON and return them in
+ * *PREFETCHER_P, allocated in RESULT_POOL.  Each worker opens its own
+ * instance of FS, using FS_CONFIG, which must remain valid until the
+ * prefetcher has been stopped.
+ *
+ * If threads are not supported, the FS caches don't support concurrent
+ * access or no worker thread could be created, set *PREFETCHER_P to NULL.
+ */
+void
+svn_repos__prefetcher_start(svn_repos__prefetcher_t **prefetcher_p,
+                            svn_fs_t *fs,
+                            apr_hash_t *fs_config,
+                            int jobs,
+                            svn_repos__prefetch_func_t func,
+                            void *baton,
+                            apr_pool_t *result_pool);
+
+/* Acquire the mutex of PREFETCHER, which protects all data shared between
+ * the driving thread and the workers. */
+svn_error_t *
+svn_repos__prefetcher_lock(svn_repos__prefetcher_t *prefetcher);
+
+/* Release the mutex of PREFETCHER and return ERR, see svn_mutex__unlock().
+ */
+svn_error_t *
+svn_repos__prefetcher_unlock(svn_repos__prefetcher_t *prefetcher,
+                             svn_error_t *err);
+
+/* Wait until some other thread calls svn_repos__prefetcher_signal() for
+ * PREFETCHER.  The caller must hold PREFETCHER's mutex. */
+svn_error_t *
+svn_repos__prefetcher_wait(svn_repos__prefetcher_t *prefetcher);
+
+/* Wake up all threads waiting for PREFETCHER.  Call this after modifying
+ * shared data.  The caller should hold PREFETCHER's mutex. */
+svn_error_t *
+svn_repos__prefetcher_signal(svn_repos__prefetcher_t *prefetcher);
+
+/* Return TRUE if the workers of PREFETCHER shall terminate.  The caller
+ * must hold PREFETCHER's mutex. */
+svn_boolean_t
+svn_repos__prefetcher_stopping(svn_repos__prefetcher_t *prefetcher);
+
+/* Tell the workers of PREFETCHER to terminate and wait for them.
+ * PREFETCHER may be NULL. */
+svn_error_t *
+svn_repos__prefetcher_stop(svn_repos__prefetcher_t *prefetcher);
+
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_REPOS_PREFETCH_H */
@@ -40,6 +40,8 @@
 #include "private/svn_repos_private.h"
 #include "private/svn_delta_private.h"
 #include "private/svn_sorts_private.h"
+#include "repos.h"
+#include "prefetch.h"
 
 
 /*** Backstory ***/
@@ -1046,6 +1048,280 @@ svn_repos_replay2(svn_fs_root_t *root,
 #endif
 }
 
+
+/*****************************************************************
+ *                      Replaying Ranges                         *
+ *****************************************************************/
+
+/* Number of revisions that the replay prefetcher may read ahead of the
+   revision being replayed and the maximum number of file content bytes
+   it may have read for them.  The latter keeps a few huge revisions from
+   evicting the data of the current one from the caches. */
+#define REPLAY_PREFETCH_WINDOW 8
+#define REPLAY_PREFETCH_MAX_BYTES (64 * 1024 * 1024)
+
+struct svn_repos__replay_prefetcher_t
+{
+  /* The helper thread. */
+  svn_repos__prefetcher_t *prefetcher;
+
+  /* Which data to read. */
+  const char *base_path;
+  svn_boolean_t send_deltas;
+
+  /* The revision range to read. */
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+
+  /* All members below are protected by PREFETCHER's mutex. */
+
+  /* The revision currently being replayed and the youngest revision read
+     by the helper thread. */
+  svn_revnum_t current_rev;
+  svn_revnum_t prefetched_rev;
+
+  /* Set while the helper thread waits for the window to advance and once
+     it has terminated, respectively. */
+  svn_boolean_t waiting;
+  svn_boolean_t finished;
+
+  /* Content bytes read for the revisions after CURRENT_REV, in total and
+     per revision, indexed by revision modulo REPLAY_PREFETCH_WINDOW. */
+  apr_size_t bytes_ahead;
+  apr_size_t bytes_read[REPLAY_PREFETCH_WINDOW];
+};
+
+/* Read the changes below BASE_PATH of revision REV in FS and, if
+   SEND_DELTAS is set, the contents of all files modified by them.
+   Set *BYTES to the number of content bytes read.  The data read is
+   discarded; we only want to get it into the caches.  Use SCRATCH_POOL
+   for temporary allocations. */
+static svn_error_t *
+prefetch_revision(apr_size_t *bytes,
+                  svn_fs_t *fs,
+                  svn_revnum_t rev,
+                  const char *base_path,
+                  svn_boolean_t send_deltas,
+                  apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_fs_root_t *root;
+  svn_fs_path_change_iterator_t *iterator;
+  svn_fs_path_change3_t *change;
+
+  *bytes = 0;
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev, scratch_pool));
+  SVN_ERR(svn_fs_paths_changed3(&iterator, root, scratch_pool,
+                                scratch_pool));
+
+  SVN_ERR(svn_fs_path_change_get(&change, iterator));
+  while (change)
+    {
+      svn_pool_clear(iterpool);
+
+      if (   send_deltas
+          && change->node_kind == svn_node_file
+          && change->change_kind != svn_fs_path_change_delete
+          && change->text_mod
+          && svn_fspath__skip_ancestor(base_path, change->path.data))
+        {
+          svn_stream_t *contents;
+          svn_filesize_t length;
+
+          SVN_ERR(svn_fs_file_length(&length, root, change->path.data,
+                                     iterpool));
+          SVN_ERR(svn_fs_file_contents(&contents, root, change->path.data,
+                                       iterpool));
+          SVN_ERR(svn_stream_copy3(contents, svn_stream_empty(iterpool),
+                                   NULL, NULL, iterpool));
+          *bytes += (apr_size_t)length;
+        }
+
+      SVN_ERR(svn_fs_path_change_get(&change, iterator));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Read the revisions of REPLAY with PREFETCHER from FS, staying within
+   the window ahead of the revision being replayed.  Use POOL for
+   temporary allocations. */
+static svn_error_t *
+prefetch_replay_revisions(svn_repos__prefetcher_t *prefetcher,
+                          svn_repos__replay_prefetcher_t *replay,
+                          svn_fs_t *fs,
+                          apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_revnum_t rev = replay->start_rev + 1;
+
+  while (rev <= replay->end_rev)
+    {
+      svn_error_t *err = SVN_NO_ERROR;
+      svn_boolean_t stop;
+      apr_size_t bytes;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_repos__prefetcher_lock(prefetcher));
+      while (   !err
+             && !svn_repos__prefetcher_stopping(prefetcher)
+             && rev > replay->current_rev + 1
+             && (   rev >= replay->current_rev + REPLAY_PREFETCH_WINDOW
+                 || replay->bytes_ahead >= REPLAY_PREFETCH_MAX_BYTES))
+        {
+          if (!replay->waiting)
+            {
+              replay->waiting = TRUE;
+              err = svn_repos__prefetcher_signal(prefetcher);
+            }
+          if (!err)
+            err = svn_repos__prefetcher_wait(prefetcher);
+        }
+
+      /* Don't bother with revisions that are already being replayed. */
+      if (rev <= replay->current_rev)
+        rev = replay->current_rev + 1;
+
+      stop = svn_repos__prefetcher_stopping(prefetcher)
+          || rev > replay->end_rev;
+      SVN_ERR(svn_repos__prefetcher_unlock(prefetcher, err));
+
+      if (stop)
+        break;
+
+      SVN_ERR(prefetch_revision(&bytes, fs, rev, replay->base_path,
+                                replay->send_deltas, iterpool));
+
+      SVN_ERR(svn_repos__prefetcher_lock(prefetcher));
+      if (rev > replay->current_rev)
+        {
+          replay->bytes_read[rev % REPLAY_PREFETCH_WINDOW] = bytes;
+          replay->bytes_ahead += bytes;
+        }
+      replay->prefetched_rev = rev;
+      SVN_ERR(svn_repos__prefetcher_unlock(prefetcher, SVN_NO_ERROR));
+
+      ++rev;
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos__prefetch_func_t.  Read the revisions of the
+   svn_repos__replay_prefetcher_t BATON from FS and tell waiters once we
+   are done. */
+static svn_error_t *
+prefetch_replay_data(svn_repos__prefetcher_t *prefetcher,
+                     void *baton,
+                     svn_fs_t *fs,
+                     apr_pool_t *pool)
+{
+  svn_repos__replay_prefetcher_t *replay = baton;
+
+  svn_error_clear(prefetch_replay_revisions(prefetcher, replay, fs, pool));
+
+  SVN_ERR(svn_repos__prefetcher_lock(prefetcher));
+  replay->finished = TRUE;
+  return svn_error_trace(svn_repos__prefetcher_unlock(prefetcher,
+                           svn_repos__prefetcher_signal(prefetcher)));
+}
+
+svn_error_t *
+svn_repos__replay_prefetcher_start(
+  svn_repos__replay_prefetcher_t **prefetcher_p,
+  svn_repos_t *repos,
+  const char *base_path,
+  svn_revnum_t start_rev,
+  svn_revnum_t end_rev,
+  svn_boolean_t send_deltas,
+  apr_pool_t *result_pool)
+{
+  svn_repos__replay_prefetcher_t *replay;
+
+  *prefetcher_p = NULL;
+
+  /* Single revisions don't need prefetching. */
+  if (end_rev <= start_rev)
+    return SVN_NO_ERROR;
+
+  replay = apr_pcalloc(result_pool, sizeof(*replay));
+  replay->base_path = svn_fspath__canonicalize(base_path, result_pool);
+  replay->send_deltas = send_deltas;
+  replay->start_rev = start_rev;
+  replay->end_rev = end_rev;
+  replay->current_rev = start_rev;
+  replay->prefetched_rev = start_rev;
+
+  svn_repos__prefetcher_start(&replay->prefetcher, repos->fs,
+                              repos->fs_config, 1, prefetch_replay_data,
+                              replay, result_pool);
+  if (replay->prefetcher)
+    *prefetcher_p = replay;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__replay_prefetcher_progress(
+  svn_repos__replay_prefetcher_t *prefetcher,
+  svn_revnum_t rev)
+{
+  if (!prefetcher)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_repos__prefetcher_lock(prefetcher->prefetcher));
+
+  /* Data read for revisions up to REV no longer counts as read ahead. */
+  for (; prefetcher->current_rev < rev; ++prefetcher->current_rev)
+    {
+      apr_size_t *bytes
+        = &prefetcher->bytes_read[(prefetcher->current_rev + 1)
+                                  % REPLAY_PREFETCH_WINDOW];
+      prefetcher->bytes_ahead -= *bytes;
+      *bytes = 0;
+    }
+
+  /* The helper will re-check whether it may continue. */
+  prefetcher->waiting = FALSE;
+
+  return svn_error_trace(svn_repos__prefetcher_unlock(
+                           prefetcher->prefetcher,
+                           svn_repos__prefetcher_signal(
+                             prefetcher->prefetcher)));
+}
+
+svn_error_t *
+svn_repos__replay_prefetcher_wait(
+  svn_revnum_t *prefetched_rev,
+  apr_size_t *bytes_ahead,
+  svn_repos__replay_prefetcher_t *prefetcher)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_repos__prefetcher_lock(prefetcher->prefetcher));
+  while (!err && !prefetcher->waiting && !prefetcher->finished)
+    err = svn_repos__prefetcher_wait(prefetcher->prefetcher);
+
+  *prefetched_rev = prefetcher->prefetched_rev;
+  *bytes_ahead = prefetcher->bytes_ahead;
+
+  return svn_error_trace(svn_repos__prefetcher_unlock(
+                           prefetcher->prefetcher, err));
+}
+
+svn_error_t *
+svn_repos__replay_prefetcher_stop(
+  svn_repos__replay_prefetcher_t *prefetcher)
+{
+  if (!prefetcher)
+    return SVN_NO_ERROR;
+
+  return svn_error_trace(svn_repos__prefetcher_stop(prefetcher->prefetcher));
+}
+
 
 /*****************************************************************
  *                      Ev2 Implementation                       *
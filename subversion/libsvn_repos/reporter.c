@@ -32,15 +32,25 @@
 #include "svn_pools.h"
 #include "svn_props.h"
 #include "repos.h"
+#include "prefetch.h"
 #include "svn_private_config.h"
 
 #include "private/svn_dep_compat.h"
 #include "private/svn_fspath.h"
+#include "private/svn_repos_private.h"
+#include "private/svn_sorts_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
 
 #define NUM_CACHED_SOURCE_ROOTS 4
 
+/* Number of file deltas to prefetch per worker thread. */
+#define PREFETCH_LOOKAHEAD_PER_JOB 4
+
+/* Maximum size of the delta windows we buffer for a single file.  Larger
+   deltas will be computed by the driving thread itself. */
+#define PREFETCH_MAX_SIZE (4 * 1024 * 1024)
+
 /* Theory of operation: we write report operations out to a spill-buffer
    as we receive them.  When the report is finished, we read the
    operations back out again, using them to guide the progression of
@@ -100,6 +110,9 @@ typedef struct revision_info_t
   svn_string_t* author;        /* name of the revisions' author */
 } revision_info_t;
 
+/* State of the delta prefetching, see below. */
+typedef struct prefetcher_t prefetcher_t;
+
 /* A structure used by the routines within the `reporter' vtable,
    driven by the client as it describes its working copy revisions. */
 typedef struct report_baton_t
@@ -128,6 +141,11 @@ typedef struct report_baton_t
   svn_repos_authz_func_t authz_read_func;
   void *authz_read_baton;
 
+  /* Read access to the entries of the target directory that delta_dirs
+     currently processes, as determined by a single batch authz check.
+     Maps the entries' target paths to svn_boolean_t *.  May be NULL. */
+  apr_hash_t *entries_access;
+
   /* The spill-buffer holding the report. */
   svn_spillbuf_reader_t *reader;
 
@@ -144,6 +162,13 @@ typedef struct report_baton_t
   /* This will not change. So, fetch it once and reuse it. */
   svn_string_t *repos_uuid;
   apr_pool_t *pool;
+
+  /* Number of worker threads to prefetch file deltas with and the FS
+     config to open their FS instances with.  While driving the editor,
+     PREFETCHER is not NULL if any worker could be started. */
+  int jobs;
+  apr_hash_t *fs_config;
+  prefetcher_t *prefetcher;
 } report_baton_t;
 
 /* The type of a function that accepts changes to an object's property
@@ -662,6 +687,420 @@ send_zero_copy_delta(const unsigned char *contents,
 }
 
 
+/* --- DELTA PREFETCHING --- */
+
+/* Reconstructing fulltexts and computing text deltas dominates the cost
+   of large checkouts and updates.  To spread that work over multiple
+   CPUs, delta_dirs() asks a small pool of worker threads to compute the
+   deltas of the next few files in the current directory ahead of time.
+   Each worker uses its own FS instance.  delta_files() then sends the
+   buffered delta windows instead of computing them itself.
+
+   Only the delta computation moves to the workers; all editor calls are
+   still made by the driving thread and in the same order.  Whenever no
+   prefetched delta is available, e.g. because we guessed its source
+   wrongly or the delta was too large to buffer, delta_files() simply
+   computes it inline. */
+
+/* Processing states of a prefetch_t. */
+typedef enum prefetch_state_t
+{
+  prefetch_queued,
+  prefetch_running,
+  prefetch_done
+} prefetch_state_t;
+
+/* A file delta to be computed ahead of time. */
+typedef struct prefetch_t
+{
+  /* Delta source and target.  S_PATH is NULL for deltas against the
+     empty file. */
+  svn_revnum_t s_rev;
+  const char *s_path;
+  const char *t_path;
+
+  /* Processing state.  Protected by the workers' mutex. */
+  prefetch_state_t state;
+
+  /* Set when the driving thread no longer needs this delta while a
+     worker is still computing it.  The worker will then release this
+     object.  Protected by the workers' mutex. */
+  svn_boolean_t abandoned;
+
+  /* The delta windows (svn_txdelta_window_t *), not including the final
+     NULL window.  NULL if the delta could not be prefetched. */
+  apr_array_header_t *windows;
+
+  /* Root pool containing this object and the windows. */
+  apr_pool_t *pool;
+} prefetch_t;
+
+struct prefetcher_t
+{
+  /* The worker threads. */
+  svn_repos__prefetcher_t *workers;
+
+  /* The revision we deliver. */
+  svn_revnum_t t_rev;
+
+  /* Maximum number of deltas to schedule at any time. */
+  int lookahead;
+
+  /* Scheduled deltas (prefetch_t *) in editor drive order.  Protected by
+     the workers' mutex. */
+  apr_array_header_t *items;
+};
+
+/* Per-thread state of a prefetch worker. */
+typedef struct prefetch_worker_t
+{
+  /* This worker's FS instance and roots.  T_ROOT is opened upon first
+     use and S_ROOT caches the last source root used. */
+  svn_fs_t *fs;
+  svn_fs_root_t *t_root;
+  svn_fs_root_t *s_root;
+
+  /* Pool owned by this worker thread. */
+  apr_pool_t *pool;
+} prefetch_worker_t;
+
+/* Using WORKER's FS instance, compute the delta given by PREFETCH with
+   its target in revision T_REV and store its windows in there. */
+static svn_error_t *
+compute_prefetch(prefetch_worker_t *worker,
+                 svn_revnum_t t_rev,
+                 prefetch_t *prefetch)
+{
+  svn_fs_root_t *s_root = NULL;
+  svn_txdelta_stream_t *dstream;
+  apr_array_header_t *windows;
+  apr_size_t size = 0;
+  apr_pool_t *iterpool;
+
+  if (!worker->t_root)
+    SVN_ERR(svn_fs_revision_root(&worker->t_root, worker->fs, t_rev,
+                                 worker->pool));
+
+  if (prefetch->s_path)
+    {
+      svn_boolean_t changed;
+
+      if (   !worker->s_root
+          || svn_fs_revision_root_revision(worker->s_root) != prefetch->s_rev)
+        {
+          if (worker->s_root)
+            svn_fs_close_root(worker->s_root);
+
+          SVN_ERR(svn_fs_revision_root(&worker->s_root, worker->fs,
+                                       prefetch->s_rev, worker->pool));
+        }
+
+      /* delta_files() won't ask for deltas between identical contents. */
+      s_root = worker->s_root;
+      SVN_ERR(svn_fs_contents_different(&changed, worker->t_root,
+                                        prefetch->t_path, s_root,
+                                        prefetch->s_path, prefetch->pool));
+      if (!changed)
+        return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_fs_get_file_delta_stream(&dstream, s_root, prefetch->s_path,
+                                       worker->t_root, prefetch->t_path,
+                                       prefetch->pool));
+
+  windows = apr_array_make(prefetch->pool, 16,
+                           sizeof(svn_txdelta_window_t *));
+  iterpool = svn_pool_create(prefetch->pool);
+  while (TRUE)
+    {
+      svn_txdelta_window_t *window;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_txdelta_next_window(&window, dstream, iterpool));
+      if (!window)
+        break;
+
+      /* Don't buffer huge deltas. */
+      size += window->num_ops * sizeof(*window->ops);
+      if (window->new_data)
+        size += window->new_data->len;
+      if (size > PREFETCH_MAX_SIZE)
+        {
+          svn_pool_destroy(iterpool);
+          return SVN_NO_ERROR;
+        }
+
+      APR_ARRAY_PUSH(windows, svn_txdelta_window_t *)
+        = svn_txdelta_window_dup(window, prefetch->pool);
+    }
+
+  svn_pool_destroy(iterpool);
+  prefetch->windows = windows;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos__prefetch_func_t.  BATON is the prefetcher_t to
+   work for.  Process queued deltas in order until WORKERS stop. */
+static svn_error_t *
+prefetch_deltas(svn_repos__prefetcher_t *workers,
+                void *baton,
+                svn_fs_t *fs,
+                apr_pool_t *pool)
+{
+  prefetcher_t *prefetcher = baton;
+  prefetch_worker_t worker = { 0 };
+  svn_error_t *err = SVN_NO_ERROR;
+
+  worker.fs = fs;
+  worker.pool = pool;
+
+  SVN_ERR(svn_repos__prefetcher_lock(workers));
+  while (!err && !svn_repos__prefetcher_stopping(workers))
+    {
+      prefetch_t *prefetch = NULL;
+      int i;
+
+      for (i = 0; i < prefetcher->items->nelts && !prefetch; ++i)
+        {
+          prefetch_t *item = APR_ARRAY_IDX(prefetcher->items, i,
+                                           prefetch_t *);
+          if (item->state == prefetch_queued)
+            prefetch = item;
+        }
+
+      if (!prefetch)
+        {
+          err = svn_repos__prefetcher_wait(workers);
+          continue;
+        }
+
+      prefetch->state = prefetch_running;
+      SVN_ERR(svn_repos__prefetcher_unlock(workers, SVN_NO_ERROR));
+
+      /* Failures simply make delta_files() compute the delta itself. */
+      svn_error_clear(compute_prefetch(&worker, prefetcher->t_rev,
+                                       prefetch));
+
+      SVN_ERR(svn_repos__prefetcher_lock(workers));
+      prefetch->state = prefetch_done;
+      if (prefetch->abandoned)
+        svn_pool_destroy(prefetch->pool);
+
+      err = svn_repos__prefetcher_signal(workers);
+    }
+
+  return svn_error_trace(svn_repos__prefetcher_unlock(workers, err));
+}
+
+/* Release PREFETCH, which has already been removed from the list of
+   scheduled deltas.  The caller must hold the workers' mutex. */
+static void
+discard_prefetch(prefetch_t *prefetch)
+{
+  if (prefetch->state == prefetch_running)
+    prefetch->abandoned = TRUE;
+  else
+    svn_pool_destroy(prefetch->pool);
+}
+
+/* Remove the first COUNT scheduled deltas from PREFETCHER and discard
+   them.  The caller must hold the workers' mutex. */
+static void
+discard_prefetches(prefetcher_t *prefetcher,
+                   int count)
+{
+  int i;
+
+  for (i = 0; i < count; ++i)
+    discard_prefetch(APR_ARRAY_IDX(prefetcher->items, i, prefetch_t *));
+
+  svn_sort__array_delete2(prefetcher->items, 0, count);
+}
+
+/* Discard all scheduled deltas of PREFETCHER and wait for its worker
+   threads to terminate. */
+static svn_error_t *
+stop_prefetcher(prefetcher_t *prefetcher)
+{
+  SVN_ERR(svn_repos__prefetcher_lock(prefetcher->workers));
+  discard_prefetches(prefetcher, prefetcher->items->nelts);
+  SVN_ERR(svn_repos__prefetcher_unlock(prefetcher->workers, SVN_NO_ERROR));
+
+  return svn_error_trace(svn_repos__prefetcher_stop(prefetcher->workers));
+}
+
+/* Start JOBS worker threads for report B and return the new prefetcher
+   in *PREFETCHER_P, allocated in B->POOL.  Set it to NULL if no workers
+   could be started. */
+static void
+start_prefetcher(prefetcher_t **prefetcher_p,
+                 report_baton_t *b,
+                 int jobs)
+{
+  prefetcher_t *prefetcher = apr_pcalloc(b->pool, sizeof(*prefetcher));
+
+  prefetcher->t_rev = b->t_rev;
+  prefetcher->lookahead = jobs * PREFETCH_LOOKAHEAD_PER_JOB;
+  prefetcher->items = apr_array_make(b->pool, prefetcher->lookahead,
+                                     sizeof(prefetch_t *));
+
+  svn_repos__prefetcher_start(&prefetcher->workers, svn_repos_fs(b->repos),
+                              b->fs_config, jobs, prefetch_deltas,
+                              prefetcher, b->pool);
+
+  *prefetcher_p = prefetcher->workers ? prefetcher : NULL;
+}
+
+/* Schedule the delta from S_PATH@S_REV to T_PATH for prefetching unless
+   PREFETCHER's lookahead limit has been reached.  Set *SCHEDULED
+   accordingly.  S_PATH may be NULL. */
+static svn_error_t *
+schedule_prefetch(svn_boolean_t *scheduled,
+                  prefetcher_t *prefetcher,
+                  svn_revnum_t s_rev,
+                  const char *s_path,
+                  const char *t_path)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_repos__prefetcher_lock(prefetcher->workers));
+
+  *scheduled = prefetcher->items->nelts < prefetcher->lookahead;
+  if (*scheduled)
+    {
+      apr_pool_t *pool = svn_pool_create(NULL);
+      prefetch_t *prefetch = apr_pcalloc(pool, sizeof(*prefetch));
+
+      prefetch->s_rev = s_rev;
+      prefetch->s_path = s_path ? apr_pstrdup(pool, s_path) : NULL;
+      prefetch->t_path = apr_pstrdup(pool, t_path);
+      prefetch->state = prefetch_queued;
+      prefetch->pool = pool;
+
+      APR_ARRAY_PUSH(prefetcher->items, prefetch_t *) = prefetch;
+      err = svn_repos__prefetcher_signal(prefetcher->workers);
+    }
+
+  return svn_error_trace(svn_repos__prefetcher_unlock(prefetcher->workers,
+                                                      err));
+}
+
+/* Return the index of the delta for T_PATH within PREFETCHER's scheduled
+   deltas or -1 if there is none.  The caller must hold the mutex. */
+static int
+find_prefetch(prefetcher_t *prefetcher,
+              const char *t_path)
+{
+  int i;
+
+  for (i = 0; i < prefetcher->items->nelts; ++i)
+    {
+      prefetch_t *prefetch = APR_ARRAY_IDX(prefetcher->items, i,
+                                           prefetch_t *);
+      if (strcmp(prefetch->t_path, t_path) == 0)
+        return i;
+    }
+
+  return -1;
+}
+
+/* The editor drive has finished processing T_PATH.  Discard its
+   prefetched delta, if any, along with all that were scheduled before
+   it.  Those won't be needed anymore, e.g. because the contents were
+   unchanged or the editor did not want a delta. */
+static svn_error_t *
+retire_prefetches(prefetcher_t *prefetcher,
+                  const char *t_path)
+{
+  int idx;
+
+  SVN_ERR(svn_repos__prefetcher_lock(prefetcher->workers));
+
+  idx = find_prefetch(prefetcher, t_path);
+  if (idx >= 0)
+    discard_prefetches(prefetcher, idx + 1);
+
+  return svn_error_trace(svn_repos__prefetcher_unlock(prefetcher->workers,
+                                                      SVN_NO_ERROR));
+}
+
+/* If PREFETCHER holds the delta from S_PATH@S_REV to T_PATH, send it to
+   DHANDLER with DBATON and set *SENT.  Otherwise, set *SENT to FALSE.
+   Wait for a worker to complete the delta if necessary.  S_PATH may be
+   NULL. */
+static svn_error_t *
+send_prefetched_delta(svn_boolean_t *sent,
+                      prefetcher_t *prefetcher,
+                      svn_revnum_t s_rev,
+                      const char *s_path,
+                      const char *t_path,
+                      svn_txdelta_window_handler_t dhandler,
+                      void *dbaton)
+{
+  prefetch_t *prefetch = NULL;
+  svn_error_t *err = SVN_NO_ERROR;
+  int idx;
+  int i;
+
+  *sent = FALSE;
+
+  SVN_ERR(svn_repos__prefetcher_lock(prefetcher->workers));
+
+  idx = find_prefetch(prefetcher, t_path);
+  if (idx >= 0)
+    {
+      prefetch = APR_ARRAY_IDX(prefetcher->items, idx, prefetch_t *);
+      svn_sort__array_delete2(prefetcher->items, idx, 1);
+      discard_prefetches(prefetcher, idx);
+
+      /* If no worker started on it yet, we are faster on our own.
+         Also, we may have guessed the delta source wrongly. */
+      if (   prefetch->state == prefetch_queued
+          || (s_path == NULL) != (prefetch->s_path == NULL)
+          || (s_path && (   s_rev != prefetch->s_rev
+                         || strcmp(s_path, prefetch->s_path))))
+        {
+          discard_prefetch(prefetch);
+          prefetch = NULL;
+        }
+      else
+        {
+          while (!err && prefetch->state != prefetch_done)
+            err = svn_repos__prefetcher_wait(prefetcher->workers);
+
+          /* Let the worker release it if we failed to wait. */
+          if (err)
+            {
+              discard_prefetch(prefetch);
+              prefetch = NULL;
+            }
+        }
+    }
+
+  SVN_ERR(svn_repos__prefetcher_unlock(prefetcher->workers, err));
+
+  /* We own PREFETCH now. */
+  if (!prefetch)
+    return SVN_NO_ERROR;
+
+  if (prefetch->windows)
+    {
+      for (i = 0; i < prefetch->windows->nelts && !err; ++i)
+        err = dhandler(APR_ARRAY_IDX(prefetch->windows, i,
+                                     svn_txdelta_window_t *),
+                       dbaton);
+
+      if (!err)
+        err = dhandler(NULL, dbaton);
+
+      *sent = TRUE;
+    }
+
+  svn_pool_destroy(prefetch->pool);
+  return svn_error_trace(err);
+}
+
 /* Make the appropriate edits on FILE_BATON to change its contents and
    properties from those in S_REV/S_PATH to those in B->t_root/T_PATH,
    possibly using LOCK_TOKEN to determine if the client's lock on the file
@@ -732,6 +1171,18 @@ delta_files(report_baton_t *b, void *file_baton, svn_revnum_t s_rev,
                 return SVN_NO_ERROR;
             }
 
+          /* Maybe, some worker has already done the hard part for us. */
+          if (b->prefetcher)
+            {
+              svn_boolean_t sent;
+
+              SVN_ERR(send_prefetched_delta(&sent, b->prefetcher, s_rev,
+                                            s_path, t_path, dhandler,
+                                            dbaton));
+              if (sent)
+                return SVN_NO_ERROR;
+            }
+
           SVN_ERR(svn_fs_get_file_delta_stream(&dstream, s_root, s_path,
                                                b->t_root, t_path, pool));
           SVN_ERR(svn_txdelta_send_txstream(dstream, dhandler, dbaton, pool));
@@ -749,12 +1200,57 @@ check_auth(report_baton_t *b, svn_boolean_t *allowed, const char *path,
            apr_pool_t *pool)
 {
   if (b->authz_read_func)
-    return svn_error_trace(b->authz_read_func(allowed, b->t_root, path,
-                                              b->authz_read_baton, pool));
+    {
+      svn_boolean_t *known = b->entries_access
+                           ? svn_hash_gets(b->entries_access, path)
+                           : NULL;
+      if (known)
+        {
+          *allowed = *known;
+          return SVN_NO_ERROR;
+        }
+
+      return svn_error_trace(b->authz_read_func(allowed, b->t_root, path,
+                                                b->authz_read_baton, pool));
+    }
+
   *allowed = TRUE;
   return SVN_NO_ERROR;
 }
 
+/* Set *ACCESS to a hash mapping the paths of all ENTRIES of the target
+   directory T_PATH to svn_boolean_t * telling whether the user is
+   authorized to view them.  Check all paths in one batch.  Allocate the
+   result in RESULT_POOL. */
+static svn_error_t *
+check_entries_auth(apr_hash_t **access, report_baton_t *b,
+                   const char *t_path, apr_hash_t *entries,
+                   apr_pool_t *result_pool)
+{
+  apr_array_header_t *paths = apr_array_make(result_pool,
+                                             apr_hash_count(entries),
+                                             sizeof(const char *));
+  svn_boolean_t *allowed;
+  apr_hash_index_t *hi;
+  int i;
+
+  for (hi = apr_hash_first(result_pool, entries); hi; hi = apr_hash_next(hi))
+    APR_ARRAY_PUSH(paths, const char *)
+      = svn_fspath__join(t_path, apr_hash_this_key(hi), result_pool);
+
+  allowed = apr_palloc(result_pool, paths->nelts * sizeof(*allowed));
+  SVN_ERR(svn_repos__authz_read_many(allowed, b->authz_read_func,
+                                     b->authz_read_baton, b->t_root, paths,
+                                     result_pool));
+
+  *access = svn_hash__make(result_pool);
+  for (i = 0; i < paths->nelts; ++i)
+    svn_hash_sets(*access, APR_ARRAY_IDX(paths, i, const char *),
+                  &allowed[i]);
+
+  return SVN_NO_ERROR;
+}
+
 /* Create a dirent in *ENTRY for the given ROOT and PATH.  We use this to
    replace the source or target dirent when a report pathinfo tells us to
    change paths or revisions. */
@@ -1095,6 +1591,60 @@ update_entry(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
     }
 }
 
+/* Schedule the text deltas for the file entries in T_ENTRIES
+   (svn_fs_dirent_t *), starting at index FIRST or *NEXT, whichever is
+   larger, for prefetching.  Stop at the first directory entry, since that
+   will schedule its own files, and when B's lookahead limit has been
+   reached.  Update *NEXT to the first entry not scheduled.
+
+   The remaining parameters are as for delta_dirs().  We guess the delta
+   source the way update_entry() usually determines it.  Wrong guesses
+   merely waste a bit of work in a worker thread.  Use SCRATCH_POOL for
+   temporary allocations. */
+static svn_error_t *
+prefetch_file_deltas(report_baton_t *b,
+                     int *next,
+                     int first,
+                     const apr_array_header_t *t_entries,
+                     svn_revnum_t s_rev,
+                     const char *s_path,
+                     apr_hash_t *s_entries,
+                     const char *t_path,
+                     svn_depth_t wc_depth,
+                     svn_depth_t requested_depth,
+                     apr_pool_t *scratch_pool)
+{
+  if (*next < first)
+    *next = first;
+
+  for (; *next < t_entries->nelts; ++*next)
+    {
+      const svn_fs_dirent_t *t_entry
+        = APR_ARRAY_IDX(t_entries, *next, svn_fs_dirent_t *);
+      const svn_fs_dirent_t *s_entry = NULL;
+      svn_boolean_t scheduled;
+
+      if (t_entry->kind != svn_node_file)
+        break;
+
+      if (s_entries
+          && !is_depth_upgrade(wc_depth, requested_depth, svn_node_file))
+        s_entry = svn_hash_gets(s_entries, t_entry->name);
+
+      SVN_ERR(schedule_prefetch(&scheduled, b->prefetcher, s_rev,
+                                (s_entry && s_entry->kind == svn_node_file)
+                                  ? svn_fspath__join(s_path, t_entry->name,
+                                                     scratch_pool)
+                                  : NULL,
+                                svn_fspath__join(t_path, t_entry->name,
+                                                 scratch_pool)));
+      if (!scheduled)
+        break;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* A helper macro for when we have to recurse into subdirectories. */
 #define DEPTH_BELOW_HERE(depth) ((depth) == svn_depth_immediates) ? \
                                  svn_depth_empty : (depth)
@@ -1161,10 +1711,12 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
            svn_depth_t requested_depth, apr_pool_t *pool)
 {
   apr_hash_t *s_entries = NULL, *t_entries;
+  apr_hash_t *parent_entries_access = b->entries_access;
   apr_hash_index_t *hi;
   apr_pool_t *subpool = svn_pool_create(pool);
   apr_array_header_t *t_ordered_entries = NULL;
   int i;
+  int prefetch_next = 0;
 
   /* Compare the property lists.  If we're starting empty, pass a NULL
      source path so that we add all the properties.
@@ -1189,6 +1741,12 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
         }
       SVN_ERR(svn_fs_dir_entries(&t_entries, b->t_root, t_path, subpool));
 
+      /* Check access to all target entries at once.  Sub-directories
+         will restore this when they are done. */
+      if (b->authz_read_func)
+        SVN_ERR(check_entries_auth(&b->entries_access, b, t_path, t_entries,
+                                   subpool));
+
       /* Iterate over the report information for this directory. */
       iterpool = svn_pool_create(subpool);
 
@@ -1343,16 +1901,26 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
           e_fullpath = svn_relpath_join(e_path, t_entry->name, iterpool);
           t_fullpath = svn_fspath__join(t_path, t_entry->name, iterpool);
 
+          if (b->prefetcher)
+            SVN_ERR(prefetch_file_deltas(b, &prefetch_next, i,
+                                         t_ordered_entries, s_rev, s_path,
+                                         s_entries, t_path, wc_depth,
+                                         requested_depth, iterpool));
+
           SVN_ERR(update_entry(b, s_rev, s_fullpath, s_entry, t_fullpath,
                                t_entry, dir_baton, e_fullpath, NULL,
                                DEPTH_BELOW_HERE(wc_depth),
                                DEPTH_BELOW_HERE(requested_depth),
                                iterpool));
+
+          if (b->prefetcher)
+            SVN_ERR(retire_prefetches(b->prefetcher, t_fullpath));
         }
 
       /* iterpool is destroyed by destroying its parent (subpool) below */
     }
 
+  b->entries_access = parent_entries_access;
   svn_pool_destroy(subpool);
 
   return SVN_NO_ERROR;
@@ -1471,9 +2039,19 @@ finish_report(report_baton_t *b, apr_pool_t *pool)
   for (i = 0; i < NUM_CACHED_SOURCE_ROOTS; i++)
     b->s_roots[i] = NULL;
 
+  /* Only text deltas are worth prefetching. */
+  if (b->jobs > 0 && b->text_deltas)
+    start_prefetcher(&b->prefetcher, b, b->jobs);
+
   {
     svn_error_t *err = svn_error_trace(drive(b, s_rev, info, pool));
 
+    if (b->prefetcher)
+      {
+        err = svn_error_compose_create(err, stop_prefetcher(b->prefetcher));
+        b->prefetcher = NULL;
+      }
+
     if (err == SVN_NO_ERROR)
       return svn_error_trace(b->editor->close_edit(b->edit_baton, pool));
 
@@ -1634,8 +2212,22 @@ svn_repos_begin_report3(void **report_baton,
                                           1000000 /* maxsize */,
                                           pool);
   b->repos_uuid = svn_string_create(uuid, pool);
+  b->jobs = 0;
+  b->fs_config = NULL;
+  b->prefetcher = NULL;
 
   /* Hand reporter back to client. */
   *report_baton = b;
   return SVN_NO_ERROR;
 }
+
+void
+svn_repos__report_set_jobs(void *report_baton,
+                           int jobs,
+                           apr_hash_t *fs_config)
+{
+  report_baton_t *b = report_baton;
+
+  b->jobs = jobs;
+  b->fs_config = fs_config;
+}
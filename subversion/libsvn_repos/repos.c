@@ -798,6 +798,98 @@ create_hooks(svn_repos_t *repos, apr_pool_t *pool)
                                      description, script, pool),
             _("Creating post-revprop-change hook"));
 
+#undef SCRIPT_NAME
+
+
+  /* Hook daemon. */
+#define SCRIPT_NAME SVN_REPOS__HOOK_DAEMON
+
+  description =
+"# HOOK-DAEMON"                                                              NL
+"#"                                                                          NL
+"# The hook daemon is an optional, long-running program that runs all"       NL
+"# other hooks on behalf of the server.  If a program named"                 NL
+"# '"SCRIPT_NAME"' (for which this file is a template) exists, the"          NL
+"# server starts it on the first hook invocation and keeps it running"       NL
+"# for as long as the server process lives.  Instead of starting a new"      NL
+"# process per hook, the server then sends each hook invocation to the"      NL
+"# daemon's STDIN and reads the outcome from the daemon's STDOUT."           NL
+"#"                                                                          NL
+"# Each daemon process handles one request at a time.  If hooks run"         NL
+"# concurrently, the server starts as many daemon processes as needed"       NL
+"# and keeps them for later hook invocations.  Note that a server that"      NL
+"# forks a process per connection, like svnserve without --threads,"         NL
+"# starts new daemons for every connection, so the daemon mainly helps"      NL
+"# servers that handle many connections in one process."                     NL
+"#"                                                                          NL
+"# Hooks are still only invoked if the respective hook program exists."      NL
+"# The daemon is invoked with the following ordered arguments:"              NL
+"#"                                                                          NL
+"#   [1] REPOS-PATH   (the path to this repository)"                         NL
+"#"                                                                          NL
+"# Requests and responses consist of fields.  Each field is written as"      NL
+"# its length in bytes, as a decimal number, followed by a newline, the"     NL
+"# field's contents and another newline.  A request has these fields:"       NL
+"#"                                                                          NL
+"#   NAME             (the name of the hook, e.g. 'pre-commit')"             NL
+"#   ARGC             (the number of hook arguments)"                        NL
+"#   ARGS...          (ARGC fields with the arguments the hook program"      NL
+"#                     would have received, starting with its path)"         NL
+"#   ENVC             (the number of environment variables)"                 NL
+"#   ENV...           (ENVC fields of the form NAME=VALUE, as given by"      NL
+"#                     the hooks-env file for this hook)"                    NL
+"#   STDIN            (the data the hook program would have read)"           NL
+"#"                                                                          NL
+"# The daemon must answer every request with these fields:"                  NL
+"#"                                                                          NL
+"#   EXIT-CODE        (the exit code of the hook)"                           NL
+"#   STDOUT           (the output of the hook)"                              NL
+"#   STDERR           (the error output of the hook)"                        NL
+"#"                                                                          NL
+"# They have the same meaning as for the respective hook program."           NL
+"# Requests are sent one at a time.  If the daemon fails to respond"         NL
+"# within 10 minutes, the hook fails and that daemon process is shut"        NL
+"# down.  When the server exits or the daemon program gets removed,"         NL
+"# the daemon sees EOF on its STDIN and should exit."                        NL
+"#"                                                                          NL
+"# The [hook-daemon] section in the hooks-env file sets the environment"     NL
+"# of the daemon process itself."                                            NL;
+  script =
+"LC_ALL=C"                                                                   NL
+"export LC_ALL"                                                              NL
+""                                                                           NL
+"# Read the next field into $FIELD."                                         NL
+"read_field() {"                                                             NL
+"  read LEN || exit 0"                                                       NL
+"  FIELD=`dd bs=1 count=\"$LEN\" 2>/dev/null`"                               NL
+"  read NEWLINE"                                                             NL
+"}"                                                                          NL
+""                                                                           NL
+"# Write all arguments as fields."                                           NL
+"write_fields() {"                                                           NL
+"  for F in \"$@\"; do"                                                      NL
+"    printf '%d\\n%s\\n' \"${#F}\" \"$F\""                                   NL
+"  done"                                                                     NL
+"}"                                                                          NL
+""                                                                           NL
+"while read_field; do"                                                       NL
+"  HOOK=\"$FIELD\""                                                          NL
+"  read_field"                                                               NL
+"  N=\"$FIELD\""                                                             NL
+"  while [ \"$N\" -gt 0 ]; do read_field; N=$((N - 1)); done"                NL
+"  read_field"                                                               NL
+"  N=\"$FIELD\""                                                             NL
+"  while [ \"$N\" -gt 0 ]; do read_field; N=$((N - 1)); done"                NL
+"  read_field"                                                               NL
+""                                                                           NL
+"  # All hooks succeed."                                                     NL
+"  write_fields 0 \"\" \"\""                                                 NL
+"done"                                                                       NL;
+
+  SVN_ERR_W(write_hook_template_file(repos, SCRIPT_NAME,
+                                     description, script, pool),
+            _("Creating hook daemon template"));
+
 #undef SCRIPT_NAME
 
   return SVN_NO_ERROR;
@@ -1308,8 +1400,12 @@ get_repos(svn_repos_t **repos_p,
 
   /* Open up the filesystem only after obtaining the lock. */
   if (open_fs)
-    SVN_ERR(svn_fs_open2(&repos->fs, repos->db_path, fs_config,
-                         result_pool, scratch_pool));
+    {
+      SVN_ERR(svn_fs_open2(&repos->fs, repos->db_path, fs_config,
+                           result_pool, scratch_pool));
+      repos->fs_config = fs_config ? apr_hash_copy(result_pool, fs_config)
+                                   : NULL;
+    }
 
 #ifdef SVN_DEBUG_CRASH_AT_REPOS_OPEN
   /* If $PATH/config/debug-abort exists, crash the server here.
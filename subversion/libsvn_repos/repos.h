@@ -83,6 +83,10 @@ extern "C" {
 #define SVN_REPOS__HOOK_PRE_UNLOCK      "pre-unlock"
 #define SVN_REPOS__HOOK_POST_UNLOCK     "post-unlock"
 
+/* The optional program that runs all of the above hooks in a single,
+   long-running process. */
+#define SVN_REPOS__HOOK_DAEMON          "hook-daemon"
+
 
 /* The extension added to the names of example hook scripts. */
 #define SVN_REPOS__HOOK_DESC_EXT        ".tmpl"
@@ -135,6 +139,10 @@ struct svn_repos_t
   /* The FS backend in use within this repository. */
   const char *fs_type;
 
+  /* The FS configuration that FS has been opened with.  May be NULL.
+     Helper threads use it to open further instances of FS. */
+  apr_hash_t *fs_config;
+
   /* If non-null, a list of all the capabilities the client (on the
      current connection) has self-reported.  Each element is a
      'const char *', one of SVN_RA_CAPABILITY_*.
@@ -23,6 +23,7 @@
 
 
 #include <string.h>
+
 #include "svn_compat.h"
 #include "svn_private_config.h"
 #include "svn_hash.h"
@@ -37,6 +38,7 @@
 #include "svn_props.h"
 #include "svn_mergeinfo.h"
 #include "repos.h"
+#include "prefetch.h"
 #include "private/svn_fspath.h"
 #include "private/svn_fs_private.h"
 #include "private/svn_sorts_private.h"
@@ -1341,6 +1343,390 @@ find_merged_revisions(apr_array_header_t **merged_path_revisions_out,
   return SVN_NO_ERROR;
 }
 
+/* Fulltexts larger than this will not be kept in memory. */
+#define FILE_REVS_MAX_FULLTEXT (16 * 1024 * 1024)
+
+/* Number of worker threads reading fulltexts ahead of time, the number
+   of fulltexts they may read ahead of the revision being sent and the
+   total size of those fulltexts. */
+#define FILE_REVS_PREFETCH_JOBS 2
+#define FILE_REVS_PREFETCH_LOOKAHEAD 8
+#define FILE_REVS_PREFETCH_MAX_BYTES (4 * FILE_REVS_MAX_FULLTEXT)
+
+/* Set *TEXT to the contents of PATH in ROOT, allocated in RESULT_POOL.
+   If the file is larger than FILE_REVS_MAX_FULLTEXT, set *TEXT to NULL.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+read_fulltext(svn_stringbuf_t **text,
+              svn_fs_root_t *root,
+              const char *path,
+              apr_pool_t *result_pool,
+              apr_pool_t *scratch_pool)
+{
+  svn_filesize_t length;
+  svn_stream_t *contents;
+
+  SVN_ERR(svn_fs_file_length(&length, root, path, scratch_pool));
+  if (length > FILE_REVS_MAX_FULLTEXT)
+    {
+      *text = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_fs_file_contents(&contents, root, path, scratch_pool));
+  SVN_ERR(svn_stringbuf_from_stream(text, contents, (apr_size_t)length,
+                                    result_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Reconstructing the fulltexts dominates the cost of get-file-revs.
+   Since we know all the revisions to send up front, we let a few worker
+   threads, each with its own FS instance, read them ahead of time.  As
+   soon as the previous fulltext is available as well, the worker also
+   computes the delta against it, so the sending thread only needs to
+   pass the windows on in order. */
+
+/* A fulltext to be read by a worker thread. */
+typedef struct fulltext_t
+{
+  /* The file to read. */
+  svn_revnum_t revnum;
+  const char *path;
+
+  /* The file contents, allocated in POOL.  NULL if the file could not be
+     read or was too large.  WINDOWS (svn_txdelta_window_t *) is the delta
+     from the previous item's TEXT to TEXT, or NULL if either is unknown.
+     Only valid once DONE has been set. */
+  svn_stringbuf_t *text;
+  apr_array_header_t *windows;
+  apr_pool_t *pool;
+
+  /* Protected by the prefetcher's mutex.  SIZE is the number of bytes
+     reserved for TEXT and WINDOWS. */
+  svn_boolean_t done;
+  apr_size_t size;
+} fulltext_t;
+
+/* Shared state of all fulltext workers. */
+typedef struct fulltext_prefetch_t
+{
+  /* The worker threads. */
+  svn_repos__prefetcher_t *prefetcher;
+
+  /* The fulltexts (fulltext_t) in the order they will be sent. */
+  apr_array_header_t *items;
+
+  /* The members below and the DONE flags of the ITEMS are protected by
+     PREFETCHER's mutex. */
+
+  /* Index of the next item to be picked up by a worker and number of
+     items already taken by the sending thread. */
+  int next;
+  int taken;
+
+  /* Total SIZE of all items picked up but not taken yet. */
+  apr_size_t bytes_ahead;
+} fulltext_prefetch_t;
+
+/* Reserve LENGTH bytes in PREFETCH for the item at INDEX, waiting until
+   that keeps PREFETCH within FILE_REVS_PREFETCH_MAX_BYTES.  The item to
+   be taken next never waits, lest the sender waits for it in turn.  Set
+   *RESERVED to FALSE if the workers shall stop instead. */
+static svn_error_t *
+reserve_fulltext(svn_boolean_t *reserved,
+                 svn_repos__prefetcher_t *prefetcher,
+                 fulltext_prefetch_t *prefetch,
+                 int index,
+                 apr_size_t length)
+{
+  fulltext_t *item = &APR_ARRAY_IDX(prefetch->items, index, fulltext_t);
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_repos__prefetcher_lock(prefetcher));
+  while (   !err
+         && !svn_repos__prefetcher_stopping(prefetcher)
+         && index > prefetch->taken
+         && prefetch->bytes_ahead + length > FILE_REVS_PREFETCH_MAX_BYTES)
+    err = svn_repos__prefetcher_wait(prefetcher);
+
+  *reserved = !err && !svn_repos__prefetcher_stopping(prefetcher);
+  if (*reserved)
+    {
+      item->size = length;
+      prefetch->bytes_ahead += length;
+    }
+
+  return svn_error_trace(svn_repos__prefetcher_unlock(prefetcher, err));
+}
+
+/* Set the WINDOWS of the item at INDEX in PREFETCH to the delta against
+   the previous item's fulltext, waiting until that has been read.  Add
+   the size of the windows to the item's reservation.  Use SCRATCH_POOL
+   for temporary allocations. */
+static svn_error_t *
+deltify_fulltext(svn_repos__prefetcher_t *prefetcher,
+                 fulltext_prefetch_t *prefetch,
+                 int index,
+                 apr_pool_t *scratch_pool)
+{
+  fulltext_t *item = &APR_ARRAY_IDX(prefetch->items, index, fulltext_t);
+  fulltext_t *prev = &APR_ARRAY_IDX(prefetch->items, index - 1, fulltext_t);
+  svn_stringbuf_t *prev_text = NULL;
+  svn_txdelta_stream_t *delta_stream;
+  svn_txdelta_window_t *window;
+  apr_array_header_t *windows;
+  apr_pool_t *iterpool;
+  apr_size_t size = 0;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  /* The previous fulltext stays alive at least until the sender took
+     this item, i.e. until we are done. */
+  SVN_ERR(svn_repos__prefetcher_lock(prefetcher));
+  while (   !err
+         && !svn_repos__prefetcher_stopping(prefetcher)
+         && !prev->done)
+    err = svn_repos__prefetcher_wait(prefetcher);
+
+  if (!err && !svn_repos__prefetcher_stopping(prefetcher))
+    prev_text = prev->text;
+  SVN_ERR(svn_repos__prefetcher_unlock(prefetcher, err));
+
+  if (!prev_text)
+    return SVN_NO_ERROR;
+
+  windows = apr_array_make(item->pool, 4, sizeof(svn_txdelta_window_t *));
+  svn_txdelta2(&delta_stream,
+               svn_stream_from_stringbuf(prev_text, scratch_pool),
+               svn_stream_from_stringbuf(item->text, scratch_pool),
+               FALSE, scratch_pool);
+
+  iterpool = svn_pool_create(scratch_pool);
+  do
+    {
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_txdelta_next_window(&window, delta_stream, iterpool));
+      if (window)
+        {
+          APR_ARRAY_PUSH(windows, svn_txdelta_window_t *)
+            = svn_txdelta_window_dup(window, item->pool);
+          size += window->num_ops * sizeof(*window->ops);
+          if (window->new_data)
+            size += window->new_data->len;
+        }
+    }
+  while (window);
+  svn_pool_destroy(iterpool);
+
+  /* The windows are tiny compared to the fulltext in most cases, so we
+     don't wait for room but merely account for them. */
+  SVN_ERR(svn_repos__prefetcher_lock(prefetcher));
+  item->windows = windows;
+  item->size += size;
+  prefetch->bytes_ahead += size;
+  SVN_ERR(svn_repos__prefetcher_unlock(prefetcher, SVN_NO_ERROR));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos__prefetch_func_t.  Read the fulltexts of the
+   fulltext_prefetch_t BATON from FS and deltify them against their
+   predecessors, staying no more than
+   FILE_REVS_PREFETCH_LOOKAHEAD items and about
+   FILE_REVS_PREFETCH_MAX_BYTES ahead of the sending thread. */
+static svn_error_t *
+prefetch_fulltexts(svn_repos__prefetcher_t *prefetcher,
+                   void *baton,
+                   svn_fs_t *fs,
+                   apr_pool_t *pool)
+{
+  fulltext_prefetch_t *prefetch = baton;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  while (TRUE)
+    {
+      fulltext_t *item = NULL;
+      svn_fs_root_t *root;
+      svn_filesize_t length;
+      svn_boolean_t reserved = FALSE;
+      svn_error_t *err = SVN_NO_ERROR;
+      int index = 0;
+
+      svn_pool_clear(iterpool);
+
+      /* Pick the next item to read. */
+      SVN_ERR(svn_repos__prefetcher_lock(prefetcher));
+      while (   !err
+             && !svn_repos__prefetcher_stopping(prefetcher)
+             && prefetch->next < prefetch->items->nelts
+             && prefetch->next
+                  >= prefetch->taken + FILE_REVS_PREFETCH_LOOKAHEAD)
+        err = svn_repos__prefetcher_wait(prefetcher);
+
+      if (   !err
+          && !svn_repos__prefetcher_stopping(prefetcher)
+          && prefetch->next < prefetch->items->nelts)
+        {
+          index = prefetch->next++;
+          item = &APR_ARRAY_IDX(prefetch->items, index, fulltext_t);
+        }
+      SVN_ERR(svn_repos__prefetcher_unlock(prefetcher, err));
+
+      if (!item)
+        break;
+
+      /* Read it.  Failures will simply make the sender read it itself.
+         Oversized texts won't be read, so they don't need a reservation.
+       */
+      item->pool = svn_pool_create(NULL);
+      err = svn_fs_revision_root(&root, fs, item->revnum, iterpool);
+      if (!err)
+        err = svn_fs_file_length(&length, root, item->path, iterpool);
+      if (!err && length <= FILE_REVS_MAX_FULLTEXT)
+        err = reserve_fulltext(&reserved, prefetcher, prefetch, index,
+                               (apr_size_t)length);
+      if (!err && reserved)
+        err = read_fulltext(&item->text, root, item->path, item->pool,
+                            iterpool);
+      if (!err && item->text && index > 0)
+        err = deltify_fulltext(prefetcher, prefetch, index, iterpool);
+      if (err)
+        {
+          svn_error_clear(err);
+          item->text = NULL;
+          item->windows = NULL;
+        }
+
+      SVN_ERR(svn_repos__prefetcher_lock(prefetcher));
+      item->done = TRUE;
+      SVN_ERR(svn_repos__prefetcher_unlock(prefetcher,
+                svn_repos__prefetcher_signal(prefetcher)));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Make the worker threads of PREFETCH terminate, wait for them and
+   release all fulltexts not taken yet.  PREFETCH may be NULL. */
+static svn_error_t *
+stop_fulltext_prefetch(fulltext_prefetch_t *prefetch)
+{
+  int i;
+
+  if (!prefetch)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_repos__prefetcher_stop(prefetch->prefetcher));
+
+  for (i = prefetch->taken; i < prefetch->next; ++i)
+    svn_pool_destroy(APR_ARRAY_IDX(prefetch->items, i, fulltext_t).pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* If worthwhile, start worker threads in *PREFETCH_P that read the
+   fulltexts of PATH_REVISIONS (struct path_revision *) in REPOS in that
+   order, starting at index FIRST.  Otherwise, set *PREFETCH_P to NULL.
+   Allocate the prefetch state in RESULT_POOL. */
+static void
+start_fulltext_prefetch(fulltext_prefetch_t **prefetch_p,
+                        svn_repos_t *repos,
+                        const apr_array_header_t *path_revisions,
+                        int first,
+                        apr_pool_t *result_pool)
+{
+  fulltext_prefetch_t *prefetch;
+  int i;
+
+  *prefetch_p = NULL;
+
+  /* A handful of revisions are not worth the overhead. */
+  if (path_revisions->nelts - first <= FILE_REVS_PREFETCH_LOOKAHEAD)
+    return;
+
+  prefetch = apr_pcalloc(result_pool, sizeof(*prefetch));
+  prefetch->items = apr_array_make(result_pool, path_revisions->nelts - first,
+                                   sizeof(fulltext_t));
+
+  for (i = first; i < path_revisions->nelts; ++i)
+    {
+      const struct path_revision *path_rev
+        = APR_ARRAY_IDX(path_revisions, i, const struct path_revision *);
+      fulltext_t *item = apr_array_push(prefetch->items);
+
+      memset(item, 0, sizeof(*item));
+      item->revnum = path_rev->revnum;
+      item->path = path_rev->path;
+    }
+
+  svn_repos__prefetcher_start(&prefetch->prefetcher, repos->fs,
+                              repos->fs_config, FILE_REVS_PREFETCH_JOBS,
+                              prefetch_fulltexts, prefetch, result_pool);
+  if (prefetch->prefetcher)
+    *prefetch_p = prefetch;
+}
+
+/* Set *TEXT to the next fulltext of PREFETCH and *WINDOWS to its delta
+   against the previous one.  Wait for the workers if necessary.  Both
+   will be NULL if they could not be prefetched.  Hand the pool they are
+   allocated in over to the caller in *TEXT_POOL, which may be NULL. */
+static svn_error_t *
+take_fulltext(svn_stringbuf_t **text,
+              apr_array_header_t **windows,
+              apr_pool_t **text_pool,
+              fulltext_prefetch_t *prefetch)
+{
+  svn_repos__prefetcher_t *prefetcher = prefetch->prefetcher;
+  svn_error_t *err = SVN_NO_ERROR;
+  fulltext_t *item;
+  svn_boolean_t picked_up;
+
+  *text = NULL;
+  *windows = NULL;
+  *text_pool = NULL;
+  if (prefetch->taken >= prefetch->items->nelts)
+    return SVN_NO_ERROR;
+
+  item = &APR_ARRAY_IDX(prefetch->items, prefetch->taken, fulltext_t);
+
+  SVN_ERR(svn_repos__prefetcher_lock(prefetcher));
+  picked_up = prefetch->next > prefetch->taken;
+
+  /* If no worker started on this one, we are faster on our own.  Make
+     sure that they skip it and don't wait for it to deltify the next. */
+  if (!picked_up)
+    {
+      prefetch->next = prefetch->taken + 1;
+      item->done = TRUE;
+    }
+
+  while (!err && picked_up && !item->done)
+    err = svn_repos__prefetcher_wait(prefetcher);
+
+  /* Unless we failed to wait for it, ITEM is ours now. */
+  if (!err)
+    {
+      prefetch->taken++;
+      prefetch->bytes_ahead -= item->size;
+      err = svn_repos__prefetcher_signal(prefetcher);
+    }
+  else
+    picked_up = FALSE;
+
+  SVN_ERR(svn_repos__prefetcher_unlock(prefetcher, err));
+
+  if (picked_up)
+    {
+      *text = item->text;
+      *windows = item->windows;
+      *text_pool = item->pool;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 struct send_baton
 {
   apr_pool_t *iterpool;
@@ -1349,6 +1735,24 @@ struct send_baton
   const char *last_path;
   svn_fs_root_t *last_root;
   svn_boolean_t include_merged_revisions;
+
+  /* If set, compute the deltas from the fulltexts kept in memory instead
+     of asking the FS for them.  LAST_TEXT is the fulltext of LAST_PATH in
+     LAST_ROOT, or NULL if that is not known. */
+  svn_boolean_t use_fulltexts;
+  svn_stringbuf_t *last_text;
+
+  /* If not NULL, the pools that the current and the last prefetched
+     fulltexts are allocated in, respectively. */
+  apr_pool_t *text_pool;
+  apr_pool_t *last_text_pool;
+
+  /* Set once the handler asked for a text delta.  Only then, reading
+     fulltexts ahead of time pays off. */
+  svn_boolean_t wants_deltas;
+
+  /* If not NULL, provides the fulltexts of all revisions still to send. */
+  fulltext_prefetch_t *prefetch;
 };
 
 /* Send PATH_REV to HANDLER and HANDLER_BATON, using information provided by
@@ -1370,9 +1774,14 @@ send_path_revision(struct path_revision *path_rev,
   apr_pool_t *tmp_pool;  /* For swapping */
   svn_boolean_t contents_changed;
   svn_boolean_t props_changed;
+  svn_stringbuf_t *text = NULL;
+  apr_array_header_t *windows = NULL;
 
   svn_pool_clear(sb->iterpool);
 
+  if (sb->prefetch)
+    SVN_ERR(take_fulltext(&text, &windows, &sb->text_pool, sb->prefetch));
+
   /* Get the revision properties. */
   SVN_ERR(svn_fs_revision_proplist2(&rev_props, repos->fs,
                                     path_rev->revnum, FALSE,
@@ -1446,26 +1855,68 @@ send_path_revision(struct path_revision *path_rev,
                   contents_changed ? &delta_baton : NULL,
                   prop_diffs, sb->iterpool));
 
+  /* Unchanged contents mean that we already know the fulltext. */
+  if (!contents_changed && !text && sb->last_text)
+    text = svn_stringbuf_dup(sb->last_text, sb->iterpool);
+
   /* Compute and send delta if client asked for it.
      Note that this was initialized to NULL, so if !contents_changed,
      no deltas will be computed. */
   if (delta_handler && delta_handler != svn_delta_noop_window_handler)
     {
-      /* Get the content delta. */
-      SVN_ERR(svn_fs_get_file_delta_stream(&delta_stream,
-                                           sb->last_root, sb->last_path,
-                                           root, path_rev->path,
-                                           sb->iterpool));
-      /* And send. */
-      SVN_ERR(svn_txdelta_send_txstream(delta_stream,
-                                        delta_handler, delta_baton,
-                                        sb->iterpool));
+      sb->wants_deltas = TRUE;
+      if (!text && sb->use_fulltexts)
+        SVN_ERR(read_fulltext(&text, root, path_rev->path, sb->iterpool,
+                              sb->iterpool));
+
+      /* Get the content delta.  Deltifying against the fulltext of the
+         previous revision saves us reconstructing it a second time.  The
+         workers may even have done that for us already. */
+      if (windows && sb->last_text)
+        {
+          int i;
+
+          for (i = 0; i < windows->nelts; ++i)
+            SVN_ERR(delta_handler(APR_ARRAY_IDX(windows, i,
+                                                svn_txdelta_window_t *),
+                                  delta_baton));
+
+          SVN_ERR(delta_handler(NULL, delta_baton));
+        }
+      else
+        {
+          if (text && (sb->last_text || !sb->last_root))
+            svn_txdelta2(&delta_stream,
+                         sb->last_text
+                           ? svn_stream_from_stringbuf(sb->last_text,
+                                                       sb->iterpool)
+                           : svn_stream_empty(sb->iterpool),
+                         svn_stream_from_stringbuf(text, sb->iterpool),
+                         FALSE, sb->iterpool);
+          else
+            SVN_ERR(svn_fs_get_file_delta_stream(&delta_stream,
+                                                 sb->last_root,
+                                                 sb->last_path,
+                                                 root, path_rev->path,
+                                                 sb->iterpool));
+          /* And send. */
+          SVN_ERR(svn_txdelta_send_txstream(delta_stream,
+                                            delta_handler, delta_baton,
+                                            sb->iterpool));
+        }
     }
 
-  /* Remember root, path and props for next iteration. */
+  /* Remember root, path, props and text for next iteration.  The
+     previous fulltext is not needed anymore. */
   sb->last_root = root;
   sb->last_path = path_rev->path;
   sb->last_props = props;
+  sb->last_text = text;
+
+  if (sb->last_text_pool)
+    svn_pool_destroy(sb->last_text_pool);
+  sb->last_text_pool = sb->text_pool;
+  sb->text_pool = NULL;
 
   /* Swap the pools. */
   tmp_pool = sb->iterpool;
@@ -1507,6 +1958,12 @@ get_file_revs_backwards(svn_repos_t *repos,
   sb.iterpool = svn_pool_create(scratch_pool);
   sb.last_pool = svn_pool_create(scratch_pool);
   sb.include_merged_revisions = FALSE;
+  sb.use_fulltexts = FALSE;
+  sb.last_text = NULL;
+  sb.text_pool = NULL;
+  sb.last_text_pool = NULL;
+  sb.wants_deltas = FALSE;
+  sb.prefetch = NULL;
 
   /* We want the first txdelta to be against the empty file. */
   sb.last_root = NULL;
@@ -1619,9 +2076,13 @@ svn_repos_get_file_revs2(svn_repos_t *repos,
                          apr_pool_t *scratch_pool)
 {
   apr_array_header_t *mainline_path_revisions, *merged_path_revisions;
+  apr_array_header_t *path_revisions;
   apr_hash_t *duplicate_path_revs;
   struct send_baton sb;
   int mainline_pos, merged_pos;
+  int i;
+  svn_boolean_t prefetch_started = FALSE;
+  svn_error_t *err = SVN_NO_ERROR;
 
   if (!SVN_IS_VALID_REVNUM(start)
       || !SVN_IS_VALID_REVNUM(end))
@@ -1670,6 +2131,14 @@ svn_repos_get_file_revs2(svn_repos_t *repos,
    * may be needed. */
   sb.include_merged_revisions = include_merged_revisions;
 
+  /* Keep a rolling fulltext to deltify successive revisions against. */
+  sb.use_fulltexts = TRUE;
+  sb.last_text = NULL;
+  sb.text_pool = NULL;
+  sb.last_text_pool = NULL;
+  sb.wants_deltas = FALSE;
+  sb.prefetch = NULL;
+
   /* Get the revisions we are interested in. */
   duplicate_path_revs = apr_hash_make(scratch_pool);
   mainline_path_revisions = apr_array_make(scratch_pool, 100,
@@ -1694,8 +2163,12 @@ svn_repos_get_file_revs2(svn_repos_t *repos,
   /* We must have at least one revision to get. */
   SVN_ERR_ASSERT(mainline_path_revisions->nelts > 0);
 
-  /* Walk through both mainline and merged revisions, and send them in
-     reverse chronological order, interleaving as appropriate. */
+  /* Merge mainline and merged revisions into a single list, in the
+     chronological order we will send them, interleaving as appropriate. */
+  path_revisions = apr_array_make(scratch_pool,
+                                  mainline_path_revisions->nelts
+                                    + merged_path_revisions->nelts,
+                                  sizeof(struct path_revision *));
   mainline_pos = mainline_path_revisions->nelts - 1;
   merged_pos = merged_path_revisions->nelts - 1;
   while (mainline_pos >= 0 && merged_pos >= 0)
@@ -1709,39 +2182,56 @@ svn_repos_get_file_revs2(svn_repos_t *repos,
 
       if (main_pr->revnum <= merged_pr->revnum)
         {
-          SVN_ERR(send_path_revision(main_pr, repos, &sb, handler,
-                                     handler_baton));
+          APR_ARRAY_PUSH(path_revisions, struct path_revision *) = main_pr;
           mainline_pos -= 1;
         }
       else
         {
-          SVN_ERR(send_path_revision(merged_pr, repos, &sb, handler,
-                                     handler_baton));
+          APR_ARRAY_PUSH(path_revisions, struct path_revision *) = merged_pr;
           merged_pos -= 1;
         }
     }
 
-  /* Send any remaining revisions from the mainline list. */
+  /* Add any remaining revisions from the mainline list. */
   for (; mainline_pos >= 0; mainline_pos -= 1)
-    {
-      struct path_revision *main_pr = APR_ARRAY_IDX(mainline_path_revisions,
-                                                    mainline_pos,
-                                                    struct path_revision *);
-      SVN_ERR(send_path_revision(main_pr, repos, &sb, handler, handler_baton));
-    }
+    APR_ARRAY_PUSH(path_revisions, struct path_revision *)
+      = APR_ARRAY_IDX(mainline_path_revisions, mainline_pos,
+                      struct path_revision *);
 
   /* Ditto for the merged list. */
   for (; merged_pos >= 0; merged_pos -= 1)
+    APR_ARRAY_PUSH(path_revisions, struct path_revision *)
+      = APR_ARRAY_IDX(merged_path_revisions, merged_pos,
+                      struct path_revision *);
+
+  for (i = 0; i < path_revisions->nelts && !err; ++i)
     {
-      struct path_revision *merged_pr = APR_ARRAY_IDX(merged_path_revisions,
-                                                      merged_pos,
-                                                      struct path_revision *);
-      SVN_ERR(send_path_revision(merged_pr, repos, &sb, handler,
-                                 handler_baton));
+      /* Now that we know all revisions and that the handler wants their
+         contents, let other threads read the remaining fulltexts while
+         we are busy sending. */
+      if (sb.wants_deltas && !prefetch_started)
+        {
+          start_fulltext_prefetch(&sb.prefetch, repos, path_revisions, i,
+                                  scratch_pool);
+          prefetch_started = TRUE;
+        }
+
+      err = send_path_revision(APR_ARRAY_IDX(path_revisions, i,
+                                             struct path_revision *),
+                               repos, &sb, handler, handler_baton);
     }
 
+  err = svn_error_compose_create(err, stop_fulltext_prefetch(sb.prefetch));
+
+  /* The workers are gone, so we can release the fulltexts taken from
+     them. */
+  if (sb.text_pool)
+    svn_pool_destroy(sb.text_pool);
+  if (sb.last_text_pool)
+    svn_pool_destroy(sb.last_text_pool);
+
   svn_pool_destroy(sb.last_pool);
   svn_pool_destroy(sb.iterpool);
 
-  return SVN_NO_ERROR;
+  return svn_error_trace(err);
 }
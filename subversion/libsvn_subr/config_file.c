@@ -1511,6 +1511,12 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### to show meaningful differences for binary file formats.  [New"  NL
         "### in 1.9]"                                                        NL
         "# diff-ignore-content-type = no"                                    NL
+        "### Set sliding-delta-windows to 'yes' to let the deltas sent on"   NL
+        "### commit follow data that has been inserted into or removed from" NL
+        "### large files.  This can greatly reduce the amount of data sent"  NL
+        "### for such files.  All servers can apply these deltas.  [New in"  NL
+        "### 1.15]"                                                          NL
+        "# sliding-delta-windows = no"                                       NL
         ""                                                                   NL
         "### Section for configuring automatic properties."                  NL
         "[auto-props]"                                                       NL
@@ -51,6 +51,18 @@
 #include <fcntl.h>
 #endif
 
+#ifdef HAVE_SYS_IOCTL_H
+#include <sys/ioctl.h>
+#endif
+
+#ifdef HAVE_LINUX_FS_H
+#include <linux/fs.h>
+#endif
+
+#if defined(FICLONE) || defined(HAVE_COPY_FILE_RANGE)
+#include <errno.h>
+#endif
+
 #include "svn_hash.h"
 #include "svn_types.h"
 #include "svn_dirent_uri.h"
@@ -871,6 +883,87 @@ svn_io_temp_dir(const char **dir,
 
 /*** Creating, copying and appending files. ***/
 
+#if defined(FICLONE) || defined(HAVE_COPY_FILE_RANGE)
+/* Maximum number of bytes to hand to a single copy_file_range() call.
+ * Keep it moderate such that signals get processed in a timely manner. */
+#define SVN__COPY_FILE_RANGE_CHUNK_SIZE (64 * 1024 * 1024)
+
+/* Let the kernel transfer the contents of FROM_FILE to TO_FILE without
+ * routing the data through user space.  Try to share the data blocks
+ * (reflink) first and fall back to copy_file_range() where the file
+ * system does not support that.
+ *
+ * Set *HANDLED to TRUE if the copy has been completed.  If the kernel
+ * cannot do (the rest of) the copy for us, set *HANDLED to FALSE and
+ * leave both file pointers at the position where the caller shall
+ * continue the copy.
+ */
+static apr_status_t
+copy_contents_in_kernel(svn_boolean_t *handled,
+                        apr_file_t *from_file,
+                        apr_file_t *to_file)
+{
+  apr_os_file_t from_fd;
+  apr_os_file_t to_fd;
+#ifdef HAVE_COPY_FILE_RANGE
+  apr_off_t total = 0;
+#endif
+
+  *handled = FALSE;
+  if (apr_os_file_get(&from_fd, from_file)
+      || apr_os_file_get(&to_fd, to_file))
+    return APR_SUCCESS;
+
+#ifdef FICLONE
+  /* Cheapest option: make TO_FILE share FROM_FILE's data blocks.
+   * This is supported by e.g. Btrfs, XFS and OCFS2. */
+  if (ioctl(to_fd, FICLONE, from_fd) == 0)
+    {
+      *handled = TRUE;
+      return APR_SUCCESS;
+    }
+#endif
+
+#ifdef HAVE_COPY_FILE_RANGE
+  /* Let the kernel copy the data.  Depending on the file system, this
+   * may still become a server-side copy or a block-sharing operation. */
+  while (1)
+    {
+      ssize_t copied = copy_file_range(from_fd, NULL, to_fd, NULL,
+                                       SVN__COPY_FILE_RANGE_CHUNK_SIZE, 0);
+      if (copied > 0)
+        {
+          total += copied;
+          continue;
+        }
+
+      if (copied == 0)
+        {
+          /* EOF.  Some pseudo file systems report 0 bytes even for
+           * non-empty files.  Unless we actually copied something, let
+           * the generic copy loop find out whether there is more data.
+           * For empty files, that costs just a single read() call. */
+          *handled = total > 0;
+          return APR_SUCCESS;
+        }
+
+      if (errno == EINTR)
+        continue;
+
+      /* Copying across file systems, unsupported file systems and old
+       * kernels.  Let our caller continue from the current position. */
+      if (   errno == EXDEV || errno == ENOSYS || errno == EINVAL
+          || errno == EOPNOTSUPP || errno == EBADF || errno == EPERM)
+        return APR_SUCCESS;
+
+      return apr_get_os_error();
+    }
+#else
+  return APR_SUCCESS;
+#endif
+}
+#endif
+
 /* Transfer the contents of FROM_FILE to TO_FILE, using POOL for temporary
  * allocations.
  *
@@ -885,6 +978,14 @@ copy_contents(apr_file_t *from_file,
               apr_file_t *to_file,
               apr_pool_t *pool)
 {
+#if defined(FICLONE) || defined(HAVE_COPY_FILE_RANGE)
+  svn_boolean_t handled;
+  apr_status_t status = copy_contents_in_kernel(&handled, from_file,
+                                                to_file);
+  if (status || handled)
+    return status;
+#endif
+
   /* Copy bytes till the cows come home. */
   while (1)
     {
@@ -2697,6 +2798,29 @@ svn_io__file_lock_autocreate(const char *lock_file,
 }
 
 
+void
+svn_io__file_advise_sequential(apr_file_t *file)
+{
+#if defined(HAVE_POSIX_FADVISE) && defined(POSIX_FADV_SEQUENTIAL)
+  apr_os_file_t filehand;
+
+  if (apr_os_file_get(&filehand, file) == APR_SUCCESS)
+    (void)posix_fadvise(filehand, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+void
+svn_io__file_advise_dontneed(apr_file_t *file)
+{
+#if defined(HAVE_POSIX_FADVISE) && defined(POSIX_FADV_DONTNEED)
+  apr_os_file_t filehand;
+
+  if (apr_os_file_get(&filehand, file) == APR_SUCCESS)
+    (void)posix_fadvise(filehand, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+}
+
+
 
 /* Data consistency/coherency operations. */
 
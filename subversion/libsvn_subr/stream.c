@@ -31,6 +31,8 @@
 #include <apr_errno.h>
 #include <apr_poll.h>
 #include <apr_portable.h>
+#include <apr_thread_cond.h>
+#include <apr_thread_proc.h>
 
 #include <zlib.h>
 
@@ -47,6 +49,7 @@
 #include "private/svn_error_private.h"
 #include "private/svn_eol_private.h"
 #include "private/svn_io_private.h"
+#include "private/svn_mutex.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_utf_private.h"
 
@@ -2444,3 +2447,364 @@ svn_stream__install_delete(svn_stream_t *install_stream,
   return svn_error_trace(svn_io_remove_file2(ib->tmp_path, FALSE,
                                              scratch_pool));
 }
+
+
+/*** Read-ahead streams ***/
+
+#if APR_HAS_THREADS
+
+/* Size of the blocks that the read-ahead thread will fetch at once. */
+#define READ_AHEAD_BLOCK_SIZE (1024 * 1024)
+
+/* Number of blocks that the read-ahead thread may fill before it has to
+   wait for the reader. */
+#define READ_AHEAD_BLOCK_COUNT 4
+
+/* Baton type used by the read-ahead stream.  The blocks form a ring
+   buffer.  The blocks from FIRST to FIRST + FULL_COUNT - 1 contain data
+   that has not been consumed by the reader yet and belong to the reader.
+   All others belong to the worker thread, which will fill them from
+   SOURCE without holding the MUTEX. */
+typedef struct read_ahead_baton_t
+{
+  /* The stream that we read from in the worker thread. */
+  svn_stream_t *source;
+
+  /* READ_AHEAD_BLOCK_COUNT buffers of READ_AHEAD_BLOCK_SIZE bytes each
+     and the number of valid bytes in them. */
+  char *blocks[READ_AHEAD_BLOCK_COUNT];
+  apr_size_t lengths[READ_AHEAD_BLOCK_COUNT];
+
+  /* Protects all members below. */
+  svn_mutex__t *mutex;
+
+  /* Signaled whenever a block has been filled or released or when the
+     worker thread shall stop. */
+  apr_thread_cond_t *changed;
+
+  /* Index of the first block with unconsumed data. */
+  apr_size_t first;
+
+  /* Number of blocks with unconsumed data. */
+  apr_size_t full_count;
+
+  /* Number of bytes already consumed in block FIRST. */
+  apr_size_t offset;
+
+  /* Set by the worker thread once it won't fill any more blocks. */
+  svn_boolean_t done;
+
+  /* Set by the reader when the worker thread shall terminate. */
+  svn_boolean_t stop;
+
+  /* The error that terminated the worker thread. */
+  svn_error_t *error;
+
+  /* The worker thread.  NULL after it has been joined. */
+  apr_thread_t *thread;
+} read_ahead_baton_t;
+
+/* Wait for RA->CHANGED to be signaled.  RA->MUTEX must be locked. */
+static svn_error_t *
+read_ahead_wait(read_ahead_baton_t *ra)
+{
+  apr_status_t status = apr_thread_cond_wait(ra->changed,
+                                             svn_mutex__get(ra->mutex));
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't wait for read-ahead data"));
+
+  return SVN_NO_ERROR;
+}
+
+/* Signal RA->CHANGED.  RA->MUTEX should be locked. */
+static svn_error_t *
+read_ahead_signal(read_ahead_baton_t *ra)
+{
+  apr_status_t status = apr_thread_cond_broadcast(ra->changed);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't signal read-ahead data"));
+
+  return SVN_NO_ERROR;
+}
+
+/* The worker thread's main loop:  Fill free blocks in RA until we reach
+   the end of RA->SOURCE or until we are being asked to stop. */
+static svn_error_t *
+read_ahead_fill(read_ahead_baton_t *ra)
+{
+  svn_boolean_t eof = FALSE;
+  while (!eof)
+    {
+      svn_error_t *err = SVN_NO_ERROR;
+      apr_size_t len = READ_AHEAD_BLOCK_SIZE;
+      apr_size_t idx;
+      svn_boolean_t stop;
+
+      /* Wait for a free block. */
+      SVN_ERR(svn_mutex__lock(ra->mutex));
+      while (   !err
+             && !ra->stop
+             && ra->full_count == READ_AHEAD_BLOCK_COUNT)
+        err = read_ahead_wait(ra);
+
+      stop = ra->stop;
+      idx = (ra->first + ra->full_count) % READ_AHEAD_BLOCK_COUNT;
+      SVN_ERR(svn_mutex__unlock(ra->mutex, err));
+
+      if (stop)
+        break;
+
+      /* The reader won't access this block while we fill it. */
+      SVN_ERR(svn_stream_read_full(ra->source, ra->blocks[idx], &len));
+      eof = len < READ_AHEAD_BLOCK_SIZE;
+
+      /* Hand it over to the reader. */
+      SVN_ERR(svn_mutex__lock(ra->mutex));
+      ra->lengths[idx] = len;
+      if (len)
+        ra->full_count++;
+
+      SVN_ERR(svn_mutex__unlock(ra->mutex, read_ahead_signal(ra)));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Thread entry point.  DATA is the read_ahead_baton_t. */
+static void * APR_THREAD_FUNC
+read_ahead_worker(apr_thread_t *thread,
+                  void *data)
+{
+  read_ahead_baton_t *ra = data;
+  svn_error_t *err = read_ahead_fill(ra);
+
+  /* Tell the reader that there will be no further data. */
+  svn_error_clear(svn_mutex__lock(ra->mutex));
+  ra->error = err;
+  ra->done = TRUE;
+  svn_error_clear(svn_mutex__unlock(ra->mutex, read_ahead_signal(ra)));
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Wait until RA has data for the reader.  Return the unconsumed part of
+   the first block in *DATA and *LEN.  Set *LEN to 0 at the end of the
+   stream.  Report any error that terminated the worker thread. */
+static svn_error_t *
+read_ahead_peek(const char **data,
+                apr_size_t *len,
+                read_ahead_baton_t *ra)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__lock(ra->mutex));
+  while (!err && !ra->done && ra->full_count == 0)
+    err = read_ahead_wait(ra);
+
+  if (!err && ra->full_count)
+    {
+      *data = ra->blocks[ra->first] + ra->offset;
+      *len = ra->lengths[ra->first] - ra->offset;
+    }
+  else
+    {
+      *len = 0;
+      if (!err)
+        {
+          err = ra->error;
+          ra->error = SVN_NO_ERROR;
+        }
+    }
+
+  return svn_error_trace(svn_mutex__unlock(ra->mutex, err));
+}
+
+/* Mark the next LEN bytes in RA as consumed and release the first block
+   to the worker thread, if it has been consumed completely. */
+static svn_error_t *
+read_ahead_consume(read_ahead_baton_t *ra,
+                   apr_size_t len)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__lock(ra->mutex));
+  ra->offset += len;
+  if (ra->offset == ra->lengths[ra->first])
+    {
+      ra->first = (ra->first + 1) % READ_AHEAD_BLOCK_COUNT;
+      ra->full_count--;
+      ra->offset = 0;
+
+      err = read_ahead_signal(ra);
+    }
+
+  return svn_error_trace(svn_mutex__unlock(ra->mutex, err));
+}
+
+/* Stop and join the worker thread in RA, if it is still running.
+
+   The stop flag is only checked between reads.  If the worker thread is
+   currently blocked in a read from RA->SOURCE, we can't interrupt it
+   portably and have to wait for that read to return.  We must not leave
+   the thread running either, because it writes to buffers allocated in
+   the pool that is about to be cleaned up. */
+static svn_error_t *
+read_ahead_stop(read_ahead_baton_t *ra)
+{
+  apr_status_t retval, status;
+
+  if (ra->thread == NULL)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__lock(ra->mutex));
+  ra->stop = TRUE;
+  SVN_ERR(svn_mutex__unlock(ra->mutex, read_ahead_signal(ra)));
+
+  status = apr_thread_join(&retval, ra->thread);
+  ra->thread = NULL;
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't join read-ahead thread"));
+
+  /* Errors that the reader did not see don't matter anymore. */
+  svn_error_clear(ra->error);
+  ra->error = SVN_NO_ERROR;
+
+  return SVN_NO_ERROR;
+}
+
+/* Pool pre-cleanup handler making sure that the worker thread does not
+   access any of the buffers after they have been freed. */
+static apr_status_t
+read_ahead_cleanup(void *data)
+{
+  svn_error_clear(read_ahead_stop(data));
+  return APR_SUCCESS;
+}
+
+/* Implements svn_read_fn_t for read-ahead streams. */
+static svn_error_t *
+read_handler_read_ahead(void *baton,
+                        char *buffer,
+                        apr_size_t *len)
+{
+  read_ahead_baton_t *ra = baton;
+  apr_size_t total = 0;
+
+  while (total < *len)
+    {
+      const char *data;
+      apr_size_t available;
+
+      SVN_ERR(read_ahead_peek(&data, &available, ra));
+      if (available == 0)
+        break;
+
+      available = MIN(available, *len - total);
+      memcpy(buffer + total, data, available);
+      total += available;
+
+      SVN_ERR(read_ahead_consume(ra, available));
+    }
+
+  *len = total;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_stream_readline_fn_t for read-ahead streams.
+   Same logic as stream_readline_bytewise but scanning whole blocks. */
+static svn_error_t *
+readline_handler_read_ahead(void *baton,
+                            svn_stringbuf_t **stringbuf,
+                            const char *eol,
+                            svn_boolean_t *eof,
+                            apr_pool_t *pool)
+{
+  read_ahead_baton_t *ra = baton;
+  svn_stringbuf_t *str = svn_stringbuf_create_ensure(SVN__LINE_CHUNK_SIZE,
+                                                     pool);
+  const char *match = eol;
+
+  /* Read into STR up to and including the next EOL sequence. */
+  while (*match)
+    {
+      const char *data;
+      apr_size_t available;
+      apr_size_t i;
+
+      SVN_ERR(read_ahead_peek(&data, &available, ra));
+      if (available == 0)
+        {
+          /* The stream has run out. */
+          *eof = TRUE;
+          *stringbuf = str;
+          return SVN_NO_ERROR;
+        }
+
+      for (i = 0; i < available && *match; ++i)
+        if (data[i] == *match)
+          match++;
+        else
+          match = eol;
+
+      svn_stringbuf_appendbytes(str, data, i);
+      SVN_ERR(read_ahead_consume(ra, i));
+    }
+
+  *eof = FALSE;
+  svn_stringbuf_chop(str, match - eol);
+  *stringbuf = str;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_close_fn_t for read-ahead streams. */
+static svn_error_t *
+close_handler_read_ahead(void *baton)
+{
+  read_ahead_baton_t *ra = baton;
+
+  SVN_ERR(read_ahead_stop(ra));
+  return svn_error_trace(svn_stream_close(ra->source));
+}
+
+#endif
+
+svn_error_t *
+svn_stream__read_ahead(svn_stream_t **stream,
+                       svn_stream_t *source,
+                       apr_pool_t *result_pool)
+{
+#if APR_HAS_THREADS
+  read_ahead_baton_t *ra = apr_pcalloc(result_pool, sizeof(*ra));
+  apr_status_t status;
+  int i;
+
+  ra->source = source;
+  for (i = 0; i < READ_AHEAD_BLOCK_COUNT; ++i)
+    ra->blocks[i] = apr_palloc(result_pool, READ_AHEAD_BLOCK_SIZE);
+
+  SVN_ERR(svn_mutex__init(&ra->mutex, TRUE, result_pool));
+  status = apr_thread_cond_create(&ra->changed, result_pool);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't create condition variable"));
+
+  status = apr_thread_create(&ra->thread, NULL, read_ahead_worker, ra,
+                             result_pool);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't create read-ahead thread"));
+
+  /* Terminate the thread before its buffers get released. */
+  apr_pool_pre_cleanup_register(result_pool, ra, read_ahead_cleanup);
+
+  *stream = svn_stream_create(ra, result_pool);
+  svn_stream_set_read2(*stream, read_handler_read_ahead,
+                       read_handler_read_ahead);
+  svn_stream_set_readline(*stream, readline_handler_read_ahead);
+  svn_stream_set_close(*stream, close_handler_read_ahead);
+#else
+  *stream = source;
+#endif
+
+  return SVN_NO_ERROR;
+}
@@ -39,6 +39,7 @@
 #include "svn_dirent_uri.h"
 #include "svn_path.h"
 
+#include "private/svn_delta_private.h"
 #include "private/svn_wc_private.h"
 
 #include "wc.h"
@@ -1024,6 +1025,7 @@ read_and_checksum_pristine_text(svn_stream_t **stream,
 typedef struct open_txdelta_stream_baton_t
 {
   svn_boolean_t need_reset;
+  svn_boolean_t sliding;
   svn_stream_t *base_stream;
   svn_stream_t *local_stream;
 } open_txdelta_stream_baton_t;
@@ -1045,8 +1047,14 @@ open_txdelta_stream(svn_txdelta_stream_t **txdelta_stream_p,
       SVN_ERR(svn_stream_reset(b->local_stream));
     }
 
-  svn_txdelta2(txdelta_stream_p, b->base_stream, b->local_stream,
-               FALSE, result_pool);
+  /* The server applies the delta to the fulltext and deltifies the
+   * result on its own, so we may use sliding source views. */
+  if (b->sliding)
+    svn_txdelta__sliding(txdelta_stream_p, b->base_stream, b->local_stream,
+                         FALSE, result_pool);
+  else
+    svn_txdelta2(txdelta_stream_p, b->base_stream, b->local_stream,
+                 FALSE, result_pool);
   b->need_reset = TRUE;
   return SVN_NO_ERROR;
 }
@@ -1154,9 +1162,12 @@ svn_wc__internal_transmit_text_deltas(svn_stream_t *tempstream,
     baton.need_reset = FALSE;
     baton.base_stream = svn_stream_disown(base_stream, scratch_pool);
     baton.local_stream = svn_stream_disown(local_stream, scratch_pool);
-    err = editor->apply_textdelta_stream(editor, file_baton, base_digest_hex,
-                                         open_txdelta_stream, &baton,
-                                         scratch_pool);
+    err = svn_wc__db_get_sliding_delta_windows(&baton.sliding, db);
+    if (!err)
+      err = editor->apply_textdelta_stream(editor, file_baton,
+                                           base_digest_hex,
+                                           open_txdelta_stream, &baton,
+                                           scratch_pool);
   }
 
   /* Close the two streams to force writing the digest */
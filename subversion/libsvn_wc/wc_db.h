@@ -269,6 +269,14 @@ svn_error_t *
 svn_wc__db_close(svn_wc__db_t *db);
 
 
+/* Set *SLIDING to TRUE if the text deltas that we send for files in DB
+   shall use sliding source views, cf. svn_txdelta__sliding().  This is
+   taken from the configuration that DB has been opened with.  */
+svn_error_t *
+svn_wc__db_get_sliding_delta_windows(svn_boolean_t *sliding,
+                                     svn_wc__db_t *db);
+
+
 /* Initialize the SDB for LOCAL_ABSPATH, which should be a working copy path.
 
    A REPOSITORY row will be constructed for the repository identified by
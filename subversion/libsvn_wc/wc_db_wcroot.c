@@ -294,6 +294,18 @@ svn_wc__db_close(svn_wc__db_t *db)
 }
 
 
+svn_error_t *
+svn_wc__db_get_sliding_delta_windows(svn_boolean_t *sliding,
+                                     svn_wc__db_t *db)
+{
+  return svn_error_trace(svn_config_get_bool(
+                             db->config, sliding,
+                             SVN_CONFIG_SECTION_MISCELLANY,
+                             SVN_CONFIG_OPTION_SLIDING_DELTA_WINDOWS,
+                             FALSE));
+}
+
+
 svn_error_t *
 svn_wc__db_pdh_create_wcroot(svn_wc__db_wcroot_t **wcroot,
                              const char *wcroot_abspath,
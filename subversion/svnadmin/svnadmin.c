@@ -45,8 +45,10 @@
 #include "svn_fs.h"
 
 #include "private/svn_cmdline_private.h"
+#include "private/svn_io_private.h"
 #include "private/svn_opt_private.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_repos_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_cmdline_private.h"
 #include "private/svn_fspath.h"
@@ -97,6 +99,7 @@ check_lib_versions(void)
 /** Subcommands. **/
 
 static svn_opt_subcommand_t
+  subcommand_build_mergeinfo_index,
   subcommand_build_repcache,
   subcommand_crashtest,
   subcommand_create,
@@ -159,7 +162,11 @@ enum svnadmin__cmdline_options_t
     svnadmin__normalize_props,
     svnadmin__exclude,
     svnadmin__include,
-    svnadmin__glob
+    svnadmin__glob,
+    svnadmin__report_throughput,
+    svnadmin__jobs,
+    svnadmin__index_file,
+    svnadmin__drop_page_cache
   };
 
 /* Option codes and descriptions.
@@ -282,6 +289,12 @@ static const apr_getopt_option_t options_table[] =
      N_("disable flushing to disk during the operation\n"
         "                             (faster, but unsafe on power off)")},
 
+    {"drop-page-cache", svnadmin__drop_page_cache, 0,
+     N_("tell the OS to drop repository files from its\n"
+        "                             page cache once they have been read\n"
+        "                             (keeps the working set of a live server\n"
+        "                             cached; FSFS only)")},
+
     {"normalize-props", svnadmin__normalize_props, 0,
      N_("normalize property values found in the dumpstream\n"
         "                             (currently, only translates non-LF line endings)")},
@@ -298,6 +311,17 @@ static const apr_getopt_option_t options_table[] =
         "                             Character '/' is not treated specially, so\n"
         "                             pattern /*/foo matches paths /a/foo and /a/b/foo.") },
 
+    {"report-throughput", svnadmin__report_throughput, 0,
+     N_("report the load throughput in MB/s and revisions\n"
+        "                             per second when done")},
+
+    {"jobs", svnadmin__jobs, 1,
+     N_("dump up to ARG revision ranges in parallel\n"
+        "                             [default: 1]")},
+
+    {"index-file", svnadmin__index_file, 1,
+     N_("index of the revisions in the dump file")},
+
     {NULL}
   };
 
@@ -307,6 +331,15 @@ static const apr_getopt_option_t options_table[] =
  */
 static const svn_opt_subcommand_desc3_t cmd_table[] =
 {
+  {"build-mergeinfo-index", subcommand_build_mergeinfo_index, {0}, {N_(
+    "usage: svnadmin build-mergeinfo-index REPOS_PATH\n"
+    "\n"), N_(
+    "Create the mergeinfo index for the latest revision of the repository\n"
+    "at REPOS_PATH, such that future commits will maintain it. The index\n"
+    "must be enabled in the repository's fsfs.conf.\n"
+   )},
+   {'q', 'M'} },
+
   {"build-repcache", subcommand_build_repcache, {0}, {N_(
     "usage: svnadmin build-repcache REPOS_PATH [-r LOWER[:UPPER]]\n"
     "\n"), N_(
@@ -383,8 +416,12 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "excluded, the copy is transformed into an add (unlike in 'svndumpfilter').\n"
    )},
   {'r', svnadmin__incremental, svnadmin__deltas, 'q', 'M', 'F',
-   svnadmin__exclude, svnadmin__include, svnadmin__glob },
-  {{'F', N_("write to file ARG instead of stdout")}} },
+   svnadmin__exclude, svnadmin__include, svnadmin__glob, svnadmin__jobs,
+   svnadmin__index_file, svnadmin__drop_page_cache },
+  {{'F', N_("write to file ARG instead of stdout")},
+   {svnadmin__index_file, N_("write an index of the revisions in the\n"
+                             "                             "
+                             "dump file to file ARG")}} },
 
   {"dump-revprops", subcommand_dump_revprops, {0}, {N_(
     "usage: svnadmin dump-revprops REPOS_PATH [-r LOWER[:UPPER]]\n"
@@ -464,14 +501,20 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "one specified in the stream.  Progress feedback is sent to stdout.\n"
     "If --revision is specified, limit the loaded revisions to only those\n"
     "in the dump stream whose revision numbers match the specified range.\n"
+    "If --index-file is given as well, only the parts of the dump file\n"
+    "containing that range will be read.\n"
    )},
    {'q', 'r', svnadmin__ignore_uuid, svnadmin__force_uuid,
     svnadmin__ignore_dates,
     svnadmin__use_pre_commit_hook, svnadmin__use_post_commit_hook,
     svnadmin__parent_dir, svnadmin__normalize_props,
     svnadmin__bypass_prop_validation, 'M',
-    svnadmin__no_flush_to_disk, 'F'},
-   {{'F', N_("read from file ARG instead of stdin")}} },
+    svnadmin__no_flush_to_disk, 'F', svnadmin__report_throughput,
+    svnadmin__index_file},
+   {{'F', N_("read from file ARG instead of stdin")},
+    {svnadmin__index_file, N_("use the dump file index in file ARG\n"
+                              "                             "
+                              "(requires -F and -r)")}} },
 
   {"load-revprops", subcommand_load_revprops, {0}, {N_(
     "usage: svnadmin load-revprops REPOS_PATH\n"
@@ -630,7 +673,8 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "Verify the data stored in the repository.\n"
    )},
    {'t', 'r', 'q', svnadmin__keep_going, 'M',
-    svnadmin__check_normalization, svnadmin__metadata_only} },
+    svnadmin__check_normalization, svnadmin__metadata_only,
+    svnadmin__drop_page_cache} },
 
   { NULL, NULL, {0}, {NULL}, {0} }
 };
@@ -664,6 +708,7 @@ struct svnadmin_opt_state
   svn_boolean_t bypass_prop_validation;             /* --bypass-prop-validation */
   svn_boolean_t ignore_dates;                       /* --ignore-dates */
   svn_boolean_t no_flush_to_disk;                   /* --no-flush-to-disk */
+  svn_boolean_t drop_page_cache;                    /* --drop-page-cache */
   svn_boolean_t normalize_props;                    /* --normalize_props */
   enum svn_repos_load_uuid uuid_action;             /* --ignore-uuid,
                                                        --force-uuid */
@@ -673,18 +718,20 @@ struct svnadmin_opt_state
   apr_array_header_t *exclude;                      /* --exclude */
   apr_array_header_t *include;                      /* --include */
   svn_boolean_t glob;                               /* --pattern */
+  svn_boolean_t report_throughput;                  /* --report-throughput */
+  int jobs;                                         /* --jobs */
+  const char *index_file;                           /* --index-file */
 
   const char *config_dir;    /* Overriding Configuration Directory */
 };
 
 
-/* Helper to open a repository and set a warning func (so we don't
- * SEGFAULT when libsvn_fs's default handler gets run).  */
-static svn_error_t *
-open_repos(svn_repos_t **repos,
-           const char *path,
-           struct svnadmin_opt_state *opt_state,
-           apr_pool_t *pool)
+/* Return the FS configuration to use when opening existing repositories
+ * according to OPT_STATE, allocated in POOL.
+ */
+static apr_hash_t *
+get_fs_config(struct svnadmin_opt_state *opt_state,
+              apr_pool_t *pool)
 {
   /* Enable the "block-read" feature (where it applies)? */
   svn_boolean_t use_block_read
@@ -702,6 +749,21 @@ open_repos(svn_repos_t **repos,
                            use_block_read ? "1" : "0");
   svn_hash_sets(fs_config, SVN_FS_CONFIG_NO_FLUSH_TO_DISK,
                            opt_state->no_flush_to_disk ? "1" : "0");
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_SEQUENTIAL_SCAN,
+                           opt_state->drop_page_cache ? "1" : "0");
+
+  return fs_config;
+}
+
+/* Helper to open a repository and set a warning func (so we don't
+ * SEGFAULT when libsvn_fs's default handler gets run).  */
+static svn_error_t *
+open_repos(svn_repos_t **repos,
+           const char *path,
+           struct svnadmin_opt_state *opt_state,
+           apr_pool_t *pool)
+{
+  apr_hash_t *fs_config = get_fs_config(opt_state, pool);
 
   /* now, open the requested repository */
   SVN_ERR(svn_repos_open3(repos, path, fs_config, pool, pool));
@@ -1431,11 +1493,18 @@ subcommand_dump(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   svn_revnum_t lower, upper;
   svn_stream_t *feedback_stream = NULL;
   struct dump_filter_baton_t filter_baton = {0};
+  svn_repos__dump_index_t *index = NULL;
+
+  /* The parallel jobs use the same FS configuration as REPOS and
+     therefore share its cache namespace. */
+  apr_hash_t *fs_config = get_fs_config(opt_state, pool);
 
   /* Expect no more arguments. */
   SVN_ERR(parse_args(NULL, os, 0, 0, pool));
 
-  SVN_ERR(open_repos(&repos, opt_state->repository_path, opt_state, pool));
+  SVN_ERR(svn_repos_open3(&repos, opt_state->repository_path, fs_config,
+                          pool, pool));
+  svn_fs_set_warning_func(svn_repos_fs(repos), warning_func, NULL);
   SVN_ERR(get_dump_range(&lower, &upper, repos, opt_state, pool));
 
   /* Open the file or STDOUT, depending on whether -F was specified. */
@@ -1476,14 +1545,34 @@ subcommand_dump(apr_getopt_t *os, void *baton, apr_pool_t *pool)
                                  "cannot be used simultaneously"));
     }
 
-  SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
-                             opt_state->incremental, opt_state->use_deltas,
-                             TRUE, TRUE,
-                             !opt_state->quiet ? repos_notify_handler : NULL,
-                             feedback_stream,
-                             filter_baton.prefixes ? dump_filter_func : NULL,
-                             &filter_baton,
-                             check_cancel, NULL, pool));
+  if (opt_state->index_file)
+    index = svn_repos__dump_index_create(pool);
+
+  SVN_ERR(svn_repos__dump_fs_jobs(repos, fs_config, warning_func, NULL,
+                                  opt_state->jobs, index, out_stream,
+                                  lower, upper,
+                                  opt_state->incremental,
+                                  opt_state->use_deltas, TRUE, TRUE,
+                                  !opt_state->quiet
+                                    ? repos_notify_handler : NULL,
+                                  feedback_stream,
+                                  filter_baton.prefixes
+                                    ? dump_filter_func : NULL,
+                                  &filter_baton,
+                                  check_cancel, NULL, pool));
+
+  if (index)
+    {
+      apr_file_t *file;
+      svn_stream_t *index_stream;
+
+      SVN_ERR(svn_io_file_open(&file, opt_state->index_file,
+                               APR_WRITE | APR_CREATE | APR_TRUNCATE
+                               | APR_BUFFERED, APR_OS_DEFAULT, pool));
+      index_stream = svn_stream_from_aprfile2(file, FALSE, pool);
+      SVN_ERR(svn_repos__dump_index_write(index_stream, index, pool));
+      SVN_ERR(svn_stream_close(index_stream));
+    }
 
   return SVN_NO_ERROR;
 }
@@ -1701,6 +1790,62 @@ get_load_range(svn_revnum_t *lower,
 }
 
 
+/* Baton type used to measure the throughput of "svnadmin load". */
+struct load_throughput_baton_t
+{
+  /* The dump stream being read. */
+  svn_stream_t *source;
+
+  /* Number of bytes read from SOURCE so far. */
+  apr_uint64_t bytes;
+
+  /* Number of revisions committed so far. */
+  svn_revnum_t revisions;
+
+  /* Notification handler to forward all notifications to.  May be NULL. */
+  svn_repos_notify_func_t notify_func;
+  void *notify_baton;
+};
+
+/* Implements svn_read_fn_t, counting the bytes read from the dump stream
+   in the load_throughput_baton_t BATON. */
+static svn_error_t *
+load_throughput_read(void *baton,
+                     char *buffer,
+                     apr_size_t *len)
+{
+  struct load_throughput_baton_t *b = baton;
+
+  SVN_ERR(svn_stream_read_full(b->source, buffer, len));
+  b->bytes += *len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_close_fn_t for the load_throughput_baton_t BATON. */
+static svn_error_t *
+load_throughput_close(void *baton)
+{
+  struct load_throughput_baton_t *b = baton;
+  return svn_error_trace(svn_stream_close(b->source));
+}
+
+/* Implements svn_repos_notify_func_t, counting the committed revisions
+   in the load_throughput_baton_t BATON. */
+static void
+load_throughput_notify(void *baton,
+                       const svn_repos_notify_t *notify,
+                       apr_pool_t *scratch_pool)
+{
+  struct load_throughput_baton_t *b = baton;
+
+  if (notify->action == svn_repos_notify_load_txn_committed)
+    b->revisions++;
+
+  if (b->notify_func)
+    b->notify_func(b->notify_baton, notify, scratch_pool);
+}
+
 /* This implements `svn_opt_subcommand_t'. */
 static svn_error_t *
 subcommand_load(apr_getopt_t *os, void *baton, apr_pool_t *pool)
@@ -1711,6 +1856,14 @@ subcommand_load(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   svn_revnum_t lower, upper;
   svn_stream_t *in_stream;
   svn_stream_t *feedback_stream = NULL;
+  svn_repos_notify_func_t notify_func;
+  void *notify_baton;
+  struct load_throughput_baton_t throughput = { 0 };
+  apr_time_t start_time;
+
+  /* The input gets read in a separate thread.  Give it a pool of its own
+     such that the reader won't compete with us for allocations. */
+  apr_pool_t *read_pool = svn_pool_create(pool);
 
   /* Expect no more arguments. */
   SVN_ERR(parse_args(NULL, os, 0, 0, pool));
@@ -1721,17 +1874,69 @@ subcommand_load(apr_getopt_t *os, void *baton, apr_pool_t *pool)
 
   SVN_ERR(open_repos(&repos, opt_state->repository_path, opt_state, pool));
 
-  /* Open the file or STDIN, depending on whether -F was specified. */
-  if (opt_state->file)
+  /* The index is only useful for selecting revisions from a file. */
+  if (opt_state->index_file && ! opt_state->file)
+    return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                            _("'--index-file' requires '-F'"));
+  if (opt_state->index_file && ! SVN_IS_VALID_REVNUM(lower))
+    return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                            _("'--index-file' requires '-r'"));
+
+  /* Open the file or STDIN, depending on whether -F was specified.
+     With an index, we only need to read the parts of the file that
+     contain the requested revisions. */
+  if (opt_state->index_file)
+    {
+      svn_repos__dump_index_t *index;
+      svn_stream_t *index_stream;
+      apr_file_t *file;
+
+      SVN_ERR(svn_stream_open_readonly(&index_stream, opt_state->index_file,
+                                       pool, pool));
+      SVN_ERR(svn_repos__dump_index_read(&index, index_stream, pool, pool));
+      SVN_ERR(svn_stream_close(index_stream));
+
+      SVN_ERR(svn_io_file_open(&file, opt_state->file,
+                               APR_READ | APR_BUFFERED, APR_OS_DEFAULT,
+                               read_pool));
+      SVN_ERR(svn_repos__dump_index_range(&in_stream, file, index,
+                                          lower, upper, read_pool));
+    }
+  else if (opt_state->file)
     SVN_ERR(svn_stream_open_readonly(&in_stream, opt_state->file,
-                                     pool, pool));
+                                     read_pool, pool));
   else
-    SVN_ERR(svn_stream_for_stdin2(&in_stream, TRUE, pool));
+    SVN_ERR(svn_stream_for_stdin2(&in_stream, TRUE, read_pool));
 
   /* Progress feedback goes to STDOUT, unless they asked to suppress it. */
   if (! opt_state->quiet)
     feedback_stream = recode_stream_create(stdout, pool);
 
+  notify_func = opt_state->quiet ? NULL : repos_notify_handler;
+  notify_baton = feedback_stream;
+
+  /* Count bytes and revisions, if requested. */
+  if (opt_state->report_throughput)
+    {
+      throughput.source = in_stream;
+      throughput.notify_func = notify_func;
+      throughput.notify_baton = notify_baton;
+
+      in_stream = svn_stream_create(&throughput, read_pool);
+      svn_stream_set_read2(in_stream, NULL, load_throughput_read);
+      svn_stream_set_close(in_stream, load_throughput_close);
+
+      notify_func = load_throughput_notify;
+      notify_baton = &throughput;
+    }
+
+  /* Parse and commit while the next parts of the dump get read.
+     Stopping the read-ahead waits for any pending read to complete,
+     so an early error would hang on a terminal waiting for input. */
+  if (opt_state->file || ! svn_cmdline__stdin_is_a_terminal())
+    SVN_ERR(svn_stream__read_ahead(&in_stream, in_stream, pool));
+
+  start_time = apr_time_now();
   err = svn_repos_load_fs6(repos, in_stream, lower, upper,
                            opt_state->uuid_action, opt_state->parent_dir,
                            opt_state->use_pre_commit_hook,
@@ -1739,8 +1944,30 @@ subcommand_load(apr_getopt_t *os, void *baton, apr_pool_t *pool)
                            !opt_state->bypass_prop_validation,
                            opt_state->ignore_dates,
                            opt_state->normalize_props,
-                           opt_state->quiet ? NULL : repos_notify_handler,
-                           feedback_stream, check_cancel, NULL, pool);
+                           notify_func, notify_baton,
+                           check_cancel, NULL, pool);
+
+  /* Make sure the read-ahead has finished before we look at its data. */
+  err = svn_error_compose_create(err, svn_stream_close(in_stream));
+
+  if (!err && opt_state->report_throughput)
+    {
+      double seconds = (double)(apr_time_now() - start_time)
+                     / APR_USEC_PER_SEC;
+      double megabytes = (double)throughput.bytes / (1024 * 1024);
+
+      /* Avoid division by zero for very short loads. */
+      if (seconds < 0.001)
+        seconds = 0.001;
+
+      SVN_ERR(svn_cmdline_printf(pool,
+                                 _("Loaded %ld revision(s), %.1f MB in "
+                                   "%.1f seconds: %.1f MB/s, "
+                                   "%.1f revisions/s.\n"),
+                                 throughput.revisions, megabytes, seconds,
+                                 megabytes / seconds,
+                                 throughput.revisions / seconds));
+    }
 
   if (svn_error_find_cause(err, SVN_ERR_BAD_PROPERTY_VALUE_EOL))
     {
@@ -3035,6 +3262,39 @@ subcommand_build_repcache(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* This implements `svn_opt_subcommand_t'. */
+static svn_error_t *
+subcommand_build_mergeinfo_index(apr_getopt_t *os, void *baton,
+                                 apr_pool_t *pool)
+{
+  struct svnadmin_opt_state *opt_state = baton;
+  svn_fs_fs__ioctl_build_mergeinfo_index_input_t input = {0};
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_error_t *err;
+
+  /* Expect no more arguments. */
+  SVN_ERR(parse_args(NULL, os, 0, 0, pool));
+
+  SVN_ERR(open_repos(&repos, opt_state->repository_path, opt_state, pool));
+  fs = svn_repos_fs(repos);
+
+  if (!opt_state->quiet)
+    input.progress_func = build_rep_cache_progress_func;
+
+  err = svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_BUILD_MERGEINFO_INDEX,
+                     &input, NULL,
+                     check_cancel, NULL, pool, pool);
+  if (err && err->apr_err == SVN_ERR_FS_UNRECOGNIZED_IOCTL_CODE)
+    return svn_error_quick_wrapf(err,
+                                 _("Building the mergeinfo index is not "
+                                   "implemented for the filesystem type "
+                                   "found in '%s'"),
+                                 svn_fs_path(fs, pool));
+
+  return svn_error_trace(err);
+}
+
 
 /** Main. **/
 
@@ -3270,9 +3530,26 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       case svnadmin__no_flush_to_disk:
         opt_state.no_flush_to_disk = TRUE;
         break;
+      case svnadmin__drop_page_cache:
+        opt_state.drop_page_cache = TRUE;
+        break;
       case svnadmin__normalize_props:
         opt_state.normalize_props = TRUE;
         break;
+      case svnadmin__report_throughput:
+        opt_state.report_throughput = TRUE;
+        break;
+      case svnadmin__index_file:
+        SVN_ERR(svn_utf_cstring_to_utf8(&utf8_opt_arg, opt_arg, pool));
+        opt_state.index_file = svn_dirent_internal_style(utf8_opt_arg, pool);
+        break;
+      case svnadmin__jobs:
+        SVN_ERR(svn_cstring_atoi(&opt_state.jobs, opt_arg));
+        if (opt_state.jobs < 1)
+          return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                   _("Invalid number of jobs '%s'"),
+                                   opt_arg);
+        break;
       case svnadmin__exclude:
         SVN_ERR(svn_utf_cstring_to_utf8(&utf8_opt_arg, opt_arg, pool));
 
@@ -3417,7 +3694,9 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     svn_cache_config_t settings = *svn_cache_config_get();
 
     settings.cache_size = opt_state.memory_cache_size;
-    settings.single_threaded = TRUE;
+
+    /* Parallel dump jobs share the caches. */
+    settings.single_threaded = opt_state.jobs <= 1;
 
     svn_cache_config_set(&settings);
   }
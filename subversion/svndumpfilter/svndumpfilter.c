@@ -882,6 +882,18 @@ close_node(void *node_baton)
 }
 
 
+/* Implements svn_repos__parse_skip_node_func_t.  The contents of dropped
+   nodes don't need to be parsed at all. */
+static svn_error_t *
+skip_node(svn_boolean_t *skip, void *node_baton)
+{
+  struct node_baton_t *nb = node_baton;
+  *skip = nb->do_skip;
+
+  return SVN_NO_ERROR;
+}
+
+
 /* Finalize revision */
 static svn_error_t *
 close_revision(void *revision_baton)
@@ -1030,6 +1042,32 @@ struct svndumpfilter_opt_state
 };
 
 
+/* Set *STREAM to read from STDIN.  If that has been redirected from a
+   regular file, the stream will support seeking, which allows the parser
+   to pass over the contents of dropped nodes without reading them.
+   Allocate the stream in POOL. */
+static svn_error_t *
+open_input_stream(svn_stream_t **stream,
+                  apr_pool_t *pool)
+{
+  apr_file_t *stdin_file;
+  apr_finfo_t finfo;
+  apr_status_t apr_err;
+
+  apr_err = apr_file_open_flags_stdin(&stdin_file, APR_BUFFERED, pool);
+  if (apr_err)
+    return svn_error_wrap_apr(apr_err, "Can't open stdin");
+
+  SVN_ERR(svn_io_file_info_get(&finfo, APR_FINFO_TYPE, stdin_file, pool));
+  if (finfo.filetype == APR_REG)
+    *stream = svn_stream_from_aprfile2(stdin_file, TRUE, pool);
+  else
+    SVN_ERR(svn_stream_for_stdin2(stream, TRUE, pool));
+
+  return SVN_NO_ERROR;
+}
+
+
 static svn_error_t *
 parse_baton_initialize(struct parse_baton_t **pb,
                        struct svndumpfilter_opt_state *opt_state,
@@ -1039,7 +1077,7 @@ parse_baton_initialize(struct parse_baton_t **pb,
   struct parse_baton_t *baton = apr_palloc(pool, sizeof(*baton));
 
   /* Read the stream from STDIN.  Users can redirect a file. */
-  SVN_ERR(svn_stream_for_stdin2(&baton->in_stream, TRUE, pool));
+  SVN_ERR(open_input_stream(&baton->in_stream, pool));
 
   /* Have the parser dump results to STDOUT. Users can redirect a file. */
   SVN_ERR(svn_stream_for_stdout(&baton->out_stream, pool));
@@ -1173,8 +1211,8 @@ do_filter(apr_getopt_t *os,
     }
 
   SVN_ERR(parse_baton_initialize(&pb, opt_state, do_exclude, pool));
-  SVN_ERR(svn_repos_parse_dumpstream3(pb->in_stream, &filtering_vtable, pb,
-                                      TRUE, NULL, NULL, pool));
+  SVN_ERR(svn_repos__parse_dumpstream(pb->in_stream, &filtering_vtable, pb,
+                                      TRUE, skip_node, NULL, NULL, pool));
 
   /* The rest of this is just reporting.  If we aren't reporting, get
      outta here. */
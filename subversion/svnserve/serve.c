@@ -54,6 +54,7 @@
 #include "private/svn_log.h"
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_ra_svn_private.h"
+#include "private/svn_repos_private.h"
 #include "private/svn_fspath.h"
 
 #ifdef HAVE_UNISTD_H
@@ -433,6 +434,26 @@ static void convert_case(char *text, svn_boolean_t to_uppercase)
     }
 }
 
+/* If we have a username in B, and we've not yet used it + any username
+   case normalization that might be requested to determine "the
+   username we used for authz purposes", do so now. */
+static void set_authz_user(server_baton_t *b)
+{
+  repository_t *repository = b->repository;
+  client_info_t *client_info = b->client_info;
+
+  if (client_info->user && (! client_info->authz_user))
+    {
+      char *authz_user = apr_pstrdup(b->pool, client_info->user);
+      if (repository->username_case == CASE_FORCE_UPPER)
+        convert_case(authz_user, TRUE);
+      else if (repository->username_case == CASE_FORCE_LOWER)
+        convert_case(authz_user, FALSE);
+
+      client_info->authz_user = authz_user;
+    }
+}
+
 /* Set *ALLOWED to TRUE if PATH is accessible in the REQUIRED mode to
    the user described in BATON according to the authz rules in BATON.
    Use POOL for temporary allocations only.  If no authz rules are
@@ -465,20 +486,7 @@ static svn_error_t *authz_check_access(svn_boolean_t *allowed,
   if (path && *path != '/')
     path = svn_fspath__canonicalize(path, pool);
 
-  /* If we have a username, and we've not yet used it + any username
-     case normalization that might be requested to determine "the
-     username we used for authz purposes", do so now. */
-  if (client_info->user && (! client_info->authz_user))
-    {
-      char *authz_user = apr_pstrdup(b->pool, client_info->user);
-      if (repository->username_case == CASE_FORCE_UPPER)
-        convert_case(authz_user, TRUE);
-      else if (repository->username_case == CASE_FORCE_LOWER)
-        convert_case(authz_user, FALSE);
-
-      client_info->authz_user = authz_user;
-    }
-
+  set_authz_user(b);
   SVN_ERR(svn_repos_authz_check_access(repository->authzdb,
                                        repository->authz_repos_name,
                                        path, client_info->authz_user,
@@ -505,6 +513,58 @@ static svn_error_t *authz_check_access_cb(svn_boolean_t *allowed,
                             sb->server, pool);
 }
 
+/* Batch version of authz_check_access_cb:  Set the elements of ALLOWED
+ * to TRUE if the respective path in PATHS is readable by the user
+ * described in BATON.  Use POOL for temporary allocations only.  ROOT
+ * is not used.  Implements the svn_repos__authz_many_func_t interface.
+ */
+static svn_error_t *authz_check_access_many_cb(svn_boolean_t *allowed,
+                                               svn_fs_root_t *root,
+                                               const apr_array_header_t *paths,
+                                               void *baton,
+                                               apr_pool_t *pool)
+{
+  authz_baton_t *sb = baton;
+  server_baton_t *b = sb->server;
+  repository_t *repository = b->repository;
+  apr_array_header_t *canonical_paths;
+  int i;
+
+  /* Same as in authz_check_access. */
+  if (!repository->authzdb)
+    {
+      for (i = 0; i < paths->nelts; ++i)
+        allowed[i] = TRUE;
+
+      return SVN_NO_ERROR;
+    }
+
+  canonical_paths = apr_array_make(pool, paths->nelts, sizeof(const char *));
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      if (path && *path != '/')
+        path = svn_fspath__canonicalize(path, pool);
+
+      APR_ARRAY_PUSH(canonical_paths, const char *) = path;
+    }
+
+  set_authz_user(b);
+  SVN_ERR(svn_repos__authz_check_access_many(allowed, repository->authzdb,
+                                             repository->authz_repos_name,
+                                             canonical_paths,
+                                             b->client_info->authz_user,
+                                             svn_authz_read, pool));
+
+  for (i = 0; i < canonical_paths->nelts; ++i)
+    if (!allowed[i])
+      SVN_ERR(log_authz_denied(APR_ARRAY_IDX(canonical_paths, i,
+                                             const char *),
+                               svn_authz_read, b, pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* If authz is enabled in the specified BATON, return a read authorization
    function. Otherwise, return NULL. */
 static svn_repos_authz_func_t authz_check_access_cb_func(server_baton_t *baton)
@@ -1014,6 +1074,7 @@ static svn_error_t *accept_report(svn_boolean_t *only_empty_entry,
                                       authz_check_access_cb_func(b),
                                       &ab, svn_ra_svn_zero_copy_limit(conn),
                                       pool));
+  svn_repos__report_set_jobs(report_baton, b->report_jobs, b->fs_config);
 
   rb.sb = b;
   rb.repos_url = svn_path_uri_decode(b->repository->repos_url, pool);
@@ -3515,6 +3576,35 @@ replay(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+/* Send the revprops of REV followed by its replay, as part of a
+   replay-range command. */
+static svn_error_t *
+replay_range_revision(svn_ra_svn_conn_t *conn,
+                      server_baton_t *b,
+                      svn_revnum_t rev,
+                      svn_revnum_t low_water_mark,
+                      svn_boolean_t send_deltas,
+                      apr_pool_t *pool)
+{
+  apr_hash_t *props;
+  authz_baton_t ab;
+
+  ab.server = b;
+  ab.conn = conn;
+
+  SVN_CMD_ERR(svn_repos_fs_revision_proplist(&props,
+                                             b->repository->repos, rev,
+                                             authz_check_access_cb_func(b),
+                                             &ab,
+                                             pool));
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "w(!", "revprops"));
+  SVN_ERR(svn_ra_svn__write_proplist(conn, pool, props));
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!)"));
+
+  return svn_error_trace(replay_one_revision(conn, b, rev, low_water_mark,
+                                             send_deltas, pool));
+}
+
 static svn_error_t *
 replay_range(svn_ra_svn_conn_t *conn,
              apr_pool_t *pool,
@@ -3525,10 +3615,8 @@ replay_range(svn_ra_svn_conn_t *conn,
   svn_boolean_t send_deltas;
   server_baton_t *b = baton;
   apr_pool_t *iterpool;
-  authz_baton_t ab;
-
-  ab.server = b;
-  ab.conn = conn;
+  svn_repos__replay_prefetcher_t *prefetcher;
+  svn_error_t *err = SVN_NO_ERROR;
 
   SVN_ERR(svn_ra_svn__parse_tuple(params, "rrrb", &start_rev,
                                  &end_rev, &low_water_mark,
@@ -3536,28 +3624,30 @@ replay_range(svn_ra_svn_conn_t *conn,
 
   SVN_ERR(trivial_auth_request(conn, pool, b));
 
+  /* Read the next revisions while we are sending the current one.
+     Writing to CONN blocks while the client is busy, which keeps the
+     prefetcher from running away. */
+  SVN_ERR(svn_repos__replay_prefetcher_start(&prefetcher,
+                                             b->repository->repos,
+                                             b->repository->fs_path->data,
+                                             start_rev, end_rev,
+                                             send_deltas, pool));
+
   iterpool = svn_pool_create(pool);
-  for (rev = start_rev; rev <= end_rev; rev++)
+  for (rev = start_rev; rev <= end_rev && !err; rev++)
     {
-      apr_hash_t *props;
-
       svn_pool_clear(iterpool);
 
-      SVN_CMD_ERR(svn_repos_fs_revision_proplist(&props,
-                                                 b->repository->repos, rev,
-                                                 authz_check_access_cb_func(b),
-                                                 &ab,
-                                                 iterpool));
-      SVN_ERR(svn_ra_svn__write_tuple(conn, iterpool, "w(!", "revprops"));
-      SVN_ERR(svn_ra_svn__write_proplist(conn, iterpool, props));
-      SVN_ERR(svn_ra_svn__write_tuple(conn, iterpool, "!)"));
-
-      SVN_ERR(replay_one_revision(conn, b, rev, low_water_mark,
-                                  send_deltas, iterpool));
-
+      err = svn_repos__replay_prefetcher_progress(prefetcher, rev);
+      if (!err)
+        err = replay_range_revision(conn, b, rev, low_water_mark,
+                                    send_deltas, iterpool);
     }
   svn_pool_destroy(iterpool);
 
+  SVN_ERR(svn_error_compose_create(
+            err, svn_repos__replay_prefetcher_stop(prefetcher)));
+
   SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, ""));
 
   return SVN_NO_ERROR;
@@ -4231,6 +4321,8 @@ construct_server_baton(server_baton_t **baton,
   b->read_only = params->read_only;
   b->pool = conn_pool;
   b->vhost = params->vhost;
+  b->report_jobs = params->report_jobs;
+  b->fs_config = params->fs_config;
 
   b->logger = params->logger;
   b->client_info = get_client_info(conn, params, conn_pool);
@@ -4529,6 +4621,14 @@ serve_interruptable(svn_boolean_t *terminate_p,
   return svn_error_trace(err);
 }
 
+svn_error_t *serve_init(void)
+{
+  /* Let the repos layer check whole batches of paths at once. */
+  return svn_error_trace(svn_repos__authz_register_many_func(
+                           authz_check_access_cb,
+                           authz_check_access_many_cb));
+}
+
 svn_error_t *serve(svn_ra_svn_conn_t *conn,
                    serve_params_t *params,
                    apr_pool_t *pool)
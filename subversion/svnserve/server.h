@@ -90,6 +90,8 @@ typedef struct server_baton_t {
                               May be NULL even if log_file is not. */
   svn_boolean_t read_only; /* Disallow write access (global flag) */
   svn_boolean_t vhost;     /* Use virtual-host-based path to repo. */
+  int report_jobs;         /* Delta prefetching threads per report */
+  apr_hash_t *fs_config;   /* FS config to open additional instances with */
   apr_pool_t *pool;
 } server_baton_t;
 
@@ -159,6 +161,10 @@ typedef struct serve_params_t {
 
   /* Use virtual-host-based path to repo. */
   svn_boolean_t vhost;
+
+  /* Number of threads per report that compute file deltas ahead of time.
+     0 disables delta prefetching. */
+  int report_jobs;
 } serve_params_t;
 
 /* This structure contains all data that describes a client / server
@@ -200,6 +206,10 @@ client_info_t * get_client_info(svn_ra_svn_conn_t *conn,
                                 serve_params_t *params,
                                 apr_pool_t *pool);
 
+/* Initialize the serving code.  Call this once before serving any
+   connection and before starting any threads. */
+svn_error_t *serve_init(void);
+
 /* Serve the connection CONN according to the parameters PARAMS. */
 svn_error_t *serve(svn_ra_svn_conn_t *conn, serve_params_t *params,
                    apr_pool_t *pool);
@@ -56,9 +56,11 @@
 #include "private/svn_cmdline_private.h"
 #include "private/svn_atomic.h"
 #include "private/svn_mutex.h"
+#include "private/svn_ra_svn_private.h"
 #include "private/svn_subr_private.h"
 
 #if APR_HAS_THREADS
+#    include <apr_poll.h>
 #    include <apr_thread_pool.h>
 #endif
 
@@ -145,6 +147,12 @@ enum run_mode {
  */
 #define THREADPOOL_THREAD_IDLE_LIMIT 1000000
 
+/* Maximum number of connections with new requests that we pick up from
+ * the poll set per wake-up in --park-idle mode.  This does not limit the
+ * number of idle connections.
+ */
+#define IDLE_POLL_BATCH_SIZE 256
+
 /* Number of client to server connections that may concurrently in the
  * TCP 3-way handshake state, i.e. are in the process of being created.
  *
@@ -222,6 +230,8 @@ void winservice_notify_stop(void)
 #define SVNSERVE_OPT_MAX_REQUEST     274
 #define SVNSERVE_OPT_MAX_RESPONSE    275
 #define SVNSERVE_OPT_CACHE_NODEPROPS 276
+#define SVNSERVE_OPT_REPORT_JOBS     277
+#define SVNSERVE_OPT_PARK_IDLE       278
 
 /* Text macro because we can't use #ifdef sections inside a N_("...")
    macro expansion. */
@@ -362,6 +372,23 @@ static const apr_getopt_option_t svnserve__options[] =
         "                             "
         "Default is " APR_STRINGIFY(THREADPOOL_MAX_SIZE) "."
         ONLY_AVAILABLE_WITH_THEADS)},
+    {"report-jobs",      SVNSERVE_OPT_REPORT_JOBS, 1,
+     N_("Number of additional threads per checkout or\n"
+        "                             "
+        "update that compute file deltas ahead of time.\n"
+        "                             "
+        "Default is 0 (compute them on demand).")},
+    {"park-idle",        SVNSERVE_OPT_PARK_IDLE, 0,
+     N_("Don't keep a server thread per connection while\n"
+        "                             "
+        "waiting for the client's next request.  Watch all\n"
+        "                             "
+        "idle connections from a single thread instead.\n"
+        "                             "
+        "Useful with many mostly idle clients.\n"
+        "                             "
+        "[mode: daemon with --threads]"
+        ONLY_AVAILABLE_WITH_THEADS)},
 #endif
     {"max-request-size", SVNSERVE_OPT_MAX_REQUEST, 1,
      N_("Maximum acceptable size of a client request in MB.\n"
@@ -614,29 +641,69 @@ static svn_root_pools__t *connection_pools;
 /* The global thread pool serving all connections. */
 static apr_thread_pool_t *threads;
 
+/* In --park-idle mode, the connections waiting for their next request.
+   NULL, if idle connections shall block their worker thread instead. */
+static apr_pollset_t *idle_connections = NULL;
+
 /* Very simple load determination callback for serve_interruptable:
    With less than half the threads in THREADS in use, we can afford to
-   wait in the socket read() function.  Otherwise, poll them round-robin. */
+   wait in the socket read() function.  Otherwise, poll them round-robin.
+   Never wait in --park-idle mode. */
 static svn_boolean_t
 is_busy(connection_t *connection)
 {
+  if (idle_connections)
+    return TRUE;
+
   return apr_thread_pool_threads_count(threads) * 2
        > apr_thread_pool_thread_max_get(threads);
 }
 
+/* Add CONNECTION to IDLE_CONNECTIONS, where it waits for its next
+   request.  CONNECTION must not be used by the caller after that. */
+static apr_status_t
+park_connection(connection_t *connection)
+{
+  apr_pollfd_t pfd = { 0 };
+
+  pfd.p = connection->pool;
+  pfd.desc_type = APR_POLL_SOCKET;
+  pfd.reqevents = APR_POLLIN;
+  pfd.desc.s = connection->usock;
+  pfd.client_data = connection;
+
+  return apr_pollset_add(idle_connections, &pfd);
+}
+
 /* Serve the connection given by DATA.  Under high load, serve only
    the current command (if any) and then put the connection back into
-   THREAD's task pool. */
+   THREAD's task pool.  In --park-idle mode, serve all commands that
+   are ready and then park the connection in IDLE_CONNECTIONS. */
 static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
 {
   svn_boolean_t done;
+  svn_boolean_t has_command = FALSE;
   connection_t *connection = data;
   svn_error_t *err;
+  apr_status_t status;
 
   apr_pool_t *pool = svn_root_pools__acquire_pool(connection_pools);
+  apr_pool_t *iterpool = svn_pool_create(pool);
 
   /* process the actual request and log errors */
-  err = serve_interruptable(&done, connection, is_busy, pool);
+  do
+    {
+      svn_pool_clear(iterpool);
+      err = serve_interruptable(&done, connection, is_busy, iterpool);
+
+      /* The client may have sent more than one command at once.  Those
+         won't trigger a poll event, so handle them right here. */
+      if (!err && !done && idle_connections)
+        err = svn_ra_svn__has_command(&has_command, &done, connection->conn,
+                                      iterpool);
+    }
+  while (!err && !done && idle_connections && has_command);
+
   if (err)
     {
       logger__log_error(connection->params->logger, err, NULL,
@@ -649,10 +716,81 @@ static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
 
   /* Close or re-schedule connection. */
   if (done)
-    close_connection(connection);
+    {
+      close_connection(connection);
+    }
+  else if (idle_connections)
+    {
+      status = park_connection(connection);
+      if (status)
+        {
+          err = svn_error_wrap_apr(status, _("Can't park idle connection"));
+          logger__log_error(connection->params->logger, err, NULL, NULL);
+          svn_error_clear(err);
+          close_connection(connection);
+        }
+    }
   else
-    apr_thread_pool_push(threads, serve_thread, connection, 0, NULL);
+    {
+      apr_thread_pool_push(threads, serve_thread, connection, 0, NULL);
+    }
+
+  return NULL;
+}
+
+/* Wait for requests on IDLE_CONNECTIONS and hand the respective
+   connections over to THREADS.  DATA is the serve_params_t. */
+static void * APR_THREAD_FUNC poll_thread(apr_thread_t *tid, void *data)
+{
+  serve_params_t *params = data;
+
+  while (TRUE)
+    {
+      const apr_pollfd_t *events;
+      apr_int32_t count;
+      apr_int32_t i;
+      apr_status_t status;
+
+      status = apr_pollset_poll(idle_connections, -1, &count, &events);
+      if (APR_STATUS_IS_EINTR(status) || APR_STATUS_IS_TIMEUP(status))
+        continue;
+
+      if (status)
+        {
+          /* Without this thread, parked connections would starve.
+             So, don't give up but don't spin on a persistent error
+             either. */
+          svn_error_t *err = svn_error_wrap_apr(status,
+                                                _("Can't poll idle "
+                                                  "connections"));
+          logger__log_error(params->logger, err, NULL, NULL);
+          svn_error_clear(err);
+          apr_sleep(apr_time_from_sec(1));
+          continue;
+        }
 
+      for (i = 0; i < count; ++i)
+        {
+          connection_t *connection = events[i].client_data;
+
+          /* Readable or closed - either way, the connection needs
+             a worker thread now.  Make sure it won't be reported again
+             while that one is busy. */
+          apr_pollset_remove(idle_connections, &events[i]);
+          status = apr_thread_pool_push(threads, serve_thread, connection,
+                                        0, NULL);
+          if (status)
+            {
+              svn_error_t *err = svn_error_wrap_apr(status,
+                                                    _("Can't push task"));
+              logger__log_error(params->logger, err, NULL, NULL);
+              svn_error_clear(err);
+              close_connection(connection);
+            }
+        }
+    }
+
+  /* NOTREACHED */
   return NULL;
 }
 
@@ -742,6 +880,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   svn_node_kind_t kind;
   apr_size_t min_thread_count = THREADPOOL_MIN_SIZE;
   apr_size_t max_thread_count = THREADPOOL_MAX_SIZE;
+  svn_boolean_t park_idle = FALSE;
 #ifdef SVN_HAVE_SASL
   SVN_ERR(cyrus_init(pool));
 #endif
@@ -754,6 +893,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 
   /* Initialize the efficient Authz support. */
   SVN_ERR(svn_repos_authz_initialize(pool));
+  SVN_ERR(serve_init());
 
   SVN_ERR(svn_cmdline__getopt_init(&os, argc, argv, pool));
 
@@ -774,6 +914,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   params.error_check_interval = 4096;
   params.max_request_size = MAX_REQUEST_SIZE * 0x100000;
   params.max_response_size = 0;
+  params.report_jobs = 0;
 
   while (1)
     {
@@ -962,6 +1103,16 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           max_thread_count = (apr_size_t)apr_strtoi64(arg, NULL, 0);
           break;
 
+        case SVNSERVE_OPT_REPORT_JOBS:
+          params.report_jobs = (int)apr_strtoi64(arg, NULL, 0);
+          if (params.report_jobs < 0)
+            params.report_jobs = 0;
+          break;
+
+        case SVNSERVE_OPT_PARK_IDLE:
+          park_idle = TRUE;
+          break;
+
 #ifdef WIN32
         case SVNSERVE_OPT_SERVICE:
           if (run_mode != run_mode_service)
@@ -1079,6 +1230,14 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
                _("Option --tunnel-user is only valid in tunnel mode"));
     }
 
+  if (park_idle && (run_mode != run_mode_daemon
+                    || handling_mode != connection_mode_thread))
+    {
+      return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+               _("Option --park-idle is only valid in daemon mode "
+                 "with --threads"));
+    }
+
   if (run_mode == run_mode_inetd || run_mode == run_mode_tunnel)
     {
       apr_pool_t *connection_pool;
@@ -1323,6 +1482,23 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 
       /* don't queue requests unless we reached the worker thread limit */
       apr_thread_pool_threshold_set(threads, 0);
+
+      /* let a single thread wait for requests on all idle connections */
+      if (park_idle)
+        {
+          apr_thread_t *tid;
+
+          status = apr_pollset_create(&idle_connections, IDLE_POLL_BATCH_SIZE,
+                                      pool, APR_POLLSET_THREADSAFE);
+          if (status)
+            return svn_error_wrap_apr(status,
+                                      _("Can't create poll set for idle "
+                                        "connections"));
+
+          status = apr_thread_create(&tid, NULL, poll_thread, &params, pool);
+          if (status)
+            return svn_error_wrap_apr(status, _("Can't create thread"));
+        }
     }
   else
     {
@@ -29,6 +29,7 @@
 #include "svn_error.h"
 #include "svn_delta.h"
 
+#include "private/svn_delta_private.h"
 #include "private/svn_subr_private.h"
 
 static svn_error_t *
@@ -97,6 +98,109 @@ stream_window_test(apr_pool_t *pool)
 }
 
 
+/* Run the delta between SOURCE and TARGET produced by either svn_txdelta2
+ * or, if SLIDING is set, svn_txdelta__sliding through svn_txdelta_apply
+ * and verify that the result matches TARGET.  Return the number of new
+ * data bytes in the delta in *NEW_DATA_LEN.  Use POOL for allocations. */
+static svn_error_t *
+apply_and_verify(apr_size_t *new_data_len,
+                 const svn_string_t *source,
+                 const svn_string_t *target,
+                 svn_boolean_t sliding,
+                 apr_pool_t *pool)
+{
+  svn_stringbuf_t *result = svn_stringbuf_create_empty(pool);
+  svn_txdelta_stream_t *txstream;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+
+  if (sliding)
+    svn_txdelta__sliding(&txstream, svn_stream_from_string(source, pool),
+                         svn_stream_from_string(target, pool), FALSE, pool);
+  else
+    svn_txdelta2(&txstream, svn_stream_from_string(source, pool),
+                 svn_stream_from_string(target, pool), FALSE, pool);
+
+  svn_txdelta_apply(svn_stream_from_string(source, pool),
+                    svn_stream_from_stringbuf(result, pool),
+                    NULL, NULL, pool, &handler, &handler_baton);
+
+  *new_data_len = 0;
+  while (1)
+    {
+      svn_txdelta_window_t *window;
+
+      SVN_ERR(svn_txdelta_next_window(&window, txstream, pool));
+      SVN_ERR(handler(window, handler_baton));
+      if (window == NULL)
+        break;
+
+      *new_data_len += window->new_data->len;
+    }
+
+  SVN_TEST_INT_ASSERT(result->len, target->len);
+  SVN_TEST_ASSERT(memcmp(result->data, target->data, target->len) == 0);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+sliding_window_test(apr_pool_t *pool)
+{
+  /* Note: put these in data segment, not the stack */
+  static char source[1000000];
+  static char inserted[1050000];
+  static char removed[970000];
+  apr_uint32_t seed = 0;
+  svn_string_t source_str, target_str;
+  apr_size_t fixed_len, sliding_len;
+  apr_size_t i;
+
+  /* Incompressible source data. */
+  for (i = 0; i < sizeof(source); ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      source[i] = (char)(seed >> 16);
+    }
+
+  source_str.data = source;
+  source_str.len = sizeof(source);
+
+  /* Insert 50000 new bytes near the start. */
+  memcpy(inserted, source, 1000);
+  memset(inserted + 1000, 'X', 50000);
+  memcpy(inserted + 51000, source + 1000, sizeof(source) - 1000);
+
+  target_str.data = inserted;
+  target_str.len = sizeof(inserted);
+  SVN_ERR(apply_and_verify(&fixed_len, &source_str, &target_str, FALSE,
+                           pool));
+  SVN_ERR(apply_and_verify(&sliding_len, &source_str, &target_str, TRUE,
+                           pool));
+  /* With fixed views, every later target window overlaps only half of
+     its source view.  Sliding views send little more than the insertion. */
+  SVN_TEST_ASSERT(fixed_len > sizeof(source) / 3);
+  SVN_TEST_ASSERT(sliding_len < 60000);
+
+  /* Remove 30000 bytes near the start. */
+  memcpy(removed, source, 1000);
+  memcpy(removed + 1000, source + 31000, sizeof(source) - 31000);
+
+  target_str.data = removed;
+  target_str.len = sizeof(removed);
+  SVN_ERR(apply_and_verify(&fixed_len, &source_str, &target_str, FALSE,
+                           pool));
+  SVN_ERR(apply_and_verify(&sliding_len, &source_str, &target_str, TRUE,
+                           pool));
+  /* Fixed views lose 30% of every later window.  Sliding views lose
+     only what they need to catch up with the removal. */
+  SVN_TEST_ASSERT(fixed_len > sizeof(source) / 5);
+  SVN_TEST_ASSERT(sliding_len < 40000);
+
+  return SVN_NO_ERROR;
+}
+
+
 
 /* The test table.  */
 
@@ -107,6 +211,8 @@ static struct svn_test_descriptor_t test_funcs[] =
     SVN_TEST_NULL,
     SVN_TEST_PASS2(stream_window_test,
                    "txdelta stream and windows test"),
+    SVN_TEST_PASS2(sliding_window_test,
+                   "txdelta with sliding source views"),
     SVN_TEST_NULL
   };
 
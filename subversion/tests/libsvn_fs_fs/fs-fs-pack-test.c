@@ -29,6 +29,7 @@
 #include "../../libsvn_fs_fs/fs.h"
 #include "../../libsvn_fs_fs/fs_fs.h"
 #include "../../libsvn_fs_fs/low_level.h"
+#include "../../libsvn_fs_fs/mergeinfo-index.h"
 #include "../../libsvn_fs_fs/pack.h"
 #include "../../libsvn_fs_fs/util.h"
 
@@ -1888,6 +1889,277 @@ large_delta_against_plain(const svn_test_opts_t *opts,
 
 #undef REPO_NAME
 
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-mergeinfo-index"
+
+/* Implements svn_fs_mergeinfo_receiver_t.  Add PATH to the hash BATON. */
+static svn_error_t *
+collect_mergeinfo_paths(const char *path,
+                        svn_mergeinfo_t mergeinfo,
+                        void *baton,
+                        apr_pool_t *scratch_pool)
+{
+  apr_hash_t *paths = baton;
+  apr_pool_t *hash_pool = apr_hash_pool_get(paths);
+
+  svn_hash_sets(paths, apr_pstrdup(hash_pool, path), "");
+  return SVN_NO_ERROR;
+}
+
+/* Verify that the mergeinfo index of revision REV in FS exists and lists
+ * exactly the EXPECTED paths, which are NULL-terminated and in index
+ * order.  Also verify that svn_fs_get_mergeinfo3 reports mergeinfo for
+ * all of these paths and no others.  Use POOL for allocations. */
+static svn_error_t *
+verify_mergeinfo_index(svn_fs_t *fs,
+                       svn_revnum_t rev,
+                       const char *expected[],
+                       apr_pool_t *pool)
+{
+  apr_array_header_t *index;
+  apr_array_header_t *paths = apr_array_make(pool, 1, sizeof(const char *));
+  apr_hash_t *reported = apr_hash_make(pool);
+  svn_fs_root_t *root;
+  int i;
+
+  SVN_ERR(svn_fs_fs__mergeinfo_index_read(&index, fs, rev, pool, pool));
+  SVN_TEST_ASSERT(index);
+
+  for (i = 0; expected[i]; ++i)
+    {
+      SVN_TEST_ASSERT(i < index->nelts);
+      SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(index, i, const char *),
+                             expected[i]);
+    }
+  SVN_TEST_ASSERT(i == index->nelts);
+
+  APR_ARRAY_PUSH(paths, const char *) = "/";
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev, pool));
+  SVN_ERR(svn_fs_get_mergeinfo3(root, paths, svn_mergeinfo_explicit, TRUE,
+                                FALSE, collect_mergeinfo_paths, reported,
+                                pool));
+
+  SVN_TEST_ASSERT(apr_hash_count(reported) == index->nelts);
+  for (i = 0; expected[i]; ++i)
+    SVN_TEST_ASSERT(svn_hash_gets(reported, expected[i]));
+
+  return SVN_NO_ERROR;
+}
+
+/* Open the FSFS at PATH in *FS, allocated in POOL, with the mergeinfo
+ * index enabled.  Use a fresh cache namespace so that nothing will be
+ * read from cache. */
+static svn_error_t *
+reopen_with_mergeinfo_index(svn_fs_t **fs,
+                            const char *path,
+                            apr_pool_t *pool)
+{
+  apr_hash_t *fs_config = apr_hash_make(pool);
+  fs_fs_data_t *ffd;
+
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                svn_uuid_generate(pool));
+  SVN_ERR(svn_fs_open2(fs, path, fs_config, pool, pool));
+
+  ffd = (*fs)->fsap_data;
+  ffd->mergeinfo_index = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+mergeinfo_index(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_fs_root_t *rev_root;
+  svn_revnum_t rev;
+  svn_string_t *mergeinfo = svn_string_create("/branch:1", pool);
+  const char *r1_paths[] = { "/A/B", "/A/D/G", NULL };
+  const char *r2_paths[] = { "/A/B", "/A/D/G", "/A2/B", "/A2/D/G", "/iota",
+                             NULL };
+  const char *r3_paths[] = { "/A/D/H/psi", "/A2/B", "/A2/D/G", "/iota",
+                             NULL };
+  const char *r34_paths[] = { "/A/D/H/psi", "/A2/B", "/A2/D/G", NULL };
+  apr_array_header_t *index;
+  int i;
+
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  SVN_ERR(svn_test__create_fs(&fs, REPO_NAME, opts, pool));
+
+  ffd = fs->fsap_data;
+  if (ffd->format < SVN_FS_FS__MIN_MERGEINFO_FORMAT)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  ffd->mergeinfo_index = TRUE;
+
+  /* Revision 1: the Greek tree with some mergeinfo. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(root, pool));
+  SVN_ERR(svn_fs_change_node_prop(root, "/A/B", SVN_PROP_MERGEINFO,
+                                  mergeinfo, pool));
+  SVN_ERR(svn_fs_change_node_prop(root, "/A/D/G", SVN_PROP_MERGEINFO,
+                                  mergeinfo, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_ERR(verify_mergeinfo_index(fs, rev, r1_paths, pool));
+
+  /* Revision 2: copy a sub-tree with mergeinfo and add more. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, rev, pool));
+  SVN_ERR(svn_fs_copy(rev_root, "/A", root, "/A2", pool));
+  SVN_ERR(svn_fs_change_node_prop(root, "/iota", SVN_PROP_MERGEINFO,
+                                  mergeinfo, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_ERR(verify_mergeinfo_index(fs, rev, r2_paths, pool));
+
+  /* Lose the index of revision 2.  Reopen the FS such that the cached
+     list won't be used. */
+  SVN_ERR(svn_io_remove_file2(svn_fs_fs__path_mergeinfo_index(fs, rev,
+                                                              pool),
+                              FALSE, pool));
+  SVN_ERR(reopen_with_mergeinfo_index(&fs, REPO_NAME, pool));
+
+  /* Revision 3: delete and modify mergeinfo.  Commits don't crawl the
+     tree, so there will be no index for it. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_delete(root, "/A/B", pool));
+  SVN_ERR(svn_fs_change_node_prop(root, "/A/D/G", SVN_PROP_MERGEINFO,
+                                  NULL, pool));
+  SVN_ERR(svn_fs_change_node_prop(root, "/A/D/H/psi", SVN_PROP_MERGEINFO,
+                                  mergeinfo, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_ERR(svn_fs_fs__mergeinfo_index_read(&index, fs, rev, pool, pool));
+  SVN_TEST_ASSERT(index == NULL);
+
+  /* Building the index only scans HEAD. */
+  SVN_ERR(svn_fs_fs__mergeinfo_index_build(fs, NULL, NULL, NULL, NULL,
+                                           pool));
+  SVN_ERR(verify_mergeinfo_index(fs, rev, r3_paths, pool));
+  SVN_ERR(svn_fs_fs__mergeinfo_index_read(&index, fs, 2, pool, pool));
+  SVN_TEST_ASSERT(index == NULL);
+
+  /* Commit past the next checkpoint, toggling the mergeinfo on /iota.
+     Then read the lists from disk again. */
+  for (i = 0; i < 32; ++i)
+    {
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+      SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+      SVN_ERR(svn_fs_change_node_prop(root, "/iota", SVN_PROP_MERGEINFO,
+                                      i % 2 ? mergeinfo : NULL, pool));
+      SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+    }
+
+  SVN_ERR(reopen_with_mergeinfo_index(&fs, REPO_NAME, pool));
+  SVN_ERR(verify_mergeinfo_index(fs, rev, r3_paths, pool));
+  SVN_ERR(verify_mergeinfo_index(fs, rev - 1, r34_paths, pool));
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-direct_packed_revprop_read"
+#define SHARD_SIZE 4
+#define MAX_REV 11
+static svn_error_t *
+direct_packed_revprop_read(const svn_test_opts_t *opts,
+                           apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  apr_hash_t *proplist;
+  const char *pack_path;
+  svn_stringbuf_t *pack;
+  apr_size_t header_start, line_start, line_end;
+  apr_int64_t size;
+  const char *new_size;
+  int i;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  /* Uncompressed revprop packs are the default. */
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                   pool));
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  ffd = fs->fsap_data;
+  if (ffd->format < SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "revprop packing not supported");
+
+  /* Find the size of the last revprop list in the pack of the second
+   * shard.  The pack starts with the length of the uncompressed data
+   * followed by "<first rev>\n<count>\n<size>\n...\n\n". */
+  pack_path = svn_dirent_join_many(pool, REPO_NAME, PATH_REVPROPS_DIR,
+                                   apr_psprintf(pool, "1%s",
+                                                PATH_EXT_PACKED_SHARD),
+                                   apr_psprintf(pool, "%d.0", SHARD_SIZE),
+                                   SVN_VA_NULL);
+  SVN_ERR(svn_stringbuf_from_file2(&pack, pack_path, pool));
+
+  for (header_start = 0; pack->data[header_start] & 0x80; ++header_start)
+    ;
+  ++header_start;
+
+  line_start = header_start;
+  for (i = 0; i < 2 + SHARD_SIZE; ++i)
+    {
+      line_end = line_start;
+      while (pack->data[line_end] != '\n')
+        ++line_end;
+
+      if (i + 1 < 2 + SHARD_SIZE)
+        line_start = line_end + 1;
+    }
+
+  /* Claim that the last revprop list extends beyond the end of the pack.
+   * Keep the header length unchanged. */
+  SVN_ERR(svn_cstring_atoi64(&size,
+                             apr_pstrndup(pool, pack->data + line_start,
+                                          line_end - line_start)));
+  new_size = apr_psprintf(pool, "%" APR_INT64_T_FMT, size + 1);
+  SVN_TEST_ASSERT(strlen(new_size) == line_end - line_start);
+  memcpy(pack->data + line_start, new_size, line_end - line_start);
+  SVN_ERR(svn_io_write_atomic2(pack_path, pack->data, pack->len, NULL,
+                               FALSE, pool));
+
+  /* Isolated lookups of any other revision of that pack do not parse
+   * the broken entry.  The cache-populating path parses the whole pack. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  for (i = SHARD_SIZE; i < 2 * SHARD_SIZE - 1; ++i)
+    {
+      SVN_ERR(svn_fs_revision_proplist2(&proplist, fs, i, TRUE,
+                                        pool, pool));
+      SVN_TEST_ASSERT(svn_hash_gets(proplist, SVN_PROP_REVISION_DATE));
+    }
+
+  /* The broken entry itself gets detected. */
+  SVN_TEST_ASSERT_ANY_ERROR(svn_fs_revision_proplist2(&proplist, fs, i,
+                                                      TRUE, pool, pool));
+  SVN_TEST_ASSERT_ANY_ERROR(svn_fs_revision_proplist2(&proplist, fs,
+                                                      SHARD_SIZE, FALSE,
+                                                      pool, pool));
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+
 
 
 /* The test table.  */
@@ -1943,6 +2215,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "pack with limited memory for metadata"),
     SVN_TEST_OPTS_PASS(large_delta_against_plain,
                        "large deltas against PLAIN, issue #4658"),
+    SVN_TEST_OPTS_PASS(mergeinfo_index,
+                       "mergeinfo index of FSFS revisions"),
+    SVN_TEST_OPTS_PASS(direct_packed_revprop_read,
+                       "read single revprops from uncompressed packs"),
     SVN_TEST_NULL
   };
 
@@ -444,6 +444,124 @@ load_index(const svn_test_opts_t *opts, apr_pool_t *pool)
 
 /* ------------------------------------------------------------------------ */
 
+/* Create a Greek tree repository under REPO_NAME using OPTS and look up
+ * the rev file offsets of all items in its latest revision through the
+ * L2P index, REPEATS times each.  Compare them to the P2L index data.
+ * Finally, verify that a batched lookup of all items yields the same.
+ * If PRINT_RATE is set, print the number of lookups per second.
+ * Use POOL for allocations.
+ */
+static svn_error_t *
+check_l2p_lookups(const svn_test_opts_t *opts,
+                  const char *repo_name,
+                  int repeats,
+                  svn_boolean_t print_rate,
+                  apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_revnum_t rev;
+  svn_fs_fs__revision_file_t *rev_file;
+  apr_array_header_t *entries = apr_array_make(pool, 41, sizeof(void *));
+  svn_fs_fs__ioctl_dump_index_input_t dump_input = {0};
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_fs_fs__id_part_t *items;
+  apr_off_t *offsets;
+  apr_int64_t lookups = 0;
+  apr_time_t start, end;
+  int i, k;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  if (opts->server_minor_version && (opts->server_minor_version < 9))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.9 SVN doesn't have FSFS indexes");
+
+  /* Create a filesystem */
+  SVN_ERR(create_greek_repo(&repos, &rev, opts, repo_name, pool, pool));
+  fs = svn_repos_fs(repos);
+
+  /* Read the P2L index contents for REV in ENTRIES. */
+  dump_input.revision = rev;
+  dump_input.callback_func = receive_index;
+  dump_input.callback_baton = entries;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_DUMP_INDEX,
+                       &dump_input, NULL, NULL, NULL, pool, pool));
+
+  /* The L2P index must agree with the P2L index for every item. */
+  SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&rev_file, fs, rev, pool, pool));
+
+  start = apr_time_now();
+  for (k = 0; k < repeats; ++k)
+    for (i = 0; i < entries->nelts; ++i)
+      {
+        const svn_fs_fs__p2l_entry_t *entry
+          = APR_ARRAY_IDX(entries, i, const svn_fs_fs__p2l_entry_t *);
+        apr_off_t offset;
+
+        if (entry->type == SVN_FS_FS__ITEM_TYPE_UNUSED)
+          continue;
+
+        svn_pool_clear(iterpool);
+        SVN_ERR(svn_fs_fs__item_offset(&offset, fs, rev_file, rev, NULL,
+                                       entry->item.number, iterpool));
+        SVN_TEST_ASSERT(offset == entry->offset);
+        ++lookups;
+      }
+  end = apr_time_now();
+
+  SVN_TEST_ASSERT(lookups == 41 * (apr_int64_t)repeats);
+
+  /* Batched lookups must return the same results, independent of the
+   * order of the requests. */
+  items = apr_palloc(pool, entries->nelts * sizeof(*items));
+  offsets = apr_palloc(pool, entries->nelts * sizeof(*offsets));
+  for (i = 0; i < entries->nelts; ++i)
+    items[i] = APR_ARRAY_IDX(entries, entries->nelts - 1 - i,
+                             const svn_fs_fs__p2l_entry_t *)->item;
+
+  SVN_ERR(svn_fs_fs__item_offsets(offsets, fs, rev_file, items,
+                                  entries->nelts, pool));
+  for (i = 0; i < entries->nelts; ++i)
+    SVN_TEST_ASSERT(offsets[i]
+                    == APR_ARRAY_IDX(entries, entries->nelts - 1 - i,
+                                     const svn_fs_fs__p2l_entry_t *)->offset);
+
+  SVN_ERR(svn_fs_fs__close_revision_file(rev_file));
+  svn_pool_destroy(iterpool);
+
+  if (print_rate)
+    {
+      printf("%"APR_TIME_T_FMT" musecs\n", end - start);
+      printf("%"APR_INT64_T_FMT" lookups / sec\n",
+             (lookups * 1000000) / MAX(end - start, 1));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+l2p_lookup(const svn_test_opts_t *opts,
+           apr_pool_t *pool)
+{
+  return svn_error_trace(check_l2p_lookups(opts, "test-repo-l2p-lookup",
+                                           1, FALSE, pool));
+}
+
+static svn_error_t *
+l2p_lookup_performance(const svn_test_opts_t *opts,
+                       apr_pool_t *pool)
+{
+  return svn_error_trace(check_l2p_lookups(opts,
+                                           "test-repo-l2p-lookup-perf",
+                                           100000, TRUE, pool));
+}
+
+/* ------------------------------------------------------------------------ */
+
 static svn_error_t *
 build_rep_cache(const svn_test_opts_t *opts, apr_pool_t *pool)
 {
@@ -516,6 +634,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "load the P2L index"),
     SVN_TEST_OPTS_PASS(build_rep_cache,
                        "build the representation cache"),
+    SVN_TEST_OPTS_PASS(l2p_lookup,
+                       "look up item offsets in the L2P index"),
+    SVN_TEST_OPTS_SKIP(l2p_lookup_performance, TRUE,
+                       "optional L2P index lookup performance test"),
     SVN_TEST_NULL
   };
 
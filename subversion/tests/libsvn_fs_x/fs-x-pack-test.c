@@ -26,9 +26,12 @@
 
 #include "../svn_test.h"
 #include "../../libsvn_fs_x/batch_fsync.h"
+#include "../../libsvn_fs_x/cached_data.h"
 #include "../../libsvn_fs_x/fs.h"
 #include "../../libsvn_fs_x/reps.h"
+#include "../../libsvn_fs/fs-loader.h"
 
+#include "svn_hash.h"
 #include "svn_pools.h"
 #include "svn_props.h"
 #include "svn_fs.h"
@@ -820,6 +823,517 @@ test_reps(const svn_test_opts_t *opts,
 #undef SHARD_SIZE
 #undef MAX_REV
 
+/* ------------------------------------------------------------------------ */
+/* Return a string of LEN printable pseudo-random characters, allocated in
+ * POOL, that is the same for the same SEED. */
+static svn_stringbuf_t *
+make_similar_text(apr_uint32_t seed,
+                  apr_size_t len,
+                  apr_pool_t *pool)
+{
+  svn_stringbuf_t *result = svn_stringbuf_create_ensure(len, pool);
+  apr_size_t i;
+
+  for (i = 0; i < len; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      svn_stringbuf_appendbyte(result, (char)('a' + (seed >> 16) % 26));
+    }
+
+  return result;
+}
+
+/* Replace a few sections of TEXT by the same number of different bytes
+ * as determined by VARIANT. */
+static void
+tweak_similar_text(svn_stringbuf_t *text,
+                   int variant)
+{
+  int i;
+  for (i = 0; i < 10; ++i)
+    {
+      apr_size_t pos = (i * 7919 + variant * 104729) % (text->len - 8);
+      memcpy(text->data + pos, "XYZXYZXY", 1 + (variant + i) % 8);
+    }
+}
+
+#define REPO_NAME "test-repo-fsx-similar-reps"
+#define SHARD_SIZE 3
+#define MAX_REV 5
+#define TEXT_LEN 32000
+#define VARIANTS 20
+
+/* Replace a short section in every 100 bytes of TEXT by the same number of
+ * different bytes as determined by VARIANT.  Return the number of bytes
+ * replaced.  Few of the unchanged sections contain a complete
+ * MATCH_BLOCKSIZE aligned block of the original text. */
+static apr_size_t
+tweak_text_densely(svn_stringbuf_t *text,
+                   int variant)
+{
+  apr_size_t replaced = 0;
+  apr_size_t pos;
+
+  for (pos = (variant * 37) % 100; pos + 8 < text->len; pos += 100)
+    {
+      apr_size_t len = 1 + (pos / 100 + variant) % 8;
+      memcpy(text->data + pos, "XYZXYZXY", len);
+      replaced += len;
+    }
+
+  return replaced;
+}
+
+/* Add the original text and all VARIANTS-1 densely tweaked variants of it
+ * to a new builder in FS.  Search for matches using JOBS threads.  Return
+ * the builder in *BUILDER, the fulltexts in *TEXTS, the serialized
+ * container in *SERIALIZED and the total number of bytes replaced in the
+ * variants in *REPLACED.  Allocate everything in POOL. */
+static svn_error_t *
+build_similar_reps(svn_fs_x__reps_builder_t **builder,
+                   apr_array_header_t **texts,
+                   svn_stringbuf_t **serialized,
+                   apr_size_t *replaced,
+                   svn_fs_t *fs,
+                   int jobs,
+                   apr_pool_t *pool)
+{
+  apr_array_header_t *variants
+    = apr_array_make(pool, VARIANTS - 1, sizeof(svn_string_t *));
+  svn_string_t *original
+    = svn_stringbuf__morph_into_string(make_similar_text(42, TEXT_LEN,
+                                                         pool));
+  svn_stream_t *stream;
+  apr_size_t idx;
+  int i;
+
+  *replaced = 0;
+  for (i = 1; i < VARIANTS; ++i)
+    {
+      svn_stringbuf_t *text = make_similar_text(42, TEXT_LEN, pool);
+      *replaced += tweak_text_densely(text, i);
+      APR_ARRAY_PUSH(variants, svn_string_t *)
+        = svn_stringbuf__morph_into_string(text);
+    }
+
+  *builder = svn_fs_x__reps_builder_create(fs, pool);
+  SVN_ERR(svn_fs_x__reps_add(&idx, *builder, original));
+  SVN_TEST_INT_ASSERT(idx, 0);
+  SVN_ERR(svn_fs_x__reps_add_many(&idx, *builder, variants, jobs, pool));
+  SVN_TEST_INT_ASSERT(idx, 1);
+
+  *texts = apr_array_make(pool, VARIANTS, sizeof(svn_string_t *));
+  APR_ARRAY_PUSH(*texts, svn_string_t *) = original;
+  apr_array_cat(*texts, variants);
+
+  *serialized = svn_stringbuf_create_empty(pool);
+  stream = svn_stream_from_stringbuf(*serialized, pool);
+  SVN_ERR(svn_fs_x__write_reps_container(stream, *builder, pool));
+  SVN_ERR(svn_stream_close(stream));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_reps_similar(const svn_test_opts_t *opts,
+                  apr_pool_t *pool)
+{
+  svn_fs_t *fs = NULL;
+  svn_fs_x__reps_builder_t *builder;
+  svn_fs_x__reps_builder_t *parallel_builder;
+  svn_fs_x__reps_t *container;
+  svn_stringbuf_t *serialized;
+  svn_stringbuf_t *parallel_serialized;
+  svn_stream_t *stream;
+  apr_array_header_t *texts;
+  apr_array_header_t *parallel_texts;
+  apr_size_t replaced;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                   pool));
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+
+  SVN_ERR(build_similar_reps(&builder, &texts, &serialized, &replaced, fs,
+                             1, pool));
+
+  /* The variants should mostly be stored as references to the original.
+   * Apart from the replaced bytes, only few instructions per edit shall
+   * be needed.  If matches were not continued behind replaced sections,
+   * most of the unchanged sections would be stored once per variant,
+   * i.e. the container would be several times larger. */
+  SVN_TEST_ASSERT(svn_fs_x__reps_estimate_size(builder)
+                  < TEXT_LEN / 2 + replaced + 8 * (VARIANTS - 1)
+                                                * (TEXT_LEN / 100));
+
+  /* Searching for matches in parallel must produce the very same
+   * container. */
+  SVN_ERR(build_similar_reps(&parallel_builder, &parallel_texts,
+                             &parallel_serialized, &replaced, fs, 4, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(serialized, parallel_serialized));
+
+  stream = svn_stream_from_stringbuf(serialized, pool);
+  SVN_ERR(svn_fs_x__read_reps_container(&container, stream, pool, pool));
+  SVN_ERR(svn_stream_close(stream));
+
+  /* All variants must be reconstructed exactly. */
+  for (i = 0; i < texts->nelts; ++i)
+    {
+      svn_fs_x__rep_extractor_t *extractor;
+      svn_stringbuf_t *contents;
+      const svn_string_t *expected = APR_ARRAY_IDX(texts, i, svn_string_t *);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_x__reps_get(&extractor, fs, container, i, iterpool));
+      SVN_ERR(svn_fs_x__extractor_drive(&contents, extractor, 0, 0,
+                                        iterpool, iterpool));
+      SVN_TEST_INT_ASSERT(contents->len, expected->len);
+      SVN_TEST_ASSERT(memcmp(contents->data, expected->data,
+                             expected->len) == 0);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+#undef TEXT_LEN
+#undef VARIANTS
+
+/* ------------------------------------------------------------------------ */
+#define REPO_NAME "test-repo-fsx-shared-dag-paths"
+#define SHARD_SIZE 4
+#define MAX_REV 3
+static svn_error_t *
+test_shared_dag_paths(const svn_test_opts_t *opts,
+                      apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_root_t *root;
+  svn_fs_x__data_t *ffd;
+  svn_cache__info_t info;
+  svn_node_kind_t kind;
+  apr_hash_t *config = apr_hash_make(pool);
+
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                   pool));
+
+  /* Paths are not shared by default. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  ffd = fs->fsap_data;
+  SVN_TEST_ASSERT(ffd->dag_path_cache == NULL);
+
+  /* Resolve a path in one session ... */
+  svn_hash_sets(config, SVN_FS_CONFIG_FSFS_CACHE_PATHS, "1");
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, config, pool, pool));
+  ffd = fs->fsap_data;
+  if (ffd->dag_path_cache == NULL)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "the DAG path cache requires a membuffer cache");
+
+  SVN_ERR(svn_fs_revision_root(&root, fs, 1, pool));
+  SVN_ERR(svn_fs_check_path(&kind, root, "A/D/G/pi", pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+  SVN_ERR(svn_cache__get_info(ffd->dag_path_cache, &info, FALSE, pool));
+  SVN_TEST_ASSERT(info.sets > 0);
+
+  /* ... and another session will not need to walk it again. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, config, pool, pool));
+  ffd = fs->fsap_data;
+
+  SVN_ERR(svn_fs_revision_root(&root, fs, 1, pool));
+  SVN_ERR(svn_fs_check_path(&kind, root, "A/D/G/pi", pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+  SVN_ERR(svn_cache__get_info(ffd->dag_path_cache, &info, FALSE, pool));
+  SVN_TEST_ASSERT(info.hits == 1);
+  SVN_TEST_ASSERT(info.sets == 0);
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+
+/* ------------------------------------------------------------------------ */
+
+/* Recursively compare the history IDs returned by svn_fs_x__get_history_ids
+ * with those of the full noderevs for the node ID in FS and all nodes
+ * below it.  Increment *COUNT for every node compared.  Use POOL for
+ * temporary allocations. */
+static svn_error_t *
+verify_history_ids(int *count,
+                   svn_fs_t *fs,
+                   const svn_fs_x__id_t *id,
+                   apr_pool_t *pool)
+{
+  svn_fs_x__noderev_t *noderev;
+  svn_fs_x__id_t node_id, copy_id;
+  apr_array_header_t *entries;
+  apr_pool_t *iterpool;
+  int i;
+
+  /* Reading the full noderev puts its container into the cache, so the
+   * history IDs will then be taken from the cached container. */
+  SVN_ERR(svn_fs_x__get_node_revision(&noderev, fs, id, pool, pool));
+  SVN_ERR(svn_fs_x__get_history_ids(&node_id, &copy_id, fs, id, pool));
+  SVN_TEST_ASSERT(svn_fs_x__id_eq(&node_id, &noderev->node_id));
+  SVN_TEST_ASSERT(svn_fs_x__id_eq(&copy_id, &noderev->copy_id));
+  ++*count;
+
+  if (noderev->kind != svn_node_dir)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_x__rep_contents_dir(&entries, fs, noderev, pool, pool));
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < entries->nelts; ++i)
+    {
+      svn_fs_x__dirent_t *dirent = APR_ARRAY_IDX(entries, i,
+                                                 svn_fs_x__dirent_t *);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(verify_history_ids(count, fs, &dirent->id, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+#define REPO_NAME "test-repo-fsx-history-ids"
+#define SHARD_SIZE 4
+#define MAX_REV 9
+static svn_error_t *
+test_history_ids(const svn_test_opts_t *opts,
+                 apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_x__data_t *ffd;
+  svn_fs_x__id_t root_id;
+  svn_cache__info_t before, after;
+  svn_revnum_t rev;
+  int count = 0;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  /* The packed revisions contain modified and copied nodes. */
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                   pool));
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  ffd = fs->fsap_data;
+  if (ffd->noderevs_container_cache == NULL)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "reading history IDs from noderevs containers "
+                            "requires a cache");
+
+  SVN_ERR(svn_cache__get_info(ffd->noderevs_container_cache, &before,
+                              FALSE, pool));
+
+  for (rev = 0; svn_fs_x__is_packed_rev(fs, rev); ++rev)
+    {
+      svn_pool_clear(iterpool);
+      svn_fs_x__init_rev_root(&root_id, rev);
+      SVN_ERR(verify_history_ids(&count, fs, &root_id, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  /* Make sure we actually compared nodes from cached containers. */
+  SVN_ERR(svn_cache__get_info(ffd->noderevs_container_cache, &after,
+                              FALSE, pool));
+  SVN_TEST_ASSERT(count > 0);
+  SVN_TEST_ASSERT(after.hits - before.hits >= (apr_uint64_t)count);
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+
+/* ------------------------------------------------------------------------ */
+
+/* Configure the FSX repository at PATH to use THREADS threads when
+ * searching for matches during pack.  Use POOL for allocations. */
+static svn_error_t *
+set_pack_match_threads(const char *path,
+                       int threads,
+                       apr_pool_t *pool)
+{
+  const char *contents
+    = apr_psprintf(pool, "[" CONFIG_SECTION_DELTIFICATION "]\n"
+                         CONFIG_OPTION_PACK_MATCH_THREADS " = %d\n",
+                   threads);
+
+  return svn_error_trace(svn_io_write_atomic2(svn_dirent_join(path,
+                                                              PATH_CONFIG,
+                                                              pool),
+                                              contents, strlen(contents),
+                                              NULL, FALSE, pool));
+}
+
+/* Pack the repository at PATH and return the time it took. */
+static svn_error_t *
+timed_pack(apr_time_t *duration,
+           const char *path,
+           apr_pool_t *pool)
+{
+  apr_time_t start = apr_time_now();
+  SVN_ERR(svn_fs_pack(path, NULL, NULL, NULL, NULL, pool));
+  *duration = apr_time_now() - start;
+
+  return SVN_NO_ERROR;
+}
+
+/* Create an unpacked FSX repository REPO_NAME with shards of SHARD_SIZE
+ * revisions, in which r2 to MAX_REV modify a set of similar files of
+ * TEXT_LEN bytes.  Also create a copy of it called PARALLEL_REPO_NAME.
+ * Configure REPO_NAME to search for matches during pack in a single
+ * thread and the copy to use 4 threads.  Use POOL for allocations. */
+static svn_error_t *
+create_similar_files_repos(const char *repo_name,
+                           const char *parallel_repo_name,
+                           const svn_test_opts_t *opts,
+                           svn_revnum_t max_rev,
+                           int shard_size,
+                           apr_size_t text_len,
+                           apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  const char *conflict;
+  svn_revnum_t after_rev;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  /* Create a small FS and add revisions that modify a set of large,
+   * similar files. */
+  SVN_ERR(create_packed_filesystem(repo_name, opts, 1, shard_size, pool));
+  SVN_ERR(svn_fs_open2(&fs, repo_name, NULL, pool, pool));
+
+  for (after_rev = 1; after_rev < max_rev; )
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, after_rev, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+
+      for (i = 0; i < 4; ++i)
+        {
+          const char *path = apr_psprintf(iterpool, "file%d", i);
+          svn_stringbuf_t *text = make_similar_text(i, text_len, iterpool);
+          tweak_similar_text(text, (int)after_rev);
+
+          if (after_rev == 1)
+            SVN_ERR(svn_fs_make_file(txn_root, path, iterpool));
+          SVN_ERR(svn_test__set_file_contents(txn_root, path, text->data,
+                                              iterpool));
+        }
+
+      SVN_ERR(svn_fs_commit_txn(&conflict, &after_rev, txn, iterpool));
+      SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(after_rev));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_io_remove_dir2(parallel_repo_name, TRUE, NULL, NULL, pool));
+  SVN_ERR(svn_io_copy_dir_recursively(repo_name, ".", parallel_repo_name,
+                                      TRUE, NULL, NULL, pool));
+  svn_test_add_dir_cleanup(parallel_repo_name);
+
+  SVN_ERR(set_pack_match_threads(repo_name, 1, pool));
+  SVN_ERR(set_pack_match_threads(parallel_repo_name, 4, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Assert that the first SHARDS pack files of the repositories REPO_NAME
+ * and PARALLEL_REPO_NAME are identical.  Use POOL for allocations. */
+static svn_error_t *
+verify_same_pack_files(const char *repo_name,
+                       const char *parallel_repo_name,
+                       int shards,
+                       apr_pool_t *pool)
+{
+  int i;
+
+  for (i = 0; i < shards; ++i)
+    {
+      svn_boolean_t same;
+      const char *shard = apr_psprintf(pool, "%d.pack", i);
+
+      SVN_ERR(svn_io_files_contents_same_p(&same,
+                svn_dirent_join_many(pool, repo_name, "revs", shard, "pack",
+                                     SVN_VA_NULL),
+                svn_dirent_join_many(pool, parallel_repo_name, "revs", shard,
+                                     "pack", SVN_VA_NULL),
+                pool));
+      SVN_TEST_ASSERT(same);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+#define REPO_NAME "test-repo-fsx-pack-match-threads"
+#define PARALLEL_REPO_NAME "test-repo-fsx-pack-match-threads-parallel"
+#define SHARD_SIZE 8
+#define MAX_REV 15
+static svn_error_t *
+pack_match_threads_same_output(const svn_test_opts_t *opts,
+                               apr_pool_t *pool)
+{
+  SVN_ERR(create_similar_files_repos(REPO_NAME, PARALLEL_REPO_NAME, opts,
+                                     MAX_REV, SHARD_SIZE, 20000, pool));
+
+  SVN_ERR(svn_fs_pack(REPO_NAME, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_pack(PARALLEL_REPO_NAME, NULL, NULL, NULL, NULL, pool));
+
+  /* The thread count must not change the pack files. */
+  return svn_error_trace(verify_same_pack_files(REPO_NAME,
+                                                PARALLEL_REPO_NAME,
+                                                (MAX_REV + 1) / SHARD_SIZE,
+                                                pool));
+}
+
+#undef REPO_NAME
+#undef PARALLEL_REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+
+#define REPO_NAME "test-repo-fsx-pack-similar-files"
+#define PARALLEL_REPO_NAME "test-repo-fsx-pack-similar-files-parallel"
+#define SHARD_SIZE 100
+#define MAX_REV 199
+static svn_error_t *
+pack_similar_files_performance(const svn_test_opts_t *opts,
+                               apr_pool_t *pool)
+{
+  apr_time_t serial_time, parallel_time;
+
+  SVN_ERR(create_similar_files_repos(REPO_NAME, PARALLEL_REPO_NAME, opts,
+                                     MAX_REV, SHARD_SIZE, 200000, pool));
+
+  SVN_ERR(timed_pack(&serial_time, REPO_NAME, pool));
+  SVN_ERR(timed_pack(&parallel_time, PARALLEL_REPO_NAME, pool));
+
+  if (opts->verbose)
+    printf("Packing %d revisions took %.3f seconds with 1 thread and "
+           "%.3f seconds with 4 threads\n", MAX_REV,
+           (double)serial_time / APR_USEC_PER_SEC,
+           (double)parallel_time / APR_USEC_PER_SEC);
+
+  return svn_error_trace(verify_same_pack_files(REPO_NAME,
+                                                PARALLEL_REPO_NAME,
+                                                (MAX_REV + 1) / SHARD_SIZE,
+                                                pool));
+}
+
+#undef REPO_NAME
+#undef PARALLEL_REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+
 /* ------------------------------------------------------------------------ */
 #define REPO_NAME "test-repo-fsx-pack-shard-size-one"
 #define SHARD_SIZE 1
@@ -959,10 +1473,20 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test svn_fs_info"),
     SVN_TEST_OPTS_PASS(test_reps,
                        "test representations container"),
+    SVN_TEST_OPTS_PASS(test_reps_similar,
+                       "test container with similar representations"),
+    SVN_TEST_OPTS_PASS(test_shared_dag_paths,
+                       "test sharing resolved paths between sessions"),
+    SVN_TEST_OPTS_PASS(test_history_ids,
+                       "test history IDs from cached noderevs"),
     SVN_TEST_OPTS_PASS(pack_shard_size_one,
                        "test packing with shard size = 1"),
     SVN_TEST_OPTS_PASS(test_batch_fsync,
                        "test batch fsync"),
+    SVN_TEST_OPTS_PASS(pack_match_threads_same_output,
+                       "pack output does not depend on match threads"),
+    SVN_TEST_OPTS_SKIP(pack_similar_files_performance, TRUE,
+                       "pack performance for similar files"),
     SVN_TEST_NULL
   };
 
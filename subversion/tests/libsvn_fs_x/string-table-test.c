@@ -133,6 +133,14 @@ short_string_table_body(svn_boolean_t do_load_store,
   for (i = 0; i < STRING_COUNT; ++i)
     indexes[i] = svn_fs_x__string_table_builder_add(builder, basic_strings[i], 0);
 
+  /* Explicit lengths must be respected when looking for duplicates. */
+  SVN_TEST_ASSERT(svn_fs_x__string_table_builder_add(builder,
+                                                     "/some/path/to/a/dirs",
+                                                     19) == indexes[7]);
+  SVN_TEST_ASSERT(svn_fs_x__string_table_builder_add(builder,
+                                                     "/some/path/to/a/dirs",
+                                                     18) != indexes[7]);
+
   table = svn_fs_x__string_table_create(builder, pool);
   if (do_load_store)
     SVN_ERR(store_and_load_table(&table, pool));
@@ -147,10 +155,24 @@ short_string_table_body(svn_boolean_t do_load_store,
       SVN_TEST_STRING_ASSERT(string, basic_strings[i]);
       SVN_TEST_ASSERT(len == strlen(string));
       SVN_TEST_ASSERT(len == strlen(basic_strings[i]));
+
+      SVN_TEST_ASSERT(svn_fs_x__string_table_equals(table, indexes[i],
+                                                    basic_strings[i], len));
     }
 
+  /* Strings sharing head and / or tail segments must still not match. */
+  SVN_TEST_ASSERT(!svn_fs_x__string_table_equals(table, indexes[7],
+                                                 basic_strings[8],
+                                                 strlen(basic_strings[8])));
+  SVN_TEST_ASSERT(!svn_fs_x__string_table_equals(table, indexes[8],
+                                                 "/some/path/to/b/file",
+                                                 20));
+  SVN_TEST_ASSERT(!svn_fs_x__string_table_equals(table, indexes[0],
+                                                 "some", 4));
+
   SVN_TEST_STRING_ASSERT(svn_fs_x__string_table_get(table, STRING_COUNT,
                                                     NULL, pool), "");
+  SVN_TEST_ASSERT(svn_fs_x__string_table_equals(table, STRING_COUNT, "", 0));
 
   return SVN_NO_ERROR;
 }
@@ -233,6 +255,10 @@ many_strings_table_body(svn_boolean_t do_load_store,
       SVN_TEST_STRING_ASSERT(string, strings[i]->data);
       SVN_TEST_ASSERT(len == strlen(string));
       SVN_TEST_ASSERT(len == strings[i]->len);
+
+      SVN_TEST_ASSERT(svn_fs_x__string_table_equals(table, indexes[i],
+                                                    strings[i]->data,
+                                                    strings[i]->len));
     }
 
   return SVN_NO_ERROR;
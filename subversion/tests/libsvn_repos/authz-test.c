@@ -25,6 +25,8 @@
 #include "svn_pools.h"
 #include "svn_iter.h"
 #include "svn_hash.h"
+#include "svn_path.h"
+#include "private/svn_repos_private.h"
 #include "private/svn_subr_private.h"
 
 #include "../../libsvn_repos/authz.h"
@@ -511,6 +513,439 @@ reposful_reposless_stanzas_inherit(apr_pool_t *pool)
    return SVN_NO_ERROR;
 }
 
+/* Rules and paths shared by the tests that check many paths at once. */
+static const char access_rules[] =
+  "[/]"                                    NL
+  "user = r"                               NL
+  ""                                       NL
+  "[/trunk/secret]"                        NL
+  "user ="                                 NL
+  ""                                       NL
+  "[/trunk/secret/public]"                 NL
+  "user = rw"                              NL
+  ""                                       NL
+  "[:glob:/branches/*/private]"            NL
+  "user ="                                 NL
+  ""                                       NL
+  "[/tags/1.0/src]"                        NL
+  "user = rw"                              NL;
+
+/* Sorted by svn_sort_compare_paths, i.e. in depth-first order. */
+static const char *access_paths[] =
+  {
+    "/",
+    "/branches",
+    "/branches/b1",
+    "/branches/b1/private",
+    "/branches/b1/private/x",
+    "/branches/b1/public",
+    "/branches/b2/private/a/b/c",
+    "/branches/b2/public/a/b/c",
+    "/tags/1.0",
+    "/tags/1.0/src",
+    "/tags/1.0/src/deep/file",
+    "/tags/1.0/test",
+    "/trunk",
+    "/trunk/secret",
+    "/trunk/secret/public",
+    "/trunk/secret/public/file",
+    "/trunk/secret/x/y",
+    "/trunk/x"
+  };
+
+/* Set *AUTHZ to a freshly parsed instance of ACCESS_RULES. */
+static svn_error_t *
+parse_access_rules(svn_authz_t **authz,
+                   apr_pool_t *pool)
+{
+  return svn_error_trace(svn_repos_authz_parse2(
+                           authz,
+                           svn_stream_from_string(
+                             svn_string_create(access_rules, pool), pool),
+                           NULL, NULL, NULL, pool, pool));
+}
+
+/* Set *EXPECTED to whether "user" has the REQUIRED access to PATH
+ * according to ACCESS_RULES, without any shared lookup state. */
+static svn_error_t *
+check_access_fresh(svn_boolean_t *expected,
+                   const char *path,
+                   svn_repos_authz_access_t required,
+                   apr_pool_t *pool)
+{
+  svn_authz_t *authz;
+
+  SVN_ERR(parse_access_rules(&authz, pool));
+  SVN_ERR(svn_repos_authz_check_access(authz, "repo", path, "user",
+                                       required, expected, pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_check_access_sequence(apr_pool_t *pool)
+{
+  const char **paths = access_paths;
+  const svn_repos_authz_access_t required[] =
+    {
+      svn_authz_read,
+      svn_authz_write,
+      svn_authz_read | svn_authz_recursive
+    };
+
+  const int path_count = sizeof(access_paths) / sizeof(access_paths[0]);
+  const int required_count = sizeof(required) / sizeof(required[0]);
+
+  svn_boolean_t *granted = apr_pcalloc(pool, path_count * sizeof(*granted));
+  svn_authz_t *authz;
+  int i, k;
+
+  for (k = 0; k < required_count; ++k)
+    {
+      /* Check all paths in order on the same authz, such that every lookup
+         resumes from the parent paths of the previous one. */
+      SVN_ERR(parse_access_rules(&authz, pool));
+      for (i = 0; i < path_count; ++i)
+        SVN_ERR(svn_repos_authz_check_access(authz, "repo", paths[i], "user",
+                                             required[k], &granted[i],
+                                             pool));
+
+      /* Compare with individual checks without any shared lookup state. */
+      for (i = 0; i < path_count; ++i)
+        {
+          svn_boolean_t expected;
+
+          SVN_ERR(check_access_fresh(&expected, paths[i], required[k],
+                                     pool));
+          if (granted[i] != expected)
+            return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                     "Sequential check for '%s' with "
+                                     "required access %d returned %d "
+                                     "instead of %d",
+                                     paths[i], required[k], granted[i],
+                                     expected);
+        }
+    }
+
+  /* Spot-check the actual results for read access. */
+  for (i = 0; i < path_count; ++i)
+    SVN_ERR(svn_repos_authz_check_access(authz, "repo", paths[i], "user",
+                                         svn_authz_read, &granted[i], pool));
+  SVN_TEST_ASSERT(granted[0]);
+  SVN_TEST_ASSERT(!granted[3]);
+  SVN_TEST_ASSERT(!granted[4]);
+  SVN_TEST_ASSERT(granted[5]);
+  SVN_TEST_ASSERT(!granted[6]);
+  SVN_TEST_ASSERT(!granted[13]);
+  SVN_TEST_ASSERT(granted[14]);
+  SVN_TEST_ASSERT(granted[15]);
+  SVN_TEST_ASSERT(!granted[16]);
+  SVN_TEST_ASSERT(granted[17]);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_check_access_many(apr_pool_t *pool)
+{
+  const svn_repos_authz_access_t required[] =
+    {
+      svn_authz_read,
+      svn_authz_write,
+      svn_authz_read | svn_authz_recursive
+    };
+
+  const int path_count = sizeof(access_paths) / sizeof(access_paths[0]);
+  const int required_count = sizeof(required) / sizeof(required[0]);
+
+  apr_array_header_t *path_array = apr_array_make(pool, path_count,
+                                                  sizeof(const char *));
+  svn_boolean_t *granted = apr_pcalloc(pool, path_count * sizeof(*granted));
+  svn_authz_t *authz;
+  int i, k;
+
+  for (i = 0; i < path_count; ++i)
+    APR_ARRAY_PUSH(path_array, const char *) = access_paths[i];
+
+  for (k = 0; k < required_count; ++k)
+    {
+      SVN_ERR(parse_access_rules(&authz, pool));
+      SVN_ERR(svn_repos__authz_check_access_many(granted, authz, "repo",
+                                                 path_array, "user",
+                                                 required[k], pool));
+
+      /* Compare with individual checks without any shared lookup state. */
+      for (i = 0; i < path_count; ++i)
+        {
+          svn_boolean_t expected;
+
+          SVN_ERR(check_access_fresh(&expected, access_paths[i],
+                                     required[k], pool));
+          if (granted[i] != expected)
+            return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                     "Bulk check for '%s' with required "
+                                     "access %d returned %d instead of %d",
+                                     access_paths[i], required[k],
+                                     granted[i], expected);
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for the authz callbacks used by test_authz_read_many. */
+typedef struct read_many_baton_t
+{
+  svn_authz_t *authz;
+  int single_calls;
+  int many_calls;
+} read_many_baton_t;
+
+/* Implements svn_repos_authz_func_t for read_many_baton_t. */
+static svn_error_t *
+read_single_cb(svn_boolean_t *allowed,
+               svn_fs_root_t *root,
+               const char *path,
+               void *baton,
+               apr_pool_t *pool)
+{
+  read_many_baton_t *b = baton;
+  b->single_calls++;
+
+  return svn_error_trace(svn_repos_authz_check_access(b->authz, "repo",
+                                                      path, "user",
+                                                      svn_authz_read,
+                                                      allowed, pool));
+}
+
+/* Implements svn_repos__authz_many_func_t for read_many_baton_t. */
+static svn_error_t *
+read_many_cb(svn_boolean_t *allowed,
+             svn_fs_root_t *root,
+             const apr_array_header_t *paths,
+             void *baton,
+             apr_pool_t *pool)
+{
+  read_many_baton_t *b = baton;
+  int i;
+
+  b->many_calls++;
+
+  /* We must get the paths in depth-first order. */
+  for (i = 1; i < paths->nelts; ++i)
+    SVN_TEST_ASSERT(svn_path_compare_paths(
+                      APR_ARRAY_IDX(paths, i - 1, const char *),
+                      APR_ARRAY_IDX(paths, i, const char *)) < 0);
+
+  return svn_error_trace(svn_repos__authz_check_access_many(allowed,
+                                                            b->authz,
+                                                            "repo", paths,
+                                                            "user",
+                                                            svn_authz_read,
+                                                            pool));
+}
+
+static svn_error_t *
+test_authz_read_many(apr_pool_t *pool)
+{
+  const int path_count = sizeof(access_paths) / sizeof(access_paths[0]);
+
+  apr_array_header_t *path_array = apr_array_make(pool, path_count,
+                                                  sizeof(const char *));
+  svn_boolean_t *expected = apr_pcalloc(pool,
+                                        path_count * sizeof(*expected));
+  svn_boolean_t *granted = apr_pcalloc(pool, path_count * sizeof(*granted));
+  read_many_baton_t baton = { 0 };
+  int i;
+
+  /* Pass the paths in reverse order.  The results must be in that order
+   * as well. */
+  for (i = path_count - 1; i >= 0; --i)
+    {
+      APR_ARRAY_PUSH(path_array, const char *) = access_paths[i];
+      SVN_ERR(check_access_fresh(&expected[path_array->nelts - 1],
+                                 access_paths[i], svn_authz_read, pool));
+    }
+
+  /* Without a registered batch function, fall back to single checks. */
+  SVN_ERR(parse_access_rules(&baton.authz, pool));
+  SVN_ERR(svn_repos__authz_read_many(granted, read_single_cb, &baton, NULL,
+                                     path_array, pool));
+  SVN_TEST_INT_ASSERT(baton.single_calls, path_count);
+  SVN_TEST_INT_ASSERT(baton.many_calls, 0);
+  for (i = 0; i < path_count; ++i)
+    SVN_TEST_ASSERT(granted[i] == expected[i]);
+
+  /* With a batch function, there is only one call. */
+  SVN_ERR(svn_repos__authz_register_many_func(read_single_cb,
+                                              read_many_cb));
+
+  memset(granted, 0, path_count * sizeof(*granted));
+  SVN_ERR(parse_access_rules(&baton.authz, pool));
+  SVN_ERR(svn_repos__authz_read_many(granted, read_single_cb, &baton, NULL,
+                                     path_array, pool));
+  SVN_TEST_INT_ASSERT(baton.single_calls, path_count);
+  SVN_TEST_INT_ASSERT(baton.many_calls, 1);
+  for (i = 0; i < path_count; ++i)
+    SVN_TEST_ASSERT(granted[i] == expected[i]);
+
+  return SVN_NO_ERROR;
+}
+
+/* Write a large authz file to PATH.  One section grants BOB_ACCESS to BOB
+ * on /p0/private.  It comes first if BOB_FIRST is set and last otherwise.
+ * All other rules apply to the whole staff. */
+static svn_error_t *
+write_reload_rules(const char *path,
+                   const char *bob_access,
+                   svn_boolean_t bob_first,
+                   apr_pool_t *pool)
+{
+  svn_stringbuf_t *rules = svn_stringbuf_create(
+    "[groups]"                               NL
+    "staff = alice, bob"                     NL
+    ""                                       NL
+    "[/]"                                    NL
+    "* = r"                                  NL
+    ""                                       NL, pool);
+  const char *bob_rules = apr_psprintf(pool,
+                                       "[/p0/private]" NL
+                                       "bob = %s"      NL
+                                       ""              NL,
+                                       bob_access);
+  int i;
+
+  if (bob_first)
+    svn_stringbuf_appendcstr(rules, bob_rules);
+
+  for (i = 0; i < 2000; ++i)
+    svn_stringbuf_appendcstr(rules,
+                             apr_psprintf(pool,
+                                          "[:glob:/p%d/**/secret]" NL
+                                          "@staff = rw"            NL
+                                          "* ="                    NL
+                                          ""                       NL,
+                                          i));
+
+  if (!bob_first)
+    svn_stringbuf_appendcstr(rules, bob_rules);
+
+  return svn_error_trace(svn_io_file_create(path, rules->data, pool));
+}
+
+/* Read the authz file at PATH into *AUTHZ, allocated in POOL, and check
+ * that USER has write access to /p7/x/secret.  Return the filtered tree
+ * used for that check in *TREE. */
+static svn_error_t *
+read_reload_rules(svn_authz_t **authz,
+                  const void **tree,
+                  const char *path,
+                  const char *user,
+                  apr_pool_t *pool)
+{
+  svn_boolean_t granted;
+
+  SVN_ERR(svn_repos_authz_read4(authz, path, NULL, TRUE, NULL,
+                                NULL, NULL, pool, pool));
+  SVN_ERR(svn_repos_authz_check_access(*authz, "repo", "/p7/x/secret",
+                                       user, svn_authz_write, &granted,
+                                       pool));
+  SVN_TEST_ASSERT(granted);
+
+  *tree = svn_authz__get_filtered_tree(*authz);
+  SVN_TEST_ASSERT(*tree);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_authz_reload(const svn_test_opts_t *opts,
+                  apr_pool_t *pool)
+{
+  /* The authz object pools must outlive this test. */
+  static apr_pool_t *cache_pool = NULL;
+
+  const char *dir;
+  const char *path;
+  svn_authz_t *authz;
+  svn_authz_t *alice_authz;
+  svn_authz_t *bob_authz;
+  const void *alice_tree;
+  const void *bob_tree;
+  const void *tree;
+  svn_boolean_t granted;
+  apr_time_t start, initial, reload;
+
+  if (!cache_pool)
+    cache_pool = svn_pool_create(NULL);
+  SVN_ERR(svn_repos_authz_initialize(cache_pool));
+
+  SVN_ERR(svn_test_make_sandbox_dir(&dir, "authz-reload", pool));
+  path = svn_dirent_join(dir, "authz", pool);
+
+  /* Initial load and filtering for ALICE and BOB.  Keep separate authz
+   * objects for both, such that their filtered trees stay referenced. */
+  SVN_ERR(write_reload_rules(path, "", FALSE, pool));
+  start = apr_time_now();
+  SVN_ERR(read_reload_rules(&alice_authz, &alice_tree, path, "alice",
+                            pool));
+  initial = apr_time_now() - start;
+  SVN_ERR(read_reload_rules(&bob_authz, &bob_tree, path, "bob", pool));
+  SVN_TEST_ASSERT(alice_tree != bob_tree);
+
+  SVN_ERR(svn_repos_authz_check_access(bob_authz, "repo", "/p0/private",
+                                       "bob", svn_authz_read, &granted,
+                                       pool));
+  SVN_TEST_ASSERT(!granted);
+
+  /* Reading the same file again reuses both trees. */
+  SVN_ERR(read_reload_rules(&authz, &tree, path, "alice", pool));
+  SVN_TEST_ASSERT(tree == alice_tree);
+  SVN_ERR(read_reload_rules(&authz, &tree, path, "bob", pool));
+  SVN_TEST_ASSERT(tree == bob_tree);
+
+  /* Modify a rule that applies to BOB only.  ALICE's filtered rule tree
+   * does not need to be rebuilt but BOB's does. */
+  SVN_ERR(write_reload_rules(path, "r", FALSE, pool));
+  start = apr_time_now();
+  SVN_ERR(read_reload_rules(&authz, &tree, path, "alice", pool));
+  reload = apr_time_now() - start;
+  SVN_TEST_ASSERT(tree == alice_tree);
+
+  SVN_ERR(svn_repos_authz_check_access(authz, "repo", "/p0/private",
+                                       "alice", svn_authz_read, &granted,
+                                       pool));
+  SVN_TEST_ASSERT(granted);
+
+  SVN_ERR(read_reload_rules(&authz, &tree, path, "bob", pool));
+  SVN_TEST_ASSERT(tree != bob_tree);
+  SVN_ERR(svn_repos_authz_check_access(authz, "repo", "/p0/private",
+                                       "bob", svn_authz_read, &granted,
+                                       pool));
+  SVN_TEST_ASSERT(granted);
+  SVN_ERR(svn_repos_authz_check_access(authz, "repo", "/p0/private",
+                                       "bob", svn_authz_write, &granted,
+                                       pool));
+  SVN_TEST_ASSERT(!granted);
+  SVN_ERR(svn_repos_authz_check_access(authz, "repo", "/p0/x/secret",
+                                       "carol", svn_authz_read, &granted,
+                                       pool));
+  SVN_TEST_ASSERT(!granted);
+
+  /* Moving BOB's rule to the top shifts the positions of all of ALICE's
+   * rules but not their relative order.  Her tree remains valid. */
+  SVN_ERR(write_reload_rules(path, "r", TRUE, pool));
+  SVN_ERR(read_reload_rules(&authz, &tree, path, "alice", pool));
+  SVN_TEST_ASSERT(tree == alice_tree);
+
+  if (opts->verbose)
+    printf("initial load: %" APR_TIME_T_FMT " usec, "
+           "reload: %" APR_TIME_T_FMT " usec\n",
+           initial, reload);
+
+  return SVN_NO_ERROR;
+}
+
 static int max_threads = 4;
 
 static struct svn_test_descriptor_t test_funcs[] =
@@ -524,6 +959,14 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "issue 4741 groups"),
     SVN_TEST_XFAIL2(reposful_reposless_stanzas_inherit,
                     "[foo:/] inherits [/]"),
+    SVN_TEST_PASS2(test_check_access_sequence,
+                   "test authz lookups sharing parent paths"),
+    SVN_TEST_PASS2(test_check_access_many,
+                   "test svn_repos__authz_check_access_many"),
+    SVN_TEST_PASS2(test_authz_read_many,
+                   "test svn_repos__authz_read_many"),
+    SVN_TEST_OPTS_PASS(test_authz_reload,
+                       "test reloading a modified authz file"),
     SVN_TEST_NULL
   };
 
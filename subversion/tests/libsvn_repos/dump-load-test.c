@@ -27,6 +27,7 @@
 #include "svn_pools.h"
 #include "svn_error.h"
 #include "svn_fs.h"
+#include "svn_props.h"
 #include "svn_repos.h"
 #include "private/svn_repos_private.h"
 
@@ -273,6 +274,434 @@ test_load_r0_mergeinfo(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Dump the REPOS into a temporary file using JOBS threads.  Return that
+ * file in *FILE, its contents in *DUMP_DATA and the dump index in *INDEX.
+ * Allocate everything in POOL.
+ */
+static svn_error_t *
+dump_with_index(svn_stringbuf_t **dump_data,
+                svn_repos__dump_index_t **index,
+                apr_file_t **file,
+                svn_repos_t *repos,
+                int jobs,
+                apr_pool_t *pool)
+{
+  svn_stream_t *stream;
+  apr_off_t offset = 0;
+
+  *index = svn_repos__dump_index_create(pool);
+  SVN_ERR(svn_io_open_unique_file3(file, NULL, NULL,
+                                   svn_io_file_del_on_pool_cleanup,
+                                   pool, pool));
+  stream = svn_stream_from_aprfile2(*file, TRUE, pool);
+  SVN_ERR(svn_repos__dump_fs_jobs(repos, NULL, NULL, NULL, jobs, *index,
+                                  stream, SVN_INVALID_REVNUM,
+                                  SVN_INVALID_REVNUM, FALSE, TRUE,
+                                  TRUE, TRUE, NULL, NULL, NULL, NULL,
+                                  NULL, NULL, pool));
+  SVN_ERR(svn_stream_close(stream));
+
+  SVN_ERR(svn_io_file_seek(*file, APR_SET, &offset, pool));
+  SVN_ERR(svn_stringbuf_from_aprfile(dump_data, *file, pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_dump_index(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+  svn_stringbuf_t *expected = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *actual;
+  svn_stringbuf_t *range_data;
+  svn_stringbuf_t *index_data = svn_stringbuf_create_empty(pool);
+  svn_repos__dump_index_t *index;
+  svn_repos__dump_index_t *index2;
+  svn_stream_t *stream;
+  apr_file_t *file;
+  apr_off_t rev1_end;
+  apr_off_t rev2_end;
+  const char *paths[] = { "/A", "/B", "/C" };
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-dump-index",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  for (i = 0; i < 3; ++i)
+    {
+      SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+      SVN_ERR(svn_fs_make_dir(txn_root, paths[i], pool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      pool));
+    }
+
+  /* Reference dump. */
+  stream = svn_stream_from_stringbuf(expected, pool);
+  SVN_ERR(svn_repos_dump_fs4(repos, stream, SVN_INVALID_REVNUM,
+                             SVN_INVALID_REVNUM, FALSE, TRUE, TRUE, TRUE,
+                             NULL, NULL, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_stream_close(stream));
+
+  /* Sequential and parallel dumps produce the same data and index. */
+  SVN_ERR(dump_with_index(&actual, &index2, &file, repos, 2, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(expected, actual));
+  SVN_ERR(dump_with_index(&actual, &index, &file, repos, 1, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(expected, actual));
+
+  SVN_TEST_INT_ASSERT(index->start_rev, 0);
+  SVN_TEST_INT_ASSERT(index->rev_ends->nelts, 4);
+  SVN_TEST_INT_ASSERT(index2->rev_ends->nelts, 4);
+  SVN_TEST_ASSERT(index->header_length == index2->header_length);
+  for (i = 0; i < 4; ++i)
+    SVN_TEST_ASSERT(APR_ARRAY_IDX(index->rev_ends, i, apr_off_t)
+                    == APR_ARRAY_IDX(index2->rev_ends, i, apr_off_t));
+  SVN_TEST_ASSERT(APR_ARRAY_IDX(index->rev_ends, 3, apr_off_t)
+                  == (apr_off_t)actual->len);
+  SVN_TEST_ASSERT(strncmp(actual->data + index->header_length,
+                          "Revision-number: 0\n", 19) == 0);
+
+  /* Round-trip the index. */
+  stream = svn_stream_from_stringbuf(index_data, pool);
+  SVN_ERR(svn_repos__dump_index_write(stream, index, pool));
+  SVN_ERR(svn_repos__dump_index_read(&index2, stream, pool, pool));
+  SVN_TEST_ASSERT(index->header_length == index2->header_length);
+  SVN_TEST_INT_ASSERT(index2->start_rev, index->start_rev);
+  SVN_TEST_INT_ASSERT(index2->rev_ends->nelts, index->rev_ends->nelts);
+
+  /* Extract r2 only: the header followed by that revision's record. */
+  rev1_end = APR_ARRAY_IDX(index->rev_ends, 1, apr_off_t);
+  rev2_end = APR_ARRAY_IDX(index->rev_ends, 2, apr_off_t);
+  expected = svn_stringbuf_ncreate(actual->data,
+                                   (apr_size_t)index->header_length, pool);
+  svn_stringbuf_appendbytes(expected, actual->data + rev1_end,
+                            (apr_size_t)(rev2_end - rev1_end));
+
+  SVN_ERR(svn_repos__dump_index_range(&stream, file, index2, 2, 2, pool));
+  SVN_ERR(svn_stringbuf_from_stream(&range_data, stream, 0, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(expected, range_data));
+
+  /* Ranges beyond the dump file yield the header only. */
+  SVN_ERR(svn_repos__dump_index_range(&stream, file, index2, 10, 20, pool));
+  SVN_ERR(svn_stringbuf_from_stream(&range_data, stream, 0, pool));
+  SVN_TEST_INT_ASSERT(range_data->len, index->header_length);
+
+  /* The headers must be terminated by an empty line. */
+  index_data = svn_stringbuf_create("SVN-dump-index-version: 1\n"
+                                    "Header-length: 10\n"
+                                    "Start-revision: 0\n"
+                                    "123\n", pool);
+  stream = svn_stream_from_stringbuf(index_data, pool);
+  SVN_TEST_ASSERT_ERROR(svn_repos__dump_index_read(&index2, stream,
+                                                   pool, pool),
+                        SVN_ERR_STREAM_MALFORMED_DATA);
+
+  /* Indexes that do not describe the dump file get rejected:
+     a different start revision ... */
+  index2 = svn_repos__dump_index_create(pool);
+  index2->header_length = index->header_length;
+  index2->start_rev = 1;
+  index2->rev_ends = apr_array_copy(pool, index->rev_ends);
+  SVN_TEST_ASSERT_ERROR(svn_repos__dump_index_range(&stream, file, index2,
+                                                    2, 2, pool),
+                        SVN_ERR_STREAM_MALFORMED_DATA);
+
+  /* ... a different record boundary ... */
+  index2->start_rev = 0;
+  APR_ARRAY_IDX(index2->rev_ends, 1, apr_off_t) -= 1;
+  SVN_TEST_ASSERT_ERROR(svn_repos__dump_index_range(&stream, file, index2,
+                                                    2, 2, pool),
+                        SVN_ERR_STREAM_MALFORMED_DATA);
+
+  /* ... and a different file size. */
+  index2->rev_ends = apr_array_copy(pool, index->rev_ends);
+  APR_ARRAY_PUSH(index2->rev_ends, apr_off_t) = (apr_off_t)actual->len + 100;
+  SVN_TEST_ASSERT_ERROR(svn_repos__dump_index_range(&stream, file, index2,
+                                                    2, 2, pool),
+                        SVN_ERR_STREAM_MALFORMED_DATA);
+
+  return SVN_NO_ERROR;
+}
+
+/* Dump revisions START_REV to END_REV of REPOS using JOBS threads and
+ * return the result in *DUMP_DATA, allocated in POOL.
+ */
+static svn_error_t *
+dump_with_jobs(svn_stringbuf_t **dump_data,
+               svn_repos_t *repos,
+               int jobs,
+               svn_revnum_t start_rev,
+               svn_revnum_t end_rev,
+               svn_boolean_t incremental,
+               svn_boolean_t use_deltas,
+               apr_pool_t *pool)
+{
+  svn_stream_t *stream;
+
+  *dump_data = svn_stringbuf_create_empty(pool);
+  stream = svn_stream_from_stringbuf(*dump_data, pool);
+  SVN_ERR(svn_repos__dump_fs_jobs(repos, NULL, NULL, NULL, jobs, NULL,
+                                  stream, start_rev, end_rev, incremental,
+                                  use_deltas, TRUE, TRUE, NULL, NULL,
+                                  NULL, NULL, NULL, NULL, pool));
+
+  return svn_error_trace(svn_stream_close(stream));
+}
+
+static svn_error_t *
+test_dump_jobs(const svn_test_opts_t *opts,
+               apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_fs_root_t *rev_root;
+  svn_revnum_t youngest_rev = 0;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-dump-jobs",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1: the Greek tree */
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* r2: branch A */
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_copy(rev_root, "A", txn_root, "branch", pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* r3 .. r12: alternate between changes on the trunk, merges into the
+   * branch and copies from older revisions. */
+  for (i = 0; i < 10; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+
+      switch (i % 3)
+        {
+          case 0:
+            SVN_ERR(svn_test__set_file_contents(txn_root, "A/mu",
+                      apr_psprintf(iterpool, "This is mu, version %d.\n", i),
+                      iterpool));
+            break;
+
+          case 1:
+            SVN_ERR(svn_test__set_file_contents(txn_root, "branch/mu",
+                      apr_psprintf(iterpool, "This is mu, version %d.\n",
+                                   i - 1),
+                      iterpool));
+            SVN_ERR(svn_fs_change_node_prop(txn_root, "branch",
+                      SVN_PROP_MERGEINFO,
+                      svn_string_createf(iterpool, "/A:2-%ld",
+                                         youngest_rev),
+                      iterpool));
+            break;
+
+          default:
+            SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev - 2,
+                                         iterpool));
+            SVN_ERR(svn_fs_copy(rev_root, "A/D/G", txn_root,
+                                apr_psprintf(iterpool, "G%d", i),
+                                iterpool));
+            break;
+        }
+
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      iterpool));
+    }
+
+  /* Dumping in parallel must produce exactly the same output as a
+   * sequential dump, with and without deltas and for partial ranges. */
+  for (i = 0; i < 6; ++i)
+    {
+      svn_stringbuf_t *expected;
+      svn_stringbuf_t *actual;
+      svn_boolean_t use_deltas = i % 2;
+      svn_revnum_t start_rev = i < 2 ? 0 : 4;
+      svn_boolean_t incremental = i >= 4;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(dump_with_jobs(&expected, repos, 1, start_rev, youngest_rev,
+                             incremental, use_deltas, iterpool));
+      SVN_ERR(dump_with_jobs(&actual, repos, 3, start_rev, youngest_rev,
+                             incremental, use_deltas, iterpool));
+      SVN_TEST_ASSERT(svn_stringbuf_compare(expected, actual));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Counters for the parser callbacks invoked in test_parse_skip_nodes(). */
+typedef struct skip_nodes_baton_t
+{
+  int nodes;
+  int closed_nodes;
+  int node_props;
+  int texts;
+} skip_nodes_baton_t;
+
+/* Implements svn_repos_parse_fns3_t.new_revision_record. */
+static svn_error_t *
+skip_nodes_new_revision(void **revision_baton,
+                        apr_hash_t *headers,
+                        void *parse_baton,
+                        apr_pool_t *pool)
+{
+  *revision_baton = parse_baton;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos_parse_fns3_t.new_node_record. */
+static svn_error_t *
+skip_nodes_new_node(void **node_baton,
+                    apr_hash_t *headers,
+                    void *revision_baton,
+                    apr_pool_t *pool)
+{
+  skip_nodes_baton_t *b = revision_baton;
+  b->nodes++;
+  *node_baton = b;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos_parse_fns3_t.set_node_property. */
+static svn_error_t *
+skip_nodes_set_node_property(void *node_baton,
+                             const char *name,
+                             const svn_string_t *value)
+{
+  skip_nodes_baton_t *b = node_baton;
+  b->node_props++;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos_parse_fns3_t.set_fulltext. */
+static svn_error_t *
+skip_nodes_set_fulltext(svn_stream_t **stream,
+                        void *node_baton)
+{
+  skip_nodes_baton_t *b = node_baton;
+  b->texts++;
+  *stream = NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos_parse_fns3_t.close_node. */
+static svn_error_t *
+skip_nodes_close_node(void *node_baton)
+{
+  skip_nodes_baton_t *b = node_baton;
+  b->closed_nodes++;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos__parse_skip_node_func_t. */
+static svn_error_t *
+skip_all_nodes(svn_boolean_t *skip,
+               void *node_baton)
+{
+  *skip = TRUE;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_parse_skip_nodes(const svn_test_opts_t *opts,
+                      apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+  svn_stringbuf_t *dump_data = svn_stringbuf_create_empty(pool);
+  svn_stream_t *stream;
+  apr_file_t *file;
+  apr_size_t written;
+  apr_off_t offset = 0;
+  svn_repos_parse_fns3_t parse_fns = { 0 };
+  skip_nodes_baton_t baton = { 0 };
+
+  parse_fns.new_revision_record = skip_nodes_new_revision;
+  parse_fns.new_node_record = skip_nodes_new_node;
+  parse_fns.set_node_property = skip_nodes_set_node_property;
+  parse_fns.set_fulltext = skip_nodes_set_fulltext;
+  parse_fns.close_node = skip_nodes_close_node;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-parse-skip-nodes",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "/iota", "prop",
+                                  svn_string_create("value", pool), pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  stream = svn_stream_from_stringbuf(dump_data, pool);
+  SVN_ERR(svn_repos_dump_fs4(repos, stream, SVN_INVALID_REVNUM,
+                             SVN_INVALID_REVNUM, FALSE, FALSE, TRUE, TRUE,
+                             NULL, NULL, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_stream_close(stream));
+
+  /* Parse from a seekable file, skipping all node contents. */
+  SVN_ERR(svn_io_open_unique_file3(&file, NULL, NULL,
+                                   svn_io_file_del_on_pool_cleanup,
+                                   pool, pool));
+  SVN_ERR(svn_io_file_write_full(file, dump_data->data, dump_data->len,
+                                 &written, pool));
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, pool));
+  stream = svn_stream_from_aprfile2(file, TRUE, pool);
+
+  SVN_ERR(svn_repos__parse_dumpstream(stream, &parse_fns, &baton, FALSE,
+                                      skip_all_nodes, NULL, NULL, pool));
+  SVN_TEST_INT_ASSERT(baton.nodes, 20);
+  SVN_TEST_INT_ASSERT(baton.closed_nodes, baton.nodes);
+  SVN_TEST_INT_ASSERT(baton.node_props, 0);
+  SVN_TEST_INT_ASSERT(baton.texts, 0);
+
+  /* Without skipping, we get all contents. */
+  memset(&baton, 0, sizeof(baton));
+  stream = svn_stream_from_stringbuf(dump_data, pool);
+  SVN_ERR(svn_repos__parse_dumpstream(stream, &parse_fns, &baton, FALSE,
+                                      NULL, NULL, NULL, pool));
+  SVN_TEST_INT_ASSERT(baton.nodes, 20);
+  SVN_TEST_INT_ASSERT(baton.node_props, 1);
+  SVN_TEST_INT_ASSERT(baton.texts, 12);
+
+  /* Truncated contents are still detected when skipping them. */
+  svn_stringbuf_chop(dump_data, 5);
+  stream = svn_stream_from_stringbuf(dump_data, pool);
+  SVN_TEST_ASSERT_ERROR(svn_repos__parse_dumpstream(stream, &parse_fns,
+                                                    &baton, FALSE,
+                                                    skip_all_nodes,
+                                                    NULL, NULL, pool),
+                        SVN_ERR_INCOMPLETE_DATA);
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -284,6 +713,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test dumping with r0 mergeinfo"),
     SVN_TEST_OPTS_PASS(test_load_r0_mergeinfo,
                        "test loading with r0 mergeinfo"),
+    SVN_TEST_OPTS_PASS(test_dump_index,
+                       "test dumping with a revision index"),
+    SVN_TEST_OPTS_PASS(test_dump_jobs,
+                       "test parallel dumps against sequential ones"),
+    SVN_TEST_OPTS_PASS(test_parse_skip_nodes,
+                       "test skipping node contents while parsing"),
     SVN_TEST_NULL
   };
 
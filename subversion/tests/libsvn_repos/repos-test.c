@@ -3274,6 +3274,219 @@ reporter_depth_exclude(const svn_test_opts_t *opts,
 }
 
 
+
+/* Test that prefetching file deltas in worker threads does not change
+   the outcome of checkouts and updates. */
+static svn_error_t *
+reporter_prefetch(const svn_test_opts_t *opts,
+                  apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  apr_pool_t *subpool = svn_pool_create(pool);
+  svn_revnum_t youngest_rev;
+  const svn_delta_editor_t *editor;
+  void *edit_baton, *report_baton;
+  svn_revnum_t base_rev;
+
+  static svn_test__tree_entry_t entries[] = {
+    { "iota",        "Changed file 'iota'.\n" },
+    { "A",           0 },
+    { "A/mu",        "Changed file 'mu'.\n" },
+    { "A/B",         0 },
+    { "A/B/bar",     "New file 'bar'.\n" },
+    { "A/B/lambda",  "This is the file 'lambda'.\n" },
+    { "A/B/E",       0 },
+    { "A/B/E/alpha", "This is the file 'alpha'.\n" },
+    { "A/B/F",       0 },
+    { "A/C",         0 },
+    { "A/D",         0 },
+    { "A/D/gamma",   "This is the file 'gamma'.\n" },
+    { "A/D/G",       0 },
+    { "A/D/G/pi",    "Changed file 'pi'.\n" },
+    { "A/D/G/rho",   "Changed file 'rho'.\n" },
+    { "A/D/G/tau",   "This is the file 'tau'.\n" },
+    { "A/D/H",       0 },
+    { "A/D/H/chi",   "This is the file 'chi'.\n" },
+    { "A/D/H/psi",   "This is the file 'psi'.\n" },
+    { "A/D/H/omega", "This is the file 'omega'.\n" }
+  };
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-reporter-prefetch",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* Revision 1: the greek tree. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
+  svn_pool_clear(subpool);
+
+  /* Revision 2: modify, add and delete files in various directories. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  {
+    static svn_test__txn_script_command_t script_entries[] = {
+      { 'e', "iota",       "Changed file 'iota'.\n" },
+      { 'e', "A/D/G/pi",   "Changed file 'pi'.\n" },
+      { 'e', "A/D/G/rho",  "Changed file 'rho'.\n" },
+      { 'e', "A/mu",       "Changed file 'mu'.\n" },
+      { 'a', "A/B/bar",    "New file 'bar'.\n" },
+      { 'd', "A/B/E/beta", NULL }
+    };
+    SVN_ERR(svn_test__txn_script_exec(txn_root,
+                                      script_entries,
+                                      sizeof(script_entries)/
+                                       sizeof(script_entries[0]),
+                                      subpool));
+  }
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
+  svn_pool_clear(subpool);
+
+  /* Check out r2 from scratch and update r1 to r2. */
+  for (base_rev = 0; base_rev < 2; ++base_rev)
+    {
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, base_rev, subpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+      SVN_ERR(dir_delta_get_editor(&editor, &edit_baton, fs,
+                                   txn_root, "", subpool));
+
+      SVN_ERR(svn_repos_begin_report3(&report_baton, youngest_rev, repos,
+                                      "/", "", NULL, TRUE,
+                                      svn_depth_infinity, FALSE, FALSE,
+                                      editor, edit_baton, NULL, NULL, 0,
+                                      subpool));
+      svn_repos__report_set_jobs(report_baton, 2, NULL);
+      SVN_ERR(svn_repos_set_path3(report_baton, "", base_rev,
+                                  svn_depth_infinity, base_rev == 0, NULL,
+                                  subpool));
+      SVN_ERR(svn_repos_finish_report(report_baton, subpool));
+
+      SVN_ERR(svn_test__validate_tree(txn_root,
+                                      entries,
+                                      sizeof(entries)/sizeof(entries[0]),
+                                      subpool));
+
+      svn_error_clear(svn_fs_abort_txn(txn, subpool));
+      svn_pool_clear(subpool);
+    }
+
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Test that the replay-range prefetcher stays within its window of
+   revisions and content bytes ahead of the revision being replayed. */
+static svn_error_t *
+replay_prefetch_window(const svn_test_opts_t *opts,
+                       apr_pool_t *pool)
+{
+  /* These must match REPLAY_PREFETCH_WINDOW and REPLAY_PREFETCH_MAX_BYTES
+     in replay.c. */
+  const svn_revnum_t window = 8;
+  const apr_size_t max_bytes = 64 * 1024 * 1024;
+
+  /* Revisions 1 to 12 add small files, revisions 13 to 18 large ones. */
+  const svn_revnum_t last_small_rev = 12;
+  const svn_revnum_t last_rev = 18;
+  const apr_size_t large_size = 24 * 1024 * 1024;
+
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  apr_pool_t *subpool = svn_pool_create(pool);
+  svn_revnum_t youngest_rev = 0;
+  svn_repos__replay_prefetcher_t *prefetcher;
+  svn_revnum_t prefetched_rev;
+  apr_size_t bytes_ahead;
+  svn_stringbuf_t *large_text;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-replay-prefetch",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  large_text = svn_stringbuf_create_ensure(large_size, pool);
+  memset(large_text->data, 'x', large_size);
+  large_text->data[large_size] = '\0';
+  large_text->len = large_size;
+
+  while (youngest_rev < last_rev)
+    {
+      const char *path = apr_psprintf(subpool, "/file-%ld",
+                                      youngest_rev + 1);
+
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+      SVN_ERR(svn_fs_make_file(txn_root, path, subpool));
+      if (youngest_rev < last_small_rev)
+        {
+          SVN_ERR(svn_test__set_file_contents(txn_root, path, "small\n",
+                                              subpool));
+        }
+      else
+        {
+          /* Make the contents unique, so they won't be shared. */
+          large_text->data[0] = (char)('a' + youngest_rev);
+          SVN_ERR(svn_test__set_file_contents(txn_root, path,
+                                              large_text->data, subpool));
+        }
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      subpool));
+      SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
+      svn_pool_clear(subpool);
+    }
+
+  SVN_ERR(svn_repos__replay_prefetcher_start(&prefetcher, repos, "/", 1,
+                                             last_rev, TRUE, pool));
+  if (!prefetcher)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "replay prefetching is not supported");
+
+  /* Replaying r1, only small revisions fit into the window. */
+  SVN_ERR(svn_repos__replay_prefetcher_progress(prefetcher, 1));
+  SVN_ERR(svn_repos__replay_prefetcher_wait(&prefetched_rev, &bytes_ahead,
+                                            prefetcher));
+  SVN_TEST_ASSERT(prefetched_rev == 1 + window - 1);
+  SVN_TEST_ASSERT(bytes_ahead == (window - 1) * strlen("small\n"));
+
+  /* Replaying r10, the byte limit stops the prefetcher after the third
+     large revision, long before the window is exhausted. */
+  SVN_ERR(svn_repos__replay_prefetcher_progress(prefetcher, 10));
+  SVN_ERR(svn_repos__replay_prefetcher_wait(&prefetched_rev, &bytes_ahead,
+                                            prefetcher));
+  SVN_TEST_ASSERT(prefetched_rev == last_small_rev + 3);
+  SVN_TEST_ASSERT(bytes_ahead == 2 * strlen("small\n") + 3 * large_size);
+  SVN_TEST_ASSERT(bytes_ahead >= max_bytes);
+
+  /* Replaying r15, the revisions up to r15 no longer count and the rest
+     of the range fits. */
+  SVN_ERR(svn_repos__replay_prefetcher_progress(prefetcher, 15));
+  SVN_ERR(svn_repos__replay_prefetcher_wait(&prefetched_rev, &bytes_ahead,
+                                            prefetcher));
+  SVN_TEST_ASSERT(prefetched_rev == last_rev);
+  SVN_TEST_ASSERT(bytes_ahead == 3 * large_size);
+
+  /* Replaying the last revision, nothing is ahead anymore. */
+  SVN_ERR(svn_repos__replay_prefetcher_progress(prefetcher, last_rev));
+  SVN_ERR(svn_repos__replay_prefetcher_wait(&prefetched_rev, &bytes_ahead,
+                                            prefetcher));
+  SVN_TEST_ASSERT(prefetched_rev == last_rev);
+  SVN_TEST_ASSERT(bytes_ahead == 0);
+
+  SVN_ERR(svn_repos__replay_prefetcher_stop(prefetcher));
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
+
 
 /* Test if prop values received by the server are validated.
  * These tests "send" property values to the server and diagnose the
@@ -3512,6 +3725,121 @@ get_logs(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Baton for the receivers used by get_logs_long. */
+typedef struct long_log_baton_t
+{
+  /* The revision expected next and the direction of the log. */
+  svn_revnum_t next_rev;
+  int step;
+
+  /* Number of changed paths reported for the current revision. */
+  int changes;
+} long_log_baton_t;
+
+/* Implements svn_repos_path_change_receiver_t. */
+static svn_error_t *
+long_log_path_change_receiver(void *baton,
+                              svn_repos_path_change_t *change,
+                              apr_pool_t *scratch_pool)
+{
+  long_log_baton_t *b = baton;
+  b->changes++;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos_log_entry_receiver_t. */
+static svn_error_t *
+long_log_revision_receiver(void *baton,
+                           svn_repos_log_entry_t *log_entry,
+                           apr_pool_t *scratch_pool)
+{
+  long_log_baton_t *b = baton;
+  const svn_string_t *author = svn_hash_gets(log_entry->revprops,
+                                             SVN_PROP_REVISION_AUTHOR);
+
+  SVN_TEST_ASSERT(log_entry->revision == b->next_rev);
+  SVN_TEST_ASSERT(b->changes == (log_entry->revision == 1 ? 20 : 1));
+  SVN_TEST_ASSERT(author && !strcmp(author->data, "jrandom"));
+
+  b->next_rev += b->step;
+  b->changes = 0;
+  return SVN_NO_ERROR;
+}
+
+/* Test logs long enough to be read ahead by a helper thread. */
+static svn_error_t *
+get_logs_long(const svn_test_opts_t *opts,
+              apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+  apr_pool_t *subpool = svn_pool_create(pool);
+  long_log_baton_t baton = { 0 };
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-get-logs-long",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* Revision 1:  Add the Greek tree. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  /* Revisions 2 to 50:  Modify iota. */
+  for (i = 2; i <= 50; ++i)
+    {
+      svn_pool_clear(subpool);
+      SVN_ERR(svn_repos_fs_begin_txn_for_commit2(&txn, repos, youngest_rev,
+                                                  apr_hash_make(subpool),
+                                                  subpool));
+      SVN_ERR(svn_fs_change_txn_prop(txn, SVN_PROP_REVISION_AUTHOR,
+                                     svn_string_create("jrandom", subpool),
+                                     subpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                          apr_psprintf(subpool,
+                                                       "Revision %d", i),
+                                          subpool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      subpool));
+    }
+
+  /* The Greek tree has no author.  Set one. */
+  SVN_ERR(svn_fs_change_rev_prop2(fs, 1, SVN_PROP_REVISION_AUTHOR, NULL,
+                                  svn_string_create("jrandom", subpool),
+                                  subpool));
+
+  /* Full log, youngest first. */
+  svn_pool_clear(subpool);
+  baton.next_rev = youngest_rev;
+  baton.step = -1;
+  SVN_ERR(svn_repos_get_logs5(repos, NULL, youngest_rev, 1, 0,
+                              FALSE, FALSE, NULL, NULL, NULL,
+                              long_log_path_change_receiver, &baton,
+                              long_log_revision_receiver, &baton,
+                              subpool));
+  SVN_TEST_ASSERT(baton.next_rev == 0);
+
+  /* Limited log, oldest first. */
+  svn_pool_clear(subpool);
+  baton.next_rev = 1;
+  baton.step = 1;
+  SVN_ERR(svn_repos_get_logs5(repos, NULL, 1, youngest_rev, 30,
+                              FALSE, FALSE, NULL, NULL, NULL,
+                              long_log_path_change_receiver, &baton,
+                              long_log_revision_receiver, &baton,
+                              subpool));
+  SVN_TEST_ASSERT(baton.next_rev == 31);
+
+  svn_pool_destroy(subpool);
+  return SVN_NO_ERROR;
+}
+
 
 /* Tests for svn_repos_get_file_revsN() */
 
@@ -3643,6 +3971,139 @@ test_get_file_revs(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Return the contents of the file in revision REV of the repository
+   created by test_get_file_revs_deltas, allocated in POOL. */
+static const char *
+file_revs_deltas_text(int rev,
+                      apr_pool_t *pool)
+{
+  svn_stringbuf_t *text = svn_stringbuf_create_empty(pool);
+  int i;
+
+  for (i = 0; i < rev * 10; ++i)
+    svn_stringbuf_appendcstr(text,
+                             apr_psprintf(pool, "line %d of revision %d\n",
+                                          i, (i % 7 == rev % 7) ? rev : 0));
+
+  return text->data;
+}
+
+/* Baton for file_revs_deltas_handler. */
+typedef struct file_revs_deltas_baton_t
+{
+  /* The file contents reconstructed so far, in the order received. */
+  apr_array_header_t *texts;
+
+  /* The revisions for which we received TEXTS. */
+  apr_array_header_t *revs;
+
+  /* Pool for TEXTS. */
+  apr_pool_t *pool;
+} file_revs_deltas_baton_t;
+
+/* Implements svn_file_rev_handler_t.  Reconstruct the file contents
+   from the delta against the previous contents in BATON. */
+static svn_error_t *
+file_revs_deltas_handler(void *baton,
+                         const char *path,
+                         svn_revnum_t rev,
+                         apr_hash_t *rev_props,
+                         svn_boolean_t result_of_merge,
+                         svn_txdelta_window_handler_t *delta_handler,
+                         void **delta_baton,
+                         apr_array_header_t *prop_diffs,
+                         apr_pool_t *pool)
+{
+  file_revs_deltas_baton_t *b = baton;
+  svn_stringbuf_t *source;
+  svn_stringbuf_t *target;
+
+  if (!delta_handler)
+    return SVN_NO_ERROR;
+
+  source = b->texts->nelts
+         ? svn_stringbuf_dup(APR_ARRAY_IDX(b->texts, b->texts->nelts - 1,
+                                           svn_stringbuf_t *),
+                             b->pool)
+         : svn_stringbuf_create_empty(b->pool);
+  target = svn_stringbuf_create_empty(b->pool);
+
+  svn_txdelta_apply(svn_stream_from_stringbuf(source, b->pool),
+                    svn_stream_from_stringbuf(target, b->pool),
+                    NULL, NULL, b->pool, delta_handler, delta_baton);
+
+  APR_ARRAY_PUSH(b->texts, svn_stringbuf_t *) = target;
+  APR_ARRAY_PUSH(b->revs, svn_revnum_t) = rev;
+
+  return SVN_NO_ERROR;
+}
+
+/* Test that svn_repos_get_file_revs2 sends correct deltas for files
+   with enough revisions to have their fulltexts read ahead. */
+static svn_error_t *
+test_get_file_revs_deltas(const svn_test_opts_t *opts,
+                          apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+  apr_pool_t *subpool = svn_pool_create(pool);
+  file_revs_deltas_baton_t baton;
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-get-filerevs-deltas",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* Revisions 1 to 30:  Add and modify a file.  Revision 15 changes
+     its properties only. */
+  for (i = 1; i <= 30; ++i)
+    {
+      svn_pool_clear(subpool);
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+      if (i == 1)
+        SVN_ERR(svn_fs_make_file(txn_root, "file", subpool));
+
+      if (i == 15)
+        SVN_ERR(svn_fs_change_node_prop(txn_root, "file", "prop",
+                                        svn_string_create("value", subpool),
+                                        subpool));
+      else
+        SVN_ERR(svn_test__set_file_contents(txn_root, "file",
+                                            file_revs_deltas_text(i, subpool),
+                                            subpool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      subpool));
+    }
+
+  svn_pool_clear(subpool);
+  baton.texts = apr_array_make(subpool, 30, sizeof(svn_stringbuf_t *));
+  baton.revs = apr_array_make(subpool, 30, sizeof(svn_revnum_t));
+  baton.pool = subpool;
+
+  SVN_ERR(svn_repos_get_file_revs2(repos, "/file", 1, youngest_rev,
+                                   FALSE, NULL, NULL,
+                                   file_revs_deltas_handler, &baton,
+                                   subpool));
+
+  SVN_TEST_ASSERT(baton.texts->nelts == 29);
+  for (i = 0; i < baton.texts->nelts; ++i)
+    {
+      svn_revnum_t rev = APR_ARRAY_IDX(baton.revs, i, svn_revnum_t);
+
+      SVN_TEST_ASSERT(rev == (i < 14 ? i + 1 : i + 2));
+      SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(baton.texts, i,
+                                           svn_stringbuf_t *)->data,
+                             file_revs_deltas_text((int)rev, subpool));
+    }
+
+  svn_pool_destroy(subpool);
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 issue_4060(const svn_test_opts_t *opts,
            apr_pool_t *pool)
@@ -4142,6 +4603,136 @@ deprecated_access_context_api(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Create an executable hook program at PATH with the shell commands
+   in BODY.  Use POOL for temporary allocations. */
+static svn_error_t *
+create_shell_hook(const char *path,
+                  const char *body,
+                  apr_pool_t *pool)
+{
+  SVN_ERR(svn_io_file_create(path,
+                             apr_pstrcat(pool, "#!/bin/sh\n", body, "\n",
+                                         SVN_VA_NULL),
+                             pool));
+  return svn_error_trace(svn_io_set_file_executable(path, TRUE, FALSE,
+                                                    pool));
+}
+
+/* Commit an empty directory at PATH in REPOS and return the new
+   revision in *NEW_REV.  Run all hooks.  Use POOL for allocations. */
+static svn_error_t *
+commit_dir_with_hooks(svn_revnum_t *new_rev,
+                      svn_repos_t *repos,
+                      const char *path,
+                      apr_pool_t *pool)
+{
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_revnum_t youngest;
+
+  SVN_ERR(svn_fs_youngest_rev(&youngest, svn_repos_fs(repos), pool));
+  SVN_ERR(svn_repos_fs_begin_txn_for_commit2(&txn, repos, youngest,
+                                             apr_hash_make(pool), pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_make_dir(root, path, pool));
+
+  return svn_error_trace(svn_repos_fs_commit_txn(NULL, repos, new_rev, txn,
+                                                 pool));
+}
+
+static svn_error_t *
+test_hook_daemon(const svn_test_opts_t *opts,
+                 apr_pool_t *pool)
+{
+#ifdef WIN32
+  return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                          "Test requires a POSIX shell");
+#else
+  svn_repos_t *repos;
+  svn_revnum_t new_rev;
+  svn_error_t *err;
+
+  /* A daemon that rejects the first pre-commit and accepts everything
+     else.  It counts the requests itself, so this only works if it is
+     the same process every time. */
+  static const char * const daemon_script =
+    "#!/bin/sh\n"
+    "LC_ALL=C\n"
+    "export LC_ALL\n"
+    "read_field() {\n"
+    "  read LEN || exit 0\n"
+    "  FIELD=`dd bs=1 count=\"$LEN\" 2>/dev/null`\n"
+    "  read NEWLINE\n"
+    "}\n"
+    "reply() {\n"
+    "  printf '%d\\n%s\\n%d\\n%s\\n%d\\n%s\\n' ${#1} \"$1\" ${#2} \"$2\" ${#3} \"$3\"\n"
+    "}\n"
+    "COUNT=0\n"
+    "while read_field; do\n"
+    "  HOOK=\"$FIELD\"\n"
+    "  read_field\n"
+    "  ARGC=\"$FIELD\"\n"
+    "  N=\"$ARGC\"\n"
+    "  while [ \"$N\" -gt 0 ]; do read_field; N=$((N - 1)); done\n"
+    "  read_field\n"
+    "  N=\"$FIELD\"\n"
+    "  while [ \"$N\" -gt 0 ]; do read_field; N=$((N - 1)); done\n"
+    "  read_field\n"
+    "  if [ \"$HOOK\" = pre-commit ]; then COUNT=$((COUNT + 1)); fi\n"
+    "  if [ \"$HOOK\" = pre-commit ] && [ \"$COUNT\" = 1 ]; then\n"
+    "    reply 1 \"\" \"rejected $HOOK with $ARGC args\"\n"
+    "  else\n"
+    "    reply 0 \"\" \"\"\n"
+    "  fi\n"
+    "done\n";
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-hook-daemon",
+                                 opts, pool));
+
+  /* The hook programs themselves would accept everything. */
+  SVN_ERR(create_shell_hook(svn_repos_start_commit_hook(repos, pool),
+                            "exit 0", pool));
+  SVN_ERR(create_shell_hook(svn_repos_pre_commit_hook(repos, pool),
+                            "exit 0", pool));
+  SVN_ERR(svn_io_file_create(svn_dirent_join(svn_repos_hook_dir(repos, pool),
+                                             "hook-daemon", pool),
+                             daemon_script, pool));
+  SVN_ERR(svn_io_set_file_executable(
+            svn_dirent_join(svn_repos_hook_dir(repos, pool), "hook-daemon",
+                            pool),
+            TRUE, FALSE, pool));
+
+  /* The daemon receives the hook name and its arguments. */
+  err = commit_dir_with_hooks(&new_rev, repos, "/A", pool);
+  SVN_TEST_ASSERT(err);
+  err = svn_error_purge_tracing(err);
+  SVN_TEST_ASSERT(err->apr_err == SVN_ERR_REPOS_HOOK_FAILURE);
+  SVN_TEST_ASSERT(strstr(err->message, "rejected pre-commit with 3 args"));
+  svn_error_clear(err);
+
+  /* The same daemon handles the next commit. */
+  SVN_ERR(commit_dir_with_hooks(&new_rev, repos, "/B", pool));
+  SVN_TEST_ASSERT(new_rev == 1);
+
+  /* Without the daemon, the hook programs run again. */
+  SVN_ERR(svn_io_remove_file2(
+            svn_dirent_join(svn_repos_hook_dir(repos, pool), "hook-daemon",
+                            pool),
+            FALSE, pool));
+  SVN_ERR(create_shell_hook(svn_repos_pre_commit_hook(repos, pool),
+                            "echo rejected by hook program >&2\nexit 1",
+                            pool));
+  err = commit_dir_with_hooks(&new_rev, repos, "/C", pool);
+  SVN_TEST_ASSERT(err);
+  err = svn_error_purge_tracing(err);
+  SVN_TEST_ASSERT(err->apr_err == SVN_ERR_REPOS_HOOK_FAILURE);
+  SVN_TEST_ASSERT(strstr(err->message, "rejected by hook program"));
+  svn_error_clear(err);
+
+  return SVN_NO_ERROR;
+#endif
+}
+
 static svn_error_t *
 mkdir_delete_copy(svn_repos_t *repos,
                   const char *src,
@@ -4429,6 +5020,19 @@ list_callback(const char *path,
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_repos_authz_func_t.  Deny access to BATON and all
+   paths below it. */
+static svn_error_t *
+list_authz_func(svn_boolean_t *allowed,
+                svn_fs_root_t *root,
+                const char *path,
+                void *baton,
+                apr_pool_t *pool)
+{
+  *allowed = !svn_dirent_is_ancestor(baton, path);
+
+  return SVN_NO_ERROR;
+}
 
 static svn_error_t *
 test_list(const svn_test_opts_t *opts,
@@ -4463,6 +5067,31 @@ test_list(const svn_test_opts_t *opts,
                          pool));
   SVN_TEST_ASSERT(counter == 7);
 
+  /* Mix literal patterns with prefixed ones.  Matching is case-
+     insensitive, so this finds 'mu', 'gamma' and 'G'. */
+  counter = 0;
+  apr_array_clear(patterns);
+  APR_ARRAY_PUSH(patterns, const char *) = "mu";
+  APR_ARRAY_PUSH(patterns, const char *) = "g*";
+  SVN_ERR(svn_repos_list(rev_root, "/A", patterns, svn_depth_infinity, FALSE,
+                         NULL, NULL, list_callback, &counter, NULL, NULL,
+                         pool));
+  SVN_TEST_ASSERT(counter == 3);
+
+  /* Non-matching sub-directories don't matter for shallow listings. */
+  counter = 0;
+  SVN_ERR(svn_repos_list(rev_root, "/A/D", patterns, svn_depth_immediates,
+                         TRUE, NULL, NULL, list_callback, &counter, NULL,
+                         NULL, pool));
+  SVN_TEST_ASSERT(counter == 2);
+
+  /* Unreadable sub-trees must be skipped entirely. */
+  counter = 0;
+  SVN_ERR(svn_repos_list(rev_root, "/A", NULL, svn_depth_infinity, TRUE,
+                         list_authz_func, "/A/D/G", list_callback, &counter,
+                         NULL, NULL, pool));
+  SVN_TEST_ASSERT(counter == 15);
+
   return SVN_NO_ERROR;
 }
 
@@ -4501,12 +5130,20 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test svn_repos_node_location_segments"),
     SVN_TEST_OPTS_PASS(reporter_depth_exclude,
                        "test reporter and svn_depth_exclude"),
+    SVN_TEST_OPTS_PASS(reporter_prefetch,
+                       "test reporter with delta prefetching"),
+    SVN_TEST_OPTS_PASS(replay_prefetch_window,
+                       "test replay prefetcher window and byte limit"),
     SVN_TEST_OPTS_PASS(prop_validation,
                        "test if revprops are validated by repos"),
     SVN_TEST_OPTS_PASS(get_logs,
                        "test svn_repos_get_logs ranges and limits"),
+    SVN_TEST_OPTS_PASS(get_logs_long,
+                       "test svn_repos_get_logs5 with long logs"),
     SVN_TEST_OPTS_PASS(test_get_file_revs,
                        "test svn_repos_get_file_revsN"),
+    SVN_TEST_OPTS_PASS(test_get_file_revs_deltas,
+                       "test svn_repos_get_file_revs2 deltas"),
     SVN_TEST_OPTS_PASS(issue_4060,
                        "test issue 4060"),
     SVN_TEST_OPTS_PASS(test_delete_repos,
@@ -4521,6 +5158,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test test_repos_fs_type"),
     SVN_TEST_OPTS_PASS(deprecated_access_context_api,
                        "test deprecated access context api"),
+    SVN_TEST_OPTS_PASS(test_hook_daemon,
+                       "test running hooks through a hook daemon"),
     SVN_TEST_OPTS_PASS(trace_node_locations_authz,
                        "authz for svn_repos_trace_node_locations"),
     SVN_TEST_OPTS_PASS(commit_aborted_txn,
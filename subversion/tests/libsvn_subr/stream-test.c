@@ -1065,6 +1065,74 @@ test_stream_readline_file_nul(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_stream_read_ahead(apr_pool_t *pool)
+{
+  /* Large enough to require multiple refills of the read-ahead buffer. */
+  enum { LINE_COUNT = 500000 };
+
+  svn_stringbuf_t *content = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *rest;
+  apr_pool_t *source_pool = svn_pool_create(pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_stream_t *source;
+  svn_stream_t *stream;
+  apr_size_t offset = 0;
+  apr_size_t len;
+  int i;
+
+  for (i = 0; i < LINE_COUNT; ++i)
+    {
+      svn_pool_clear(iterpool);
+      svn_stringbuf_appendcstr(content,
+                               apr_psprintf(iterpool, "line %d\r\n", i));
+    }
+  svn_stringbuf_appendcstr(content, "no EOL");
+
+  source = svn_stream_from_stringbuf(content, source_pool);
+  SVN_ERR(svn_stream__read_ahead(&stream, source, pool));
+
+  /* Read the first half line by line. */
+  for (i = 0; i < LINE_COUNT / 2; ++i)
+    {
+      svn_stringbuf_t *line;
+      svn_boolean_t eof;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_stream_readline(stream, &line, "\r\n", &eof, iterpool));
+      SVN_TEST_ASSERT(!eof);
+      SVN_TEST_STRING_ASSERT(line->data,
+                             apr_psprintf(iterpool, "line %d", i));
+      offset += line->len + 2;
+    }
+
+  /* Read the remainder en bloc. */
+  len = content->len - offset + 1;
+  rest = svn_stringbuf_create_ensure(len, pool);
+  SVN_ERR(svn_stream_read_full(stream, rest->data, &len));
+  SVN_TEST_ASSERT(len == content->len - offset);
+  SVN_TEST_ASSERT(memcmp(rest->data, content->data + offset, len) == 0);
+
+  /* Further reads hit EOF. */
+  len = 1;
+  SVN_ERR(svn_stream_read_full(stream, rest->data, &len));
+  SVN_TEST_ASSERT(len == 0);
+
+  SVN_ERR(svn_stream_close(stream));
+
+  /* Closing without reading everything must work as well. */
+  source = svn_stream_from_stringbuf(content, source_pool);
+  SVN_ERR(svn_stream__read_ahead(&stream, source, pool));
+  len = 10;
+  SVN_ERR(svn_stream_read_full(stream, rest->data, &len));
+  SVN_TEST_ASSERT(len == 10);
+  SVN_ERR(svn_stream_close(stream));
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 1;
@@ -1104,6 +1172,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test reading CRLF-terminated lines from file"),
     SVN_TEST_PASS2(test_stream_readline_file_nul,
                    "test reading line from file with nul bytes"),
+    SVN_TEST_PASS2(test_stream_read_ahead,
+                   "test reading streams ahead in another thread"),
     SVN_TEST_NULL
   };
 
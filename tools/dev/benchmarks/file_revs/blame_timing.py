@@ -0,0 +1,181 @@
+#!/usr/bin/env python
+#
+#  blame_timing.py: measure svnserve CPU and wall time of 'svn blame'.
+#
+#  Subversion is a tool for revision control.
+#  See http://subversion.apache.org for more information.
+#
+# ====================================================================
+#    Licensed to the Apache Software Foundation (ASF) under one
+#    or more contributor license agreements.  See the NOTICE file
+#    distributed with this work for additional information
+#    regarding copyright ownership.  The ASF licenses this file
+#    to you under the Apache License, Version 2.0 (the
+#    "License"); you may not use this file except in compliance
+#    with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing,
+#    software distributed under the License is distributed on an
+#    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#    KIND, either express or implied.  See the License for the
+#    specific language governing permissions and limitations
+#    under the License.
+######################################################################
+
+"""Usage: blame_timing.py [options]
+
+Load a fresh repository with a single file that has been modified in
+many revisions, serve it with a threaded svnserve and run 'svn blame'
+on it a few times.  For each run, report the wall time of the client as
+well as the user and system CPU time used by svnserve, i.e. the cost of
+the server-side get-file-revs.
+
+The first run starts with cold server caches, the later ones with warm
+caches.  This is a Unix-only tool.
+"""
+
+# General modules
+import optparse
+import os
+import random
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+FILE_NAME = 'file.txt'
+
+def write_dump(path, revisions, lines, changes):
+  """ Write a dump file to PATH that creates FILE_NAME with LINES lines
+      in r1 and modifies CHANGES of its lines in each of the following
+      REVISIONS - 1 revisions. """
+  rng = random.Random(revisions)
+  content = ['line %d of the original text\n' % i for i in range(lines)]
+  empty_props = b'PROPS-END\n'
+
+  with open(path, 'wb') as f:
+    f.write(b'SVN-fs-dump-format-version: 2\n\n')
+    for rev in range(1, revisions + 1):
+      if rev > 1:
+        for i in range(changes):
+          line = rng.randrange(lines)
+          content[line] = 'line %d changed in r%d\n' % (line, rev)
+
+      text = ''.join(content).encode()
+      f.write(b'Revision-number: %d\n' % rev)
+      f.write(b'Prop-content-length: %d\n' % len(empty_props))
+      f.write(b'Content-length: %d\n\n' % len(empty_props))
+      f.write(empty_props + b'\n')
+
+      f.write(b'Node-path: ' + FILE_NAME.encode() + b'\n')
+      f.write(b'Node-kind: file\n')
+      if rev == 1:
+        f.write(b'Node-action: add\n')
+        f.write(b'Prop-content-length: %d\n' % len(empty_props))
+        f.write(b'Text-content-length: %d\n' % len(text))
+        f.write(b'Content-length: %d\n\n' % (len(empty_props) + len(text)))
+        f.write(empty_props)
+      else:
+        f.write(b'Node-action: change\n')
+        f.write(b'Text-content-length: %d\n' % len(text))
+        f.write(b'Content-length: %d\n\n' % len(text))
+      f.write(text + b'\n\n')
+
+def cpu_times(pid):
+  """ Return the user and system CPU seconds used by process PID. """
+  with open('/proc/%d/stat' % pid) as f:
+    # The command name may contain blanks; skip past it.
+    fields = f.read().rsplit(')', 1)[1].split()
+  ticks = float(os.sysconf('SC_CLK_TCK'))
+  return int(fields[11]) / ticks, int(fields[12]) / ticks
+
+def free_port():
+  s = socket.socket()
+  s.bind(('127.0.0.1', 0))
+  port = s.getsockname()[1]
+  s.close()
+  return port
+
+def start_server(opts, root):
+  port = free_port()
+  cmd = [opts.svnserve, '-d', '--foreground', '--threads', '-r', root,
+         '--listen-host', '127.0.0.1', '--listen-port', str(port)]
+  if opts.memory_cache_size is not None:
+    cmd += ['-M', str(opts.memory_cache_size)]
+
+  server = subprocess.Popen(cmd)
+
+  # Wait for the server to listen.
+  for i in range(100):
+    try:
+      socket.create_connection(('127.0.0.1', port)).close()
+      return server, port
+    except socket.error:
+      time.sleep(0.1)
+
+  server.kill()
+  sys.exit('svnserve did not start: %s' % ' '.join(cmd))
+
+def run(opts, root):
+  server, port = start_server(opts, root)
+  url = 'svn://127.0.0.1:%d/repo/%s' % (port, FILE_NAME)
+
+  try:
+    with open(os.devnull, 'wb') as devnull:
+      for i in range(opts.runs):
+        user, system = cpu_times(server.pid)
+        t = time.time()
+        subprocess.check_call([opts.svn, 'blame', '--non-interactive', url],
+                              stdout=devnull)
+        wall = time.time() - t
+        end_user, end_system = cpu_times(server.pid)
+
+        print('run %d: wall %.2f s, svnserve user %.2f s, system %.2f s'
+              % (i + 1, wall, end_user - user, end_system - system))
+  finally:
+    server.terminate()
+    server.wait()
+
+def main():
+  parser = optparse.OptionParser(usage=__doc__)
+  parser.add_option('--revisions', type='int', default=2000,
+                    help='number of revisions of the file [%default]')
+  parser.add_option('--lines', type='int', default=2000,
+                    help='number of lines in the file [%default]')
+  parser.add_option('--changes', type='int', default=5,
+                    help='lines changed per revision [%default]')
+  parser.add_option('--runs', type='int', default=3,
+                    help='number of blame runs [%default]')
+  parser.add_option('--memory-cache-size', type='int',
+                    help='passed on to svnserve as -M')
+  parser.add_option('--svn', default='svn',
+                    help='svn binary to use [%default]')
+  parser.add_option('--svnserve', default='svnserve',
+                    help='svnserve binary to use [%default]')
+  parser.add_option('--svnadmin', default='svnadmin',
+                    help='svnadmin binary to use [%default]')
+  opts, args = parser.parse_args()
+  if args:
+    parser.error('unexpected arguments')
+
+  root = tempfile.mkdtemp(prefix='blame_timing.')
+  try:
+    repo = os.path.join(root, 'repo')
+    dump = os.path.join(root, 'repo.dump')
+
+    write_dump(dump, opts.revisions, opts.lines, opts.changes)
+    subprocess.check_call([opts.svnadmin, 'create', repo])
+    with open(dump, 'rb') as f:
+      subprocess.check_call([opts.svnadmin, 'load', '-q', repo], stdin=f)
+    os.remove(dump)
+
+    run(opts, root)
+  finally:
+    shutil.rmtree(root)
+
+if __name__ == '__main__':
+  main()
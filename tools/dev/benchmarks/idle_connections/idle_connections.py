@@ -0,0 +1,323 @@
+#!/usr/bin/env python
+#
+#  idle_connections.py: measure svnserve with many idle ra_svn sessions.
+#
+#  Subversion is a tool for revision control.
+#  See http://subversion.apache.org for more information.
+#
+# ====================================================================
+#    Licensed to the Apache Software Foundation (ASF) under one
+#    or more contributor license agreements.  See the NOTICE file
+#    distributed with this work for additional information
+#    regarding copyright ownership.  The ASF licenses this file
+#    to you under the Apache License, Version 2.0 (the
+#    "License"); you may not use this file except in compliance
+#    with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing,
+#    software distributed under the License is distributed on an
+#    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#    KIND, either express or implied.  See the License for the
+#    specific language governing permissions and limitations
+#    under the License.
+######################################################################
+
+"""Usage: idle_connections.py [options]
+
+Start a threaded svnserve on a fresh repository, open many ra_svn sessions
+that stay idle after the handshake, and let a few other sessions issue
+requests as fast as they can.  Report the request throughput and latency
+of the active sessions as well as the number of threads and the memory
+used by svnserve.
+
+By default, this is done twice: once with the classic thread pool mode
+and once with --park-idle.  This is a Unix-only tool.
+"""
+
+# General modules
+import optparse
+import os
+import resource
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+# The capabilities we announce to the server.
+CLIENT_CAPS = b'edit-pipeline svndiff1 absent-entries depth mergeinfo ' \
+              b'log-revprops'
+
+class ProtocolError(Exception):
+  pass
+
+class Connection:
+  """ A minimal ra_svn client connection.
+
+      It knows just enough about the protocol to perform an anonymous
+      handshake and to send simple commands.  Responses are parsed into
+      nested lists of words, numbers and byte strings.
+  """
+
+  def __init__(self, host, port, url):
+    self.sock = socket.create_connection((host, port))
+    self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    self.buffer = b''
+    self.url = url.encode()
+
+  def close(self):
+    self.sock.close()
+
+  def _fill(self):
+    data = self.sock.recv(16384)
+    if not data:
+      raise ProtocolError('connection closed by server')
+    self.buffer += data
+
+  def _char(self):
+    while not self.buffer:
+      self._fill()
+    c = self.buffer[:1]
+    self.buffer = self.buffer[1:]
+    return c
+
+  def _token(self):
+    """ Return the next item: '(' or ')' as str, or a word, number or
+        byte string.  Whitespace between items is skipped. """
+    c = self._char()
+    while c in b' \n':
+      c = self._char()
+
+    if c in b'()':
+      return c.decode()
+
+    token = c
+    c = self._char()
+    while c not in b' \n:':
+      token += c
+      c = self._char()
+
+    if c != b':':
+      return int(token) if token.isdigit() else token.decode()
+
+    # A string: LEN:BYTES
+    length = int(token)
+    while len(self.buffer) < length:
+      self._fill()
+    value = self.buffer[:length]
+    self.buffer = self.buffer[length:]
+    return value
+
+  def read_item(self):
+    token = self._token()
+    if token != '(':
+      return token
+
+    items = []
+    while True:
+      item = self.read_item()
+      if item == ')':
+        return items
+      items.append(item)
+
+  def read_response(self):
+    response = self.read_item()
+    if not isinstance(response, list) or response[0] != 'success':
+      raise ProtocolError('unexpected response: %r' % (response,))
+    return response[1]
+
+  def send(self, data):
+    self.sock.sendall(data)
+
+  def handshake(self):
+    self.read_response()    # greeting
+    self.send(b'( 2 ( ' + CLIENT_CAPS + b' ) '
+              + str(len(self.url)).encode() + b':' + self.url
+              + b' 17:idle_connections ( ) ) ')
+    self.read_response()    # auth request
+    self.send(b'( ANONYMOUS ( 0: ) ) ')
+    self.read_response()    # auth success
+    self.read_response()    # repository info
+
+  def get_latest_rev(self):
+    self.send(b'( get-latest-rev ( ) ) ')
+    self.read_response()    # (empty) auth request
+    return self.read_response()[0]
+
+
+def raise_fd_limit(needed):
+  soft, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+  if hard != resource.RLIM_INFINITY and hard < needed:
+    sys.exit('need %d file handles but the hard limit is %d' % (needed, hard))
+  if soft == resource.RLIM_INFINITY or soft < needed:
+    resource.setrlimit(resource.RLIMIT_NOFILE, (needed, hard))
+
+def process_status(pid):
+  """ Return the number of threads and the resident memory in kB. """
+  threads = rss = 0
+  with open('/proc/%d/status' % pid) as f:
+    for line in f:
+      if line.startswith('Threads:'):
+        threads = int(line.split()[1])
+      elif line.startswith('VmRSS:'):
+        rss = int(line.split()[1])
+  return threads, rss
+
+def free_port():
+  s = socket.socket()
+  s.bind(('127.0.0.1', 0))
+  port = s.getsockname()[1]
+  s.close()
+  return port
+
+def start_server(opts, root, park_idle):
+  port = free_port()
+  cmd = [opts.svnserve, '-d', '--foreground', '--threads', '-r', root,
+         '--listen-host', '127.0.0.1', '--listen-port', str(port)]
+  if opts.max_threads:
+    cmd += ['--max-threads', str(opts.max_threads)]
+  if park_idle:
+    cmd += ['--park-idle']
+
+  server = subprocess.Popen(cmd)
+
+  # Wait for the server to listen.
+  for i in range(100):
+    try:
+      socket.create_connection(('127.0.0.1', port)).close()
+      return server, port
+    except socket.error:
+      time.sleep(0.1)
+
+  server.kill()
+  sys.exit('svnserve did not start: %s' % ' '.join(cmd))
+
+def open_idle(count, port, url, jobs=32):
+  """ Open COUNT connections in parallel and return them. """
+  result = []
+  lock = threading.Lock()
+
+  def worker(n):
+    for i in range(n):
+      conn = Connection('127.0.0.1', port, url)
+      conn.handshake()
+      with lock:
+        result.append(conn)
+
+  threads = [threading.Thread(target=worker,
+                              args=(count // jobs + (i < count % jobs),))
+             for i in range(jobs)]
+  for t in threads:
+    t.start()
+  for t in threads:
+    t.join()
+
+  return result
+
+def run_active(count, port, url, duration):
+  """ Let COUNT connections issue requests for DURATION seconds.
+      Return the list of all request latencies. """
+  latencies = []
+  lock = threading.Lock()
+  start = threading.Event()
+
+  def worker():
+    conn = Connection('127.0.0.1', port, url)
+    conn.handshake()
+    mine = []
+    start.wait()
+    end = time.time() + duration
+    while time.time() < end:
+      t = time.time()
+      conn.get_latest_rev()
+      mine.append(time.time() - t)
+    conn.close()
+    with lock:
+      latencies.extend(mine)
+
+  threads = [threading.Thread(target=worker) for i in range(count)]
+  for t in threads:
+    t.start()
+  start.set()
+  for t in threads:
+    t.join()
+
+  return latencies
+
+def percentile(values, p):
+  return values[min(len(values) - 1, int(len(values) * p / 100.0))]
+
+def run(opts, root, park_idle):
+  server, port = start_server(opts, root, park_idle)
+  url = 'svn://127.0.0.1:%d/repo' % port
+  label = park_idle and '--park-idle' or 'thread pool'
+
+  try:
+    t = time.time()
+    idle = open_idle(opts.idle, port, url)
+    print('%s: opened %d idle connections in %.1f s'
+          % (label, len(idle), time.time() - t))
+
+    time.sleep(1)
+    threads, rss = process_status(server.pid)
+    print('%s: idle   svnserve threads %d, RSS %d MB'
+          % (label, threads, rss // 1024))
+
+    latencies = sorted(run_active(opts.active, port, url, opts.duration))
+    threads, rss = process_status(server.pid)
+    print('%s: active svnserve threads %d, RSS %d MB'
+          % (label, threads, rss // 1024))
+
+    if latencies:
+      print('%s: %d requests, %.0f req/s, latency p50 %.2f ms, p99 %.2f ms'
+            % (label, len(latencies), len(latencies) / opts.duration,
+               percentile(latencies, 50) * 1000,
+               percentile(latencies, 99) * 1000))
+
+    for conn in idle:
+      conn.close()
+  finally:
+    server.terminate()
+    server.wait()
+
+def main():
+  parser = optparse.OptionParser(usage=__doc__)
+  parser.add_option('--idle', type='int', default=10000,
+                    help='number of idle connections [%default]')
+  parser.add_option('--active', type='int', default=200,
+                    help='number of active connections [%default]')
+  parser.add_option('--duration', type='float', default=30,
+                    help='seconds to run the active connections [%default]')
+  parser.add_option('--max-threads', type='int', default=0,
+                    help='passed on to svnserve')
+  parser.add_option('--mode', choices=['both', 'threads', 'park-idle'],
+                    default='both',
+                    help='threads, park-idle or both [%default]')
+  parser.add_option('--svnserve', default='svnserve',
+                    help='svnserve binary to use [%default]')
+  parser.add_option('--svnadmin', default='svnadmin',
+                    help='svnadmin binary to use [%default]')
+  opts, args = parser.parse_args()
+  if args:
+    parser.error('unexpected arguments')
+
+  # Both, this process and svnserve need one handle per connection.
+  raise_fd_limit(opts.idle + opts.active + 1024)
+
+  root = tempfile.mkdtemp(prefix='idle_connections.')
+  try:
+    subprocess.check_call([opts.svnadmin, 'create',
+                           os.path.join(root, 'repo')])
+    if opts.mode in ('both', 'threads'):
+      run(opts, root, False)
+    if opts.mode in ('both', 'park-idle'):
+      run(opts, root, True)
+  finally:
+    shutil.rmtree(root)
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,232 @@
+#!/usr/bin/env python
+#
+#  delta_sizes.py: compare fixed and sliding txdelta source views.
+#
+#  Subversion is a tool for revision control.
+#  See http://subversion.apache.org for more information.
+#
+# ====================================================================
+#    Licensed to the Apache Software Foundation (ASF) under one
+#    or more contributor license agreements.  See the NOTICE file
+#    distributed with this work for additional information
+#    regarding copyright ownership.  The ASF licenses this file
+#    to you under the Apache License, Version 2.0 (the
+#    "License"); you may not use this file except in compliance
+#    with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing,
+#    software distributed under the License is distributed on an
+#    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#    KIND, either express or implied.  See the License for the
+#    specific language governing permissions and limitations
+#    under the License.
+######################################################################
+
+"""Usage: delta_sizes.py [options] [CORPUS_DIR...]
+
+Load a fresh FSFS repository with a series of versions of a single file
+and run 'svnadmin dump --deltas' over it, once with the default fixed
+source views and once with 'sliding-delta-windows' enabled in fsfs.conf.
+Report the size of the deltas in the dump as well as the time it took.
+These are the same deltas that svnserve and mod_dav_svn send to clients.
+
+Each CORPUS_DIR contains the versions of one file, e.g. the saved states
+of an office document, in the order of their names.  Without a CORPUS_DIR,
+two synthetic corpora are used: random binary data with data inserted and
+removed at random places, and a zip archive of text files that have been
+edited.  The latter is similar to office documents.
+
+This is a Unix-only tool.
+"""
+
+# General modules
+import io
+import optparse
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+import zipfile
+
+FILE_NAME = 'file.bin'
+
+def random_bytes(rng, count):
+  """ Return COUNT random bytes taken from RNG. """
+  return rng.getrandbits(8 * count).to_bytes(count, 'little')
+
+def random_binary_versions(size, revisions):
+  """ Return REVISIONS versions of SIZE bytes of random data, each one
+      with a few blocks inserted, removed or replaced. """
+  rng = random.Random(size)
+  data = bytearray(random_bytes(rng, size))
+  versions = [bytes(data)]
+
+  for rev in range(1, revisions):
+    for i in range(3):
+      pos = rng.randrange(len(data))
+      length = rng.randrange(1, 32 * 1024)
+      action = rng.randrange(3)
+      block = random_bytes(rng, length)
+      if action == 0:
+        data[pos:pos] = block
+      elif action == 1:
+        del data[pos:pos + length]
+      else:
+        data[pos:pos + length] = block
+    versions.append(bytes(data))
+
+  return versions
+
+def zip_versions(parts, revisions):
+  """ Return REVISIONS versions of a zip archive with PARTS compressed
+      text members, where each version changes a few lines in one of
+      them. """
+  rng = random.Random(parts)
+  texts = [['paragraph %d of part %d with some text to compress\n' % (i, p)
+            for i in range(2000)] for p in range(parts)]
+  versions = []
+
+  for rev in range(revisions):
+    if rev:
+      part = texts[rng.randrange(parts)]
+      for i in range(5):
+        line = rng.randrange(len(part))
+        part[line] = 'paragraph %d edited in version %d\n' % (line, rev)
+
+    buffer = io.BytesIO()
+    with zipfile.ZipFile(buffer, 'w', zipfile.ZIP_DEFLATED) as archive:
+      for p in range(parts):
+        info = zipfile.ZipInfo('part%d.xml' % p, (2000, 1, 1, 0, 0, 0))
+        info.compress_type = zipfile.ZIP_DEFLATED
+        archive.writestr(info, ''.join(texts[p]))
+    versions.append(buffer.getvalue())
+
+  return versions
+
+def corpus_versions(path):
+  """ Return the contents of all files in directory PATH, sorted by name. """
+  versions = []
+  for name in sorted(os.listdir(path)):
+    with open(os.path.join(path, name), 'rb') as f:
+      versions.append(f.read())
+  return versions
+
+def write_dump(path, versions):
+  """ Write a dump file to PATH that stores the VERSIONS of FILE_NAME
+      in consecutive revisions, starting at r1. """
+  empty_props = b'PROPS-END\n'
+
+  with open(path, 'wb') as f:
+    f.write(b'SVN-fs-dump-format-version: 2\n\n')
+    for rev, text in enumerate(versions, 1):
+      f.write(b'Revision-number: %d\n' % rev)
+      f.write(b'Prop-content-length: %d\n' % len(empty_props))
+      f.write(b'Content-length: %d\n\n' % len(empty_props))
+      f.write(empty_props + b'\n')
+
+      f.write(b'Node-path: ' + FILE_NAME.encode() + b'\n')
+      f.write(b'Node-kind: file\n')
+      if rev == 1:
+        f.write(b'Node-action: add\n')
+        f.write(b'Prop-content-length: %d\n' % len(empty_props))
+        f.write(b'Text-content-length: %d\n' % len(text))
+        f.write(b'Content-length: %d\n\n' % (len(empty_props) + len(text)))
+        f.write(empty_props)
+      else:
+        f.write(b'Node-action: change\n')
+        f.write(b'Text-content-length: %d\n' % len(text))
+        f.write(b'Content-length: %d\n\n' % len(text))
+      f.write(text + b'\n\n')
+
+def set_sliding(repo, enabled):
+  """ Set the sliding-delta-windows option in REPO's fsfs.conf. """
+  path = os.path.join(repo, 'db', 'fsfs.conf')
+  with open(path) as f:
+    lines = [line for line in f
+             if not line.startswith('sliding-delta-windows')]
+
+  section = lines.index('[deltification]\n')
+  lines.insert(section + 1, 'sliding-delta-windows = %s\n'
+                            % (enabled and 'true' or 'false'))
+  with open(path, 'w') as f:
+    f.writelines(lines)
+
+def dump_deltas(opts, repo):
+  """ Return the size of the deltas of r2 and later and the wall time. """
+  with tempfile.TemporaryFile() as out:
+    t = time.time()
+    subprocess.check_call([opts.svnadmin, 'dump', '-q', '--deltas',
+                           '--incremental', '-r', '2:HEAD', repo],
+                          stdout=out)
+    wall = time.time() - t
+    out.seek(0, os.SEEK_END)
+    return out.tell(), wall
+
+def run(opts, root, label, versions):
+  repo = os.path.join(root, 'repo')
+  dump = os.path.join(root, 'repo.dump')
+
+  write_dump(dump, versions)
+  subprocess.check_call([opts.svnadmin, 'create', '--fs-type', 'fsfs',
+                         repo])
+  with open(dump, 'rb') as f:
+    subprocess.check_call([opts.svnadmin, 'load', '-q', repo], stdin=f)
+  os.remove(dump)
+
+  fulltexts = sum(len(v) for v in versions[1:])
+  print('%s: %d versions, %.1f MB of changed fulltexts'
+        % (label, len(versions), fulltexts / 1048576.0))
+
+  try:
+    for sliding in (False, True):
+      set_sliding(repo, sliding)
+      best = None
+      for i in range(opts.runs):
+        size, wall = dump_deltas(opts, repo)
+        best = best is None and wall or min(best, wall)
+
+      print('%s: %-7s views: deltas %.1f MB (%.1f%% of fulltexts), '
+            '%.2f s, %.1f MB/s'
+            % (label, sliding and 'sliding' or 'fixed', size / 1048576.0,
+               100.0 * size / max(fulltexts, 1), best,
+               fulltexts / 1048576.0 / max(best, 0.001)))
+  finally:
+    shutil.rmtree(repo)
+
+def main():
+  parser = optparse.OptionParser(usage=__doc__)
+  parser.add_option('--size', type='int', default=8 * 1024 * 1024,
+                    help='size of the synthetic binary file [%default]')
+  parser.add_option('--parts', type='int', default=20,
+                    help='members of the synthetic zip archive [%default]')
+  parser.add_option('--revisions', type='int', default=20,
+                    help='versions of the synthetic files [%default]')
+  parser.add_option('--runs', type='int', default=3,
+                    help='dumps per variant; the fastest counts [%default]')
+  parser.add_option('--svnadmin', default='svnadmin',
+                    help='svnadmin binary to use [%default]')
+  opts, args = parser.parse_args()
+
+  if args:
+    corpora = [(os.path.basename(os.path.normpath(path)),
+                corpus_versions(path)) for path in args]
+  else:
+    corpora = [('binary', random_binary_versions(opts.size, opts.revisions)),
+               ('zip', zip_versions(opts.parts, opts.revisions))]
+
+  root = tempfile.mkdtemp(prefix='delta_sizes.')
+  try:
+    for label, versions in corpora:
+      if len(versions) < 2:
+        sys.exit('%s: need at least two versions' % label)
+      run(opts, root, label, versions)
+  finally:
+    shutil.rmtree(root)
+
+if __name__ == '__main__':
+  main()